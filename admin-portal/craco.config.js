@@ -0,0 +1,39 @@
+/**
+ * Build overrides for react-scripts
+ * Splits the chain libraries (ethers and its @ethersproject packages, only
+ * reached through dynamic imports) and MUI/emotion into their own vendor
+ * chunks, so they are cached independently of app code and never end up in
+ * the entry bundle by way of the shared node_modules chunk.
+ */
+module.exports = {
+  webpack: {
+    configure: (webpackConfig, { env }) => {
+      if (env !== 'production') {
+        return webpackConfig;
+      }
+
+      const splitChunks = webpackConfig.optimization.splitChunks || {};
+      webpackConfig.optimization.splitChunks = {
+        ...splitChunks,
+        chunks: 'all',
+        cacheGroups: {
+          ...(splitChunks.cacheGroups || {}),
+          ethers: {
+            test: /[\\/]node_modules[\\/](ethers|@ethersproject|bn\.js|elliptic|js-sha3|hash\.js|aes-js|scrypt-js)[\\/]/,
+            name: 'vendor-ethers',
+            chunks: 'async',
+            priority: 30,
+            enforce: true
+          },
+          mui: {
+            test: /[\\/]node_modules[\\/](@mui|@emotion)[\\/]/,
+            name: 'vendor-mui',
+            priority: 20,
+            reuseExistingChunk: true
+          }
+        }
+      };
+      return webpackConfig;
+    }
+  }
+};
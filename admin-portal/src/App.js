@@ -3,14 +3,16 @@ import { BrowserRouter as Router, Routes, Route, Navigate } from 'react-router-d
 import { AuthProvider, useAuth } from './utils/AuthContext';
 import { ThemeProvider } from './utils/ThemeContext';
 
-// Pages
+// Pages: login is in the entry chunk, the rest load on demand (see routes.js)
 import Login from './pages/Login';
-import Dashboard from './pages/Dashboard';
-import RecordManagement from './pages/RecordManagement';
-import ActivityLogs from './pages/ActivityLogs';
-import Settings from './pages/Settings';
-import ProfessionalRecords from './pages/ProfessionalRecords';
-import FaceVerification from './pages/FaceVerification';
+import {
+  Dashboard,
+  RecordManagement,
+  ActivityLogs,
+  Settings,
+  ProfessionalRecords,
+  FaceVerification
+} from './routes';
 
 // Components
 import MainLayout from './components/MainLayout';
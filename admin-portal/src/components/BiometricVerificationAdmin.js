@@ -1,5 +1,6 @@
 import React, { useState, useEffect, useRef } from 'react';
 import ApiService from '../services/ApiService';
+import { loadFaceDetection, createFaceDetector, captureFrame } from '../utils/faceDetection';
 import { FaCamera, FaCheck, FaTimes, FaSpinner, FaExclamationTriangle } from 'react-icons/fa';
 
 const BiometricVerificationAdmin = ({ onVerificationComplete, onError }) => {
@@ -9,48 +10,24 @@ const BiometricVerificationAdmin = ({ onVerificationComplete, onError }) => {
   const [faceDetected, setFaceDetected] = useState(false);
   const [verificationStatus, setVerificationStatus] = useState(null); // null, 'success', 'failed'
   const [userInfo, setUserInfo] = useState(null);
-  const [processingFrame, setProcessingFrame] = useState(false);
   
   const videoRef = useRef(null);
   const canvasRef = useRef(null);
   const streamRef = useRef(null);
-  const animationRef = useRef(null);
+  const detectorRef = useRef(null);
   
-  // Initialize OpenCV
+  // Load OpenCV.js (in the face detection worker where supported)
   useEffect(() => {
-    // Check if OpenCV is already loaded
-    if (window.cv) {
-      setLoading(false);
-      return;
-    }
-
-    // Add event listener for when OpenCV is loaded
-    window.addEventListener('opencv-loaded', () => {
-      console.log('OpenCV.js loaded successfully');
-      setLoading(false);
-    });
-
-    // If OpenCV script doesn't exist, add it
-    if (!document.getElementById('opencv-script')) {
-      const script = document.createElement('script');
-      script.id = 'opencv-script';
-      script.src = 'https://docs.opencv.org/4.5.5/opencv.js';
-      script.async = true;
-      script.onload = () => {
-        // Dispatch event when loaded
-        window.dispatchEvent(new Event('opencv-loaded'));
-      };
-      script.onerror = () => {
+    let mounted = true;
+    loadFaceDetection()
+      .then(() => mounted && setLoading(false))
+      .catch(() => {
+        if (!mounted) return;
         setError('Failed to load OpenCV.js. Please refresh the page and try again.');
         setLoading(false);
-      };
-      document.body.appendChild(script);
-    }
-
-    return () => {
-      window.removeEventListener('opencv-loaded', () => {
-        console.log('OpenCV.js event listener removed');
       });
+    return () => {
+      mounted = false;
     };
   }, []);
 
@@ -92,9 +69,9 @@ const BiometricVerificationAdmin = ({ onVerificationComplete, onError }) => {
   };
 
   const stopCamera = () => {
-    if (animationRef.current) {
-      cancelAnimationFrame(animationRef.current);
-      animationRef.current = null;
+    if (detectorRef.current) {
+      detectorRef.current.stop();
+      detectorRef.current = null;
     }
     
     if (streamRef.current) {
@@ -105,148 +82,20 @@ const BiometricVerificationAdmin = ({ onVerificationComplete, onError }) => {
     setCameraActive(false);
   };
 
+  // Analyze frames off the UI thread; the overlay canvas is drawn by the detector
   const startVideoProcessing = () => {
-    if (!window.cv || !videoRef.current || !canvasRef.current) return;
-    
-    const processFrame = () => {
-      if (!videoRef.current || !canvasRef.current || !streamRef.current) return;
-      
-      const video = videoRef.current;
-      const canvas = canvasRef.current;
-      
-      // Only process if video is playing
-      if (video.readyState !== video.HAVE_ENOUGH_DATA || processingFrame) {
-        animationRef.current = requestAnimationFrame(processFrame);
-        return;
-      }
-      
-      // Set canvas dimensions to match video
-      canvas.width = video.videoWidth;
-      canvas.height = video.videoHeight;
-      
-      // Draw video frame to canvas
-      const ctx = canvas.getContext('2d');
-      ctx.drawImage(video, 0, 0, canvas.width, canvas.height);
-      
-      // Process frame for face detection
-      detectFace(canvas, ctx);
-      
-      // Continue processing frames
-      animationRef.current = requestAnimationFrame(processFrame);
-    };
-    
-    animationRef.current = requestAnimationFrame(processFrame);
-  };
+    if (!videoRef.current || !canvasRef.current || detectorRef.current) return;
 
-  const detectFace = async (canvas, ctx) => {
-    if (!window.cv || processingFrame) return;
-    
-    setProcessingFrame(true);
-    
-    try {
-      // Get image data from canvas
-      const imageData = ctx.getImageData(0, 0, canvas.width, canvas.height);
-      
-      // Create OpenCV matrices
-      const src = new window.cv.Mat(canvas.height, canvas.width, window.cv.CV_8UC4);
-      
-      // Copy image data to src matrix
-      const data = imageData.data;
-      const numBytes = data.length * data.BYTES_PER_ELEMENT;
-      const dataPtr = src.data;
-      
-      // Copy data from canvas to OpenCV matrix
-      for (let i = 0; i < numBytes; i++) {
-        dataPtr[i] = data[i];
-      }
-      
-      // Define center region for face detection (middle 60% of frame)
-      const centerX = Math.floor(canvas.width * 0.2);
-      const centerY = Math.floor(canvas.height * 0.2);
-      const centerWidth = Math.floor(canvas.width * 0.6);
-      const centerHeight = Math.floor(canvas.height * 0.6);
-      const centerRect = new window.cv.Rect(centerX, centerY, centerWidth, centerHeight);
-      
-      // Extract center region
-      const centerRegion = src.roi(centerRect);
-      
-      // Convert to grayscale for analysis
-      const gray = new window.cv.Mat();
-      window.cv.cvtColor(centerRegion, gray, window.cv.COLOR_RGBA2GRAY);
-      
-      // Calculate brightness (mean of center region)
-      const mean = new window.cv.Mat();
-      const stddev = new window.cv.Mat();
-      window.cv.meanStdDev(gray, mean, stddev);
-      const brightness = mean.data64F[0];
-      const contrast = stddev.data64F[0];
-      
-      // Apply Canny edge detection
-      const edges = new window.cv.Mat();
-      window.cv.Canny(gray, edges, 50, 150);
-      
-      // Count edge pixels
-      const edgePixels = window.cv.countNonZero(edges);
-      const edgeRatio = edgePixels / (centerWidth * centerHeight);
-      
-      // Determine if face is detected based on multiple metrics
-      // Lower thresholds to make detection more lenient
-      const hasSufficientBrightness = brightness > 30; // Lower minimum brightness threshold
-      const hasSufficientContrast = contrast > 15; // Lower minimum contrast threshold
-      const hasSufficientEdges = edgeRatio > 0.03; // Lower minimum edge ratio threshold
-      
-      // Make detection more flexible - only require 2 out of 3 conditions to be met
-      const conditionsMet = [hasSufficientBrightness, hasSufficientContrast, hasSufficientEdges].filter(Boolean).length;
-      
-      // Real detection mode - face is detected if at least 2 conditions are met
-      const faceDetected = conditionsMet >= 2;
-      
-      // Log detection metrics for debugging
-      console.log('Face Detection Metrics:', {
-        brightness,
-        contrast,
-        edgeRatio,
-        hasSufficientBrightness,
-        hasSufficientContrast,
-        hasSufficientEdges,
-        conditionsMet,
-        faceDetected
-      });
-      
-      setFaceDetected(faceDetected);
-      
-      // Draw rectangle and circle for visual feedback
-      const rectColor = faceDetected ? [0, 255, 0, 255] : [255, 0, 0, 255]; // Green if face detected, red otherwise
-      const rectThickness = 2;
-      
-      // Draw rectangle around center region
-      window.cv.rectangle(src, new window.cv.Point(centerX, centerY), 
-                         new window.cv.Point(centerX + centerWidth, centerY + centerHeight), 
-                         new window.cv.Scalar(...rectColor), rectThickness);
-      
-      // Draw targeting circle in the middle
-      const centerCircleX = Math.floor(canvas.width / 2);
-      const centerCircleY = Math.floor(canvas.height / 2);
-      window.cv.circle(src, new window.cv.Point(centerCircleX, centerCircleY), 
-                      Math.floor(canvas.width / 10), // Circle radius
-                      new window.cv.Scalar(255, 255, 255, 128), // White, semi-transparent
-                      2); // Thickness
-      
-      // Put the processed frame back to canvas
-      window.cv.imshow(canvas, src);
-      
-      // Clean up OpenCV resources
-      src.delete();
-      centerRegion.delete();
-      gray.delete();
-      mean.delete();
-      stddev.delete();
-      edges.delete();
-    } catch (err) {
-      console.error('Error in face detection:', err);
-    } finally {
-      setProcessingFrame(false);
-    }
+    detectorRef.current = createFaceDetector({
+      video: videoRef.current,
+      canvas: canvasRef.current,
+      profile: 'admin',
+      onResult: (result) => setFaceDetected(result.faceDetected)
+    });
+    detectorRef.current.start().catch((err) => {
+      console.error('Error starting face detection:', err);
+      setError('Failed to start face detection. Please refresh the page and try again.');
+    });
   };
 
   const verifyUserBiometric = async () => {
@@ -261,9 +110,8 @@ const BiometricVerificationAdmin = ({ onVerificationComplete, onError }) => {
     setLoading(true);
 
     try {
-      // Capture the current frame from the canvas
-      const canvas = canvasRef.current;
-      const imageData = canvas.toDataURL('image/jpeg', 0.9);
+      // Capture the current frame from the camera
+      const imageData = captureFrame(videoRef.current, 0.9);
 
       // Create biometric data object
       const biometricData = {
@@ -303,8 +151,7 @@ const BiometricVerificationAdmin = ({ onVerificationComplete, onError }) => {
     setError(null);
     
     try {
-      const canvas = canvasRef.current;
-      const imageData = canvas.toDataURL('image/jpeg', 0.9);
+      const imageData = captureFrame(videoRef.current, 0.9);
       
       // Create biometric data object - no userId needed for direct face identification
       const biometricData = {
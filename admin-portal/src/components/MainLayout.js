@@ -1,12 +1,33 @@
-import React, { useState } from 'react';
+import React, { Suspense, useState } from 'react';
 import { NavLink, useNavigate, useLocation } from 'react-router-dom';
 import { useAuth } from '../utils/AuthContext';
 import { useTheme } from '../utils/ThemeContext';
+import { preloadFaceDetection } from '../utils/faceDetection';
+import {
+  Dashboard,
+  RecordManagement,
+  ProfessionalRecords,
+  FaceVerification,
+  ActivityLogs,
+  Settings
+} from '../routes';
 import { RiMenuFoldLine, RiMenuUnfoldLine, RiDashboardLine, RiFileUserLine,
          RiShieldUserLine, RiAccountCircleLine, RiAwardLine, RiBillLine,
          RiSettingsLine, RiLogoutBoxLine, RiSunLine, RiMoonLine, RiUser3Line,
          RiNotificationLine } from 'react-icons/ri';
 
+// Nav link hover, focus or touch fetches the page chunk before the click
+const preloadOn = (preload) => ({
+  onMouseEnter: preload,
+  onFocus: preload,
+  onTouchStart: preload
+});
+
+const preloadFaceVerification = () => {
+  FaceVerification.preload();
+  preloadFaceDetection();
+};
+
 const MainLayout = ({ children }) => {
   const [sidebarOpen, setSidebarOpen] = useState(true);
   const [showDevControls, setShowDevControls] = useState(false);
@@ -53,6 +74,7 @@ const MainLayout = ({ children }) => {
               <NavLink
                 to="/dashboard"
                 className={({ isActive }) => isActive ? 'active' : ''}
+                {...preloadOn(Dashboard.preload)}
               >
                 {!sidebarOpen && <span className="tooltip">Dashboard</span>}
                 <RiDashboardLine className="nav-icon" />
@@ -63,6 +85,7 @@ const MainLayout = ({ children }) => {
               <NavLink
                 to="/records"
                 className={({ isActive }) => isActive ? 'active' : ''}
+                {...preloadOn(RecordManagement.preload)}
               >
                 <RiFileUserLine className="nav-icon" />
                 {sidebarOpen && <span>User Records</span>}
@@ -72,6 +95,7 @@ const MainLayout = ({ children }) => {
               <NavLink
                 to="/professional-records"
                 className={({ isActive }) => isActive ? 'active' : ''}
+                {...preloadOn(ProfessionalRecords.preload)}
               >
                 <RiAwardLine className="nav-icon" />
                 {sidebarOpen && <span>Professional Records</span>}
@@ -81,6 +105,7 @@ const MainLayout = ({ children }) => {
               <NavLink
                 to="/face-verification"
                 className={({ isActive }) => isActive ? 'active' : ''}
+                {...preloadOn(preloadFaceVerification)}
               >
                 <RiUser3Line className="nav-icon" />
                 {sidebarOpen && <span>Face Verification</span>}
@@ -90,6 +115,7 @@ const MainLayout = ({ children }) => {
               <NavLink
                 to="/activity-logs"
                 className={({ isActive }) => isActive ? 'active' : ''}
+                {...preloadOn(ActivityLogs.preload)}
               >
                 <RiBillLine className="nav-icon" />
                 {sidebarOpen && <span>Activity Logs</span>}
@@ -101,6 +127,7 @@ const MainLayout = ({ children }) => {
               <NavLink
                 to="/settings"
                 className={({ isActive }) => isActive ? 'active' : ''}
+                {...preloadOn(Settings.preload)}
               >
                 <RiSettingsLine className="nav-icon" />
                 {sidebarOpen && <span>Settings</span>}
@@ -166,7 +193,10 @@ const MainLayout = ({ children }) => {
 
         {/* Content Area */}
         <main className="content-area">
-          {children}
+          {/* Page chunks load inside the layout, so navigation keeps the sidebar */}
+          <Suspense fallback={<div className="loading-spinner"><div className="spinner"></div></div>}>
+            {children}
+          </Suspense>
         </main>
       </div>
     </div>
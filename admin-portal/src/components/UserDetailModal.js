@@ -16,11 +16,24 @@ const UserDetailModal = ({ user, onClose, onUserUpdated }) => {
   const [blockchainLoading, setBlockchainLoading] = useState(false);
   const [blockchainError, setBlockchainError] = useState(null);
   const [blockchainSuccess, setBlockchainSuccess] = useState(null);
+  const [onChainIdentity, setOnChainIdentity] = useState(null);
 
   useEffect(() => {
     fetchUserDetails();
+    fetchOnChainIdentity();
   }, [user.id]);
 
+  // Identity status and professional records come back from a single aggregated RPC call
+  const fetchOnChainIdentity = async () => {
+    try {
+      const response = await ApiService.getOnChainIdentities([user.id], { recordLimit: 200 });
+      setOnChainIdentity(response.identities && response.identities.length > 0 ? response.identities[0] : null);
+    } catch (err) {
+      console.error('Error fetching on-chain identity:', err);
+      setOnChainIdentity(null);
+    }
+  };
+
   const fetchUserDetails = async () => {
     setLoading(true);
     setError(null);
@@ -386,6 +399,40 @@ const UserDetailModal = ({ user, onClose, onUserUpdated }) => {
                       )}
                     </div>
                   </div>
+                  {onChainIdentity && (
+                    <div className="user-info-section">
+                      <h3 className="section-title">On-Chain Identity</h3>
+                      <div className="info-list">
+                        <div className="info-item">
+                          <p className="info-label">Status</p>
+                          <p className="info-value">
+                            {!onChainIdentity.exists ? 'Not Registered' : (onChainIdentity.isVerified ? 'Verified' : 'Registered')}
+                          </p>
+                        </div>
+                        {onChainIdentity.exists && (
+                          <div className="info-item">
+                            <p className="info-label">On-Chain Biometric Hash</p>
+                            <p className="info-value">{truncateHash(onChainIdentity.biometricHash)}</p>
+                          </div>
+                        )}
+                        {onChainIdentity.createdAt && (
+                          <div className="info-item">
+                            <p className="info-label">Registered On Chain</p>
+                            <p className="info-value">{formatDate(onChainIdentity.createdAt * 1000)}</p>
+                          </div>
+                        )}
+                        {onChainIdentity.exists && (
+                          <div className="info-item">
+                            <p className="info-label">Professional Records</p>
+                            <p className="info-value">
+                              {onChainIdentity.professionalRecordCount} on chain
+                              ({onChainIdentity.professionalRecords.filter(record => record.isVerified).length} verified)
+                            </p>
+                          </div>
+                        )}
+                      </div>
+                    </div>
+                  )}
                 </div>
               )}
               {activeTab === 'documents' && (
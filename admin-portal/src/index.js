@@ -11,6 +11,15 @@ root.render(
   </React.StrictMode>
 );
 
+// Cache the OpenCV.js runtime between visits (see public/opencv-sw.js)
+if ('serviceWorker' in navigator && process.env.NODE_ENV === 'production') {
+  window.addEventListener('load', () => {
+    navigator.serviceWorker
+      .register(`${process.env.PUBLIC_URL}/opencv-sw.js`)
+      .catch(error => console.warn('OpenCV cache service worker registration failed:', error));
+  });
+}
+
 // If you want to start measuring performance in your app, pass a function
 // to log results (for example: reportWebVitals(console.log))
 // or send to an analytics endpoint. Learn more: https://bit.ly/CRA-vitals
@@ -1,26 +1,45 @@
-import React, { useState, useEffect, useCallback } from 'react';
+import React, { useState, useEffect, useCallback, useRef } from 'react';
 import ApiService from '../services/ApiService';
 import { FaSearch, FaDownload, FaCalendarAlt, FaFilter, 
          FaCheckCircle, FaTimesCircle, FaEdit, FaClock, 
-         FaChevronLeft, FaChevronRight, FaHistory } from 'react-icons/fa';
+         FaHistory } from 'react-icons/fa';
+
+// Map an audit_logs row from the API to the fields the table displays
+const toDisplayLog = (log) => ({
+  ...log,
+  userName: log.user_name,
+  userId: log.government_id,
+  adminName: log.admin_username,
+  timestamp: log.created_at,
+  txHash: log.details && (log.details.transactionHash || log.details.txHash)
+});
 
 const ActivityLogs = () => {
   const [logs, setLogs] = useState([]);
   const [loading, setLoading] = useState(true);
+  const [loadingMore, setLoadingMore] = useState(false);
   const [error, setError] = useState(null);
   const [searchQuery, setSearchQuery] = useState('');
-  const [currentPage, setCurrentPage] = useState(1);
-  const [totalPages, setTotalPages] = useState(1);
+  const [nextCursor, setNextCursor] = useState(null);
+  const [totalLogs, setTotalLogs] = useState(0);
+  const [totalIsEstimate, setTotalIsEstimate] = useState(false);
   const [dateRange, setDateRange] = useState({
     startDate: '',
     endDate: ''
   });
   const [actionFilter, setActionFilter] = useState('all');
   const logsPerPage = 15;
+  const sentinelRef = useRef(null);
+  const requestIdRef = useRef(0);
 
-  // Memoize fetchActivityLogs to avoid recreation on each render
-  const fetchActivityLogs = useCallback(async () => {
-    setLoading(true);
+  // Load the first page (cursor = null) or append the page after the given cursor
+  const fetchActivityLogs = useCallback(async (cursor = null) => {
+    const requestId = ++requestIdRef.current;
+    if (cursor) {
+      setLoadingMore(true);
+    } else {
+      setLoading(true);
+    }
     try {
       const filters = {
         action: actionFilter !== 'all' ? actionFilter : undefined,
@@ -29,27 +48,82 @@ const ActivityLogs = () => {
         search: searchQuery || undefined
       };
       
-      const data = await ApiService.getActivityLogs(currentPage, logsPerPage, filters);
-      setLogs(data.logs);
-      setTotalPages(Math.ceil(data.total / logsPerPage));
-      setLoading(false);
+      const data = await ApiService.getActivityLogs(cursor, logsPerPage, filters);
+      // Ignore responses for filters that have since changed
+      if (requestId !== requestIdRef.current) return;
+
+      const page = data.logs.map(toDisplayLog);
+      setLogs(prev => (cursor ? [...prev, ...page] : page));
+      setNextCursor(data.pagination.nextCursor);
+      setTotalLogs(data.pagination.total);
+      setTotalIsEstimate(Boolean(data.pagination.estimated));
+      setError(null);
     } catch (err) {
       console.error('Error fetching activity logs:', err);
       setError('Failed to load activity logs. Please try again.');
-      setLoading(false);
+    } finally {
+      if (requestId === requestIdRef.current) {
+        setLoading(false);
+        setLoadingMore(false);
+      }
     }
-  }, [currentPage, logsPerPage, searchQuery, actionFilter, dateRange]);
+  }, [logsPerPage, searchQuery, actionFilter, dateRange]);
+
+  const fetchActivityLogsRef = useRef(fetchActivityLogs);
+  fetchActivityLogsRef.current = fetchActivityLogs;
 
   useEffect(() => {
     fetchActivityLogs();
   }, [fetchActivityLogs]);
 
+  // Current filters and rows for the live handler, which subscribes once
+  const liveFilterRef = useRef({ actionFilter, dateRange });
+  liveFilterRef.current = { actionFilter, dateRange };
+  const logsRef = useRef(logs);
+  logsRef.current = logs;
 
+  // Live updates: prepend pushed logs that match the filters instead of re-querying
+  useEffect(() => {
+    const unsubscribe = ApiService.subscribeToEvents({
+      audit_log: (rows) => {
+        const { actionFilter: action, dateRange: range } = liveFilterRef.current;
+        // A fixed end date excludes anything new
+        if (range.endDate) return;
+        const fresh = rows.filter(row => action === 'all' || row.action === action).map(toDisplayLog);
+        if (fresh.length === 0) return;
+
+        const seen = new Set(logsRef.current.map(log => log.id));
+        const added = fresh.filter(log => !seen.has(log.id));
+        if (added.length === 0) return;
+
+        setLogs(prev => [...added, ...prev]);
+        setTotalLogs(total => total + added.length);
+      },
+      // The stream was down for a while; reload from the newest log
+      resync: () => fetchActivityLogsRef.current()
+    });
+
+    return unsubscribe;
+  }, []);
+
+  // Infinite scroll: load the next page when the sentinel below the table comes into view
+  useEffect(() => {
+    const sentinel = sentinelRef.current;
+    if (!sentinel || !nextCursor || loading || loadingMore) return undefined;
+
+    const observer = new IntersectionObserver((entries) => {
+      if (entries[0].isIntersecting) {
+        fetchActivityLogs(nextCursor);
+      }
+    }, { rootMargin: '200px' });
+
+    observer.observe(sentinel);
+    return () => observer.disconnect();
+  }, [fetchActivityLogs, nextCursor, loading, loadingMore]);
 
   const handleSearch = (e) => {
     e.preventDefault();
-    setCurrentPage(1); // Reset to first page on new search
-    fetchActivityLogs();
+    fetchActivityLogs(); // Start again from the newest log
   };
 
   const handleDateRangeChange = (e) => {
@@ -61,8 +135,7 @@ const ActivityLogs = () => {
   };
 
   const handleFilterApply = () => {
-    setCurrentPage(1); // Reset to first page on filter change
-    fetchActivityLogs();
+    fetchActivityLogs(); // Start again from the newest log
   };
 
   const handleExportLogs = async () => {
@@ -587,63 +660,24 @@ const ActivityLogs = () => {
         </table>
       </div>
       
-      {/* Pagination */}
-      {totalPages > 1 && (
+      {/* Infinite scroll */}
+      {!loading && logs.length > 0 && (
         <div className="pagination" style={{
           display: 'flex',
-          justifyContent: 'space-between',
+          justifyContent: 'center',
           alignItems: 'center',
           padding: '16px',
           backgroundColor: '#2d2d2d',
           borderRadius: '12px',
           boxShadow: '0 4px 6px rgba(0,0,0,0.1)'
         }}>
-          <div className="pagination-info" style={{
+          <div ref={sentinelRef} className="pagination-info" style={{
             fontSize: '14px',
             color: '#a3a3a3'
           }}>
-            Showing page {currentPage} of {totalPages}
-          </div>
-          <div className="pagination-controls" style={{
-            display: 'flex',
-            gap: '12px'
-          }}>
-            <button
-              onClick={() => setCurrentPage(prev => Math.max(prev - 1, 1))}
-              disabled={currentPage === 1}
-              style={{
-                display: 'flex',
-                alignItems: 'center',
-                padding: '8px 16px',
-                borderRadius: '8px',
-                border: '1px solid #404040',
-                backgroundColor: currentPage === 1 ? '#262626' : '#2d2d2d',
-                color: currentPage === 1 ? '#6b7280' : '#6366f1',
-                cursor: currentPage === 1 ? 'not-allowed' : 'pointer',
-                transition: 'all 0.2s ease'
-              }}
-            >
-              <FaChevronLeft style={{ marginRight: '8px' }} />
-              Previous
-            </button>
-            <button
-              onClick={() => setCurrentPage(prev => Math.min(prev + 1, totalPages))}
-              disabled={currentPage === totalPages}
-              style={{
-                display: 'flex',
-                alignItems: 'center',
-                padding: '8px 16px',
-                borderRadius: '8px',
-                border: '1px solid #404040',
-                backgroundColor: currentPage === totalPages ? '#262626' : '#2d2d2d',
-                color: currentPage === totalPages ? '#6b7280' : '#6366f1',
-                cursor: currentPage === totalPages ? 'not-allowed' : 'pointer',
-                transition: 'all 0.2s ease'
-              }}
-            >
-              Next
-              <FaChevronRight style={{ marginLeft: '8px' }} />
-            </button>
+            {loadingMore
+              ? 'Loading more logs...'
+              : `Showing ${logs.length} of ${totalIsEstimate ? '~' : ''}${totalLogs.toLocaleString()} logs`}
           </div>
         </div>
       )}
@@ -1,4 +1,4 @@
-import React, { useState, useEffect } from 'react';
+import React, { useState, useEffect, useRef } from 'react';
 import { Link } from 'react-router-dom';
 import ApiService from '../services/ApiService';
 import { FaUsers, FaUserCheck, FaUserClock, FaUserTimes, 
@@ -28,18 +28,61 @@ const Dashboard = () => {
   const [loading, setLoading] = useState(true);
   const [refreshing, setRefreshing] = useState(false);
   const [error, setError] = useState(null);
+  const [live, setLive] = useState(false);
+  const liveRef = useRef(false);
 
   useEffect(() => {
     fetchDashboardData();
-    // Set up auto-refresh every 5 minutes
+    // Fallback auto-refresh every 5 minutes, only while live updates are down
+    // and the tab is in the foreground
     const refreshInterval = setInterval(() => {
-      handleRefresh(true);
+      if (!liveRef.current && document.visibilityState === 'visible') {
+        handleRefresh(true);
+      }
     }, 300000);
     
     return () => clearInterval(refreshInterval);
     // eslint-disable-next-line react-hooks/exhaustive-deps
   }, []);
 
+  // Live updates: the server pushes fresh stats within a second of any change
+  useEffect(() => {
+    const unsubscribe = ApiService.subscribeToEvents({
+      stats: (data) => {
+        setStats(prev => ({
+          totalUsers: data.userStats?.total || 0,
+          verifiedUsers: data.userStats?.verified || 0,
+          pendingUsers: data.userStats?.pending || 0,
+          rejectedUsers: data.userStats?.rejected || 0,
+          lastUpdated: new Date(),
+          trends: {
+            totalChange: (data.userStats?.total || 0) - prev.totalUsers,
+            verifiedChange: (data.userStats?.verified || 0) - prev.verifiedUsers,
+            pendingChange: (data.userStats?.pending || 0) - prev.pendingUsers,
+            rejectedChange: (data.userStats?.rejected || 0) - prev.rejectedUsers
+          },
+          recentActivities: (data.recentActivity || []).map(activity => ({
+            id: activity.id || Math.random().toString(36).substr(2, 9),
+            action: activity.action,
+            timestamp: new Date(activity.created_at || activity.timestamp || Date.now()),
+            userName: activity.user_name || activity.userName || 'Unknown User',
+            userId: activity.government_id || activity.userId || '-',
+            adminName: activity.admin_username || activity.adminName || currentUser?.username || 'System',
+            txHash: activity.details?.transactionHash || activity.txHash
+          }))
+        }));
+      },
+      // The stream was down for a while; changes may have been missed
+      resync: () => handleRefresh(true)
+    }, (connected) => {
+      liveRef.current = connected;
+      setLive(connected);
+    });
+
+    return unsubscribe;
+    // eslint-disable-next-line react-hooks/exhaustive-deps
+  }, []);
+
   // Initial empty state for dashboard data - used as reference for data structure
   // eslint-disable-next-line no-unused-vars
   const initialDashboardState = {
@@ -231,7 +274,7 @@ const Dashboard = () => {
           </button>
           {stats.lastUpdated && (
             <div className="last-updated">
-              Last updated: {formatDate(stats.lastUpdated)}
+              Last updated: {formatDate(stats.lastUpdated)}{live ? ' (live)' : ''}
             </div>
           )}
         </div>
@@ -219,7 +219,7 @@ const ProfessionalRecords = () => {
     try {
       const response = await ApiService.getDocument(doc.id);
       if (response.document) {
-        const { mimeType, fileUrl, isPreviewable } = response.document;
+        const { mimeType, contentUrl, isPreviewable } = response.document;
         
         if (!isPreviewable) {
           setError('This document type cannot be previewed. You can download it instead.');
@@ -227,7 +227,8 @@ const ProfessionalRecords = () => {
         }
         
         setPreviewDocType(mimeType);
-        setPreviewDocUrl(`${process.env.REACT_APP_API_URL}${fileUrl}`);
+        // Signed link: the browser's viewer fetches it directly, with Range requests
+        setPreviewDocUrl(ApiService.resolveUrl(contentUrl));
       }
     } catch (error) {
       console.error('Error fetching document:', error);
@@ -740,7 +741,7 @@ const ProfessionalRecords = () => {
                         />
                         <ListItemSecondaryAction>
                           <Tooltip title="Download">
-                            <IconButton edge="end" href={doc.file_url} download>
+                            <IconButton edge="end" href={doc.contentUrl ? ApiService.resolveUrl(doc.contentUrl) : doc.file_url} download>
                               <DownloadIcon />
                             </IconButton>
                           </Tooltip>
@@ -1,13 +1,16 @@
 import React, { useState, useEffect, useCallback, useRef } from 'react';
 import ApiService from '../services/ApiService';
 import UserDetailModal from '../components/UserDetailModal';
-import { FaSearch, FaEye, FaUserCheck, FaUserTimes, FaUserClock, FaChevronLeft, FaChevronRight, FaDatabase, FaExclamationCircle, FaEdit } from 'react-icons/fa';
+import { FaSearch, FaEye, FaUserCheck, FaUserTimes, FaUserClock, FaChevronLeft, FaChevronRight, FaDatabase, FaExclamationCircle, FaEdit, FaLink } from 'react-icons/fa';
 
 const RecordManagement = () => {
   const [users, setUsers] = useState([]);
   const [loading, setLoading] = useState(true);
   const [error, setError] = useState(null);
   const [searchQuery, setSearchQuery] = useState('');
+  const [appliedQuery, setAppliedQuery] = useState(''); // Query the list is filtered by, set on submit
+  const [suggestions, setSuggestions] = useState([]);
+  const [showSuggestions, setShowSuggestions] = useState(false);
   const [searchType, setSearchType] = useState('name'); // 'name', 'id', or 'facehash'
   const [selectedUser, setSelectedUser] = useState(null);
   const [isModalOpen, setIsModalOpen] = useState(false);
@@ -17,6 +20,9 @@ const RecordManagement = () => {
   const [refreshInterval, setRefreshInterval] = useState(60000); // 60 seconds refresh by default
   const [lastRefreshed, setLastRefreshed] = useState(new Date());
   const [autoRefresh, setAutoRefresh] = useState(false); // Disabled by default
+  const [selectedIds, setSelectedIds] = useState([]);
+  const [batchStatus, setBatchStatus] = useState(null); // { type: 'success' | 'error', message }
+  const [batchSubmitting, setBatchSubmitting] = useState(false);
   const refreshTimerRef = useRef(null);
   const usersPerPage = 10;
 
@@ -24,10 +30,10 @@ const RecordManagement = () => {
   const fetchUsers = useCallback(async () => {
     setLoading(true);
     try {
-      const data = await ApiService.getUsers(currentPage, usersPerPage, searchQuery, searchType);
+      const data = await ApiService.getUsers(currentPage, usersPerPage, appliedQuery, searchType);
       setUsers(data.users);
-      setTotalPages(Math.ceil(data.total / usersPerPage));
-      setTotalUsers(data.total);
+      setTotalPages(data.pagination.pages);
+      setTotalUsers(data.pagination.total);
       setLastRefreshed(new Date());
       setLoading(false);
     } catch (err) {
@@ -35,7 +41,7 @@ const RecordManagement = () => {
       setError('Failed to load users. Please try again.');
       setLoading(false);
     }
-  }, [currentPage, usersPerPage, searchQuery, searchType]);
+  }, [currentPage, usersPerPage, appliedQuery, searchType]);
 
   // Initial data load
   useEffect(() => {
@@ -73,10 +79,81 @@ const RecordManagement = () => {
     setRefreshInterval(value);
   };
 
+  // Debounced typeahead; the list itself only reloads when the search is submitted
+  useEffect(() => {
+    const term = searchQuery.trim();
+    if (!term || searchType === 'facehash') {
+      setSuggestions([]);
+      return undefined;
+    }
+
+    let cancelled = false;
+    const timer = setTimeout(async () => {
+      try {
+        const data = await ApiService.searchUsers(term, { limit: 8 });
+        if (!cancelled) setSuggestions(data.users);
+      } catch (err) {
+        if (!cancelled) setSuggestions([]);
+      }
+    }, 250);
+
+    return () => {
+      cancelled = true;
+      clearTimeout(timer);
+    };
+  }, [searchQuery, searchType]);
+
   const handleSearch = (e) => {
     e.preventDefault();
     setCurrentPage(1); // Reset to first page on new search
-    fetchUsers();
+    setSelectedIds([]);
+    setShowSuggestions(false);
+    if (searchQuery === appliedQuery) {
+      fetchUsers();
+    } else {
+      setAppliedQuery(searchQuery); // fetchUsers re-runs with the new query
+    }
+  };
+
+  // Only users verified off-chain can be verified on the blockchain
+  const isSelectable = (user) => user?.verification_status === 'VERIFIED';
+  const selectableOnPage = users.filter(isSelectable).map(user => user.id);
+  const allOnPageSelected = selectableOnPage.length > 0 && selectableOnPage.every(id => selectedIds.includes(id));
+
+  const toggleSelected = (userId) => {
+    setSelectedIds(prev => prev.includes(userId)
+      ? prev.filter(id => id !== userId)
+      : [...prev, userId]);
+  };
+
+  const toggleSelectPage = () => {
+    setSelectedIds(prev => allOnPageSelected
+      ? prev.filter(id => !selectableOnPage.includes(id))
+      : [...new Set([...prev, ...selectableOnPage])]);
+  };
+
+  // Queue on-chain verification for every selected user (one contract call per batch)
+  const handleBatchVerify = async () => {
+    setBatchSubmitting(true);
+    setBatchStatus(null);
+    try {
+      const result = await ApiService.batchVerifyOnBlockchain(selectedIds);
+      const skipped = result.skipped && result.skipped.length > 0
+        ? ` (${result.skipped.length} skipped: not verified or no wallet)`
+        : '';
+      setBatchStatus({
+        type: 'success',
+        message: `Queued ${result.queued} users for blockchain verification in ${result.blockchainJobs.length} transaction(s)${skipped}`
+      });
+      setSelectedIds([]);
+    } catch (err) {
+      setBatchStatus({
+        type: 'error',
+        message: err.response?.data?.message || 'Failed to queue blockchain verification. Please try again.'
+      });
+    } finally {
+      setBatchSubmitting(false);
+    }
   };
 
   const handleViewUser = (user) => {
@@ -261,7 +338,12 @@ const RecordManagement = () => {
                 type="text"
                 placeholder={`Search by ${searchType}...`}
                 value={searchQuery}
-                onChange={(e) => setSearchQuery(e.target.value)}
+                onChange={(e) => {
+                  setSearchQuery(e.target.value);
+                  setShowSuggestions(true);
+                }}
+                onFocus={() => setShowSuggestions(true)}
+                onBlur={() => setShowSuggestions(false)}
                 style={{
                   width: '100%',
                   padding: '12px 16px 12px 40px',
@@ -281,6 +363,46 @@ const RecordManagement = () => {
                 transform: 'translateY(-50%)',
                 color: '#6b7280'
               }} />
+              {showSuggestions && suggestions.length > 0 && (
+                <ul style={{
+                  position: 'absolute',
+                  top: '100%',
+                  left: 0,
+                  right: 0,
+                  zIndex: 10,
+                  margin: '4px 0 0',
+                  padding: '4px 0',
+                  listStyle: 'none',
+                  backgroundColor: 'white',
+                  border: '1px solid #3b82f6',
+                  borderRadius: '12px',
+                  boxShadow: '0 4px 6px rgba(0, 0, 0, 0.1)'
+                }}>
+                  {suggestions.map(user => (
+                    <li
+                      key={user.id}
+                      // onMouseDown runs before the input's onBlur hides the list
+                      onMouseDown={(e) => {
+                        e.preventDefault();
+                        setShowSuggestions(false);
+                        handleViewUser(user);
+                      }}
+                      style={{
+                        display: 'flex',
+                        justifyContent: 'space-between',
+                        gap: '12px',
+                        padding: '8px 16px',
+                        cursor: 'pointer',
+                        fontSize: '14px',
+                        color: '#1f2937'
+                      }}
+                    >
+                      <span>{user.name}</span>
+                      <span style={{ color: '#6b7280', fontFamily: 'monospace' }}>{user.government_id}</span>
+                    </li>
+                  ))}
+                </ul>
+              )}
             </div>
             
             <button
@@ -345,6 +467,86 @@ const RecordManagement = () => {
         </div>
       )}
 
+      {batchStatus && (
+        <div style={{
+          backgroundColor: 'white',
+          color: batchStatus.type === 'success' ? '#10b981' : '#ef4444',
+          padding: '16px',
+          borderRadius: '12px',
+          marginBottom: '24px',
+          fontSize: '14px',
+          border: `1px solid ${batchStatus.type === 'success' ? '#10b981' : '#ef4444'}`,
+          display: 'flex',
+          alignItems: 'center',
+          gap: '12px',
+          boxShadow: '0 2px 4px rgba(0, 0, 0, 0.1)'
+        }}>
+          {batchStatus.type === 'success' ? <FaLink /> : <FaExclamationCircle />}
+          {batchStatus.message}
+        </div>
+      )}
+
+      {selectedIds.length > 0 && (
+        <div style={{
+          display: 'flex',
+          alignItems: 'center',
+          justifyContent: 'space-between',
+          backgroundColor: 'white',
+          padding: '12px 16px',
+          borderRadius: '12px',
+          marginBottom: '16px',
+          border: '1px solid #3b82f6',
+          boxShadow: '0 2px 4px rgba(0, 0, 0, 0.1)',
+          fontSize: '14px',
+          color: '#1f2937'
+        }}>
+          <span>{selectedIds.length} user{selectedIds.length === 1 ? '' : 's'} selected</span>
+          <div style={{
+            display: 'flex',
+            gap: '8px'
+          }}>
+            <button
+              onClick={() => setSelectedIds([])}
+              disabled={batchSubmitting}
+              style={{
+                backgroundColor: 'white',
+                color: '#6b7280',
+                border: '1px solid #d1d5db',
+                borderRadius: '8px',
+                padding: '8px 16px',
+                fontSize: '14px',
+                cursor: batchSubmitting ? 'not-allowed' : 'pointer',
+                transition: 'all 0.2s ease'
+              }}
+            >
+              Clear
+            </button>
+            <button
+              onClick={handleBatchVerify}
+              disabled={batchSubmitting}
+              style={{
+                backgroundColor: '#3b82f6',
+                color: '#fff',
+                border: 'none',
+                borderRadius: '8px',
+                padding: '8px 16px',
+                fontSize: '14px',
+                fontWeight: '500',
+                cursor: batchSubmitting ? 'not-allowed' : 'pointer',
+                opacity: batchSubmitting ? 0.6 : 1,
+                display: 'flex',
+                alignItems: 'center',
+                gap: '8px',
+                transition: 'all 0.2s ease'
+              }}
+            >
+              <FaLink />
+              {batchSubmitting ? 'Queueing...' : 'Verify on Blockchain'}
+            </button>
+          </div>
+        </div>
+      )}
+
       <div style={{
         backgroundColor: 'white',
         borderRadius: '16px',
@@ -365,6 +567,21 @@ const RecordManagement = () => {
               <tr style={{
                 backgroundColor: '#3b82f6'
               }}>
+                <th style={{
+                  padding: '16px',
+                  textAlign: 'left',
+                  borderBottom: '2px solid white',
+                  width: '40px'
+                }}>
+                  <input
+                    type="checkbox"
+                    checked={allOnPageSelected}
+                    disabled={selectableOnPage.length === 0}
+                    onChange={toggleSelectPage}
+                    title="Select all verified users on this page"
+                    style={{ accentColor: 'white', cursor: 'pointer' }}
+                  />
+                </th>
                 <th style={{
                   padding: '16px',
                   textAlign: 'left',
@@ -418,7 +635,7 @@ const RecordManagement = () => {
             <tbody>
               {loading ? (
                 <tr>
-                  <td colSpan="6" style={{
+                  <td colSpan="7" style={{
                     padding: '48px',
                     textAlign: 'center'
                   }}>
@@ -442,7 +659,7 @@ const RecordManagement = () => {
                 </tr>
               ) : users.length === 0 ? (
                 <tr>
-                  <td colSpan="6" style={{
+                  <td colSpan="7" style={{
                     padding: '48px',
                     textAlign: 'center'
                   }}>
@@ -465,6 +682,18 @@ const RecordManagement = () => {
                     backgroundColor: index % 2 === 0 ? 'white' : '#f9fafb',
                     transition: 'background-color 0.2s ease'
                   }}>
+                    <td style={{
+                      padding: '16px'
+                    }}>
+                      <input
+                        type="checkbox"
+                        checked={selectedIds.includes(user?.id)}
+                        disabled={!isSelectable(user)}
+                        onChange={() => toggleSelected(user.id)}
+                        title={isSelectable(user) ? 'Select for blockchain verification' : 'Only verified users can be verified on blockchain'}
+                        style={{ accentColor: '#3b82f6', cursor: isSelectable(user) ? 'pointer' : 'not-allowed' }}
+                      />
+                    </td>
                     <td style={{
                       padding: '16px',
                       color: '#1f2937',
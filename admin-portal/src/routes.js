@@ -0,0 +1,16 @@
+/**
+ * Lazily loaded pages
+ * Login stays in the entry chunk; every page behind it is its own chunk.
+ * RecordManagement (via UserDetailModal) reaches the chain libraries only
+ * through BlockchainService, which loads them on first use. MainLayout
+ * calls preload() on nav link hover and focus; the dashboard is prefetched
+ * once the app is idle since it is where login lands.
+ */
+import { lazyRoute } from './utils/lazyRoute';
+
+export const Dashboard = lazyRoute(() => import(/* webpackChunkName: "page-dashboard", webpackPrefetch: true */ './pages/Dashboard'));
+export const RecordManagement = lazyRoute(() => import(/* webpackChunkName: "page-records" */ './pages/RecordManagement'));
+export const ActivityLogs = lazyRoute(() => import(/* webpackChunkName: "page-activity-logs" */ './pages/ActivityLogs'));
+export const Settings = lazyRoute(() => import(/* webpackChunkName: "page-settings" */ './pages/Settings'));
+export const ProfessionalRecords = lazyRoute(() => import(/* webpackChunkName: "page-professional-records" */ './pages/ProfessionalRecords'));
+export const FaceVerification = lazyRoute(() => import(/* webpackChunkName: "page-face-verification" */ './pages/FaceVerification'));
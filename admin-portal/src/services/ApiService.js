@@ -109,6 +109,19 @@ class ApiService {
     }
   }
 
+  // Ranked typeahead lookup by name, government ID or email
+  async searchUsers(query, options = {}) {
+    try {
+      const response = await this.api.get('/admin/users/search', {
+        params: { q: query, limit: options.limit, status: options.status }
+      });
+      return response.data;
+    } catch (error) {
+      console.error('Error searching users:', error);
+      throw error;
+    }
+  }
+
   async getUserById(userId) {
     try {
       const response = await this.api.get(`/admin/users/${userId}`);
@@ -178,13 +191,45 @@ class ApiService {
     }
   }
 
+  // Verify many users on-chain; the backend queues one contract call per batch
+  async batchVerifyOnBlockchain(userIds) {
+    try {
+      const response = await this.api.post('/blockchain/identities/batch-verify', { userIds });
+      return response.data;
+    } catch (error) {
+      console.error('Error batch verifying identities on blockchain:', error);
+      throw error;
+    }
+  }
+
+  // Read on-chain status and professional records for many users in one aggregated call
+  async getOnChainIdentities(userIds, options = {}) {
+    try {
+      const response = await this.api.post('/blockchain/identities/summary', { userIds, ...options });
+      return response.data;
+    } catch (error) {
+      console.error('Error fetching on-chain identities:', error);
+      throw error;
+    }
+  }
+
+  async getBlockchainJob(jobId) {
+    try {
+      const response = await this.api.get(`/admin/blockchain-jobs/${jobId}`);
+      return response.data;
+    } catch (error) {
+      console.error(`Error fetching blockchain job ${jobId}:`, error);
+      throw error;
+    }
+  }
+
   // Activity logs
-  async getActivityLogs(page = 1, limit = 20, filters = {}) {
+  // Pass the previous response's pagination.nextCursor to load the following page
+  async getActivityLogs(cursor = null, limit = 20, filters = {}) {
     try {
-      
       const response = await this.api.get('/admin/logs', {
         params: {
-          page,
+          cursor: cursor || undefined,
           limit,
           ...filters
         }
@@ -259,6 +304,11 @@ class ApiService {
     }
   }
 
+  // Absolute URL for a server-relative path such as a signed document link
+  resolveUrl(urlPath) {
+    return new URL(urlPath, this.api.defaults.baseURL).toString();
+  }
+
   // Document Management
   async getDocuments(professionalRecordId) {
     try {
@@ -410,6 +460,79 @@ class ApiService {
     }
   }
 
+  // Live updates (Server-Sent Events from /admin/events)
+  // Read with fetch rather than EventSource so the token travels in the
+  // Authorization header instead of the URL. Reconnects with backoff and
+  // returns a function that closes the stream.
+  subscribeToEvents(handlers = {}, onStatusChange = () => {}) {
+    let controller = null;
+    let closed = false;
+    let retryTimer = null;
+    let retryDelay = 1000;
+
+    const dispatch = (frame) => {
+      let event = 'message';
+      const data = [];
+      frame.split('\n').forEach((line) => {
+        if (line.startsWith('event:')) event = line.slice(6).trim();
+        else if (line.startsWith('data:')) data.push(line.slice(5).trim());
+      });
+      if (data.length === 0 || !handlers[event]) return;
+      try {
+        handlers[event](JSON.parse(data.join('\n')));
+      } catch (error) {
+        console.error(`Error handling live event ${event}:`, error);
+      }
+    };
+
+    const connect = async () => {
+      controller = new AbortController();
+      try {
+        const token = localStorage.getItem('authToken');
+        const response = await fetch(`${this.api.defaults.baseURL}/admin/events`, {
+          headers: token ? { Authorization: `Bearer ${token}`, Accept: 'text/event-stream' } : {},
+          signal: controller.signal
+        });
+        if (!response.ok || !response.body) {
+          throw new Error(`Live updates unavailable (${response.status})`);
+        }
+
+        onStatusChange(true);
+        retryDelay = 1000;
+        const reader = response.body.getReader();
+        const decoder = new TextDecoder();
+        let buffer = '';
+
+        for (;;) {
+          const { value, done } = await reader.read();
+          if (done) break;
+          buffer += decoder.decode(value, { stream: true });
+          let boundary;
+          while ((boundary = buffer.indexOf('\n\n')) !== -1) {
+            dispatch(buffer.slice(0, boundary));
+            buffer = buffer.slice(boundary + 2);
+          }
+        }
+      } catch (error) {
+        if (closed) return;
+        console.warn('Live updates disconnected:', error.message);
+      }
+
+      if (closed) return;
+      onStatusChange(false);
+      retryTimer = setTimeout(connect, retryDelay);
+      retryDelay = Math.min(retryDelay * 2, 30000);
+    };
+
+    connect();
+
+    return () => {
+      closed = true;
+      clearTimeout(retryTimer);
+      if (controller) controller.abort();
+    };
+  }
+
   // Export data
   async exportUsers(filters = {}) {
     try {
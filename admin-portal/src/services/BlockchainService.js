@@ -1,5 +1,16 @@
-import { ethers } from 'ethers';
-import IdentityManagementABI from '../utils/IdentityManagementABI.json';
+/**
+ * Blockchain service for the admin portal
+ * Identity and record writes go through the backend API. The direct contract
+ * calls load ethers and the IdentityManagement ABI on first use, each into
+ * its own chunk, so pages that import this service stay light.
+ */
+const loadChainLibraries = () => Promise.all([
+  import(/* webpackChunkName: "vendor-ethers" */ 'ethers'),
+  import(/* webpackChunkName: "identity-abi" */ '../utils/IdentityManagementABI.json')
+]).then(([ethersModule, abiModule]) => ({
+  ethers: ethersModule.ethers,
+  abi: abiModule.default
+}));
 
 class BlockchainService {
   constructor() {
@@ -8,6 +19,32 @@ class BlockchainService {
     this.contract = null;
     this.contractAddress = process.env.REACT_APP_CONTRACT_ADDRESS;
     this.initialized = false;
+    this.contractLoading = null;
+  }
+
+  /**
+   * Contract instance, created on first use
+   * Signs with the browser wallet when there is one, else reads over RPC
+   */
+  getContract() {
+    if (!this.contractLoading) {
+      this.contractLoading = loadChainLibraries().then(({ ethers, abi }) => {
+        if (window.ethereum) {
+          this.provider = new ethers.providers.Web3Provider(window.ethereum);
+          this.signer = this.provider.getSigner();
+        } else {
+          this.provider = new ethers.providers.JsonRpcProvider(
+            process.env.REACT_APP_AVALANCHE_FUJI_RPC_URL || 'https://api.avax-test.network/ext/bc/C/rpc'
+          );
+        }
+        this.contract = new ethers.Contract(this.contractAddress, abi, this.signer || this.provider);
+        return this.contract;
+      }).catch((error) => {
+        this.contractLoading = null;
+        throw error;
+      });
+    }
+    return this.contractLoading;
   }
 
   async initialize() {
@@ -52,7 +89,8 @@ class BlockchainService {
     }
     
     try {
-      const tx = await this.contract.updateBiometricHash(userAddress, newBiometricHash);
+      const contract = await this.getContract();
+      const tx = await contract.updateBiometricHash(userAddress, newBiometricHash);
       const receipt = await tx.wait();
       return {
         success: true,
@@ -187,7 +225,8 @@ class BlockchainService {
     }
     
     try {
-      const hash = await this.contract.getBiometricHash(userAddress);
+      const contract = await this.getContract();
+      const hash = await contract.getBiometricHash(userAddress);
       return {
         success: true,
         hash
@@ -11,6 +11,9 @@ contract IdentityManagement {
     bytes32 public constant GOVERNMENT_ROLE = keccak256("GOVERNMENT");
     bytes32 public constant ADMIN_ROLE = keccak256("ADMIN");
 
+    // Upper bound on batch sizes so a single batch call stays well under the block gas limit
+    uint256 public constant MAX_BATCH_SIZE = 200;
+
     // Identity struct to store user identity information
     struct Identity {
         bytes32 biometricHash;        // SHA-256 hash of facemesh data
@@ -195,6 +198,89 @@ contract IdentityManagement {
         emit ProfessionalRecordVerified(user, recordIndex, msg.sender, block.timestamp);
     }
 
+    /**
+     * @dev Verify many identities in one transaction (government only)
+     * Addresses without an identity or already verified are skipped instead of reverting the batch
+     * @param users Addresses of the users to verify
+     * @return verified Number of identities newly verified
+     */
+    function batchVerifyIdentities(address[] calldata users)
+        external
+        onlyRole(GOVERNMENT_ROLE)
+        returns (uint256 verified)
+    {
+        uint256 length = users.length;
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            address user = users[i];
+            Identity storage identity = identities[user];
+
+            if (hasIdentity[user] && !identity.isVerified) {
+                identity.isVerified = true;
+                identity.updatedAt = block.timestamp;
+                identity.updatedBy = msg.sender;
+                emit IdentityVerified(user, msg.sender, block.timestamp);
+                verified++;
+            }
+
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Verify many professional records in one transaction (government only)
+     * Missing or already verified records are skipped instead of reverting the batch
+     * @param users Addresses of the record owners
+     * @param recordIndexes Index of each record in its owner's professional history
+     * @return verified Number of records newly verified
+     */
+    function batchVerifyProfessionalRecords(address[] calldata users, uint256[] calldata recordIndexes)
+        external
+        onlyRole(GOVERNMENT_ROLE)
+        returns (uint256 verified)
+    {
+        uint256 length = users.length;
+        require(length == recordIndexes.length, "Array length mismatch");
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            address user = users[i];
+            uint256 recordIndex = recordIndexes[i];
+
+            if (hasIdentity[user] && recordIndex < professionalHistory[user].length) {
+                ProfessionalRecord storage record = professionalHistory[user][recordIndex];
+                if (!record.isVerified) {
+                    record.isVerified = true;
+                    record.verifier = msg.sender;
+                    emit ProfessionalRecordVerified(user, recordIndex, msg.sender, block.timestamp);
+                    verified++;
+                }
+            }
+
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Grant a role to many accounts (admin only)
+     * @param accounts Addresses to grant the role to
+     * @param role Role to grant
+     */
+    function grantRoles(address[] calldata accounts, bytes32 role)
+        external
+        onlyRole(ADMIN_ROLE)
+    {
+        uint256 length = accounts.length;
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            roles[accounts[i]][role] = true;
+            emit RoleGranted(accounts[i], role, msg.sender);
+            unchecked { ++i; }
+        }
+    }
+
     /**
      * @dev Grant a role to an account (admin only)
      * @param account Address to grant the role to
@@ -308,4 +394,70 @@ contract IdentityManagement {
             record.createdAt
         );
     }
+
+    /**
+     * @dev Get an identity's status fields and record count in one call
+     * Does not revert for unknown addresses, so it can be batched through a multicall
+     * @param user Address of the user
+     * @return exists True if the user has an identity
+     * @return biometricHash Biometric hash
+     * @return isVerified Verification status
+     * @return createdAt Creation timestamp
+     * @return updatedAt Last update timestamp
+     * @return professionalRecordCount Number of professional records
+     */
+    function getIdentitySummary(address user)
+        external
+        view
+        returns (
+            bool exists,
+            bytes32 biometricHash,
+            bool isVerified,
+            uint256 createdAt,
+            uint256 updatedAt,
+            uint256 professionalRecordCount
+        )
+    {
+        Identity storage identity = identities[user];
+        return (
+            hasIdentity[user],
+            identity.biometricHash,
+            identity.isVerified,
+            identity.createdAt,
+            identity.updatedAt,
+            professionalHistory[user].length
+        );
+    }
+
+    /**
+     * @dev Get a page of a user's professional records
+     * Does not revert for unknown addresses or out-of-range offsets; limit is capped at MAX_BATCH_SIZE
+     * @param user Address of the user
+     * @param offset Index of the first record
+     * @param limit Maximum number of records to return
+     * @return records Records in index order
+     * @return total Total number of records for the user
+     */
+    function getProfessionalRecords(address user, uint256 offset, uint256 limit)
+        external
+        view
+        returns (ProfessionalRecord[] memory records, uint256 total)
+    {
+        ProfessionalRecord[] storage history = professionalHistory[user];
+        total = history.length;
+        if (offset >= total) {
+            return (new ProfessionalRecord[](0), total);
+        }
+
+        if (limit > MAX_BATCH_SIZE) {
+            limit = MAX_BATCH_SIZE;
+        }
+        uint256 end = offset + limit > total ? total : offset + limit;
+        records = new ProfessionalRecord[](end - offset);
+
+        for (uint256 i = offset; i < end; ) {
+            records[i - offset] = history[i];
+            unchecked { ++i; }
+        }
+    }
 }
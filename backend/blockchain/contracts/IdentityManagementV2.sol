@@ -0,0 +1,592 @@
+// SPDX-License-Identifier: MIT
+pragma solidity ^0.8.0;
+
+/**
+ * @title IdentityManagementV2
+ * @dev Gas-optimized IdentityManagement with packed storage.
+ * External interface and events match IdentityManagement, plus a one-time
+ * import path used to migrate state from the v1 contract.
+ *
+ * Storage per identity: 3 slots (v1: 5 slots + hasIdentity mapping)
+ * Storage per record:   2 slots, 3 when endDate is set (v1: 5 slots)
+ */
+contract IdentityManagementV2 {
+    // Role definitions
+    bytes32 public constant USER_ROLE = keccak256("USER");
+    bytes32 public constant GOVERNMENT_ROLE = keccak256("GOVERNMENT");
+    bytes32 public constant ADMIN_ROLE = keccak256("ADMIN");
+
+    // Upper bound on batch sizes so a single batch call stays well under the block gas limit
+    uint256 public constant MAX_BATCH_SIZE = 200;
+
+    // Identity struct; updatedBy, both timestamps and isVerified share one slot
+    struct Identity {
+        bytes32 biometricHash;        // SHA-256 hash of facemesh data
+        bytes32 professionalDataHash; // Hash of professional data stored off-chain
+        address updatedBy;            // Address that performed the last update
+        uint40 createdAt;             // Timestamp when identity was created (0 = no identity)
+        uint40 updatedAt;             // Timestamp when identity was last updated
+        bool isVerified;              // Government verification status
+    }
+
+    // Professional history record; verifier, isVerified, createdAt and startDate share one slot
+    struct ProfessionalRecord {
+        bytes32 dataHash;             // Hash of professional record data
+        address verifier;             // Address that verified this record
+        bool isVerified;              // Verification status
+        uint40 createdAt;             // Timestamp when record was created
+        uint40 startDate;             // Start date of employment/education
+        uint40 endDate;               // End date of employment/education (0 if current)
+    }
+
+    // Professional record as returned by views (same field order and types as v1)
+    struct ProfessionalRecordView {
+        bytes32 dataHash;
+        uint256 startDate;
+        uint256 endDate;
+        address verifier;
+        bool isVerified;
+        uint256 createdAt;
+    }
+
+    // State imported from the v1 contract by the migration script
+    struct IdentityImport {
+        address user;
+        bytes32 biometricHash;
+        bytes32 professionalDataHash;
+        address updatedBy;
+        uint40 createdAt;
+        uint40 updatedAt;
+        bool isVerified;
+    }
+
+    struct ProfessionalRecordImport {
+        address user;
+        bytes32 dataHash;
+        address verifier;
+        bool isVerified;
+        uint40 createdAt;
+        uint40 startDate;
+        uint40 endDate;
+    }
+
+    // Mapping from user address to their identity
+    mapping(address => Identity) private identities;
+
+    // Mapping from user address to their professional history
+    mapping(address => ProfessionalRecord[]) private professionalHistory;
+
+    // Mapping for role-based access control
+    mapping(address => mapping(bytes32 => bool)) private roles;
+
+    // Set once the v1 import is finished; import functions are disabled afterwards
+    bool public migrationClosed;
+
+    // Events
+    event IdentityCreated(address indexed user, bytes32 biometricHash, uint256 timestamp);
+    event IdentityUpdated(address indexed user, address indexed updatedBy, uint256 timestamp);
+    event IdentityVerified(address indexed user, address indexed verifier, uint256 timestamp);
+    event ProfessionalRecordAdded(address indexed user, bytes32 dataHash, uint256 timestamp);
+    event ProfessionalRecordVerified(address indexed user, uint256 recordIndex, address verifier, uint256 timestamp);
+    event RoleGranted(address indexed account, bytes32 indexed role, address indexed grantor);
+    event RoleRevoked(address indexed account, bytes32 indexed role, address indexed revoker);
+    event MigrationClosed(address indexed closedBy, uint256 timestamp);
+
+    // Modifiers
+    modifier onlyRole(bytes32 role) {
+        require(roles[msg.sender][role], "Caller does not have the required role");
+        _;
+    }
+
+    modifier identityExists(address user) {
+        require(identities[user].createdAt != 0, "Identity does not exist");
+        _;
+    }
+
+    modifier duringMigration() {
+        require(!migrationClosed, "Migration is closed");
+        _;
+    }
+
+    // Constructor
+    constructor() {
+        // Grant admin role to contract deployer
+        roles[msg.sender][ADMIN_ROLE] = true;
+        emit RoleGranted(msg.sender, ADMIN_ROLE, msg.sender);
+    }
+
+    /**
+     * @dev Create a new identity
+     * @param biometricHash SHA-256 hash of the user's facemesh data
+     * @param professionalDataHash Hash of the user's professional data
+     */
+    function createIdentity(bytes32 biometricHash, bytes32 professionalDataHash) external {
+        Identity storage identity = identities[msg.sender];
+        require(identity.createdAt == 0, "Identity already exists");
+
+        uint40 timestamp = uint40(block.timestamp);
+        identity.biometricHash = biometricHash;
+        identity.professionalDataHash = professionalDataHash;
+        identity.updatedBy = msg.sender;
+        identity.createdAt = timestamp;
+        identity.updatedAt = timestamp;
+
+        // Grant user role
+        roles[msg.sender][USER_ROLE] = true;
+
+        emit IdentityCreated(msg.sender, biometricHash, block.timestamp);
+        emit RoleGranted(msg.sender, USER_ROLE, msg.sender);
+    }
+
+    /**
+     * @dev Update biometric hash
+     * @param user Address of the user
+     * @param newBiometricHash New SHA-256 hash of the user's facemesh data
+     */
+    function updateBiometricHash(address user, bytes32 newBiometricHash)
+        external
+        identityExists(user)
+    {
+        require(user == msg.sender || roles[msg.sender][GOVERNMENT_ROLE] || roles[msg.sender][ADMIN_ROLE],
+                "Not authorized to update");
+
+        Identity storage identity = identities[user];
+        identity.biometricHash = newBiometricHash;
+        identity.updatedAt = uint40(block.timestamp);
+        identity.updatedBy = msg.sender;
+
+        emit IdentityUpdated(user, msg.sender, block.timestamp);
+    }
+
+    /**
+     * @dev Update professional data hash
+     * @param newProfessionalDataHash New hash of the user's professional data
+     */
+    function updateProfessionalData(bytes32 newProfessionalDataHash)
+        external
+        identityExists(msg.sender)
+    {
+        Identity storage identity = identities[msg.sender];
+        identity.professionalDataHash = newProfessionalDataHash;
+        identity.updatedAt = uint40(block.timestamp);
+        identity.updatedBy = msg.sender;
+
+        emit IdentityUpdated(msg.sender, msg.sender, block.timestamp);
+    }
+
+    /**
+     * @dev Verify a user's identity (government only)
+     * @param user Address of the user to verify
+     */
+    function verifyIdentity(address user)
+        external
+        onlyRole(GOVERNMENT_ROLE)
+        identityExists(user)
+    {
+        Identity storage identity = identities[user];
+        identity.isVerified = true;
+        identity.updatedAt = uint40(block.timestamp);
+        identity.updatedBy = msg.sender;
+
+        emit IdentityVerified(user, msg.sender, block.timestamp);
+    }
+
+    /**
+     * @dev Verify many identities in one transaction (government only)
+     * Addresses without an identity or already verified are skipped instead of reverting the batch
+     * @param users Addresses of the users to verify
+     * @return verified Number of identities newly verified
+     */
+    function batchVerifyIdentities(address[] calldata users)
+        external
+        onlyRole(GOVERNMENT_ROLE)
+        returns (uint256 verified)
+    {
+        uint256 length = users.length;
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+        uint40 timestamp = uint40(block.timestamp);
+
+        for (uint256 i = 0; i < length; ) {
+            address user = users[i];
+            Identity storage identity = identities[user];
+
+            if (identity.createdAt != 0 && !identity.isVerified) {
+                identity.isVerified = true;
+                identity.updatedAt = timestamp;
+                identity.updatedBy = msg.sender;
+                emit IdentityVerified(user, msg.sender, block.timestamp);
+                verified++;
+            }
+
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Add a professional record to a user's history
+     * @param dataHash Hash of the professional record data
+     * @param startDate Start date of employment/education
+     * @param endDate End date of employment/education (0 if current)
+     */
+    function addProfessionalRecord(bytes32 dataHash, uint256 startDate, uint256 endDate)
+        external
+        identityExists(msg.sender)
+    {
+        require(startDate <= block.timestamp, "Start date cannot be in the future");
+        require(endDate == 0 || endDate >= startDate, "End date must be after start date");
+        require(endDate <= type(uint40).max, "End date out of range");
+
+        professionalHistory[msg.sender].push(ProfessionalRecord({
+            dataHash: dataHash,
+            verifier: address(0),
+            isVerified: false,
+            createdAt: uint40(block.timestamp),
+            startDate: uint40(startDate),
+            endDate: uint40(endDate)
+        }));
+
+        emit ProfessionalRecordAdded(msg.sender, dataHash, block.timestamp);
+    }
+
+    /**
+     * @dev Verify a professional record (government only)
+     * @param user Address of the user
+     * @param recordIndex Index of the record in the user's professional history
+     */
+    function verifyProfessionalRecord(address user, uint256 recordIndex)
+        external
+        onlyRole(GOVERNMENT_ROLE)
+        identityExists(user)
+    {
+        require(recordIndex < professionalHistory[user].length, "Record does not exist");
+
+        // verifier and isVerified live in the same slot: one SSTORE
+        ProfessionalRecord storage record = professionalHistory[user][recordIndex];
+        record.isVerified = true;
+        record.verifier = msg.sender;
+
+        emit ProfessionalRecordVerified(user, recordIndex, msg.sender, block.timestamp);
+    }
+
+    /**
+     * @dev Verify many professional records in one transaction (government only)
+     * Missing or already verified records are skipped instead of reverting the batch
+     * @param users Addresses of the record owners
+     * @param recordIndexes Index of each record in its owner's professional history
+     * @return verified Number of records newly verified
+     */
+    function batchVerifyProfessionalRecords(address[] calldata users, uint256[] calldata recordIndexes)
+        external
+        onlyRole(GOVERNMENT_ROLE)
+        returns (uint256 verified)
+    {
+        uint256 length = users.length;
+        require(length == recordIndexes.length, "Array length mismatch");
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            address user = users[i];
+            uint256 recordIndex = recordIndexes[i];
+
+            if (recordIndex < professionalHistory[user].length) {
+                ProfessionalRecord storage record = professionalHistory[user][recordIndex];
+                if (!record.isVerified) {
+                    record.isVerified = true;
+                    record.verifier = msg.sender;
+                    emit ProfessionalRecordVerified(user, recordIndex, msg.sender, block.timestamp);
+                    verified++;
+                }
+            }
+
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Grant a role to an account (admin only)
+     * @param account Address to grant the role to
+     * @param role Role to grant
+     */
+    function grantRole(address account, bytes32 role)
+        external
+        onlyRole(ADMIN_ROLE)
+    {
+        roles[account][role] = true;
+        emit RoleGranted(account, role, msg.sender);
+    }
+
+    /**
+     * @dev Grant a role to many accounts (admin only)
+     * @param accounts Addresses to grant the role to
+     * @param role Role to grant
+     */
+    function grantRoles(address[] calldata accounts, bytes32 role)
+        external
+        onlyRole(ADMIN_ROLE)
+    {
+        uint256 length = accounts.length;
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            roles[accounts[i]][role] = true;
+            emit RoleGranted(accounts[i], role, msg.sender);
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Revoke a role from an account (admin only)
+     * @param account Address to revoke the role from
+     * @param role Role to revoke
+     */
+    function revokeRole(address account, bytes32 role)
+        external
+        onlyRole(ADMIN_ROLE)
+    {
+        roles[account][role] = false;
+        emit RoleRevoked(account, role, msg.sender);
+    }
+
+    /**
+     * @dev Import identities from the v1 contract (admin only, before closeMigration)
+     * Addresses that already have an identity are skipped; imported ones emit IdentityCreated
+     * (and IdentityVerified) with their v1 timestamps
+     * @param imports Identity state read from v1
+     */
+    function importIdentities(IdentityImport[] calldata imports)
+        external
+        onlyRole(ADMIN_ROLE)
+        duringMigration
+    {
+        uint256 length = imports.length;
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            IdentityImport calldata data = imports[i];
+            Identity storage identity = identities[data.user];
+
+            if (identity.createdAt == 0 && data.createdAt != 0) {
+                identity.biometricHash = data.biometricHash;
+                identity.professionalDataHash = data.professionalDataHash;
+                identity.updatedBy = data.updatedBy;
+                identity.createdAt = data.createdAt;
+                identity.updatedAt = data.updatedAt;
+                identity.isVerified = data.isVerified;
+                roles[data.user][USER_ROLE] = true;
+
+                // Same events as the original calls, with v1 timestamps, so indexers see migrated state
+                emit IdentityCreated(data.user, data.biometricHash, data.createdAt);
+                if (data.isVerified) {
+                    emit IdentityVerified(data.user, data.updatedBy, data.updatedAt);
+                }
+            }
+
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Import professional records from the v1 contract (admin only, before closeMigration)
+     * Records are appended in the order given, so import each user's history in v1 index order
+     * @param imports Record state read from v1
+     */
+    function importProfessionalRecords(ProfessionalRecordImport[] calldata imports)
+        external
+        onlyRole(ADMIN_ROLE)
+        duringMigration
+    {
+        uint256 length = imports.length;
+        require(length <= MAX_BATCH_SIZE, "Batch too large");
+
+        for (uint256 i = 0; i < length; ) {
+            ProfessionalRecordImport calldata data = imports[i];
+            require(identities[data.user].createdAt != 0, "Identity does not exist");
+
+            professionalHistory[data.user].push(ProfessionalRecord({
+                dataHash: data.dataHash,
+                verifier: data.verifier,
+                isVerified: data.isVerified,
+                createdAt: data.createdAt,
+                startDate: data.startDate,
+                endDate: data.endDate
+            }));
+
+            emit ProfessionalRecordAdded(data.user, data.dataHash, data.createdAt);
+            if (data.isVerified) {
+                emit ProfessionalRecordVerified(data.user, professionalHistory[data.user].length - 1, data.verifier, data.createdAt);
+            }
+
+            unchecked { ++i; }
+        }
+    }
+
+    /**
+     * @dev Permanently disable the import functions (admin only)
+     */
+    function closeMigration() external onlyRole(ADMIN_ROLE) duringMigration {
+        migrationClosed = true;
+        emit MigrationClosed(msg.sender, block.timestamp);
+    }
+
+    /**
+     * @dev Check if an account has a specific role
+     * @param account Address to check
+     * @param role Role to check
+     * @return bool True if the account has the role
+     */
+    function hasRole(address account, bytes32 role) external view returns (bool) {
+        return roles[account][role];
+    }
+
+    /**
+     * @dev Get biometric hash for a user
+     * @param user Address of the user
+     * @return bytes32 Biometric hash
+     */
+    function getBiometricHash(address user)
+        external
+        view
+        identityExists(user)
+        returns (bytes32)
+    {
+        return identities[user].biometricHash;
+    }
+
+    /**
+     * @dev Check if a user's identity is verified
+     * @param user Address of the user
+     * @return bool True if the identity is verified
+     */
+    function isIdentityVerified(address user)
+        external
+        view
+        identityExists(user)
+        returns (bool)
+    {
+        return identities[user].isVerified;
+    }
+
+    /**
+     * @dev Get the number of professional records for a user
+     * @param user Address of the user
+     * @return uint256 Number of professional records
+     */
+    function getProfessionalRecordCount(address user)
+        external
+        view
+        returns (uint256)
+    {
+        return professionalHistory[user].length;
+    }
+
+    /**
+     * @dev Get a professional record for a user
+     * @param user Address of the user
+     * @param recordIndex Index of the record
+     * @return dataHash Hash of the record data
+     * @return startDate Start date
+     * @return endDate End date
+     * @return verifier Address of the verifier
+     * @return isVerified Verification status
+     * @return createdAt Creation timestamp
+     */
+    function getProfessionalRecord(address user, uint256 recordIndex)
+        external
+        view
+        identityExists(user)
+        returns (
+            bytes32 dataHash,
+            uint256 startDate,
+            uint256 endDate,
+            address verifier,
+            bool isVerified,
+            uint256 createdAt
+        )
+    {
+        require(recordIndex < professionalHistory[user].length, "Record does not exist");
+
+        ProfessionalRecord storage record = professionalHistory[user][recordIndex];
+        return (
+            record.dataHash,
+            record.startDate,
+            record.endDate,
+            record.verifier,
+            record.isVerified,
+            record.createdAt
+        );
+    }
+
+    /**
+     * @dev Get an identity's status fields and record count in one call
+     * Does not revert for unknown addresses, so it can be batched through a multicall
+     * @param user Address of the user
+     * @return exists True if the user has an identity
+     * @return biometricHash Biometric hash
+     * @return isVerified Verification status
+     * @return createdAt Creation timestamp
+     * @return updatedAt Last update timestamp
+     * @return professionalRecordCount Number of professional records
+     */
+    function getIdentitySummary(address user)
+        external
+        view
+        returns (
+            bool exists,
+            bytes32 biometricHash,
+            bool isVerified,
+            uint256 createdAt,
+            uint256 updatedAt,
+            uint256 professionalRecordCount
+        )
+    {
+        Identity storage identity = identities[user];
+        return (
+            identity.createdAt != 0,
+            identity.biometricHash,
+            identity.isVerified,
+            identity.createdAt,
+            identity.updatedAt,
+            professionalHistory[user].length
+        );
+    }
+
+    /**
+     * @dev Get a page of a user's professional records
+     * Does not revert for unknown addresses or out-of-range offsets; limit is capped at MAX_BATCH_SIZE
+     * @param user Address of the user
+     * @param offset Index of the first record
+     * @param limit Maximum number of records to return
+     * @return records Records in index order
+     * @return total Total number of records for the user
+     */
+    function getProfessionalRecords(address user, uint256 offset, uint256 limit)
+        external
+        view
+        returns (ProfessionalRecordView[] memory records, uint256 total)
+    {
+        ProfessionalRecord[] storage history = professionalHistory[user];
+        total = history.length;
+        if (offset >= total) {
+            return (new ProfessionalRecordView[](0), total);
+        }
+
+        if (limit > MAX_BATCH_SIZE) {
+            limit = MAX_BATCH_SIZE;
+        }
+        uint256 end = offset + limit > total ? total : offset + limit;
+        records = new ProfessionalRecordView[](end - offset);
+
+        for (uint256 i = offset; i < end; ) {
+            ProfessionalRecord storage record = history[i];
+            records[i - offset] = ProfessionalRecordView({
+                dataHash: record.dataHash,
+                startDate: record.startDate,
+                endDate: record.endDate,
+                verifier: record.verifier,
+                isVerified: record.isVerified,
+                createdAt: record.createdAt
+            });
+            unchecked { ++i; }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * Gas report for the identity contracts
+ * Deploys IdentityManagement and IdentityManagementV2 on the in-process
+ * hardhat network and records the gas each write method uses: single calls,
+ * and batch calls at several sizes with the cost per item. Results are
+ * written to test-results/gas-report-<timestamp>.json.
+ *
+ * With BENCH_BASELINE set to an earlier report, the run fails (exit code 1)
+ * if any method uses more than BENCH_TOLERANCE (default 0.01) more gas.
+ *
+ * Usage: npx hardhat run --network hardhat blockchain/scripts/gas-report.js
+ */
+const hre = require('hardhat');
+const { writeResults, compareToBaseline, reportRegressions } = require('../../scripts/bench/stats');
+
+const { ethers } = hre;
+
+const CONTRACTS = ['IdentityManagement', 'IdentityManagementV2'];
+const BATCH_SIZES = (process.env.GAS_BATCH_SIZES || '1,10,50,200').split(',').map(Number);
+const TOLERANCE = parseFloat(process.env.BENCH_TOLERANCE || '0.01');
+
+const GOVERNMENT_ROLE = ethers.utils.id('GOVERNMENT');
+const USER_ROLE = ethers.utils.id('USER');
+
+const gasOf = async (txPromise) => {
+  const receipt = await (await txPromise).wait();
+  return receipt.gasUsed.toNumber();
+};
+
+/**
+ * Fresh funded wallets, each with an identity and one professional record
+ */
+const createUsers = async (contract, funder, count) => {
+  const users = [];
+  for (let i = 0; i < count; i++) {
+    const wallet = ethers.Wallet.createRandom().connect(ethers.provider);
+    await (await funder.sendTransaction({ to: wallet.address, value: ethers.utils.parseEther('1') })).wait();
+    const asUser = contract.connect(wallet);
+    await (await asUser.createIdentity(ethers.utils.id(`bio-${wallet.address}`), ethers.utils.id(`pro-${wallet.address}`))).wait();
+    await (await asUser.addProfessionalRecord(ethers.utils.id(`rec-${wallet.address}`), 1, 0)).wait();
+    users.push(wallet);
+  }
+  return users;
+};
+
+const reportContract = async (name, owner) => {
+  const factory = await ethers.getContractFactory(name);
+  const contract = await factory.deploy();
+  const deployReceipt = await contract.deployTransaction.wait();
+  const report = { [`${name}.deploy`]: { gasUsed: deployReceipt.gasUsed.toNumber() } };
+  const single = (method, gasUsed) => { report[`${name}.${method}`] = { gasUsed }; };
+
+  await (await contract.grantRole(owner.address, GOVERNMENT_ROLE)).wait();
+
+  // Single calls, from a fresh user (first write to each storage slot is the expensive case)
+  const wallet = ethers.Wallet.createRandom().connect(ethers.provider);
+  await (await owner.sendTransaction({ to: wallet.address, value: ethers.utils.parseEther('1') })).wait();
+  const asUser = contract.connect(wallet);
+  single('createIdentity', await gasOf(asUser.createIdentity(ethers.utils.id('bio'), ethers.utils.id('pro'))));
+  single('updateProfessionalData', await gasOf(asUser.updateProfessionalData(ethers.utils.id('pro-2'))));
+  single('addProfessionalRecord', await gasOf(asUser.addProfessionalRecord(ethers.utils.id('record'), 1, 0)));
+  single('updateBiometricHash', await gasOf(contract.updateBiometricHash(wallet.address, ethers.utils.id('bio-2'))));
+  single('verifyIdentity', await gasOf(contract.verifyIdentity(wallet.address)));
+  single('verifyProfessionalRecord', await gasOf(contract.verifyProfessionalRecord(wallet.address, 0)));
+  single('grantRole', await gasOf(contract.grantRole(ethers.Wallet.createRandom().address, USER_ROLE)));
+
+  // Batch calls: total and per-item gas at each size
+  for (const size of BATCH_SIZES) {
+    const users = await createUsers(contract, owner, size);
+    const addresses = users.map(user => user.address);
+    const batch = (method, gasUsed) => {
+      report[`${name}.${method}.${size}`] = { gasUsed, perItem: Math.round(gasUsed / size) };
+    };
+    batch('batchVerifyIdentities', await gasOf(contract.batchVerifyIdentities(addresses)));
+    batch('batchVerifyProfessionalRecords', await gasOf(contract.batchVerifyProfessionalRecords(addresses, addresses.map(() => 0))));
+    batch('grantRoles', await gasOf(contract.grantRoles(
+      Array.from({ length: size }, () => ethers.Wallet.createRandom().address),
+      USER_ROLE
+    )));
+  }
+  return report;
+};
+
+async function main() {
+  if (hre.network.name !== 'hardhat') {
+    console.warn(`Running on ${hre.network.name}; gas figures are only comparable between runs on the hardhat network`);
+  }
+  const [owner] = await ethers.getSigners();
+
+  const summary = {};
+  for (const name of CONTRACTS) {
+    console.log(`Measuring ${name}...`);
+    Object.assign(summary, await reportContract(name, owner));
+  }
+
+  const width = Math.max(...Object.keys(summary).map(label => label.length));
+  for (const [label, { gasUsed, perItem }] of Object.entries(summary)) {
+    console.log(`${label.padEnd(width)} ${String(gasUsed).padStart(10)}${perItem ? `  (${perItem}/item)` : ''}`);
+  }
+
+  const file = writeResults('gas-report', {
+    startedAt: new Date().toISOString(),
+    config: { network: hre.network.name, solidity: hre.config.solidity, batchSizes: BATCH_SIZES },
+    summary
+  });
+  console.log(`Results saved to ${file}`);
+
+  if (process.env.BENCH_BASELINE) {
+    reportRegressions(compareToBaseline(summary, process.env.BENCH_BASELINE, {
+      metrics: ['gasUsed'],
+      tolerance: TOLERANCE
+    }));
+  }
+}
+
+main().catch((error) => {
+  console.error('Gas report failed:', error);
+  process.exit(1);
+});
@@ -140,4 +140,310 @@ describe("IdentityManagement", function () {
       expect(record.verifier).to.equal(government.address);
     });
   });
+  
+  describe("Batch Operations", function () {
+    beforeEach(async function () {
+      // Create identities for both users
+      await identityManagement.connect(user1).createIdentity(biometricHash, professionalDataHash);
+      await identityManagement.connect(user2).createIdentity(biometricHash, professionalDataHash);
+    });
+    
+    it("Should verify many identities in one transaction and skip unknown addresses", async function () {
+      const govContract = identityManagement.connect(government);
+      
+      const tx = await govContract.batchVerifyIdentities([user1.address, user2.address, owner.address]);
+      const receipt = await tx.wait();
+      
+      const verifiedEvents = receipt.events.filter(e => e.event === "IdentityVerified");
+      expect(verifiedEvents.length).to.equal(2);
+      expect(await identityManagement.isIdentityVerified(user1.address)).to.equal(true);
+      expect(await identityManagement.isIdentityVerified(user2.address)).to.equal(true);
+    });
+    
+    it("Should not re-verify identities that are already verified", async function () {
+      const govContract = identityManagement.connect(government);
+      await govContract.verifyIdentity(user1.address);
+      
+      const receipt = await (await govContract.batchVerifyIdentities([user1.address, user2.address])).wait();
+      expect(receipt.events.filter(e => e.event === "IdentityVerified").length).to.equal(1);
+    });
+    
+    it("Should verify many professional records in one transaction", async function () {
+      const startDate = Math.floor(Date.now() / 1000) - 86400; // yesterday
+      await identityManagement.connect(user1).addProfessionalRecord(recordDataHash, startDate, 0);
+      await identityManagement.connect(user1).addProfessionalRecord(recordDataHash, startDate, 0);
+      await identityManagement.connect(user2).addProfessionalRecord(recordDataHash, startDate, 0);
+      
+      const govContract = identityManagement.connect(government);
+      const receipt = await (await govContract.batchVerifyProfessionalRecords(
+        [user1.address, user1.address, user2.address, user2.address],
+        [0, 1, 0, 5] // index 5 does not exist and is skipped
+      )).wait();
+      
+      expect(receipt.events.filter(e => e.event === "ProfessionalRecordVerified").length).to.equal(3);
+      expect((await identityManagement.getProfessionalRecord(user1.address, 1)).isVerified).to.equal(true);
+      expect((await identityManagement.getProfessionalRecord(user2.address, 0)).verifier).to.equal(government.address);
+    });
+    
+    it("Should reject mismatched record batch arrays", async function () {
+      await expect(
+        identityManagement.connect(government).batchVerifyProfessionalRecords([user1.address], [0, 1])
+      ).to.be.revertedWith("Array length mismatch");
+    });
+    
+    it("Should bound batch sizes", async function () {
+      const maxBatchSize = (await identityManagement.MAX_BATCH_SIZE()).toNumber();
+      const users = Array(maxBatchSize + 1).fill(user1.address);
+      
+      await expect(
+        identityManagement.connect(government).batchVerifyIdentities(users)
+      ).to.be.revertedWith("Batch too large");
+    });
+    
+    it("Should only allow government to batch verify", async function () {
+      await expect(
+        identityManagement.connect(user2).batchVerifyIdentities([user1.address])
+      ).to.be.revertedWith("Caller does not have the required role");
+    });
+    
+    it("Should allow admin to grant a role to many accounts", async function () {
+      await identityManagement.grantRoles([user1.address, user2.address], GOVERNMENT_ROLE);
+      
+      expect(await identityManagement.hasRole(user1.address, GOVERNMENT_ROLE)).to.equal(true);
+      expect(await identityManagement.hasRole(user2.address, GOVERNMENT_ROLE)).to.equal(true);
+    });
+  });
+  
+  describe("Summary Views", function () {
+    it("Should return an identity summary in one call", async function () {
+      await identityManagement.connect(user1).createIdentity(biometricHash, professionalDataHash);
+      const startDate = Math.floor(Date.now() / 1000) - 86400; // yesterday
+      await identityManagement.connect(user1).addProfessionalRecord(recordDataHash, startDate, 0);
+      await identityManagement.connect(government).verifyIdentity(user1.address);
+      
+      const summary = await identityManagement.getIdentitySummary(user1.address);
+      expect(summary.exists).to.equal(true);
+      expect(summary.biometricHash).to.equal(biometricHash);
+      expect(summary.isVerified).to.equal(true);
+      expect(summary.professionalRecordCount).to.equal(1);
+    });
+    
+    it("Should not revert for addresses without an identity", async function () {
+      const summary = await identityManagement.getIdentitySummary(user2.address);
+      expect(summary.exists).to.equal(false);
+      
+      const page = await identityManagement.getProfessionalRecords(user2.address, 0, 10);
+      expect(page.records.length).to.equal(0);
+      expect(page.total).to.equal(0);
+    });
+    
+    it("Should page professional records", async function () {
+      await identityManagement.connect(user1).createIdentity(biometricHash, professionalDataHash);
+      const startDate = Math.floor(Date.now() / 1000) - 86400; // yesterday
+      for (let i = 0; i < 5; i++) {
+        await identityManagement.connect(user1).addProfessionalRecord(ethers.utils.id(`record_${i}`), startDate, 0);
+      }
+      
+      const page = await identityManagement.getProfessionalRecords(user1.address, 3, 10);
+      expect(page.total).to.equal(5);
+      expect(page.records.length).to.equal(2);
+      expect(page.records[0].dataHash).to.equal(ethers.utils.id("record_3"));
+      expect((await identityManagement.getProfessionalRecords(user1.address, 5, 10)).records.length).to.equal(0);
+    });
+  });
+});
+
+describe("IdentityManagementV2", function () {
+  let v1;
+  let v2;
+  let owner;
+  let government;
+  let user1;
+  let user2;
+  
+  const GOVERNMENT_ROLE = ethers.utils.id("GOVERNMENT");
+  const USER_ROLE = ethers.utils.id("USER");
+  
+  const biometricHash = ethers.utils.id("sample_biometric_hash");
+  const professionalDataHash = ethers.utils.id("sample_professional_data_hash");
+  const recordDataHash = ethers.utils.id("sample_record_data_hash");
+  
+  const deploy = async (name) => {
+    const factory = await ethers.getContractFactory(name);
+    const contract = await factory.deploy();
+    await contract.deployed();
+    await contract.grantRole(government.address, GOVERNMENT_ROLE);
+    return contract;
+  };
+  
+  beforeEach(async function () {
+    [owner, government, user1, user2] = await ethers.getSigners();
+    v1 = await deploy("IdentityManagement");
+    v2 = await deploy("IdentityManagementV2");
+  });
+  
+  describe("Packed Storage", function () {
+    it("Should derive identity existence from createdAt", async function () {
+      await expect(v2.getBiometricHash(user1.address)).to.be.revertedWith("Identity does not exist");
+      
+      await v2.connect(user1).createIdentity(biometricHash, professionalDataHash);
+      
+      expect(await v2.getBiometricHash(user1.address)).to.equal(biometricHash);
+      expect(await v2.hasRole(user1.address, USER_ROLE)).to.equal(true);
+      await expect(
+        v2.connect(user1).createIdentity(biometricHash, professionalDataHash)
+      ).to.be.revertedWith("Identity already exists");
+    });
+    
+    it("Should return the same professional record values as v1", async function () {
+      const startDate = Math.floor(Date.now() / 1000) - 86400; // yesterday
+      const endDate = startDate + 3600;
+      
+      for (const contract of [v1, v2]) {
+        await contract.connect(user1).createIdentity(biometricHash, professionalDataHash);
+        await contract.connect(user1).addProfessionalRecord(recordDataHash, startDate, endDate);
+        await contract.connect(government).verifyProfessionalRecord(user1.address, 0);
+      }
+      
+      const expected = await v1.getProfessionalRecord(user1.address, 0);
+      const actual = await v2.getProfessionalRecord(user1.address, 0);
+      expect(actual.dataHash).to.equal(expected.dataHash);
+      expect(actual.startDate).to.equal(startDate);
+      expect(actual.endDate).to.equal(endDate);
+      expect(actual.verifier).to.equal(government.address);
+      expect(actual.isVerified).to.equal(true);
+    });
+    
+    it("Should return the same summary views as v1", async function () {
+      const startDate = Math.floor(Date.now() / 1000) - 86400; // yesterday
+      for (const contract of [v1, v2]) {
+        await contract.connect(user1).createIdentity(biometricHash, professionalDataHash);
+        await contract.connect(user1).addProfessionalRecord(recordDataHash, startDate, 0);
+      }
+      
+      const expected = await v1.getProfessionalRecords(user1.address, 0, 10);
+      const actual = await v2.getProfessionalRecords(user1.address, 0, 10);
+      expect(actual.total).to.equal(expected.total);
+      expect(actual.records[0].dataHash).to.equal(expected.records[0].dataHash);
+      expect(actual.records[0].startDate).to.equal(expected.records[0].startDate);
+      expect((await v2.getIdentitySummary(user1.address)).exists).to.equal(true);
+      expect((await v2.getIdentitySummary(user2.address)).exists).to.equal(false);
+    });
+    
+    it("Should reject end dates that do not fit in uint40", async function () {
+      await v2.connect(user1).createIdentity(biometricHash, professionalDataHash);
+      
+      await expect(
+        v2.connect(user1).addProfessionalRecord(recordDataHash, 0, ethers.BigNumber.from(2).pow(40))
+      ).to.be.revertedWith("End date out of range");
+    });
+  });
+  
+  describe("Migration", function () {
+    const identityImport = (user, isVerified) => ({
+      user,
+      biometricHash,
+      professionalDataHash,
+      updatedBy: government.address,
+      createdAt: 1700000000,
+      updatedAt: 1700000100,
+      isVerified
+    });
+    
+    it("Should import identities and professional records from v1", async function () {
+      await expect(v2.importIdentities([identityImport(user1.address, true), identityImport(user2.address, false)]))
+        .to.emit(v2, "IdentityCreated")
+        .withArgs(user1.address, biometricHash, 1700000000);
+      await v2.importProfessionalRecords([{
+        user: user1.address,
+        dataHash: recordDataHash,
+        verifier: government.address,
+        isVerified: true,
+        createdAt: 1700000000,
+        startDate: 1600000000,
+        endDate: 0
+      }]);
+      
+      expect(await v2.isIdentityVerified(user1.address)).to.equal(true);
+      expect(await v2.isIdentityVerified(user2.address)).to.equal(false);
+      expect(await v2.hasRole(user2.address, USER_ROLE)).to.equal(true);
+      expect((await v2.getProfessionalRecord(user1.address, 0)).createdAt).to.equal(1700000000);
+    });
+    
+    it("Should skip identities that already exist", async function () {
+      await v2.connect(user1).createIdentity(ethers.utils.id("new_hash"), professionalDataHash);
+      await v2.importIdentities([identityImport(user1.address, true)]);
+      
+      expect(await v2.getBiometricHash(user1.address)).to.equal(ethers.utils.id("new_hash"));
+      expect(await v2.isIdentityVerified(user1.address)).to.equal(false);
+    });
+    
+    it("Should only allow admin to import", async function () {
+      await expect(
+        v2.connect(government).importIdentities([identityImport(user1.address, true)])
+      ).to.be.revertedWith("Caller does not have the required role");
+    });
+    
+    it("Should disable imports once the migration is closed", async function () {
+      await v2.closeMigration();
+      
+      expect(await v2.migrationClosed()).to.equal(true);
+      await expect(
+        v2.importIdentities([identityImport(user1.address, true)])
+      ).to.be.revertedWith("Migration is closed");
+    });
+  });
+  
+  describe("Gas Benchmark", function () {
+    const gasUsed = async (txPromise) => (await (await txPromise).wait()).gasUsed;
+    
+    // Runs the same sequence against a contract and returns gas per call
+    const measure = async (contract) => {
+      const startDate = Math.floor(Date.now() / 1000) - 86400; // yesterday
+      const results = {};
+      
+      results.createIdentity = await gasUsed(contract.connect(user1).createIdentity(biometricHash, professionalDataHash));
+      await contract.connect(user2).createIdentity(biometricHash, professionalDataHash);
+      results.updateBiometricHash = await gasUsed(
+        contract.connect(user1).updateBiometricHash(user1.address, ethers.utils.id("updated_hash"))
+      );
+      results.verifyIdentity = await gasUsed(contract.connect(government).verifyIdentity(user1.address));
+      results.addProfessionalRecord = await gasUsed(
+        contract.connect(user1).addProfessionalRecord(recordDataHash, startDate, 0)
+      );
+      await contract.connect(user1).addProfessionalRecord(recordDataHash, startDate, startDate + 3600);
+      results.addProfessionalRecordWithEndDate = await gasUsed(
+        contract.connect(user2).addProfessionalRecord(recordDataHash, startDate, startDate + 3600)
+      );
+      results.verifyProfessionalRecord = await gasUsed(
+        contract.connect(government).verifyProfessionalRecord(user1.address, 0)
+      );
+      results.batchVerifyProfessionalRecords = await gasUsed(
+        contract.connect(government).batchVerifyProfessionalRecords([user1.address, user2.address], [1, 0])
+      );
+      
+      return results;
+    };
+    
+    it("Should use less gas than v1 for every state-changing call", async function () {
+      const before = await measure(v1);
+      const after = await measure(v2);
+      
+      const table = {};
+      for (const name of Object.keys(before)) {
+        const saved = before[name].sub(after[name]);
+        table[name] = {
+          v1: before[name].toNumber(),
+          v2: after[name].toNumber(),
+          saved: saved.toNumber(),
+          savedPercent: (saved.toNumber() * 100 / before[name].toNumber()).toFixed(1)
+        };
+      }
+      console.table(table);
+      
+      for (const name of Object.keys(before)) {
+        expect(after[name].lt(before[name]), `${name} should be cheaper on v2`).to.equal(true);
+      }
+    });
+  });
 });
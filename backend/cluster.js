@@ -0,0 +1,95 @@
+/**
+ * Decentralized Biometric Identity System (DBIS)
+ * Cluster entry point: runs one HTTP worker (server.js) per core
+ *
+ * The primary only supervises. It forks WEB_CONCURRENCY workers (default: one
+ * per CPU), replaces workers that crash and relays cross-worker broadcasts
+ * and gather requests such as the /metrics scrape
+ * (utils/cluster.utils.js). On SIGTERM/SIGINT it asks every worker to drain
+ * and exits once they all have. Background jobs run in whichever worker wins
+ * leader election (services/leader.service.js).
+ */
+
+const cluster = require('cluster');
+const os = require('os');
+const clusterUtils = require('./utils/cluster.utils');
+const { logger } = require('./utils/logger.utils');
+
+const cpuCount = () => (os.availableParallelism ? os.availableParallelism() : os.cpus().length);
+
+const WORKERS = parseInt(process.env.WEB_CONCURRENCY || '0', 10) || cpuCount();
+
+// Workers get this long to drain before the primary gives up on them
+const SHUTDOWN_TIMEOUT_MS = parseInt(process.env.SHUTDOWN_TIMEOUT_MS || '25000', 10) + 5000;
+
+// Restart backoff for workers that keep crashing
+const RESTART_MIN_MS = 1000;
+const RESTART_MAX_MS = 30000;
+// A worker that lived this long resets the backoff
+const STABLE_UPTIME_MS = 60000;
+
+if (!clusterUtils.isPrimary()) {
+  require('./server');
+} else {
+  let shuttingDown = false;
+  let restartDelay = RESTART_MIN_MS;
+  const startedAt = new Map();
+
+  // Structured clone keeps Buffers and typed arrays intact in broadcasts
+  (cluster.setupPrimary || cluster.setupMaster).call(cluster, { serialization: 'advanced' });
+
+  const fork = () => {
+    const worker = cluster.fork();
+    startedAt.set(worker.id, Date.now());
+  };
+
+  cluster.on('exit', (worker, code, signal) => {
+    const uptime = Date.now() - (startedAt.get(worker.id) || 0);
+    startedAt.delete(worker.id);
+
+    if (shuttingDown) {
+      if (Object.keys(cluster.workers).length === 0) {
+        logger.info('All workers stopped');
+        process.exit(0);
+      }
+      return;
+    }
+
+    if (uptime > STABLE_UPTIME_MS) {
+      restartDelay = RESTART_MIN_MS;
+    }
+    logger.error(`Worker ${worker.process.pid} exited (${signal || code}), restarting in ${restartDelay}ms`);
+    setTimeout(() => {
+      if (!shuttingDown) fork();
+    }, restartDelay);
+    restartDelay = Math.min(restartDelay * 2, RESTART_MAX_MS);
+  });
+
+  const shutdown = (signal) => {
+    if (shuttingDown) return;
+    shuttingDown = true;
+    logger.info(`${signal} received, draining ${Object.keys(cluster.workers).length} workers`);
+
+    for (const worker of Object.values(cluster.workers)) {
+      worker.process.kill('SIGTERM');
+    }
+    if (Object.keys(cluster.workers).length === 0) {
+      process.exit(0);
+    }
+
+    setTimeout(() => {
+      logger.error('Workers did not stop in time, exiting');
+      process.exit(1);
+    }, SHUTDOWN_TIMEOUT_MS).unref();
+  };
+
+  process.on('SIGTERM', () => shutdown('SIGTERM'));
+  process.on('SIGINT', () => shutdown('SIGINT'));
+
+  clusterUtils.relayBroadcasts();
+
+  logger.info(`Primary ${process.pid} starting ${WORKERS} workers`);
+  for (let i = 0; i < WORKERS; i++) {
+    fork();
+  }
+}
@@ -6,6 +6,15 @@ DROP TABLE IF EXISTS document_records CASCADE;
 DROP TABLE IF EXISTS professional_records CASCADE;
 DROP TABLE IF EXISTS biometric_verifications CASCADE;
 DROP TABLE IF EXISTS biometric_data CASCADE;
+DROP TABLE IF EXISTS stat_daily CASCADE;
+DROP TABLE IF EXISTS stat_counters CASCADE;
+DROP TABLE IF EXISTS scheduled_tasks CASCADE;
+DROP TABLE IF EXISTS chain_professional_records CASCADE;
+DROP TABLE IF EXISTS chain_identities CASCADE;
+DROP TABLE IF EXISTS chain_events CASCADE;
+DROP TABLE IF EXISTS chain_index_blocks CASCADE;
+DROP TABLE IF EXISTS chain_index_cursors CASCADE;
+DROP TABLE IF EXISTS blockchain_jobs CASCADE;
 DROP TABLE IF EXISTS blockchain_transactions CASCADE;
 DROP TABLE IF EXISTS audit_logs CASCADE;
 DROP TABLE IF EXISTS user_sessions CASCADE;
@@ -14,6 +23,9 @@ DROP TABLE IF EXISTS admins CASCADE;
 DROP TABLE IF EXISTS users CASCADE;
 DROP TABLE IF EXISTS migrations CASCADE;
 
+-- Trigram matching for user search
+CREATE EXTENSION IF NOT EXISTS pg_trgm;
+
 -- Users table
 CREATE TABLE IF NOT EXISTS users (
     id SERIAL PRIMARY KEY,
@@ -32,7 +44,9 @@ CREATE TABLE IF NOT EXISTS users (
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
     updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
     avax_address TEXT,
+    -- Legacy random wallets only; derived wallets store wallet_index instead
     avax_private_key TEXT,
+    wallet_index INTEGER UNIQUE,
     password VARCHAR(255),
     blockchain_status VARCHAR(20) DEFAULT 'PENDING',
     blockchain_expiry TIMESTAMP,
@@ -41,6 +55,9 @@ CREATE TABLE IF NOT EXISTS users (
     CONSTRAINT users_verification_status_check CHECK (verification_status IN ('PENDING', 'VERIFIED', 'REJECTED'))
 );
 
+-- Derivation indexes for HD user wallets (services/hd-wallet.service.js)
+CREATE SEQUENCE IF NOT EXISTS users_wallet_index_seq AS INTEGER MINVALUE 0 START 0 OWNED BY users.wallet_index;
+
 -- Admins table
 CREATE TABLE IF NOT EXISTS admins (
     id SERIAL PRIMARY KEY,
@@ -117,6 +134,7 @@ CREATE TABLE IF NOT EXISTS biometric_data (
     user_id INTEGER REFERENCES users(id) ON DELETE CASCADE,
     facemesh_hash VARCHAR(255) NOT NULL,
     facemesh_data JSONB,
+    facemesh_template BYTEA,
     is_active BOOLEAN DEFAULT TRUE,
     blockchain_tx_hash VARCHAR(66),
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
@@ -173,9 +191,9 @@ CREATE TABLE IF NOT EXISTS admin_sessions (
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
 );
 
--- Audit logs table
+-- Audit logs table, range partitioned by month (see audit_logs_ensure_partitions)
 CREATE TABLE IF NOT EXISTS audit_logs (
-    id SERIAL PRIMARY KEY,
+    id SERIAL,
     user_id INTEGER REFERENCES users(id) ON DELETE SET NULL,
     admin_id INTEGER REFERENCES admins(id) ON DELETE SET NULL,
     action VARCHAR(50) NOT NULL,
@@ -183,8 +201,61 @@ CREATE TABLE IF NOT EXISTS audit_logs (
     entity_id INTEGER,
     details JSONB,
     ip_address VARCHAR(45),
-    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
-);
+    created_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (id, created_at)
+) PARTITION BY RANGE (created_at);
+
+CREATE TABLE IF NOT EXISTS audit_logs_default PARTITION OF audit_logs DEFAULT;
+
+-- Create the partition for the month containing p_month; returns false if it already exists.
+-- Rows that landed in the default partition for that month are moved into it
+CREATE OR REPLACE FUNCTION audit_logs_create_partition(p_month DATE) RETURNS BOOLEAN AS $$
+DECLARE
+  lower_bound TIMESTAMP := date_trunc('month', p_month);
+  upper_bound TIMESTAMP := date_trunc('month', p_month) + INTERVAL '1 month';
+  partition_name TEXT := 'audit_logs_' || to_char(p_month, '"y"YYYY"m"MM');
+BEGIN
+  IF to_regclass(partition_name) IS NOT NULL THEN
+    RETURN false;
+  END IF;
+
+  IF EXISTS (SELECT 1 FROM audit_logs_default WHERE created_at >= lower_bound AND created_at < upper_bound) THEN
+    EXECUTE format('CREATE TABLE %I (LIKE audit_logs INCLUDING DEFAULTS)', partition_name);
+    EXECUTE format(
+      'WITH moved AS (DELETE FROM audit_logs_default WHERE created_at >= $1 AND created_at < $2 RETURNING *)
+       INSERT INTO %I SELECT * FROM moved',
+      partition_name
+    ) USING lower_bound, upper_bound;
+    EXECUTE format('ALTER TABLE audit_logs ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)',
+      partition_name, lower_bound, upper_bound);
+  ELSE
+    EXECUTE format('CREATE TABLE %I PARTITION OF audit_logs FOR VALUES FROM (%L) TO (%L)',
+      partition_name, lower_bound, upper_bound);
+  END IF;
+  RETURN true;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Make sure partitions exist from the current month to p_months_ahead months ahead; returns how many were created
+CREATE OR REPLACE FUNCTION audit_logs_ensure_partitions(p_months_ahead INTEGER DEFAULT 3) RETURNS INTEGER AS $$
+DECLARE
+  created INTEGER := 0;
+  partition_month DATE;
+BEGIN
+  FOR partition_month IN
+    SELECT generate_series(date_trunc('month', LOCALTIMESTAMP),
+                           date_trunc('month', LOCALTIMESTAMP) + make_interval(months => p_months_ahead),
+                           INTERVAL '1 month')::date
+  LOOP
+    IF audit_logs_create_partition(partition_month) THEN
+      created := created + 1;
+    END IF;
+  END LOOP;
+  RETURN created;
+END;
+$$ LANGUAGE plpgsql;
+
+SELECT audit_logs_ensure_partitions(3);
 
 -- Blockchain transactions table
 CREATE TABLE IF NOT EXISTS blockchain_transactions (
@@ -207,6 +278,122 @@ CREATE TABLE IF NOT EXISTS blockchain_transactions (
     CONSTRAINT blockchain_transactions_status_check CHECK (status IN ('PENDING', 'CONFIRMED', 'FAILED'))
 );
 
+-- Blockchain jobs table (durable outbox for on-chain writes, drained by the blockchain worker)
+CREATE TABLE IF NOT EXISTS blockchain_jobs (
+    id SERIAL PRIMARY KEY,
+    job_type VARCHAR(50) NOT NULL,
+    user_id INTEGER REFERENCES users(id) ON DELETE CASCADE,
+    payload JSONB NOT NULL DEFAULT '{}',
+    status VARCHAR(20) NOT NULL DEFAULT 'QUEUED',
+    attempts INTEGER NOT NULL DEFAULT 0,
+    max_attempts INTEGER NOT NULL DEFAULT 5,
+    run_after TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    locked_by VARCHAR(100),
+    locked_until TIMESTAMP,
+    transaction_hash VARCHAR(66),
+    raw_transaction TEXT,
+    submitted_at TIMESTAMP,
+    result JSONB,
+    last_error TEXT,
+    created_by INTEGER REFERENCES admins(id),
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    CONSTRAINT blockchain_jobs_status_check CHECK (status IN ('QUEUED', 'SUBMITTED', 'CONFIRMED', 'FAILED'))
+);
+
+-- Contract event index (filled by the chain indexer, keyed by contract address)
+-- Indexing progress per contract; locked_by/locked_until lease it to a single indexer
+CREATE TABLE IF NOT EXISTS chain_index_cursors (
+    contract_address VARCHAR(42) PRIMARY KEY,
+    block_number BIGINT NOT NULL,
+    block_hash VARCHAR(66),
+    locked_by VARCHAR(100),
+    locked_until TIMESTAMP,
+    caught_up_at TIMESTAMP,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Hashes of recently indexed blocks, used to find the fork point after a reorg
+CREATE TABLE IF NOT EXISTS chain_index_blocks (
+    contract_address VARCHAR(42) NOT NULL,
+    block_number BIGINT NOT NULL,
+    block_hash VARCHAR(66) NOT NULL,
+    PRIMARY KEY (contract_address, block_number)
+);
+
+-- Raw decoded events; projections are rebuilt from these after a reorg
+CREATE TABLE IF NOT EXISTS chain_events (
+    id BIGSERIAL PRIMARY KEY,
+    contract_address VARCHAR(42) NOT NULL,
+    block_number BIGINT NOT NULL,
+    block_hash VARCHAR(66) NOT NULL,
+    transaction_hash VARCHAR(66) NOT NULL,
+    log_index INTEGER NOT NULL,
+    event_name VARCHAR(50) NOT NULL,
+    account VARCHAR(42) NOT NULL,
+    args JSONB NOT NULL,
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    CONSTRAINT chain_events_log_unique UNIQUE (contract_address, transaction_hash, log_index)
+);
+
+-- Current on-chain identity state (account is the lowercased wallet address)
+CREATE TABLE IF NOT EXISTS chain_identities (
+    contract_address VARCHAR(42) NOT NULL,
+    account VARCHAR(42) NOT NULL,
+    biometric_hash VARCHAR(66),
+    is_verified BOOLEAN NOT NULL DEFAULT FALSE,
+    verified_by VARCHAR(42),
+    created_at TIMESTAMP NOT NULL,
+    updated_at TIMESTAMP NOT NULL,
+    verified_at TIMESTAMP,
+    created_block BIGINT NOT NULL,
+    updated_block BIGINT NOT NULL,
+    PRIMARY KEY (contract_address, account)
+);
+
+-- Current on-chain professional records, in contract index order
+CREATE TABLE IF NOT EXISTS chain_professional_records (
+    contract_address VARCHAR(42) NOT NULL,
+    account VARCHAR(42) NOT NULL,
+    record_index INTEGER NOT NULL,
+    data_hash VARCHAR(66) NOT NULL,
+    start_date TIMESTAMP,
+    end_date TIMESTAMP,
+    is_verified BOOLEAN NOT NULL DEFAULT FALSE,
+    verifier VARCHAR(42),
+    created_at TIMESTAMP NOT NULL,
+    verified_at TIMESTAMP,
+    created_block BIGINT NOT NULL,
+    PRIMARY KEY (contract_address, account, record_index)
+);
+
+-- Scheduled background tasks; checkpoint holds the resume position of an unfinished sweep
+CREATE TABLE IF NOT EXISTS scheduled_tasks (
+    name VARCHAR(100) PRIMARY KEY,
+    checkpoint JSONB,
+    last_run_started_at TIMESTAMP,
+    last_run_finished_at TIMESTAMP,
+    last_result JSONB,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Dashboard counters (kept current by the stat_* triggers below) and daily rollups
+CREATE TABLE IF NOT EXISTS stat_counters (
+    name VARCHAR(100) NOT NULL,
+    dimension VARCHAR(100) NOT NULL DEFAULT '',
+    shard SMALLINT NOT NULL DEFAULT 0,
+    count BIGINT NOT NULL DEFAULT 0,
+    PRIMARY KEY (name, dimension, shard)
+);
+
+CREATE TABLE IF NOT EXISTS stat_daily (
+    name VARCHAR(100) NOT NULL,
+    day DATE NOT NULL,
+    dimension VARCHAR(100) NOT NULL DEFAULT '',
+    count BIGINT NOT NULL DEFAULT 0,
+    PRIMARY KEY (name, day, dimension)
+);
+
 -- Biometric verifications table
 CREATE TABLE IF NOT EXISTS biometric_verifications (
     id SERIAL PRIMARY KEY,
@@ -229,6 +416,15 @@ CREATE INDEX IF NOT EXISTS idx_users_government_id ON users(government_id);
 CREATE INDEX IF NOT EXISTS idx_users_avax_address ON users(avax_address);
 CREATE INDEX IF NOT EXISTS idx_users_verification_status ON users(verification_status);
 CREATE INDEX IF NOT EXISTS idx_users_blockchain_status ON users(blockchain_status);
+CREATE INDEX IF NOT EXISTS idx_users_created_at_id ON users(created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_users_name_trgm ON users USING gin (lower(name) gin_trgm_ops);
+CREATE INDEX IF NOT EXISTS idx_users_government_id_trgm ON users USING gin (lower(government_id) gin_trgm_ops);
+CREATE INDEX IF NOT EXISTS idx_users_email_trgm ON users USING gin (lower(email) gin_trgm_ops);
+CREATE INDEX IF NOT EXISTS idx_users_username_trgm ON users USING gin (lower(username) gin_trgm_ops);
+CREATE INDEX IF NOT EXISTS idx_users_name_prefix ON users (lower(name) text_pattern_ops);
+CREATE INDEX IF NOT EXISTS idx_users_government_id_prefix ON users (lower(government_id) text_pattern_ops);
+CREATE INDEX IF NOT EXISTS idx_users_email_prefix ON users (lower(email) text_pattern_ops);
+CREATE INDEX IF NOT EXISTS idx_users_blockchain_expiry_pending ON users(blockchain_expiry, id) WHERE blockchain_status = 'PENDING';
 
 CREATE INDEX IF NOT EXISTS idx_document_records_user_id ON document_records(user_id);
 CREATE INDEX IF NOT EXISTS idx_document_records_verification_status ON document_records(verification_status);
@@ -241,6 +437,7 @@ CREATE INDEX IF NOT EXISTS idx_professional_records_record_type ON professional_
 CREATE INDEX IF NOT EXISTS idx_biometric_data_user_id ON biometric_data(user_id);
 CREATE INDEX IF NOT EXISTS idx_biometric_data_facemesh_hash ON biometric_data(facemesh_hash);
 CREATE INDEX IF NOT EXISTS idx_biometric_data_verification_status ON biometric_data(verification_status);
+CREATE INDEX IF NOT EXISTS idx_biometric_data_active_user_id ON biometric_data(user_id) WHERE is_active = true;
 
 CREATE INDEX IF NOT EXISTS idx_verification_requests_user_id ON verification_requests(user_id);
 CREATE INDEX IF NOT EXISTS idx_verification_requests_record_id ON verification_requests(record_id);
@@ -251,11 +448,86 @@ CREATE INDEX IF NOT EXISTS idx_audit_logs_user_id ON audit_logs(user_id);
 CREATE INDEX IF NOT EXISTS idx_audit_logs_admin_id ON audit_logs(admin_id);
 CREATE INDEX IF NOT EXISTS idx_audit_logs_action ON audit_logs(action);
 CREATE INDEX IF NOT EXISTS idx_audit_logs_entity_type ON audit_logs(entity_type);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_created_at_id ON audit_logs(created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_user_created_at_id ON audit_logs(user_id, created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_action_created_at_id ON audit_logs(action, created_at DESC, id DESC);
 
 CREATE INDEX IF NOT EXISTS idx_blockchain_transactions_user_id ON blockchain_transactions(user_id);
 CREATE INDEX IF NOT EXISTS idx_blockchain_transactions_hash ON blockchain_transactions(transaction_hash);
 CREATE INDEX IF NOT EXISTS idx_blockchain_transactions_status ON blockchain_transactions(status);
 
+CREATE INDEX IF NOT EXISTS idx_blockchain_jobs_runnable ON blockchain_jobs(run_after) WHERE status IN ('QUEUED', 'SUBMITTED');
+CREATE INDEX IF NOT EXISTS idx_blockchain_jobs_user_id ON blockchain_jobs(user_id);
+
+CREATE INDEX IF NOT EXISTS idx_chain_events_block ON chain_events(contract_address, block_number);
+CREATE INDEX IF NOT EXISTS idx_chain_events_account ON chain_events(contract_address, account, block_number, log_index);
+
+-- Dashboard counter triggers
+CREATE OR REPLACE FUNCTION stat_counter_bump(p_name TEXT, p_dimension TEXT, p_delta BIGINT) RETURNS void AS $$
+BEGIN
+  INSERT INTO stat_counters (name, dimension, shard, count)
+  VALUES (p_name, COALESCE(p_dimension, ''), pg_backend_pid() % 8, p_delta)
+  ON CONFLICT (name, dimension, shard) DO UPDATE SET count = stat_counters.count + EXCLUDED.count;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Row trigger; the optional argument names the column counted by value
+CREATE OR REPLACE FUNCTION stat_track_rows() RETURNS trigger AS $$
+DECLARE
+  old_dimension TEXT;
+  new_dimension TEXT;
+BEGIN
+  IF TG_NARGS > 0 THEN
+    IF TG_OP <> 'INSERT' THEN old_dimension := to_jsonb(OLD) ->> TG_ARGV[0]; END IF;
+    IF TG_OP <> 'DELETE' THEN new_dimension := to_jsonb(NEW) ->> TG_ARGV[0]; END IF;
+  END IF;
+
+  IF TG_OP = 'UPDATE' AND old_dimension IS NOT DISTINCT FROM new_dimension THEN
+    RETURN NULL;
+  END IF;
+  IF TG_OP <> 'INSERT' THEN PERFORM stat_counter_bump(TG_TABLE_NAME, old_dimension, -1); END IF;
+  IF TG_OP <> 'DELETE' THEN PERFORM stat_counter_bump(TG_TABLE_NAME, new_dimension, 1); END IF;
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS stat_users ON users;
+CREATE TRIGGER stat_users AFTER INSERT OR DELETE OR UPDATE OF verification_status ON users
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows('verification_status');
+
+DROP TRIGGER IF EXISTS stat_biometric_data ON biometric_data;
+CREATE TRIGGER stat_biometric_data AFTER INSERT OR DELETE OR UPDATE OF verification_status ON biometric_data
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows('verification_status');
+
+DROP TRIGGER IF EXISTS stat_professional_records ON professional_records;
+CREATE TRIGGER stat_professional_records AFTER INSERT OR DELETE ON professional_records
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows();
+
+DROP TRIGGER IF EXISTS stat_blockchain_transactions ON blockchain_transactions;
+CREATE TRIGGER stat_blockchain_transactions AFTER INSERT OR DELETE OR UPDATE OF transaction_type ON blockchain_transactions
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows('transaction_type');
+
+-- Change notifications for the admin live feed; payload is {table, id}.
+-- Partitioned tables pass their own name, as row triggers fire on the partition
+CREATE OR REPLACE FUNCTION notify_change() RETURNS trigger AS $$
+BEGIN
+  PERFORM pg_notify('dbis_changes', json_build_object('table', COALESCE(TG_ARGV[0], TG_TABLE_NAME), 'id', NEW.id)::text);
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS notify_audit_logs ON audit_logs;
+CREATE TRIGGER notify_audit_logs AFTER INSERT ON audit_logs
+  FOR EACH ROW EXECUTE PROCEDURE notify_change('audit_logs');
+
+DROP TRIGGER IF EXISTS notify_verification_requests ON verification_requests;
+CREATE TRIGGER notify_verification_requests AFTER INSERT ON verification_requests
+  FOR EACH ROW EXECUTE PROCEDURE notify_change();
+
+DROP TRIGGER IF EXISTS notify_blockchain_transactions ON blockchain_transactions;
+CREATE TRIGGER notify_blockchain_transactions AFTER INSERT ON blockchain_transactions
+  FOR EACH ROW EXECUTE PROCEDURE notify_change();
+
 -- Initial admin user (password: admin123)
 INSERT INTO admins (username, password, email, role)
 VALUES ('admin', '$argon2id$v=19$m=65536,t=3,p=4$hnDOWUtprTXmHGMM4ZxTig$2eZ1T3Vy4SY10OuNkXEPTO6UFHT+aFxc2MZwsrfS9tQ', 'admin@dbis.gov', 'SUPER_ADMIN')
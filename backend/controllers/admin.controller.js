@@ -2,8 +2,16 @@
  * Admin controller for DBIS
  */
 const jwt = require('jsonwebtoken');
-const argon2 = require('argon2');
 const { v4: uuidv4 } = require('uuid');
+const blockchainQueue = require('../services/blockchain-queue.service');
+const hdWallet = require('../services/hd-wallet.service');
+const userSearch = require('../services/user-search.service');
+const statsService = require('../services/stats.service');
+const changeFeed = require('../services/change-feed.service');
+const passwordHash = require('../services/password-hash.service');
+const auditLog = require('../services/audit-log.service');
+const { keys: cacheKeys } = require('../services/cache.service');
+const { decodeCursor, parseLimit, keysetPage, cachedCount, tableCount } = require('../utils/pagination.utils');
 
 /**
  * Generate JWT token for admin
@@ -66,34 +74,26 @@ exports.loginAdmin = async (req, res) => {
     }
 
     // Verify password
+    // argon2, or bcrypt for older accounts; runs on the hashing pool
     let passwordValid;
     try {
-      // Check if password is hashed with argon2
-      if (admin.password.startsWith('$argon2')) {
-        passwordValid = await argon2.verify(admin.password, password);
-      } else {
-        // Fallback to bcrypt if needed
-        const bcrypt = require('bcryptjs');
-        passwordValid = await bcrypt.compare(password, admin.password);
-      }
+      passwordValid = await passwordHash.verify(password, admin.password);
     } catch (error) {
+      if (passwordHash.respondIfBusy(res, error)) return;
       logger.error('Password verification error:', error);
       return res.status(500).json({ message: 'Error during authentication' });
     }
 
     if (!passwordValid) {
       // Log failed login attempt
-      await db.query(
-        'INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address) VALUES ($1, $2, $3, $4, $5, $6)',
-        [
-          admin.id,
-          'ADMIN_LOGIN_FAILED',
-          'admins',
-          admin.id,
-          JSON.stringify({ reason: 'Invalid password' }),
-          req.ip
-        ]
-      );
+      auditLog.record(db, {
+        adminId: admin.id,
+        action: 'ADMIN_LOGIN_FAILED',
+        entityType: 'admins',
+        entityId: admin.id,
+        details: { reason: 'Invalid password' },
+        ipAddress: req.ip
+      });
       
       return res.status(401).json({ message: 'Invalid credentials' });
     }
@@ -114,17 +114,14 @@ exports.loginAdmin = async (req, res) => {
     );
 
     // Log successful login
-    await db.query(
-      'INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address) VALUES ($1, $2, $3, $4, $5, $6)',
-      [
-        admin.id,
-        'ADMIN_LOGIN_SUCCESS',
-        'admins',
-        admin.id,
-        JSON.stringify({}),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: admin.id,
+      action: 'ADMIN_LOGIN_SUCCESS',
+      entityType: 'admins',
+      entityId: admin.id,
+      details: {},
+      ipAddress: req.ip
+    });
 
     // Return admin data and token in the format expected by the government portal
     res.status(200).json({
@@ -244,51 +241,69 @@ exports.refreshAdminToken = async (req, res) => {
 exports.getAllUsers = async (req, res) => {
   const db = req.app.locals.db;
   const logger = req.app.locals.logger;
-  const { page = 1, limit = 10, search = '', status = '' } = req.query;
+  const { page, cursor, search = '', status = '' } = req.query;
+  const limit = parseLimit(req.query.limit, 10);
   
   try {
-    let query = `
-      SELECT u.id, u.name, u.government_id, u.email, u.phone, u.avax_address, 
-             u.is_verified, u.verification_status, u.created_at, u.updated_at,
-             EXISTS(SELECT 1 FROM biometric_data b WHERE b.user_id = u.id AND b.is_active = true) as has_biometric
-      FROM users u
-      WHERE 1=1
-    `;
-    
+    const conditions = [];
     const queryParams = [];
-    let paramIndex = 1;
     
     if (search) {
-      query += ` AND (u.name ILIKE $${paramIndex} OR u.government_id ILIKE $${paramIndex} OR u.email ILIKE $${paramIndex})`;
-      queryParams.push(`%${search}%`);
-      paramIndex++;
+      queryParams.push(userSearch.substringPattern(search));
+      conditions.push(userSearch.substringCondition('u', queryParams.length));
     }
     
     if (status) {
-      query += ` AND u.verification_status = $${paramIndex}`;
       queryParams.push(status);
-      paramIndex++;
+      conditions.push(`u.verification_status = $${queryParams.length}`);
     }
     
-    // Count total users matching the criteria
-    const countQuery = `SELECT COUNT(*) FROM (${query}) AS count`;
-    const countResult = await db.query(countQuery, queryParams);
-    const totalUsers = parseInt(countResult.rows[0].count);
+    // Totals are cached briefly; an unfiltered total comes from table statistics once the table is large
+    const total = conditions.length > 0
+      ? { count: await cachedCount(db, `SELECT COUNT(*) FROM users u WHERE ${conditions.join(' AND ')}`, queryParams), estimated: false }
+      : await tableCount(db, 'users');
     
-    // Add pagination
-    const offset = (page - 1) * limit;
-    query += ` ORDER BY u.created_at DESC LIMIT $${paramIndex} OFFSET $${paramIndex + 1}`;
-    queryParams.push(limit, offset);
+    // Keyset position from the cursor; page/OFFSET is still accepted for numbered pagination
+    const position = decodeCursor(cursor);
+    const pageNumber = Math.max(parseInt(page, 10) || 1, 1);
+    const pageConditions = [...conditions];
+    const pageParams = [...queryParams];
+    
+    if (position) {
+      pageParams.push(position.createdAt, position.id);
+      pageConditions.push(`(u.created_at, u.id) < ($${pageParams.length - 1}::timestamp, $${pageParams.length}::int)`);
+    }
+    pageParams.push(limit + 1, position ? 0 : (pageNumber - 1) * limit);
+    
+    // has_biometric is only evaluated for the rows on the page
+    const result = await db.query(
+      `SELECT p.*,
+              EXISTS(SELECT 1 FROM biometric_data b WHERE b.user_id = p.id AND b.is_active = true) as has_biometric
+       FROM (
+         SELECT u.id, u.name, u.government_id, u.email, u.phone, u.avax_address, 
+                u.is_verified, u.verification_status, u.created_at, u.updated_at,
+                u.created_at::text AS cursor_created_at
+         FROM users u
+         ${pageConditions.length > 0 ? `WHERE ${pageConditions.join(' AND ')}` : ''}
+         ORDER BY u.created_at DESC, u.id DESC
+         LIMIT $${pageParams.length - 1} OFFSET $${pageParams.length}
+       ) p
+       ORDER BY p.created_at DESC, p.id DESC`,
+      pageParams
+    );
     
-    const result = await db.query(query, queryParams);
+    const { rows, nextCursor, hasMore } = keysetPage(result.rows, limit);
     
     res.status(200).json({
-      users: result.rows,
+      users: rows,
       pagination: {
-        total: totalUsers,
-        page: parseInt(page),
-        limit: parseInt(limit),
-        pages: Math.ceil(totalUsers / limit)
+        total: total.count,
+        estimated: total.estimated,
+        page: position ? null : pageNumber,
+        limit,
+        pages: Math.ceil(total.count / limit),
+        nextCursor,
+        hasMore
       }
     });
   } catch (error) {
@@ -297,6 +312,29 @@ exports.getAllUsers = async (req, res) => {
   }
 };
 
+/**
+ * Typeahead user search ranked by exact, prefix and fuzzy matches
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ */
+exports.searchUsers = async (req, res) => {
+  const db = req.app.locals.db;
+  const logger = req.app.locals.logger;
+  const { q = '', limit, status } = req.query;
+  
+  try {
+    const users = await userSearch.searchUsers(db, q, { limit, status });
+    
+    res.status(200).json({
+      query: q,
+      users
+    });
+  } catch (error) {
+    logger.error('Search users error:', error);
+    res.status(500).json({ message: 'Server error while searching users' });
+  }
+};
+
 /**
  * Get user by ID
  * @param {Object} req - Express request object
@@ -403,9 +441,9 @@ exports.verifyUser = async (req, res) => {
   const { verificationStatus, verificationNotes, transferAmount } = req.body;
   
   try {
-    // Check if user exists and get all necessary user data including private key
+    // Check if user exists and get all necessary user data including the wallet key reference
     const userResult = await db.query(
-      'SELECT id, name, government_id, verification_status, avax_address, avax_address, avax_private_key FROM users WHERE id = $1',
+      'SELECT id, name, government_id, verification_status, avax_address, wallet_index, avax_private_key FROM users WHERE id = $1',
       [id]
     );
     
@@ -416,7 +454,7 @@ exports.verifyUser = async (req, res) => {
     const user = userResult.rows[0];
     
     // Start a transaction
-    const client = await db.pool.connect();
+    const client = await db.connect();
     try {
       await client.query('BEGIN');
       
@@ -470,228 +508,32 @@ exports.verifyUser = async (req, res) => {
         ]
       );
       
-      // Initialize variables for transaction results
-      let fundingResult = null;
-      let blockchainRegistrationResult = null;
+      // On-chain work is queued in the same transaction and run by the blockchain worker,
+      // so the request never waits on RPC calls or confirmations
+      const blockchainJobs = [];
       
-      // STEP 1: If verification status is VERIFIED, first transfer funds to the user's wallet
       if (verificationStatus === 'VERIFIED') {
-        // Import the wallet service
-        const walletService = require('../services/wallet.service');
-        
         // Get transfer amount from request or use default (0.03 AVAX)
         const amount = transferAmount || 0.03;
-        
-        // Check if user has avax_address, use that if available
-        const targetAddress = user.avax_address || user.avax_address;
+        const targetAddress = user.avax_address;
         
         if (targetAddress) {
-          logger.info(`Transferring ${amount} AVAX to user ${user.id} at address ${targetAddress}`);
-          
-          // Transfer AVAX to user's wallet
-          fundingResult = await walletService.transferTokens(targetAddress, amount);
+          logger.info(`Queueing ${amount} AVAX funding for user ${user.id} at address ${targetAddress}`);
           
-          if (fundingResult.success) {
-            // Update user's blockchain transaction record
-            await client.query(
-              `INSERT INTO blockchain_transactions 
-               (user_id, transaction_type, transaction_hash, block_number, status, data)
-               VALUES ($1, $2, $3, $4, $5, $6)`,
-              [
-                id,
-                'VERIFICATION_FUNDING',
-                fundingResult.transactionHash,
-                fundingResult.blockNumber,
-                'SUCCESS',
-                JSON.stringify({
-                  amount: amount,
-                  from: fundingResult.from,
-                  to: targetAddress,
-                  gasUsed: fundingResult.gasUsed,
-                  network: 'avalanche_fuji'
-                })
-              ]
-            );
-            
-            // Log the transaction
-            await client.query(
-              `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-               VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-              [
-                req.admin.id,
-                id,
-                'USER_BLOCKCHAIN_FUNDING',
-                'users',
-                id,
-                JSON.stringify({
-                  transactionHash: fundingResult.transactionHash,
-                  amount: amount,
-                  status: 'SUCCESS'
-                }),
-                req.ip
-              ]
-            );
-            
-            // STEP 2: After successful funding, forcefully register user's identity on blockchain
-            if (user.avax_private_key) {
-              try {
-                // Get user's biometric data hash
-                const biometricResult = await client.query(
-                  'SELECT facemesh_hash FROM biometric_data WHERE user_id = $1 AND is_active = true',
-                  [id]
-                );
-                
-                if (biometricResult.rows.length > 0) {
-                  const biometricHash = biometricResult.rows[0].facemesh_hash;
-                  
-                  // Import blockchain service
-                  const blockchainService = require('../services/blockchain.service');
-                  
-                  // Check if identity already exists on blockchain
-                  const targetAddress = user.avax_address || user.avax_address;
-                  let identityExists = false;
-                  
-                  try {
-                    identityExists = await blockchainService.isIdentityRegistered(targetAddress);
-                    logger.info(`Identity check for user ${user.id} completed. Result: ${identityExists ? 'EXISTS' : 'NOT EXISTS'}`);
-                  } catch (identityCheckError) {
-                    logger.error(`Error checking if identity exists for user ${user.id}:`, identityCheckError);
-                    // Continue with registration attempt even if check fails
-                  }
-                  
-                  if (identityExists) {
-                    logger.info(`Identity for user ${user.id} already exists on blockchain, skipping registration`);
-                    
-                    // Record the existing identity in audit logs
-                    await client.query(
-                      `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-                       VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-                      [
-                        req.admin.id,
-                        id,
-                        'USER_BLOCKCHAIN_IDENTITY_EXISTS',
-                        'users',
-                        id,
-                        JSON.stringify({
-                          message: 'Identity already exists on blockchain',
-                          walletAddress: targetAddress
-                        }),
-                        req.ip
-                      ]
-                    );
-                    
-                    // Set blockchainRegistrationResult to indicate existing identity
-                    blockchainRegistrationResult = {
-                      status: 'ALREADY_EXISTS',
-                      message: 'Identity already exists on blockchain'
-                    };
-                  } else {
-                    // Use empty professional data hash for now
-                    const professionalDataHash = "0x0000000000000000000000000000000000000000000000000000000000000000";
-                    
-                    logger.info(`Registering user ${user.id} identity on blockchain using their private key`);
-                    
-                    // Register identity on blockchain using user's private key
-                    blockchainRegistrationResult = await blockchainService.registerIdentity(
-                      user.avax_private_key,
-                      biometricHash,
-                      professionalDataHash
-                    );
-                  
-                    // Record blockchain registration only if we actually registered (not for existing identities)
-                    await client.query(
-                      `INSERT INTO blockchain_transactions 
-                       (user_id, transaction_type, transaction_hash, block_number, status, data)
-                       VALUES ($1, $2, $3, $4, $5, $6)`,
-                      [
-                        id,
-                        'IDENTITY_REGISTRATION',
-                        blockchainRegistrationResult.transactionHash,
-                        blockchainRegistrationResult.blockNumber,
-                        blockchainRegistrationResult.status,
-                        JSON.stringify({
-                          biometricHash: biometricHash,
-                          registeredBy: 'SYSTEM_AUTOMATIC',
-                          network: blockchainRegistrationResult.network
-                        })
-                      ]
-                    );
-                    
-                    // Update the biometric data with the blockchain transaction hash
-                    await client.query(
-                      `UPDATE biometric_data 
-                       SET blockchain_tx_hash = $1,
-                           updated_at = NOW()
-                       WHERE user_id = $2 AND is_active = true`,
-                      [blockchainRegistrationResult.transactionHash, id]
-                    );
-                  }
-                  
-                  // Log blockchain registration in audit logs only since blockchain_status column doesn't exist
-                  logger.info(`Successfully registered user ${id} identity on blockchain with tx hash: ${blockchainRegistrationResult.transactionHash}`);
-                  
-                  // Log the blockchain registration
-                  await client.query(
-                    `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-                     VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-                    [
-                      req.admin.id,
-                      id,
-                      'USER_BLOCKCHAIN_REGISTRATION',
-                      'users',
-                      id,
-                      JSON.stringify({
-                        transactionHash: blockchainRegistrationResult.transactionHash,
-                        status: blockchainRegistrationResult.status,
-                        automatic: true
-                      }),
-                      req.ip
-                    ]
-                  );
-                } else {
-                  logger.error(`No active biometric data found for user ${id}`);
-                }
-              } catch (blockchainError) {
-                logger.error(`Error registering user ${id} on blockchain:`, blockchainError);
-                
-                // Log the failed blockchain registration
-                await client.query(
-                  `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-                   VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-                  [
-                    req.admin.id,
-                    id,
-                    'USER_BLOCKCHAIN_REGISTRATION_FAILED',
-                    'users',
-                    id,
-                    JSON.stringify({
-                      error: blockchainError.message
-                    }),
-                    req.ip
-                  ]
-                );
-              }
-            } else {
-              logger.error(`No private key available for user ${id}`);
+          // Identity registration is queued by the funding job once the funds are confirmed
+          const job = await blockchainQueue.enqueue(client, 'VERIFICATION_FUNDING', {
+            userId: user.id,
+            createdBy: req.admin.id,
+            payload: {
+              toAddress: targetAddress,
+              amount: amount,
+              registerIdentity: hdWallet.hasSigner(user)
             }
-          } else {
-            // Log the failed funding transaction
-            await client.query(
-              `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-               VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-              [
-                req.admin.id,
-                id,
-                'USER_BLOCKCHAIN_FUNDING_FAILED',
-                'users',
-                id,
-                JSON.stringify({
-                  error: fundingResult.error,
-                  amount: amount
-                }),
-                req.ip
-              ]
-            );
+          });
+          blockchainJobs.push(job);
+          
+          if (!hdWallet.hasSigner(user)) {
+            logger.error(`No signing key available for user ${id}`);
           }
         } else {
           logger.error(`No wallet address available for user ${id}`);
@@ -699,6 +541,7 @@ exports.verifyUser = async (req, res) => {
       }
       
       await client.query('COMMIT');
+      await db.invalidate(cacheKeys.user(id));
       
       // Prepare response
       const response = {
@@ -712,37 +555,16 @@ exports.verifyUser = async (req, res) => {
         }
       };
       
-      // Add transaction details to response if available
-      if (fundingResult && fundingResult.success) {
-        response.fundingTransaction = {
-          hash: fundingResult.transactionHash,
-          blockNumber: fundingResult.blockNumber,
-          explorerUrl: fundingResult.explorerUrl
-        };
-      }
-      
-      // Add blockchain registration details if available
-      if (blockchainRegistrationResult) {
-        response.blockchainRegistration = {};
-        
-        // Handle the case where identity already exists
-        if (blockchainRegistrationResult.status === 'ALREADY_EXISTS') {
-          response.blockchainRegistration.status = 'ALREADY_EXISTS';
-          response.blockchainRegistration.message = blockchainRegistrationResult.message;
-        } else {
-          // For newly registered identities
-          response.blockchainRegistration.hash = blockchainRegistrationResult.transactionHash;
-          response.blockchainRegistration.blockNumber = blockchainRegistrationResult.blockNumber;
-          response.blockchainRegistration.status = blockchainRegistrationResult.status;
-          
-          // Include network info if available
-          if (blockchainRegistrationResult.network) {
-            response.blockchainRegistration.network = blockchainRegistrationResult.network;
-          }
-        }
+      // Poll GET /api/admin/blockchain-jobs/:id for progress
+      if (blockchainJobs.length > 0) {
+        response.blockchainJobs = blockchainJobs.map(job => ({
+          id: job.id,
+          type: job.job_type,
+          status: job.status
+        }));
       }
       
-      res.status(200).json(response);
+      res.status(blockchainJobs.length > 0 ? 202 : 200).json(response);
     } catch (error) {
       await client.query('ROLLBACK');
       throw error;
@@ -755,6 +577,43 @@ exports.verifyUser = async (req, res) => {
   }
 };
 
+/**
+ * Get the status of a queued blockchain job
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ */
+exports.getBlockchainJob = async (req, res) => {
+  const db = req.app.locals.db;
+  const logger = req.app.locals.logger;
+  
+  try {
+    const job = await blockchainQueue.getJob(db, req.params.id);
+    
+    if (!job) {
+      return res.status(404).json({ message: 'Blockchain job not found' });
+    }
+    
+    res.status(200).json({
+      id: job.id,
+      type: job.job_type,
+      userId: job.user_id,
+      status: job.status,
+      attempts: job.attempts,
+      maxAttempts: job.max_attempts,
+      transactionHash: job.transaction_hash,
+      explorerUrl: job.transaction_hash ? `https://testnet.snowtrace.io/tx/${job.transaction_hash}` : null,
+      result: job.result,
+      lastError: job.last_error,
+      nextAttemptAt: job.run_after,
+      createdAt: job.created_at,
+      updatedAt: job.updated_at
+    });
+  } catch (error) {
+    logger.error('Get blockchain job error:', error);
+    res.status(500).json({ message: 'Server error while retrieving blockchain job' });
+  }
+};
+
 /**
  * Update user information
  * @param {Object} req - Express request object
@@ -799,28 +658,25 @@ exports.updateUser = async (req, res) => {
     );
     
     const updatedUser = updateResult.rows[0];
+    await db.invalidate(cacheKeys.userProfile(id));
     
     // Log the update action
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-      [
-        req.admin.id,
-        id,
-        'USER_UPDATED',
-        'users',
-        id,
-        JSON.stringify({
-          changes: {
-            name: name !== user.name ? { from: user.name, to: name } : undefined,
-            email: email !== user.email ? { from: user.email, to: email } : undefined,
-            phone: phone !== user.phone ? { from: user.phone, to: phone } : undefined,
-            walletAddress: walletAddress !== user.avax_address ? { from: user.avax_address, to: walletAddress } : undefined
-          }
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      userId: id,
+      action: 'USER_UPDATED',
+      entityType: 'users',
+      entityId: id,
+      details: {
+        changes: {
+          name: name !== user.name ? { from: user.name, to: name } : undefined,
+          email: email !== user.email ? { from: user.email, to: email } : undefined,
+          phone: phone !== user.phone ? { from: user.phone, to: phone } : undefined,
+          walletAddress: walletAddress !== user.avax_address ? { from: user.avax_address, to: walletAddress } : undefined
+        }
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'User updated successfully',
@@ -840,71 +696,88 @@ exports.updateUser = async (req, res) => {
 exports.getActivityLogs = async (req, res) => {
   const db = req.app.locals.db;
   const logger = req.app.locals.logger;
-  const { page = 1, limit = 20, userId, adminId, action, startDate, endDate } = req.query;
+  const { page, cursor, userId, adminId, action, startDate, endDate } = req.query;
+  const limit = parseLimit(req.query.limit, 20);
   
   try {
-    let query = `
-      SELECT l.id, l.action, l.entity_type, l.entity_id, l.details, l.ip_address, l.created_at,
-             u.name as user_name, u.government_id,
-             a.username as admin_username
-      FROM audit_logs l
-      LEFT JOIN users u ON l.user_id = u.id
-      LEFT JOIN admins a ON l.admin_id = a.id
-      WHERE 1=1
-    `;
-    
+    const conditions = [];
     const queryParams = [];
-    let paramIndex = 1;
     
     if (userId) {
-      query += ` AND l.user_id = $${paramIndex}`;
       queryParams.push(userId);
-      paramIndex++;
+      conditions.push(`l.user_id = $${queryParams.length}`);
     }
     
     if (adminId) {
-      query += ` AND l.admin_id = $${paramIndex}`;
       queryParams.push(adminId);
-      paramIndex++;
+      conditions.push(`l.admin_id = $${queryParams.length}`);
     }
     
     if (action) {
-      query += ` AND l.action = $${paramIndex}`;
       queryParams.push(action);
-      paramIndex++;
+      conditions.push(`l.action = $${queryParams.length}`);
     }
     
     if (startDate) {
-      query += ` AND l.created_at >= $${paramIndex}`;
       queryParams.push(startDate);
-      paramIndex++;
+      conditions.push(`l.created_at >= $${queryParams.length}`);
     }
     
     if (endDate) {
-      query += ` AND l.created_at <= $${paramIndex}`;
       queryParams.push(endDate);
-      paramIndex++;
+      conditions.push(`l.created_at <= $${queryParams.length}`);
     }
     
-    // Count total logs matching the criteria
-    const countQuery = `SELECT COUNT(*) FROM (${query}) AS count`;
-    const countResult = await db.query(countQuery, queryParams);
-    const totalLogs = parseInt(countResult.rows[0].count);
+    // Totals are cached briefly; an unfiltered total comes from table statistics once the table is large
+    const total = conditions.length > 0
+      ? { count: await cachedCount(db, `SELECT COUNT(*) FROM audit_logs l WHERE ${conditions.join(' AND ')}`, queryParams), estimated: false }
+      : await tableCount(db, 'audit_logs');
+    
+    // Keyset position from the cursor; page/OFFSET is still accepted for numbered pagination
+    const position = decodeCursor(cursor);
+    const pageNumber = Math.max(parseInt(page, 10) || 1, 1);
+    const pageConditions = [...conditions];
+    const pageParams = [...queryParams];
+    
+    if (position) {
+      pageParams.push(position.createdAt, position.id);
+      // The plain bound on created_at lets Postgres skip the monthly partitions after the cursor
+      pageConditions.push(`l.created_at <= $${pageParams.length - 1}::timestamp`);
+      pageConditions.push(`(l.created_at, l.id) < ($${pageParams.length - 1}::timestamp, $${pageParams.length}::int)`);
+    }
+    pageParams.push(limit + 1, position ? 0 : (pageNumber - 1) * limit);
     
-    // Add pagination
-    const offset = (page - 1) * limit;
-    query += ` ORDER BY l.created_at DESC LIMIT $${paramIndex} OFFSET $${paramIndex + 1}`;
-    queryParams.push(limit, offset);
+    // Users and admins are joined to the page rows only
+    const result = await db.query(
+      `SELECT p.*,
+              u.name as user_name, u.government_id,
+              a.username as admin_username
+       FROM (
+         SELECT l.id, l.user_id, l.admin_id, l.action, l.entity_type, l.entity_id, l.details, l.ip_address, l.created_at,
+                l.created_at::text AS cursor_created_at
+         FROM audit_logs l
+         ${pageConditions.length > 0 ? `WHERE ${pageConditions.join(' AND ')}` : ''}
+         ORDER BY l.created_at DESC, l.id DESC
+         LIMIT $${pageParams.length - 1} OFFSET $${pageParams.length}
+       ) p
+       LEFT JOIN users u ON p.user_id = u.id
+       LEFT JOIN admins a ON p.admin_id = a.id
+       ORDER BY p.created_at DESC, p.id DESC`,
+      pageParams
+    );
     
-    const result = await db.query(query, queryParams);
+    const { rows, nextCursor, hasMore } = keysetPage(result.rows, limit);
     
     res.status(200).json({
-      logs: result.rows,
+      logs: rows,
       pagination: {
-        total: totalLogs,
-        page: parseInt(page),
-        limit: parseInt(limit),
-        pages: Math.ceil(totalLogs / limit)
+        total: total.count,
+        estimated: total.estimated,
+        page: position ? null : pageNumber,
+        limit,
+        pages: Math.ceil(total.count / limit),
+        nextCursor,
+        hasMore
       }
     });
   } catch (error) {
@@ -935,7 +808,7 @@ exports.createAdmin = async (req, res) => {
     }
     
     // Hash password with Argon2
-    const hashedPassword = await argon2.hash(password);
+    const hashedPassword = await passwordHash.hash(password, { algorithm: 'argon2' });
     
     // Insert new admin
     const result = await db.query(
@@ -948,28 +821,25 @@ exports.createAdmin = async (req, res) => {
     const newAdmin = result.rows[0];
     
     // Log the admin creation
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        req.admin.id,
-        'ADMIN_CREATED',
-        'admins',
-        newAdmin.id,
-        JSON.stringify({
-          username: newAdmin.username,
-          email: newAdmin.email,
-          role: newAdmin.role
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      action: 'ADMIN_CREATED',
+      entityType: 'admins',
+      entityId: newAdmin.id,
+      details: {
+        username: newAdmin.username,
+        email: newAdmin.email,
+        role: newAdmin.role
+      },
+      ipAddress: req.ip
+    });
     
     res.status(201).json({
       message: 'Admin created successfully',
       admin: newAdmin
     });
   } catch (error) {
+    if (passwordHash.respondIfBusy(res, error)) return;
     logger.error('Create admin error:', error);
     res.status(500).json({ message: 'Server error while creating admin' });
   }
@@ -985,76 +855,10 @@ exports.getDashboardStats = async (req, res) => {
   const logger = req.app.locals.logger;
   
   try {
-    // Get total users count
-    const usersCountResult = await db.query('SELECT COUNT(*) FROM users');
-    const totalUsers = parseInt(usersCountResult.rows[0].count);
-    
-    // Get verified users count
-    const verifiedUsersResult = await db.query(
-      "SELECT COUNT(*) FROM users WHERE verification_status = 'VERIFIED'"
-    );
-    const verifiedUsers = parseInt(verifiedUsersResult.rows[0].count);
-    
-    // Get pending users count
-    const pendingUsersResult = await db.query(
-      "SELECT COUNT(*) FROM users WHERE verification_status = 'PENDING'"
-    );
-    const pendingUsers = parseInt(pendingUsersResult.rows[0].count);
+    // Counters and rollups are precomputed (services/stats.service.js); nothing here scans users or logs
+    const stats = await statsService.getDashboardStats(db);
     
-    // Get rejected users count
-    const rejectedUsersResult = await db.query(
-      "SELECT COUNT(*) FROM users WHERE verification_status = 'REJECTED'"
-    );
-    const rejectedUsers = parseInt(rejectedUsersResult.rows[0].count);
-    
-    // Get total biometric records count
-    const biometricResult = await db.query('SELECT COUNT(*) FROM biometric_data');
-    const totalBiometricRecords = parseInt(biometricResult.rows[0].count);
-    
-    // Get total professional records count
-    const professionalResult = await db.query('SELECT COUNT(*) FROM professional_records');
-    const totalProfessionalRecords = parseInt(professionalResult.rows[0].count);
-    
-    // Get total blockchain transactions count
-    const blockchainResult = await db.query('SELECT COUNT(*) FROM blockchain_transactions');
-    const totalBlockchainTransactions = parseInt(blockchainResult.rows[0].count);
-    
-    // Get recent activity (last 5 audit logs)
-    const recentActivityResult = await db.query(
-      `SELECT l.id, l.action, l.entity_type, l.created_at,
-              u.name as user_name, u.government_id,
-              a.username as admin_username
-       FROM audit_logs l
-       LEFT JOIN users u ON l.user_id = u.id
-       LEFT JOIN admins a ON l.admin_id = a.id
-       ORDER BY l.created_at DESC
-       LIMIT 5`
-    );
-    
-    // Get user registration trend (last 7 days)
-    const registrationTrendResult = await db.query(
-      `SELECT DATE(created_at) as date, COUNT(*) as count
-       FROM users
-       WHERE created_at >= NOW() - INTERVAL '7 days'
-       GROUP BY DATE(created_at)
-       ORDER BY date ASC`
-    );
-    
-    res.status(200).json({
-      userStats: {
-        total: totalUsers,
-        verified: verifiedUsers,
-        pending: pendingUsers,
-        rejected: rejectedUsers
-      },
-      recordStats: {
-        biometricRecords: totalBiometricRecords,
-        professionalRecords: totalProfessionalRecords,
-        blockchainTransactions: totalBlockchainTransactions
-      },
-      recentActivity: recentActivityResult.rows,
-      registrationTrend: registrationTrendResult.rows
-    });
+    res.status(200).json(stats);
   } catch (error) {
     logger.error('Get dashboard stats error:', error);
     res.status(500).json({ message: 'Server error while retrieving dashboard statistics' });
@@ -1151,20 +955,16 @@ exports.updateAdminProfile = async (req, res) => {
     );
     
     // Log the update action
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        adminId,
-        'ADMIN_PROFILE_UPDATED',
-        'admins',
-        adminId,
-        JSON.stringify({
-          email: email !== adminResult.rows[0].email ? { from: adminResult.rows[0].email, to: email } : undefined
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: adminId,
+      action: 'ADMIN_PROFILE_UPDATED',
+      entityType: 'admins',
+      entityId: adminId,
+      details: {
+        email: email !== adminResult.rows[0].email ? { from: adminResult.rows[0].email, to: email } : undefined
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'Admin profile updated successfully',
@@ -1208,14 +1008,14 @@ exports.changeAdminPassword = async (req, res) => {
     }
     
     // Verify current password
-    const isPasswordValid = await argon2.verify(adminResult.rows[0].password, currentPassword);
+    const isPasswordValid = await passwordHash.verify(currentPassword, adminResult.rows[0].password);
     
     if (!isPasswordValid) {
       return res.status(401).json({ message: 'Current password is incorrect' });
     }
     
     // Hash new password
-    const hashedPassword = await argon2.hash(newPassword);
+    const hashedPassword = await passwordHash.hash(newPassword, { algorithm: 'argon2' });
     
     // Update password
     await db.query(
@@ -1224,18 +1024,14 @@ exports.changeAdminPassword = async (req, res) => {
     );
     
     // Log the password change
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        adminId,
-        'ADMIN_PASSWORD_CHANGED',
-        'admins',
-        adminId,
-        JSON.stringify({}),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: adminId,
+      action: 'ADMIN_PASSWORD_CHANGED',
+      entityType: 'admins',
+      entityId: adminId,
+      details: {},
+      ipAddress: req.ip
+    });
     
     // Invalidate all existing sessions except the current one
     await db.query(
@@ -1247,6 +1043,7 @@ exports.changeAdminPassword = async (req, res) => {
       message: 'Password changed successfully'
     });
   } catch (error) {
+    if (passwordHash.respondIfBusy(res, error)) return;
     logger.error('Change admin password error:', error);
     res.status(500).json({ message: 'Server error while changing password' });
   }
@@ -1294,22 +1091,18 @@ exports.deactivateUser = async (req, res) => {
     );
     
     // Log the deactivation
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-      [
-        req.admin.id,
-        userId,
-        'USER_DEACTIVATED',
-        'users',
-        userId,
-        JSON.stringify({
-          reason: reason || 'No reason provided',
-          governmentId: user.government_id
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      userId,
+      action: 'USER_DEACTIVATED',
+      entityType: 'users',
+      entityId: userId,
+      details: {
+        reason: reason || 'No reason provided',
+        governmentId: user.government_id
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'User deactivated successfully',
@@ -1361,21 +1154,17 @@ exports.reactivateUser = async (req, res) => {
     );
     
     // Log the reactivation
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-      [
-        req.admin.id,
-        userId,
-        'USER_REACTIVATED',
-        'users',
-        userId,
-        JSON.stringify({
-          governmentId: user.government_id
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      userId,
+      action: 'USER_REACTIVATED',
+      entityType: 'users',
+      entityId: userId,
+      details: {
+        governmentId: user.government_id
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'User reactivated successfully',
@@ -1402,31 +1191,30 @@ exports.checkBlockchainExpiry = async (req, res) => {
   const logger = req.app.locals.logger;
   
   try {
-    // Import blockchain service
-    const blockchainService = require('../services/blockchain.service');
+    // Import blockchain expiry service
+    const blockchainExpiry = require('../services/blockchain-expiry.service');
     
-    // Process expired blockchain statuses
-    const results = await blockchainService.processExpiredBlockchainStatuses(db);
+    // Run a sweep now instead of waiting for the scheduler; refunds are queued, not sent inline
+    const results = await blockchainExpiry.runSweep(db);
     
     // Log the action
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, action, entity_type, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5)`,
-      [
-        req.admin.id,
-        'BLOCKCHAIN_EXPIRY_CHECK',
-        'users',
-        JSON.stringify({
-          total: results.total,
-          confirmed: results.confirmed,
-          expired: results.expired
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      action: 'BLOCKCHAIN_EXPIRY_CHECK',
+      entityType: 'users',
+      details: {
+        total: results.total,
+        confirmed: results.confirmed,
+        expired: results.expired,
+        completed: results.completed
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
-      message: 'Blockchain expiry check completed successfully',
+      message: results.completed
+        ? 'Blockchain expiry check completed successfully'
+        : 'Blockchain expiry check stopped early and will resume on the next run',
       results
     });
   } catch (error) {
@@ -1456,12 +1244,12 @@ exports.getUserActivityLogs = async (req, res) => {
       return res.status(404).json({ message: 'User not found' });
     }
     
-    // Get user activity logs
+    // Get user activity logs; the newest monthly partitions are read first until 100 rows are found
     const logsResult = await db.query(
       `SELECT id, admin_id, user_id, action, entity_type, entity_id, details, ip_address, created_at
        FROM audit_logs
        WHERE user_id = $1
-       ORDER BY created_at DESC
+       ORDER BY created_at DESC, id DESC
        LIMIT 100`,
       [id]
     );
@@ -1508,50 +1296,16 @@ exports.getDetailedDashboardStats = async (req, res) => {
   const logger = req.app.locals.logger;
   
   try {
-    // Get user statistics by verification status
-    const userStatsByStatus = await db.query(`
-      SELECT verification_status, COUNT(*) as count 
-      FROM users 
-      GROUP BY verification_status
-    `);
-    
-    // Get user statistics by registration date (last 30 days)
-    const userStatsByDate = await db.query(`
-      SELECT DATE(created_at) as date, COUNT(*) as count 
-      FROM users 
-      WHERE created_at >= NOW() - INTERVAL '30 days' 
-      GROUP BY DATE(created_at) 
-      ORDER BY date
-    `);
-    
-    // Get biometric data statistics
-    const biometricStats = await db.query(`
-      SELECT verification_status, COUNT(*) as count 
-      FROM biometric_data 
-      GROUP BY verification_status
-    `);
-    
-    // Get blockchain transaction statistics
-    const blockchainStats = await db.query(`
-      SELECT transaction_type, COUNT(*) as count 
-      FROM blockchain_transactions 
-      GROUP BY transaction_type
-    `);
-    
-    // Get activity logs statistics
-    const activityStats = await db.query(`
-      SELECT action, COUNT(*) as count 
-      FROM audit_logs 
-      WHERE created_at >= NOW() - INTERVAL '30 days' 
-      GROUP BY action
-    `);
+    // Same precomputed read as getDashboardStats, in the detailed response shape
+    const stats = await statsService.getDashboardStats(db);
     
     res.status(200).json({
-      userStatsByStatus: userStatsByStatus.rows,
-      userStatsByDate: userStatsByDate.rows,
-      biometricStats: biometricStats.rows,
-      blockchainStats: blockchainStats.rows,
-      activityStats: activityStats.rows
+      userStatsByStatus: stats.userStatsByStatus,
+      userStatsByDate: stats.userStatsByDate,
+      biometricStats: stats.biometricStats,
+      blockchainStats: stats.blockchainStats,
+      activityStats: stats.activityStats,
+      rollupRefreshedAt: stats.rollupRefreshedAt
     });
   } catch (error) {
     logger.error('Get detailed dashboard stats error:', error);
@@ -1705,7 +1459,7 @@ exports.updateProfessionalRecordStatus = async (req, res) => {
   }
 
   try {
-    const client = await db.pool.connect();
+    const client = await db.connect();
     try {
       await client.query('BEGIN');
 
@@ -1778,3 +1532,16 @@ exports.updateProfessionalRecordStatus = async (req, res) => {
     res.status(500).json({ message: 'Server error while updating professional record status' });
   }
 };
+
+/**
+ * Stream live changes to the admin portal (Server-Sent Events)
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ */
+exports.streamEvents = (req, res) => {
+  const db = req.app.locals.db;
+
+  if (!changeFeed.subscribe(db, req, res)) {
+    return res.status(503).json({ message: 'Too many live connections, please poll instead', retryAfter: 30 });
+  }
+};
@@ -2,23 +2,21 @@
  * Authentication controller for DBIS
  */
 const jwt = require('jsonwebtoken');
-const bcrypt = require('bcryptjs');
-const crypto = require('crypto');
+const passwordHash = require('../services/password-hash.service');
 const { v4: uuidv4 } = require('uuid');
-const walletService = require('../services/wallet.service');
-
-/**
- * Generate SHA-256 hash for facemesh data
- * @param {Object} facemeshData - Facemesh data object
- * @returns {String} SHA-256 hash
- */
-const generateFacemeshHash = (facemeshData) => {
-  // Convert facemesh data to a consistent string format
-  const facemeshString = JSON.stringify(facemeshData);
-  
-  // Generate SHA-256 hash
-  return crypto.createHash('sha256').update(facemeshString).digest('hex');
-};
+const hdWallet = require('../services/hd-wallet.service');
+const facemeshIndex = require('../services/facemesh-index.service');
+const auditLog = require('../services/audit-log.service');
+const { calculateFacemeshSimilarity, generateFacemeshHash, timeComparison } = require('../utils/biometric.utils');
+const { matchStoredHash } = require('../utils/hash.utils');
+const {
+  resolveFacemeshTemplate,
+  decodeFacemeshTemplate,
+  hashFacemeshTemplate
+} = require('../utils/facemesh-template.utils');
+
+// Minimum similarity for a template-based biometric match
+const BIOMETRIC_MATCH_THRESHOLD = 0.85;
 
 /**
  * Verify user biometric data (used for verification, not login)
@@ -28,19 +26,23 @@ const generateFacemeshHash = (facemeshData) => {
 exports.verifyUserBiometric = async (req, res) => {
   const db = req.app.locals.db;
   const logger = req.app.locals.logger;
-  const { userId, facemeshData } = req.body;
+  const { userId, facemeshData, facemeshTemplate } = req.body;
 
-  if (!userId || !facemeshData) {
+  if (!userId || (!facemeshData && !facemeshTemplate)) {
     return res.status(400).json({ message: 'User ID and facemesh data are required' });
   }
 
+  let probeTemplate;
   try {
-    // Generate facemesh hash
-    const facemeshHash = generateFacemeshHash(facemeshData);
+    probeTemplate = resolveFacemeshTemplate(facemeshData, facemeshTemplate);
+  } catch (error) {
+    return res.status(400).json({ message: error.message });
+  }
 
+  try {
     // Check biometric data
     const biometricResult = await db.query(
-      `SELECT id, facemesh_hash
+      `SELECT id, facemesh_hash, facemesh_template
        FROM biometric_data
        WHERE user_id = $1 AND is_active = true`,
       [userId]
@@ -50,23 +52,53 @@ exports.verifyUserBiometric = async (req, res) => {
       return res.status(404).json({ message: 'No active biometric data found for this user' });
     }
 
-    // Verify facemesh hash
-    const storedHash = biometricResult.rows[0].facemesh_hash;
-    const isMatch = storedHash === facemeshHash;
+    const stored = biometricResult.rows[0];
+    let isMatch;
+
+    if (probeTemplate && stored.facemesh_template) {
+      // Compare landmarks directly when both sides have a binary template
+      const similarity = timeComparison('verify', () => calculateFacemeshSimilarity(
+        { landmarks: decodeFacemeshTemplate(probeTemplate) },
+        { landmarks: decodeFacemeshTemplate(stored.facemesh_template) }
+      ));
+      isMatch = similarity >= BIOMETRIC_MATCH_THRESHOLD;
+    } else {
+      // Legacy enrollments only have the hash of the JSON landmarks, so they
+      // can only be matched when the client still sends facemeshData
+      const hashForm = facemeshData
+        ? matchStoredHash(facemeshData, stored.facemesh_hash)
+        : (stored.facemesh_hash === hashFacemeshTemplate(probeTemplate) ? 'canonical' : null);
+      isMatch = hashForm !== null;
+
+      // Move unsorted-JSON hashes to the canonical form, unless the hash is already anchored on chain
+      if (hashForm === 'legacy') {
+        await db.query(
+          `UPDATE biometric_data SET facemesh_hash = $1
+           WHERE id = $2 AND facemesh_hash = $3 AND blockchain_tx_hash IS NULL`,
+          [generateFacemeshHash(facemeshData), stored.id, stored.facemesh_hash]
+        );
+      }
+
+      // Store the template on first match so later verifies use similarity
+      if (isMatch && probeTemplate && !stored.facemesh_template) {
+        await db.query(
+          `UPDATE biometric_data SET facemesh_template = $1
+           WHERE id = $2 AND facemesh_template IS NULL`,
+          [probeTemplate, stored.id]
+        );
+        facemeshIndex.publish('add', stored.id, userId, probeTemplate);
+      }
+    }
 
     // Log verification attempt
-    await db.query(
-      `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        userId,
-        isMatch ? 'BIOMETRIC_VERIFICATION_SUCCESS' : 'BIOMETRIC_VERIFICATION_FAILED',
-        'users',
-        userId,
-        JSON.stringify({ verified: isMatch }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      userId,
+      action: isMatch ? 'BIOMETRIC_VERIFICATION_SUCCESS' : 'BIOMETRIC_VERIFICATION_FAILED',
+      entityType: 'users',
+      entityId: userId,
+      details: { verified: isMatch },
+      ipAddress: req.ip
+    });
 
     return res.status(200).json({
       verified: isMatch,
@@ -117,7 +149,7 @@ const generateUserToken = (user) => {
 exports.registerUser = async (req, res) => {
   const db = req.app.locals.db;
   const logger = req.app.locals.logger;
-  const { username, password, name, governmentId, email, phone, facemeshData, avaxAddress } = req.body;
+  const { username, password, name, governmentId, email, phone, facemeshData, facemeshTemplate, avaxAddress } = req.body;
   
   // If username is not provided, generate one based on name or a random identifier
   const userUsername = username || 
@@ -129,8 +161,33 @@ exports.registerUser = async (req, res) => {
     return res.status(400).json({ message: 'Password is required' });
   }
   
-  // Hash the password
-  const hashedPassword = await bcrypt.hash(password, 10);
+  // Encode landmarks once into the binary template used for storage and matching
+  let template = null;
+  try {
+    template = resolveFacemeshTemplate(facemeshData, facemeshTemplate);
+  } catch (error) {
+    return res.status(400).json({ message: error.message });
+  }
+  
+  // Reject enrollments whose face is already registered to another identity
+  if (template) {
+    if (facemeshIndex.respondIfNotReady(res)) return;
+    const duplicates = facemeshIndex.findDuplicates(template, { limit: 1 });
+    if (duplicates.length > 0) {
+      logger.warn(`Duplicate biometric enrollment rejected (matches user ${duplicates[0].userId})`);
+      return res.status(409).json({ message: 'Biometric data is already registered to another identity' });
+    }
+  }
+  
+  // Hash the password (off the event loop)
+  let hashedPassword;
+  try {
+    hashedPassword = await passwordHash.hash(password);
+  } catch (error) {
+    if (passwordHash.respondIfBusy(res, error)) return;
+    logger.error('Password hashing error:', error);
+    return res.status(500).json({ message: 'Server error during registration' });
+  }
   
   try {
     // Start transaction
@@ -162,13 +219,15 @@ exports.registerUser = async (req, res) => {
     
     // Generate a new Avalanche wallet if one wasn't provided
     let userWalletAddress = avaxAddress; // Use avaxAddress from request body
+    let walletIndex = null;
     let avaxPrivateKey = null;
     
     if (!userWalletAddress) {
       try {
-        logger.info('Generating new Avalanche wallet for user registration');
-        const wallet = walletService.generateWallet();
+        // Derived from the master seed; only the index is stored
+        const wallet = await hdWallet.allocateWallet(db);
         userWalletAddress = wallet.address;
+        walletIndex = wallet.walletIndex;
         avaxPrivateKey = wallet.privateKey;
       } catch (err) {
         logger.error('Error generating wallet:', err);
@@ -187,12 +246,13 @@ exports.registerUser = async (req, res) => {
         email,
         phone,
         avax_address,
+        wallet_index,
         avax_private_key,
         is_verified,
         verification_status,
         created_at,
         updated_at
-      ) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, NOW(), NOW())
+      ) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, NOW(), NOW())
       RETURNING id, username, name, government_id, email, phone, avax_address, is_verified, verification_status`,
       [
         userUsername,
@@ -202,7 +262,8 @@ exports.registerUser = async (req, res) => {
         email,
         phone,
         userWalletAddress, // Wallet address
-        avaxPrivateKey, // Avalanche private key
+        walletIndex, // HD derivation index
+        avaxPrivateKey, // Legacy random-wallet key (null for derived wallets)
         false, // is_verified
         'PENDING' // verification_status
       ]
@@ -211,18 +272,24 @@ exports.registerUser = async (req, res) => {
     const user = userResult.rows[0];
     
     // If facemesh data was provided, store it
-    if (facemeshData) {
-      const facemeshHash = generateFacemeshHash(facemeshData);
+    let biometricId = null;
+    if (facemeshData || template) {
+      const facemeshHash = facemeshData ? generateFacemeshHash(facemeshData) : hashFacemeshTemplate(template);
       
-      await db.query(
+      // Landmarks are kept as a binary template; JSON is only stored when it has no landmarks
+      const biometricResult = await db.query(
         `INSERT INTO biometric_data (
           user_id,
           facemesh_hash,
+          facemesh_data,
+          facemesh_template,
           is_active,
           created_at
-        ) VALUES ($1, $2, $3, NOW())`,
-        [user.id, facemeshHash, true]
+        ) VALUES ($1, $2, $3, $4, $5, NOW())
+        RETURNING id`,
+        [user.id, facemeshHash, template ? null : JSON.stringify(facemeshData), template, true]
       );
+      biometricId = biometricResult.rows[0].id;
     }
     
     // Generate tokens
@@ -258,7 +325,7 @@ exports.registerUser = async (req, res) => {
         user.id,
         JSON.stringify({
           method: 'password',
-          hasBiometric: !!facemeshData,
+          hasBiometric: !!biometricId,
           hasWallet: true
         }),
         req.ip
@@ -268,6 +335,10 @@ exports.registerUser = async (req, res) => {
     // Commit transaction
     await db.query('COMMIT');
     
+    if (biometricId && template) {
+      facemeshIndex.publish('add', biometricId, user.id, template);
+    }
+    
     // Return success response
     res.status(201).json({
       message: 'Registration successful',
@@ -324,22 +395,18 @@ exports.loginUser = async (req, res) => {
     const user = userResult.rows[0];
 
     // Verify password
-    const isPasswordValid = await bcrypt.compare(password, user.password);
+    const isPasswordValid = await passwordHash.verify(password, user.password);
     
     if (!isPasswordValid) {
       // Log failed login attempt
-      await db.query(
-        `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address)
-         VALUES ($1, $2, $3, $4, $5, $6)`,
-        [
-          user.id,
-          'LOGIN_FAILED',
-          'users',
-          user.id,
-          JSON.stringify({ reason: 'Invalid password' }),
-          req.ip
-        ]
-      );
+      auditLog.record(db, {
+        userId: user.id,
+        action: 'LOGIN_FAILED',
+        entityType: 'users',
+        entityId: user.id,
+        details: { reason: 'Invalid password' },
+        ipAddress: req.ip
+      });
       
       return res.status(401).json({ message: 'Invalid credentials' });
     }
@@ -355,18 +422,14 @@ exports.loginUser = async (req, res) => {
     );
 
     // Log successful login
-    await db.query(
-      `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        user.id,
-        'LOGIN_SUCCESS',
-        'users',
-        user.id,
-        JSON.stringify({ method: 'password' }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      userId: user.id,
+      action: 'LOGIN_SUCCESS',
+      entityType: 'users',
+      entityId: user.id,
+      details: { method: 'password' },
+      ipAddress: req.ip
+    });
 
     // Return user data and token
     res.status(200).json({
@@ -383,6 +446,7 @@ exports.loginUser = async (req, res) => {
       tokens
     });
   } catch (error) {
+    if (passwordHash.respondIfBusy(res, error)) return;
     logger.error('User login error:', error);
     res.status(500).json({ message: 'Server error during login' });
   }
@@ -3,8 +3,20 @@
  * Handles interactions with the blockchain
  */
 const blockchainService = require('../services/blockchain.service');
+const blockchainQueue = require('../services/blockchain-queue.service');
+const hdWallet = require('../services/hd-wallet.service');
+const chainIndexer = require('../services/chain-indexer.service');
+const auditLog = require('../services/audit-log.service');
 const ethers = require('ethers');
 
+/**
+ * Read one identity summary from the chain index, or from the chain when the index is stale
+ */
+const readIdentitySummary = async (db, walletAddress, options) => {
+  const { blockNumber, identities } = await chainIndexer.readIdentitySummaries(db, [walletAddress], options);
+  return { ...identities[0], blockNumber };
+};
+
 /**
  * Record user identity on blockchain
  * @param {Object} req - Express request object
@@ -101,24 +113,20 @@ exports.recordIdentityOnBlockchain = async (req, res) => {
     );
     
     // Log the action
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-      [
-        req.admin.id,
-        userId,
-        'IDENTITY_RECORDED_ON_BLOCKCHAIN',
-        'users',
-        userId,
-        JSON.stringify({
-          transactionHash: result.transactionHash,
-          blockNumber: result.blockNumber,
-          status: result.status,
-          network: result.network
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      userId,
+      action: 'IDENTITY_RECORDED_ON_BLOCKCHAIN',
+      entityType: 'users',
+      entityId: userId,
+      details: {
+        transactionHash: result.transactionHash,
+        blockNumber: result.blockNumber,
+        status: result.status,
+        network: result.network
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: `Identity recorded on ${isVerified ? 'Avalanche' : 'local'} blockchain successfully`,
@@ -164,8 +172,12 @@ exports.fetchIdentityFromBlockchain = async (req, res) => {
       return res.status(400).json({ message: 'User does not have a wallet address' });
     }
     
-    // Fetch identity from blockchain
-    const isRegistered = await blockchainService.isIdentityRegistered(user.avax_address, isVerified);
+    // Fetch identity and a page of records from the chain index (one aggregated RPC call if it is stale)
+    const summary = await readIdentitySummary(db, user.avax_address, {
+      recordOffset: req.query.recordOffset,
+      recordLimit: req.query.recordLimit === undefined ? blockchainService.MAX_BATCH_SIZE : req.query.recordLimit
+    });
+    const isRegistered = summary.exists;
     
     if (!isRegistered) {
       return res.status(404).json({
@@ -173,23 +185,10 @@ exports.fetchIdentityFromBlockchain = async (req, res) => {
       });
     }
     
-    const biometricHash = await blockchainService.getBiometricHash(user.avax_address, isVerified);
-    const identityVerified = await blockchainService.isIdentityVerified(user.avax_address, isVerified);
-    const recordCount = await blockchainService.getProfessionalRecordCount(user.avax_address, isVerified);
-    
-    // Get records if any
-    const records = [];
-    for (let i = 0; i < recordCount; i++) {
-      try {
-        const record = await blockchainService.getProfessionalRecord(user.avax_address, i, isVerified);
-        records.push({
-          index: i,
-          ...record
-        });
-      } catch (error) {
-        logger.error(`Error fetching record at index ${i}:`, error);
-      }
-    }
+    const biometricHash = summary.biometricHash;
+    const identityVerified = summary.isVerified;
+    const recordCount = summary.professionalRecordCount;
+    const records = summary.professionalRecords;
     
     // Get blockchain network info
     const networkInfo = blockchainService.getNetworkInfo();
@@ -198,24 +197,20 @@ exports.fetchIdentityFromBlockchain = async (req, res) => {
       networkInfo.pendingNetwork.networkName;
     
     // Log the action
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        req.admin.id,
-        'IDENTITY_FETCHED_FROM_BLOCKCHAIN',
-        'users',
-        userId,
-        JSON.stringify({
-          walletAddress: user.avax_address,
-          isRegistered,
-          isVerified: identityVerified,
-          recordCount,
-          network: networkName
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      action: 'IDENTITY_FETCHED_FROM_BLOCKCHAIN',
+      entityType: 'users',
+      entityId: userId,
+      details: {
+        walletAddress: user.avax_address,
+        isRegistered,
+        isVerified: identityVerified,
+        recordCount,
+        network: networkName
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: `Identity fetched from ${isVerified ? 'Avalanche' : 'local'} blockchain successfully`,
@@ -223,6 +218,8 @@ exports.fetchIdentityFromBlockchain = async (req, res) => {
         walletAddress: user.avax_address,
         biometricHash,
         isVerified: identityVerified,
+        createdAt: summary.createdAt,
+        updatedAt: summary.updatedAt,
         professionalRecordCount: recordCount,
         professionalRecords: records,
         network: networkName
@@ -290,25 +287,36 @@ exports.getUserBlockchainStatus = async (req, res) => {
       // Continue with default network name
     }
     
-    // Get blockchain status
+    // Get blockchain status from the chain index, or one aggregated RPC call if it is stale
     let isRegistered = false;
     let isIdentityVerified = false;
+    let summary = null;
     
     try {
-      isRegistered = await blockchainService.isIdentityRegistered(walletAddress, isVerified);
-      if (isRegistered) {
-        try {
-          isIdentityVerified = await blockchainService.isIdentityVerified(walletAddress, isVerified);
-        } catch (verifyError) {
-          logger.warn(`Error checking if identity is verified for ${walletAddress}:`, verifyError);
-          // Continue with default value (false)
-        }
-      }
-    } catch (registerError) {
-      logger.warn(`Error checking if identity is registered for ${walletAddress}:`, registerError);
+      summary = await readIdentitySummary(db, walletAddress, { recordLimit: 0 });
+      isRegistered = summary.exists;
+      isIdentityVerified = summary.isVerified;
+    } catch (summaryError) {
+      logger.warn(`Error reading identity summary for ${walletAddress}:`, summaryError);
       // Continue with default values
     }
     
+    // Latest registration transaction, with confirmations derived from the block read above
+    let registration = null;
+    try {
+      const registrationResult = await db.query(
+        `SELECT transaction_hash, block_number
+         FROM blockchain_transactions
+         WHERE user_id = $1 AND transaction_type = 'IDENTITY_REGISTRATION' AND status <> 'FAILED'
+         ORDER BY created_at DESC
+         LIMIT 1`,
+        [userId]
+      );
+      registration = registrationResult.rows[0] || null;
+    } catch (registrationError) {
+      logger.warn('Error getting registration transaction:', registrationError.message);
+    }
+    
     // Get recent blockchain transactions
     let recentTransactions = [];
     try {
@@ -352,7 +360,13 @@ exports.getUserBlockchainStatus = async (req, res) => {
         isRegistered,
         isVerified: isIdentityVerified,
         network,
-        identityStatus: isIdentityVerified ? 'VERIFIED' : (isRegistered ? 'REGISTERED' : 'NOT_REGISTERED')
+        identityStatus: isIdentityVerified ? 'VERIFIED' : (isRegistered ? 'REGISTERED' : 'NOT_REGISTERED'),
+        registrationTimestamp: summary && summary.createdAt ? new Date(summary.createdAt * 1000).toISOString() : null,
+        registrationTxHash: registration ? registration.transaction_hash : null,
+        confirmations: registration && registration.block_number && summary && summary.blockNumber
+          ? Math.max(summary.blockNumber - registration.block_number + 1, 0)
+          : 0,
+        professionalRecordCount: summary ? summary.professionalRecordCount : 0
       },
       recentTransactions: recentTransactions
     });
@@ -460,23 +474,19 @@ exports.recordProfessionalRecord = async (req, res) => {
     );
     
     // Log the action
-    await db.query(
-      `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6, $7)`,
-      [
-        req.admin.id,
-        userId,
-        'PROFESSIONAL_RECORD_RECORDED_ON_BLOCKCHAIN',
-        'professional_records',
-        recordId,
-        JSON.stringify({
-          transactionHash: result.transactionHash,
-          blockNumber: result.blockNumber,
-          status: result.status
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      adminId: req.admin.id,
+      userId,
+      action: 'PROFESSIONAL_RECORD_RECORDED_ON_BLOCKCHAIN',
+      entityType: 'professional_records',
+      entityId: recordId,
+      details: {
+        transactionHash: result.transactionHash,
+        blockNumber: result.blockNumber,
+        status: result.status
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'Professional record recorded on blockchain successfully',
@@ -580,7 +590,7 @@ exports.recordUserProfessionalRecord = async (req, res) => {
   try {
     // Check if user exists and has a wallet address
     const userResult = await db.query(
-      'SELECT id, name, government_id, avax_address, avax_private_key FROM users WHERE id = $1',
+      'SELECT id, name, government_id, avax_address, wallet_index, avax_private_key FROM users WHERE id = $1',
       [userId]
     );
     
@@ -591,7 +601,7 @@ exports.recordUserProfessionalRecord = async (req, res) => {
     const user = userResult.rows[0];
     
     // Check if user has a wallet address
-    if (!user.avax_address || !user.avax_private_key) {
+    if (!user.avax_address || !hdWallet.hasSigner(user)) {
       return res.status(400).json({ message: 'User does not have a wallet address or private key' });
     }
     
@@ -625,7 +635,7 @@ exports.recordUserProfessionalRecord = async (req, res) => {
     
     // Record professional record on blockchain
     const result = await blockchainService.recordProfessionalRecord(
-      user.avax_private_key,
+      hdWallet.signerForUser(user),
       user.avax_address,
       record.data_hash,
       startTimestamp,
@@ -841,3 +851,119 @@ exports.verifyProfessionalRecord = async (req, res) => {
     res.status(500).json({ message: 'Server error while verifying professional record on blockchain' });
   }
 };
+
+// Largest number of users accepted by one batch verification request
+const MAX_BATCH_VERIFY_USERS = 1000;
+
+/**
+ * Verify many user identities on blockchain (Admin)
+ * Users are queued in batches of MAX_BATCH_SIZE; each batch is a single batchVerifyIdentities transaction
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ */
+exports.batchVerifyIdentities = async (req, res) => {
+  const db = req.app.locals.db;
+  const logger = req.app.locals.logger;
+  const { userIds } = req.body;
+  
+  if (!Array.isArray(userIds) || userIds.length === 0) {
+    return res.status(400).json({ message: 'userIds must be a non-empty array' });
+  }
+  
+  if (userIds.length > MAX_BATCH_VERIFY_USERS) {
+    return res.status(400).json({ message: `At most ${MAX_BATCH_VERIFY_USERS} users can be verified per request` });
+  }
+  
+  try {
+    // Only users verified off-chain with a wallet can be verified on-chain
+    const usersResult = await db.query(
+      `SELECT id, avax_address
+       FROM users
+       WHERE id = ANY($1::int[]) AND is_verified = true AND avax_address IS NOT NULL`,
+      [userIds.map(id => parseInt(id, 10))]
+    );
+    
+    const eligible = usersResult.rows.map(user => ({ userId: user.id, walletAddress: user.avax_address }));
+    const eligibleIds = new Set(eligible.map(user => user.userId));
+    const skipped = userIds.filter(id => !eligibleIds.has(parseInt(id, 10)));
+    
+    if (eligible.length === 0) {
+      return res.status(400).json({ message: 'None of the selected users can be verified on blockchain', skipped });
+    }
+    
+    const blockchainJobs = [];
+    const client = await db.connect();
+    try {
+      await client.query('BEGIN');
+      
+      for (let i = 0; i < eligible.length; i += blockchainService.MAX_BATCH_SIZE) {
+        const job = await blockchainQueue.enqueue(client, 'IDENTITY_VERIFICATION_BATCH', {
+          createdBy: req.admin.id,
+          payload: { users: eligible.slice(i, i + blockchainService.MAX_BATCH_SIZE) }
+        });
+        blockchainJobs.push({ id: job.id, type: job.job_type, status: job.status });
+      }
+      
+      await client.query('COMMIT');
+    } catch (error) {
+      await client.query('ROLLBACK');
+      throw error;
+    } finally {
+      client.release();
+    }
+    
+    logger.info(`Queued on-chain verification of ${eligible.length} users in ${blockchainJobs.length} batch(es)`);
+    
+    res.status(202).json({
+      message: `Queued ${eligible.length} users for blockchain verification`,
+      queued: eligible.length,
+      skipped,
+      blockchainJobs
+    });
+  } catch (error) {
+    logger.error('Batch verify identities error:', error);
+    res.status(500).json({ message: 'Server error during batch blockchain verification' });
+  }
+};
+
+/**
+ * Get on-chain identity summaries for many users (Admin)
+ * All users are read through one aggregated eth_call per multicall batch
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ */
+exports.getIdentitySummaries = async (req, res) => {
+  const db = req.app.locals.db;
+  const logger = req.app.locals.logger;
+  const { userIds, recordOffset, recordLimit } = req.body;
+  
+  if (!Array.isArray(userIds) || userIds.length === 0) {
+    return res.status(400).json({ message: 'userIds must be a non-empty array' });
+  }
+  
+  if (userIds.length > MAX_BATCH_VERIFY_USERS) {
+    return res.status(400).json({ message: `At most ${MAX_BATCH_VERIFY_USERS} users can be read per request` });
+  }
+  
+  try {
+    const usersResult = await db.query(
+      `SELECT id, avax_address
+       FROM users
+       WHERE id = ANY($1::int[]) AND avax_address IS NOT NULL`,
+      [userIds.map(id => parseInt(id, 10))]
+    );
+    
+    const users = usersResult.rows;
+    const { blockNumber, identities } = users.length > 0
+      ? await chainIndexer.readIdentitySummaries(db, users.map(user => user.avax_address), { recordOffset, recordLimit })
+      : { blockNumber: null, identities: [] };
+    
+    res.status(200).json({
+      blockNumber,
+      identities: users.map((user, i) => ({ userId: user.id, ...identities[i] }))
+    });
+  } catch (error) {
+    logger.error('Get identity summaries error:', error);
+    res.status(500).json({ message: 'Server error while reading identities from blockchain' });
+  }
+};
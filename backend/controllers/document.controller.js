@@ -1,7 +1,5 @@
 const { validationResult } = require('express-validator');
-const path = require('path');
-const crypto = require('crypto');
-const fs = require('fs').promises;
+const documentStorage = require('../services/document-storage.service');
 
 /**
  * Upload a new document
@@ -19,12 +17,11 @@ exports.uploadDocument = async (req, res) => {
       return res.status(400).json({ message: 'No file uploaded' });
     }
 
-    // Calculate file hash
-    const fileBuffer = await fs.readFile(file.path);
-    const fileHash = crypto.createHash('sha256').update(fileBuffer).digest('hex');
+    // Hashed while streaming into content-addressed storage
+    const fileHash = file.hash;
 
     // Start a transaction
-    const client = await db.pool.connect();
+    const client = await db.connect();
     try {
       await client.query('BEGIN');
 
@@ -45,8 +42,8 @@ exports.uploadDocument = async (req, res) => {
         RETURNING id`,
         [
           userId,
-          file.path,
-          `/uploads/${file.filename}`,
+          file.storageKey,
+          file.url,
           fileHash,
           file.originalname,
           file.mimetype,
@@ -75,7 +72,7 @@ exports.uploadDocument = async (req, res) => {
            SET document_url = $1,
                updated_at = NOW()
            WHERE id = $2`,
-          [`/uploads/${file.filename}`, professionalRecordId]
+          [file.url, professionalRecordId]
         );
       }
 
@@ -124,6 +121,7 @@ exports.uploadDocument = async (req, res) => {
             fileName: file.originalname,
             fileSize: file.size,
             mimeType: file.mimetype,
+            deduplicated: file.deduplicated,
             professionalRecordId
           }),
           req.ip
@@ -135,7 +133,8 @@ exports.uploadDocument = async (req, res) => {
       res.status(201).json({
         message: 'Document uploaded successfully',
         documentId,
-        fileUrl: `/uploads/${file.filename}`,
+        fileUrl: file.url,
+        contentUrl: documentStorage.contentUrl(documentId),
         verificationStatus: 'PENDING',
         professionalRecordId
       });
@@ -148,7 +147,7 @@ exports.uploadDocument = async (req, res) => {
     }
 
   } catch (error) {
-    console.error('Document upload error:', error);
+    req.app.locals.logger.error('Document upload error:', error);
     res.status(500).json({ 
       message: 'Server error while uploading document',
       error: error.message 
@@ -173,7 +172,7 @@ exports.verifyDocument = async (req, res) => {
       return res.status(400).json({ message: 'Invalid verification status' });
     }
 
-    const client = await db.pool.connect();
+    const client = await db.connect();
     try {
       await client.query('BEGIN');
 
@@ -274,7 +273,7 @@ exports.verifyDocument = async (req, res) => {
     }
 
   } catch (error) {
-    console.error('Document verification error:', error);
+    req.app.locals.logger.error('Document verification error:', error);
     res.status(500).json({ 
       message: 'Server error while verifying document',
       error: error.message 
@@ -324,10 +323,7 @@ exports.getDocument = async (req, res) => {
     const document = result.rows[0];
 
     // Check if file exists
-    const filePath = path.join(process.cwd(), document.file_path);
-    try {
-      await fs.promises.access(filePath, fs.constants.F_OK);
-    } catch (err) {
+    if (!(await documentStorage.documentExists(document.file_path))) {
       return res.status(404).json({ message: 'Document file not found' });
     }
 
@@ -337,6 +333,7 @@ exports.getDocument = async (req, res) => {
         id: document.id,
         fileName: document.original_name,
         fileUrl: document.file_url,
+        contentUrl: documentStorage.contentUrl(document.id),
         fileSize: document.file_size,
         mimeType: document.mime_type,
         isPreviewable: document.is_previewable,
@@ -355,7 +352,7 @@ exports.getDocument = async (req, res) => {
     });
 
   } catch (error) {
-    console.error('Get document error:', error);
+    req.app.locals.logger.error('Get document error:', error);
     res.status(500).json({ message: 'Server error while retrieving document' });
   }
 };
@@ -402,6 +399,7 @@ exports.listProfessionalRecordDocuments = async (req, res) => {
         id: doc.id,
         fileName: doc.original_name,
         fileUrl: doc.file_url,
+        contentUrl: documentStorage.contentUrl(doc.id),
         fileSize: doc.file_size,
         mimeType: doc.mime_type,
         verificationStatus: doc.verification_status,
@@ -414,7 +412,50 @@ exports.listProfessionalRecordDocuments = async (req, res) => {
     });
 
   } catch (error) {
-    console.error('List professional record documents error:', error);
+    req.app.locals.logger.error('List professional record documents error:', error);
     res.status(500).json({ message: 'Server error while retrieving documents' });
   }
-}; 
\ No newline at end of file
+};
+
+/**
+ * Serve a document's content from a signed link (see documentStorage.contentUrl)
+ * Supports Range and conditional requests; the ETag is the stored file hash
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ */
+exports.getDocumentContent = async (req, res) => {
+  try {
+    const db = req.app.locals.db;
+    const { documentId } = req.params;
+    const { expires, signature } = req.query;
+
+    if (!documentStorage.verifyContentLink(documentId, expires, signature)) {
+      return res.status(403).json({ message: 'Document link is invalid or has expired' });
+    }
+
+    const result = await db.query(
+      'SELECT file_path, file_hash, mime_type, original_name FROM document_records WHERE id = $1',
+      [documentId]
+    );
+
+    if (result.rows.length === 0) {
+      return res.status(404).json({ message: 'Document not found' });
+    }
+
+    const document = result.rows[0];
+    await documentStorage.send(req, res, {
+      filePath: document.file_path,
+      hash: document.file_hash,
+      mimeType: document.mime_type,
+      fileName: document.original_name
+    });
+  } catch (error) {
+    if (documentStorage.isNotFound(error)) {
+      return res.status(404).json({ message: 'Document file not found' });
+    }
+    req.app.locals.logger.error('Get document content error:', error);
+    if (!res.headersSent) {
+      res.status(500).json({ message: 'Server error while retrieving document content' });
+    }
+  }
+};
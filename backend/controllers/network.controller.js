@@ -3,6 +3,7 @@
  * Handles blockchain network selection and status
  */
 const blockchainService = require('../services/blockchain.service');
+const auditLog = require('../services/audit-log.service');
 const { exec } = require('child_process');
 const path = require('path');
 
@@ -64,22 +65,17 @@ exports.switchNetwork = async (req, res) => {
     const networkInfo = blockchainService.getNetworkInfo();
     
     // Log the network switch
-    await req.app.locals.db.query(
-      `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        req.admin?.id || null,
-        'NETWORK_SWITCHED',
-        'system',
-        null,
-        JSON.stringify({
-          previousNetwork: 'avalanche',
-          newNetwork: network,
-          timestamp: new Date().toISOString()
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(req.app.locals.db, {
+      adminId: req.admin?.id,
+      action: 'NETWORK_SWITCHED',
+      entityType: 'system',
+      details: {
+        previousNetwork: 'avalanche',
+        newNetwork: network,
+        timestamp: new Date().toISOString()
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: `Using Avalanche Fuji Testnet network`,
@@ -162,44 +158,34 @@ exports.deployContract = async (req, res) => {
         logger.error(`Deployment stderr: ${stderr}`);
         
         // Log the failed deployment
-        await db.query(
-          `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-           VALUES ($1, $2, $3, $4, $5, $6)`,
-          [
-            req.admin?.id || null,
-            'CONTRACT_DEPLOYMENT_FAILED',
-            'system',
-            null,
-            JSON.stringify({
-              network: networkInfo.networkName,
-              error: error.message,
-              stderr,
-              timestamp: new Date().toISOString()
-            }),
-            req.ip
-          ]
-        );
+        auditLog.record(db, {
+          adminId: req.admin?.id,
+          action: 'CONTRACT_DEPLOYMENT_FAILED',
+          entityType: 'system',
+          details: {
+            network: networkInfo.networkName,
+            error: error.message,
+            stderr,
+            timestamp: new Date().toISOString()
+          },
+          ipAddress: req.ip
+        });
       } else {
         logger.info(`Deployment to ${networkInfo.networkName} successful`);
         logger.debug(`Deployment output: ${stdout}`);
         
         // Log the successful deployment
-        await db.query(
-          `INSERT INTO audit_logs (admin_id, action, entity_type, entity_id, details, ip_address)
-           VALUES ($1, $2, $3, $4, $5, $6)`,
-          [
-            req.admin?.id || null,
-            'CONTRACT_DEPLOYED',
-            'system',
-            null,
-            JSON.stringify({
-              network: networkInfo.networkName,
-              stdout: stdout.substring(0, 1000), // Limit the size of stored output
-              timestamp: new Date().toISOString()
-            }),
-            req.ip
-          ]
-        );
+        auditLog.record(db, {
+          adminId: req.admin?.id,
+          action: 'CONTRACT_DEPLOYED',
+          entityType: 'system',
+          details: {
+            network: networkInfo.networkName,
+            stdout: stdout.substring(0, 1000), // Limit the size of stored output
+            timestamp: new Date().toISOString()
+          },
+          ipAddress: req.ip
+        });
       }
     });
   } catch (error) {
@@ -36,7 +36,7 @@ exports.uploadProfessionProof = async (req, res) => {
 
     return res.status(201).json({ message: 'Image uploaded successfully', id: recordId });
   } catch (err) {
-    console.error('uploadProfessionProof error:', err);
+    req.app.locals.logger.error('uploadProfessionProof error:', err);
     return res.status(500).json({ message: 'Internal server error' });
   }
 };
@@ -57,7 +57,7 @@ exports.getPendingVerifications = async (req, res) => {
 
     return res.json({ records: result.rows });
   } catch (err) {
-    console.error('getPendingVerifications error:', err);
+    req.app.locals.logger.error('getPendingVerifications error:', err);
     return res.status(500).json({ message: 'Internal server error' });
   }
 };
@@ -99,7 +99,7 @@ exports.verifyProfession = async (req, res) => {
 
     return res.json({ message: `Record ${status}` });
   } catch (err) {
-    console.error('verifyProfession error:', err);
+    req.app.locals.logger.error('verifyProfession error:', err);
     return res.status(500).json({ message: 'Internal server error' });
   }
 };
@@ -1,20 +1,13 @@
 /**
  * User controller for DBIS
  */
-const crypto = require('crypto');
-
-/**
- * Generate SHA-256 hash for facemesh data
- * @param {Object} facemeshData - Facemesh data object
- * @returns {String} SHA-256 hash
- */
-const generateFacemeshHash = (facemeshData) => {
-  // Convert facemesh data to a consistent string format
-  const facemeshString = JSON.stringify(facemeshData);
-  
-  // Generate SHA-256 hash
-  return crypto.createHash('sha256').update(facemeshString).digest('hex');
-};
+const facemeshIndex = require('../services/facemesh-index.service');
+const { resolveFacemeshTemplate, hashFacemeshTemplate } = require('../utils/facemesh-template.utils');
+const { generateFacemeshHash } = require('../utils/biometric.utils');
+const { generateCanonicalHash } = require('../utils/hash.utils');
+const { keys: cacheKeys } = require('../services/cache.service');
+const auditLog = require('../services/audit-log.service');
+const hdWallet = require('../services/hd-wallet.service');
 
 /**
  * Get user profile
@@ -27,57 +20,61 @@ exports.getUserProfile = async (req, res) => {
   const userId = req.user.id;
   
   try {
-    // Get user details
-    const userResult = await db.query(
-      `SELECT id, name, government_id, email, phone, avax_address,
-              is_verified, verification_status, created_at, updated_at
-       FROM users
-       WHERE id = $1`,
-      [userId]
-    );
+    const profile = await db.cached(cacheKeys.userProfile(userId), async () => {
+      // Get user details
+      const userResult = await db.prepared('user_profile',
+        `SELECT id, name, government_id, email, phone, avax_address,
+                is_verified, verification_status, created_at, updated_at
+         FROM users
+         WHERE id = $1`,
+        [userId]
+      );
+      
+      if (userResult.rows.length === 0) {
+        return undefined;
+      }
+      
+      const user = userResult.rows[0];
+      
+      // Get biometric data status (not the actual data) and professional records count
+      const [biometricResult, recordsResult] = await Promise.all([
+        db.prepared('user_has_biometric',
+          `SELECT EXISTS (
+             SELECT 1 FROM biometric_data WHERE user_id = $1 AND is_active = true
+           ) AS has_biometric`,
+          [userId]
+        ),
+        db.prepared('user_professional_record_count',
+          `SELECT COUNT(*) as count
+           FROM professional_records
+           WHERE user_id = $1`,
+          [userId]
+        )
+      ]);
+      
+      return {
+        user: {
+          id: user.id,
+          name: user.name,
+          governmentId: user.government_id,
+          email: user.email,
+          phone: user.phone,
+          walletAddress: user.avax_address || user.avax_address,
+          isVerified: user.is_verified,
+          verificationStatus: user.verification_status,
+          createdAt: user.created_at,
+          updatedAt: user.updated_at
+        },
+        hasBiometricData: biometricResult.rows[0].has_biometric,
+        professionalRecordsCount: parseInt(recordsResult.rows[0].count)
+      };
+    });
     
-    if (userResult.rows.length === 0) {
+    if (!profile) {
       return res.status(404).json({ message: 'User not found' });
     }
     
-    const user = userResult.rows[0];
-    
-    // Get biometric data status (not the actual data)
-    const biometricResult = await db.query(
-      `SELECT COUNT(*) as count
-       FROM biometric_data
-       WHERE user_id = $1 AND is_active = true`,
-      [userId]
-    );
-    
-    const hasBiometricData = parseInt(biometricResult.rows[0].count) > 0;
-    
-    // Get professional records count
-    const recordsResult = await db.query(
-      `SELECT COUNT(*) as count
-       FROM professional_records
-       WHERE user_id = $1`,
-      [userId]
-    );
-    
-    const professionalRecordsCount = parseInt(recordsResult.rows[0].count);
-    
-    res.status(200).json({
-      user: {
-        id: user.id,
-        name: user.name,
-        governmentId: user.government_id,
-        email: user.email,
-        phone: user.phone,
-        walletAddress: user.avax_address || user.avax_address,
-        isVerified: user.is_verified,
-        verificationStatus: user.verification_status,
-        createdAt: user.created_at,
-        updatedAt: user.updated_at
-      },
-      hasBiometricData,
-      professionalRecordsCount
-    });
+    res.status(200).json(profile);
   } catch (error) {
     logger.error('Get user profile error:', error);
     res.status(500).json({ message: 'Server error while retrieving user profile' });
@@ -128,27 +125,24 @@ exports.updateUserProfile = async (req, res) => {
     );
     
     const updatedUser = updateResult.rows[0];
+    await db.invalidate(cacheKeys.userProfile(userId));
     
     // Log the update action
-    await db.query(
-      `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        userId,
-        'PROFILE_UPDATED',
-        'users',
-        userId,
-        JSON.stringify({
-          changes: {
-            name: name !== user.name ? { from: user.name, to: name } : undefined,
-            email: email !== user.email ? { from: user.email, to: email } : undefined,
-            phone: phone !== user.phone ? { from: user.phone, to: phone } : undefined,
-            walletAddress: walletAddress !== user.avax_address ? { from: user.avax_address, to: walletAddress } : undefined
-          }
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      userId,
+      action: 'PROFILE_UPDATED',
+      entityType: 'users',
+      entityId: userId,
+      details: {
+        changes: {
+          name: name !== user.name ? { from: user.name, to: name } : undefined,
+          email: email !== user.email ? { from: user.email, to: email } : undefined,
+          phone: phone !== user.phone ? { from: user.phone, to: phone } : undefined,
+          walletAddress: walletAddress !== user.avax_address ? { from: user.avax_address, to: walletAddress } : undefined
+        }
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'Profile updated successfully',
@@ -171,31 +165,37 @@ exports.getVerificationStatus = async (req, res) => {
   const userId = req.user.id;
   
   try {
-    const result = await db.query(
-      `SELECT u.is_verified, u.verification_status, u.verification_notes, u.verified_at, u.created_at,
-              a.username as verified_by
-       FROM users u
-       LEFT JOIN admins a ON u.verified_by = a.id
-       WHERE u.id = $1`,
-      [userId]
-    );
-    
-    if (result.rows.length === 0) {
-      return res.status(404).json({ message: 'User not found' });
-    }
-    
-    // Format the response to match what the frontend expects
-    const userData = result.rows[0];
-    
-    res.status(200).json({
-      data: {
+    const status = await db.cached(cacheKeys.verificationStatus(userId), async () => {
+      const result = await db.prepared('user_verification_status',
+        `SELECT u.is_verified, u.verification_status, u.verification_notes, u.verified_at, u.created_at,
+                a.username as verified_by
+         FROM users u
+         LEFT JOIN admins a ON u.verified_by = a.id
+         WHERE u.id = $1`,
+        [userId]
+      );
+      
+      if (result.rows.length === 0) {
+        return undefined;
+      }
+      
+      // Format the response to match what the frontend expects
+      const userData = result.rows[0];
+      
+      return {
         status: userData.verification_status,
         submittedAt: userData.created_at,
         verifiedAt: userData.verified_at,
         rejectionReason: userData.verification_notes,
         verifiedBy: userData.verified_by
-      }
+      };
     });
+    
+    if (!status) {
+      return res.status(404).json({ message: 'User not found' });
+    }
+    
+    res.status(200).json({ data: status });
   } catch (error) {
     logger.error('Get verification status error:', error);
     res.status(500).json({ message: 'Server error while retrieving verification status' });
@@ -227,7 +227,7 @@ exports.addProfessionalRecord = async (req, res) => {
       timestamp: new Date().toISOString()
     };
     
-    const dataHash = crypto.createHash('sha256').update(JSON.stringify(recordData)).digest('hex');
+    const dataHash = generateCanonicalHash(recordData);
     
     // Insert professional record
     const result = await db.query(
@@ -251,25 +251,22 @@ exports.addProfessionalRecord = async (req, res) => {
     );
     
     const newRecord = result.rows[0];
+    await db.invalidate(cacheKeys.userProfile(userId));
     
     // Log the action
-    await db.query(
-      `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        userId,
-        'PROFESSIONAL_RECORD_ADDED',
-        'professional_records',
-        newRecord.id,
-        JSON.stringify({
-          recordType,
-          institution,
-          title,
-          dataHash
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      userId,
+      action: 'PROFESSIONAL_RECORD_ADDED',
+      entityType: 'professional_records',
+      entityId: newRecord.id,
+      details: {
+        recordType,
+        institution,
+        title,
+        dataHash
+      },
+      ipAddress: req.ip
+    });
     
     res.status(201).json({
       message: 'Professional record added successfully',
@@ -292,7 +289,7 @@ exports.getProfessionalRecords = async (req, res) => {
   const userId = req.user.id;
   
   try {
-    const result = await db.query(
+    const result = await db.prepared('user_professional_records',
       `SELECT id, record_type, institution, title, description, 
               start_date, end_date, is_current, verification_status, 
               verified_by, verified_at, blockchain_tx_hash, 
@@ -354,11 +351,11 @@ exports.updateProfessionalRecord = async (req, res) => {
       institution: institution,
       year: year,
       description: description,
-      userId: userId,
+      userId,
       timestamp: new Date().toISOString()
     };
     
-    const dataHash = crypto.createHash('sha256').update(JSON.stringify(recordData)).digest('hex');
+    const dataHash = generateCanonicalHash(recordData);
     
     // Update the record
     const updateResult = await db.query(
@@ -388,22 +385,18 @@ exports.updateProfessionalRecord = async (req, res) => {
     const updatedRecord = updateResult.rows[0];
     
     // Log the update action
-    await db.query(
-      `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address)
-       VALUES ($1, $2, $3, $4, $5, $6)`,
-      [
-        userId,
-        'PROFESSIONAL_RECORD_UPDATED',
-        'professional_records',
-        recordId,
-        JSON.stringify({
-          title,
-          institution,
-          year
-        }),
-        req.ip
-      ]
-    );
+    auditLog.record(db, {
+      userId,
+      action: 'PROFESSIONAL_RECORD_UPDATED',
+      entityType: 'professional_records',
+      entityId: recordId,
+      details: {
+        title,
+        institution,
+        year
+      },
+      ipAddress: req.ip
+    });
     
     res.status(200).json({
       message: 'Professional record updated successfully',
@@ -497,18 +490,35 @@ exports.updateFacemesh = async (req, res) => {
   const db = req.app.locals.db;
   const logger = req.app.locals.logger;
   const userId = req.user.id;
-  const { facemeshData } = req.body;
+  const { facemeshData, facemeshTemplate } = req.body;
   
-  if (!facemeshData) {
+  if (!facemeshData && !facemeshTemplate) {
     return res.status(400).json({ message: 'Facemesh data is required' });
   }
   
+  let template;
+  try {
+    template = resolveFacemeshTemplate(facemeshData, facemeshTemplate);
+  } catch (error) {
+    return res.status(400).json({ message: error.message });
+  }
+  
+  // The new template must not match another user's enrollment
+  if (template && facemeshIndex.respondIfNotReady(res)) return;
+  const duplicates = template
+    ? facemeshIndex.findDuplicates(template, { limit: 1, excludeUserId: userId })
+    : [];
+  if (duplicates.length > 0) {
+    logger.warn(`Facemesh update for user ${userId} matches user ${duplicates[0].userId}`);
+    return res.status(409).json({ message: 'Biometric data is already registered to another identity' });
+  }
+  
   try {
     // Generate hash for facemesh data
-    const facemeshHash = generateFacemeshHash(facemeshData);
+    const facemeshHash = facemeshData ? generateFacemeshHash(facemeshData) : hashFacemeshTemplate(template);
     
     // Use a transaction for atomicity
-    const client = await db.pool.connect();
+    const client = await db.connect();
     
     try {
       await client.query('BEGIN');
@@ -521,10 +531,10 @@ exports.updateFacemesh = async (req, res) => {
       
       // Insert new biometric data
       const result = await client.query(
-        `INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_data, is_active)
-         VALUES ($1, $2, $3, true)
+        `INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_data, facemesh_template, is_active)
+         VALUES ($1, $2, $3, $4, true)
          RETURNING id, facemesh_hash, is_active, created_at`,
-        [userId, facemeshHash, JSON.stringify(facemeshData)]
+        [userId, facemeshHash, template ? null : JSON.stringify(facemeshData), template]
       );
       
       // Log the update
@@ -545,6 +555,13 @@ exports.updateFacemesh = async (req, res) => {
       );
       
       await client.query('COMMIT');
+      await db.invalidate([cacheKeys.userProfile(userId), cacheKeys.biometricStatus(userId)]);
+      
+      if (template) {
+        facemeshIndex.publish('replaceUser', result.rows[0].id, userId, template);
+      } else {
+        facemeshIndex.publish('removeUser', userId);
+      }
       
       res.status(200).json({
         message: 'Facemesh data updated successfully',
@@ -578,59 +595,63 @@ exports.getBiometricStatus = async (req, res) => {
   const userId = req.user.id;
   
   try {
-    // Get the latest active biometric data
-    const biometricResult = await db.query(
-      `SELECT id, facemesh_hash, is_active, created_at, updated_at, 
-              verification_status, verification_score, last_verified_at
-       FROM biometric_data
-       WHERE user_id = $1 AND is_active = true
-       ORDER BY created_at DESC
-       LIMIT 1`,
-      [userId]
-    );
-    
-    // Check if user has biometric data
-    const hasBiometricData = biometricResult.rows.length > 0;
-    
-    // Get verification attempts
-    const verificationResult = await db.query(
-      `SELECT COUNT(*) as total_verifications, 
-              COUNT(*) FILTER (WHERE success = true) as successful_verifications,
-              MAX(created_at) FILTER (WHERE success = true) as last_successful_verification
-       FROM biometric_verifications
-       WHERE user_id = $1`,
-      [userId]
-    );
-    
-    const verificationStats = verificationResult.rows[0];
-    
-    // Determine if user is verified based on active biometric data and successful verification
-    const isVerified = hasBiometricData && 
-                      biometricResult.rows[0].verification_status === 'VERIFIED' &&
-                      verificationStats.successful_verifications > 0;
-    
-    // Prepare response data
-    const responseData = {
-      verified: isVerified,
-      facemeshExists: hasBiometricData,
-      lastVerified: verificationStats.last_successful_verification || null,
-      verificationCount: parseInt(verificationStats.total_verifications) || 0,
-      successfulVerifications: parseInt(verificationStats.successful_verifications) || 0
-    };
-    
-    // Add biometric details if they exist
-    if (hasBiometricData) {
-      const biometricData = biometricResult.rows[0];
-      responseData.biometricDetails = {
-        id: biometricData.id,
-        createdAt: biometricData.created_at,
-        updatedAt: biometricData.updated_at,
-        verificationStatus: biometricData.verification_status,
-        verificationScore: biometricData.verification_score
+    const status = await db.cached(cacheKeys.biometricStatus(userId), async () => {
+      // Get the latest active biometric data
+      const biometricResult = await db.prepared('user_biometric_latest',
+        `SELECT id, facemesh_hash, is_active, created_at, updated_at, 
+                verification_status, verification_score, last_verified_at
+         FROM biometric_data
+         WHERE user_id = $1 AND is_active = true
+         ORDER BY created_at DESC
+         LIMIT 1`,
+        [userId]
+      );
+      
+      // Check if user has biometric data
+      const hasBiometricData = biometricResult.rows.length > 0;
+      
+      // Get verification attempts
+      const verificationResult = await db.prepared('user_biometric_verification_counts',
+        `SELECT COUNT(*) as total_verifications, 
+                COUNT(*) FILTER (WHERE success = true) as successful_verifications,
+                MAX(created_at) FILTER (WHERE success = true) as last_successful_verification
+         FROM biometric_verifications
+         WHERE user_id = $1`,
+        [userId]
+      );
+      
+      const verificationStats = verificationResult.rows[0];
+      
+      // Determine if user is verified based on active biometric data and successful verification
+      const isVerified = hasBiometricData && 
+                        biometricResult.rows[0].verification_status === 'VERIFIED' &&
+                        verificationStats.successful_verifications > 0;
+      
+      // Prepare response data
+      const responseData = {
+        verified: isVerified,
+        facemeshExists: hasBiometricData,
+        lastVerified: verificationStats.last_successful_verification || null,
+        verificationCount: parseInt(verificationStats.total_verifications) || 0,
+        successfulVerifications: parseInt(verificationStats.successful_verifications) || 0
       };
-    }
+      
+      // Add biometric details if they exist
+      if (hasBiometricData) {
+        const biometricData = biometricResult.rows[0];
+        responseData.biometricDetails = {
+          id: biometricData.id,
+          createdAt: biometricData.created_at,
+          updatedAt: biometricData.updated_at,
+          verificationStatus: biometricData.verification_status,
+          verificationScore: biometricData.verification_score
+        };
+      }
+      
+      return responseData;
+    });
     
-    res.status(200).json(responseData);
+    res.status(200).json(status);
   } catch (error) {
     logger.error('Get biometric status error:', error);
     res.status(500).json({ message: 'Server error while retrieving biometric status' });
@@ -756,7 +777,7 @@ exports.transferToBlockchain = async (req, res) => {
   try {
     // Check if user exists and get wallet information
     const userResult = await db.query(
-      `SELECT id, name, government_id, avax_address, avax_private_key, 
+      `SELECT id, name, government_id, avax_address, wallet_index, avax_private_key, 
               blockchain_status, blockchain_expiry, verification_status 
        FROM users WHERE id = $1`,
       [userId]
@@ -776,8 +797,8 @@ exports.transferToBlockchain = async (req, res) => {
       });
     }
     
-    // Check if user has a wallet address and private key
-    if (!user.avax_address || !user.avax_private_key) {
+    // Check if user has a wallet address and a key the backend can sign with
+    if (!user.avax_address || !hdWallet.hasSigner(user)) {
       return res.status(400).json({ message: 'User does not have a valid blockchain wallet' });
     }
     
@@ -830,12 +851,11 @@ exports.transferToBlockchain = async (req, res) => {
       professionalDataHash = '0x' + professionalResult.rows[0].data_hash;
     } else {
       // Create a placeholder hash for professional data
-      const placeholder = JSON.stringify({
+      professionalDataHash = '0x' + generateCanonicalHash({
         userId: user.id,
         governmentId: user.government_id,
         timestamp: new Date().toISOString()
       });
-      professionalDataHash = '0x' + crypto.createHash('sha256').update(placeholder).digest('hex');
     }
     
     // Import blockchain service
@@ -862,14 +882,14 @@ exports.transferToBlockchain = async (req, res) => {
     }
     
     // Start a transaction
-    const client = await db.pool.connect();
+    const client = await db.connect();
     
     try {
       await client.query('BEGIN');
       
       // Register identity on blockchain
       const result = await blockchainService.registerIdentity(
-        user.avax_private_key,
+        hdWallet.signerForUser(user),
         biometricHash,
         professionalDataHash
       );
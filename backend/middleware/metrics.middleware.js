@@ -0,0 +1,53 @@
+/**
+ * Metrics middleware for DBIS
+ * Records a latency histogram per route and opens a server span for each
+ * request, so database and chain spans started by the handler nest under it.
+ *
+ * Routes are labelled by their Express template (/api/admin/users/:userId),
+ * never the raw path; requests no route matched count as "unmatched".
+ */
+const { registry } = require('../utils/metrics.utils');
+const tracing = require('../utils/tracing.utils');
+
+const httpDuration = registry.histogram(
+  'dbis_http_request_duration_seconds',
+  'API request latency by route template and status',
+  ['method', 'route', 'status']
+);
+
+const httpInFlight = registry.gauge('dbis_http_requests_in_flight', 'API requests being handled');
+
+const routeTemplate = (req) => (req.route ? `${req.baseUrl || ''}${req.route.path}` : 'unmatched');
+
+/**
+ * Create the metrics middleware; register it before the routes
+ * @returns {Function} Express middleware
+ */
+exports.metricsMiddleware = () => (req, res, next) => {
+  const end = httpDuration.startTimer({ method: req.method });
+  const span = tracing.startSpan(`${req.method} ${req.path}`, {
+    'http.method': req.method,
+    'http.target': req.originalUrl,
+    'http.request_id': req.id
+  }, tracing.SpanKind.SERVER);
+  httpInFlight.inc();
+
+  let recorded = false;
+  const done = () => {
+    if (recorded) return;
+    recorded = true;
+    httpInFlight.dec();
+    const route = routeTemplate(req);
+    const status = res.writableFinished ? res.statusCode : 'aborted';
+    end({ route, status });
+    if (span) {
+      span.updateName(`${req.method} ${route}`);
+      span.setAttributes({ 'http.route': route, 'http.status_code': res.statusCode });
+      tracing.endSpan(span, res.statusCode >= 500 ? new Error(`HTTP ${res.statusCode}`) : undefined);
+    }
+  };
+  res.once('finish', done);
+  res.once('close', done);
+
+  tracing.runInSpan(span, next);
+};
@@ -0,0 +1,100 @@
+/**
+ * Request logging middleware for DBIS
+ * Gives each request an id and logs one line when it finishes.
+ *
+ * The id comes from the X-Request-Id header when the caller (or a proxy)
+ * sent a usable one, and is generated otherwise. It is echoed in the
+ * response header, set as req.id, and added to every line logged while the
+ * request is handled (see utils/logger.utils.js).
+ *
+ * High-volume routes are sampled: LOG_SAMPLE_RATES lists
+ * "METHOD /path/prefix=rate" rules, comma separated, and the longest
+ * matching prefix sets the share of successful requests logged. Errors
+ * (status 400 and up), aborted requests and requests slower than
+ * LOG_SLOW_REQUEST_MS are always logged, except on routes with rate 0.
+ */
+const { v4: uuidv4 } = require('uuid');
+const { logger: defaultLogger, requestContext } = require('../utils/logger.utils');
+
+const VALID_REQUEST_ID = /^[\w.:-]{1,128}$/;
+const SLOW_REQUEST_MS = parseInt(process.env.LOG_SLOW_REQUEST_MS || '1000', 10);
+
+// The admin portal polls the user list; health checks and scrapes are periodic; event streams stay open
+const DEFAULT_SAMPLE_RATES = 'GET /api/admin/users=0.05,GET /api/health=0,GET /metrics=0,GET /api/admin/events=0';
+
+/**
+ * Parse sampling rules, longest prefix first
+ * @param {String} spec - "METHOD /prefix=rate,..."
+ * @returns {Array} [{ method, prefix, rate }]
+ */
+const parseSampleRates = (spec) => spec
+  .split(',')
+  .map(rule => rule.trim())
+  .filter(Boolean)
+  .map((rule) => {
+    const [route, rate] = rule.split('=');
+    const [method, prefix] = route.trim().split(/\s+/);
+    return { method: method.toUpperCase(), prefix, rate: Math.min(Math.max(parseFloat(rate), 0), 1) };
+  })
+  .filter(rule => rule.prefix && !Number.isNaN(rule.rate))
+  .sort((a, b) => b.prefix.length - a.prefix.length);
+
+const sampleRate = (rules, method, path) => {
+  const rule = rules.find(r => r.method === method && path.startsWith(r.prefix));
+  return rule ? rule.rate : 1;
+};
+
+/**
+ * Create the request logging middleware; register it before the routes
+ * @param {Object} options - logger, sampleRates (rule string), slowMs
+ * @returns {Function} Express middleware
+ */
+exports.requestLogger = (options = {}) => {
+  const logger = options.logger || defaultLogger;
+  const rules = parseSampleRates(options.sampleRates || process.env.LOG_SAMPLE_RATES || DEFAULT_SAMPLE_RATES);
+  const slowMs = options.slowMs || SLOW_REQUEST_MS;
+
+  return (req, res, next) => {
+    const started = process.hrtime.bigint();
+    const incoming = req.headers['x-request-id'];
+    const reqId = typeof incoming === 'string' && VALID_REQUEST_ID.test(incoming) ? incoming : uuidv4();
+    req.id = reqId;
+    res.setHeader('X-Request-Id', reqId);
+
+    let logged = false;
+    const done = () => {
+      if (logged) return;
+      logged = true;
+      const durationNs = process.hrtime.bigint() - started;
+      logger.recordRequest(durationNs);
+
+      const ms = Number(durationNs) / 1e6;
+      const status = res.statusCode;
+      const aborted = !res.writableFinished;
+      const path = req.originalUrl.split('?')[0];
+      const rate = sampleRate(rules, req.method, path);
+      if (rate === 0) return;
+      if (status < 400 && !aborted && ms < slowMs && rate < 1 && Math.random() >= rate) return;
+
+      const level = status >= 500 ? 'error' : (status >= 400 || aborted ? 'warn' : 'info');
+      logger[level](aborted ? 'request aborted' : 'request completed', {
+        reqId,
+        method: req.method,
+        url: req.originalUrl,
+        status,
+        ms: Math.round(ms * 10) / 10,
+        bytes: res.getHeader('content-length'),
+        ip: req.ip,
+        userId: req.user?.id,
+        adminId: req.admin?.id,
+        sampleRate: rate < 1 ? rate : undefined
+      });
+    };
+    res.once('finish', done);
+    res.once('close', done);
+
+    requestContext.run({ reqId }, next);
+  };
+};
+
+exports.parseSampleRates = parseSampleRates;
@@ -2,6 +2,7 @@
  * Validation middleware for DBIS
  */
 const { body, validationResult } = require('express-validator');
+const { logger } = require('../utils/logger.utils');
 
 /**
  * Middleware to validate request data
@@ -9,7 +10,7 @@ const { body, validationResult } = require('express-validator');
 exports.validate = (req, res, next) => {
   const errors = validationResult(req);
   if (!errors.isEmpty()) {
-    console.log('Validation errors:', JSON.stringify(errors.array()));
+    logger.info('Validation failed', { errors: errors.array() });
     return res.status(400).json({ 
       message: 'Validation failed', 
       errors: errors.array() 
@@ -0,0 +1,27 @@
+-- Durable outbox for on-chain writes
+-- Rows are inserted inside the request transaction and drained by the blockchain worker
+CREATE TABLE IF NOT EXISTS blockchain_jobs (
+  id SERIAL PRIMARY KEY,
+  job_type VARCHAR(50) NOT NULL,
+  user_id INTEGER REFERENCES users(id) ON DELETE CASCADE,
+  payload JSONB NOT NULL DEFAULT '{}',
+  status VARCHAR(20) NOT NULL DEFAULT 'QUEUED',
+  attempts INTEGER NOT NULL DEFAULT 0,
+  max_attempts INTEGER NOT NULL DEFAULT 5,
+  run_after TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+  locked_by VARCHAR(100),
+  locked_until TIMESTAMP,
+  transaction_hash VARCHAR(66),
+  raw_transaction TEXT,
+  submitted_at TIMESTAMP,
+  result JSONB,
+  last_error TEXT,
+  created_by INTEGER REFERENCES admins(id),
+  created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+  updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+  CONSTRAINT blockchain_jobs_status_check CHECK (status IN ('QUEUED', 'SUBMITTED', 'CONFIRMED', 'FAILED'))
+);
+
+-- Only runnable jobs are scanned by the worker
+CREATE INDEX IF NOT EXISTS idx_blockchain_jobs_runnable ON blockchain_jobs(run_after) WHERE status IN ('QUEUED', 'SUBMITTED');
+CREATE INDEX IF NOT EXISTS idx_blockchain_jobs_user_id ON blockchain_jobs(user_id);
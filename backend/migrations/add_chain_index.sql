@@ -0,0 +1,75 @@
+-- Contract event index
+-- Filled by the chain indexer (services/chain-indexer.service.js); rows are keyed by
+-- contract so a redeployed contract is indexed alongside the old one
+
+-- Indexing progress per contract; locked_by/locked_until lease it to a single indexer
+CREATE TABLE IF NOT EXISTS chain_index_cursors (
+  contract_address VARCHAR(42) PRIMARY KEY,
+  block_number BIGINT NOT NULL,
+  block_hash VARCHAR(66),
+  locked_by VARCHAR(100),
+  locked_until TIMESTAMP,
+  -- Last time the cursor was seen at the safe head; readers only trust the index while this is recent
+  caught_up_at TIMESTAMP,
+  updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+ALTER TABLE chain_index_cursors
+ADD COLUMN IF NOT EXISTS caught_up_at TIMESTAMP;
+
+-- Hashes of recently indexed blocks, used to find the fork point after a reorg
+CREATE TABLE IF NOT EXISTS chain_index_blocks (
+  contract_address VARCHAR(42) NOT NULL,
+  block_number BIGINT NOT NULL,
+  block_hash VARCHAR(66) NOT NULL,
+  PRIMARY KEY (contract_address, block_number)
+);
+
+-- Raw decoded events; projections are rebuilt from these after a reorg
+CREATE TABLE IF NOT EXISTS chain_events (
+  id BIGSERIAL PRIMARY KEY,
+  contract_address VARCHAR(42) NOT NULL,
+  block_number BIGINT NOT NULL,
+  block_hash VARCHAR(66) NOT NULL,
+  transaction_hash VARCHAR(66) NOT NULL,
+  log_index INTEGER NOT NULL,
+  event_name VARCHAR(50) NOT NULL,
+  account VARCHAR(42) NOT NULL,
+  args JSONB NOT NULL,
+  created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+  CONSTRAINT chain_events_log_unique UNIQUE (contract_address, transaction_hash, log_index)
+);
+
+-- Current on-chain identity state (account is the lowercased wallet address)
+CREATE TABLE IF NOT EXISTS chain_identities (
+  contract_address VARCHAR(42) NOT NULL,
+  account VARCHAR(42) NOT NULL,
+  biometric_hash VARCHAR(66),
+  is_verified BOOLEAN NOT NULL DEFAULT FALSE,
+  verified_by VARCHAR(42),
+  created_at TIMESTAMP NOT NULL,
+  updated_at TIMESTAMP NOT NULL,
+  verified_at TIMESTAMP,
+  created_block BIGINT NOT NULL,
+  updated_block BIGINT NOT NULL,
+  PRIMARY KEY (contract_address, account)
+);
+
+-- Current on-chain professional records, in contract index order
+CREATE TABLE IF NOT EXISTS chain_professional_records (
+  contract_address VARCHAR(42) NOT NULL,
+  account VARCHAR(42) NOT NULL,
+  record_index INTEGER NOT NULL,
+  data_hash VARCHAR(66) NOT NULL,
+  start_date TIMESTAMP,
+  end_date TIMESTAMP,
+  is_verified BOOLEAN NOT NULL DEFAULT FALSE,
+  verifier VARCHAR(42),
+  created_at TIMESTAMP NOT NULL,
+  verified_at TIMESTAMP,
+  created_block BIGINT NOT NULL,
+  PRIMARY KEY (contract_address, account, record_index)
+);
+
+CREATE INDEX IF NOT EXISTS idx_chain_events_block ON chain_events(contract_address, block_number);
+CREATE INDEX IF NOT EXISTS idx_chain_events_account ON chain_events(contract_address, account, block_number, log_index);
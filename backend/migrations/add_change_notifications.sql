@@ -0,0 +1,23 @@
+-- Change notifications for the admin live feed (services/change-feed.service.js)
+-- Each insert into a watched table sends a small NOTIFY on channel dbis_changes
+-- carrying only the table name and row id; listeners read the row itself.
+-- Notifications are delivered at commit, so rolled-back inserts are never seen.
+
+CREATE OR REPLACE FUNCTION notify_change() RETURNS trigger AS $$
+BEGIN
+  PERFORM pg_notify('dbis_changes', json_build_object('table', TG_TABLE_NAME, 'id', NEW.id)::text);
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS notify_audit_logs ON audit_logs;
+CREATE TRIGGER notify_audit_logs AFTER INSERT ON audit_logs
+  FOR EACH ROW EXECUTE PROCEDURE notify_change();
+
+DROP TRIGGER IF EXISTS notify_verification_requests ON verification_requests;
+CREATE TRIGGER notify_verification_requests AFTER INSERT ON verification_requests
+  FOR EACH ROW EXECUTE PROCEDURE notify_change();
+
+DROP TRIGGER IF EXISTS notify_blockchain_transactions ON blockchain_transactions;
+CREATE TRIGGER notify_blockchain_transactions AFTER INSERT ON blockchain_transactions
+  FOR EACH ROW EXECUTE PROCEDURE notify_change();
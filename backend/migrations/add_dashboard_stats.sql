@@ -0,0 +1,76 @@
+-- Dashboard statistics (services/stats.service.js)
+-- stat_counters holds row counts per table and dimension, kept current by triggers.
+-- Each counter is split across shards, picked by backend pid, so concurrent
+-- writers do not all queue on one row; readers SUM the shards.
+-- stat_daily holds per-day rollups, refreshed periodically by the stats rollup.
+
+CREATE TABLE IF NOT EXISTS stat_counters (
+  name VARCHAR(100) NOT NULL,
+  dimension VARCHAR(100) NOT NULL DEFAULT '',
+  shard SMALLINT NOT NULL DEFAULT 0,
+  count BIGINT NOT NULL DEFAULT 0,
+  PRIMARY KEY (name, dimension, shard)
+);
+
+CREATE TABLE IF NOT EXISTS stat_daily (
+  name VARCHAR(100) NOT NULL,
+  day DATE NOT NULL,
+  dimension VARCHAR(100) NOT NULL DEFAULT '',
+  count BIGINT NOT NULL DEFAULT 0,
+  PRIMARY KEY (name, day, dimension)
+);
+
+CREATE OR REPLACE FUNCTION stat_counter_bump(p_name TEXT, p_dimension TEXT, p_delta BIGINT) RETURNS void AS $$
+BEGIN
+  INSERT INTO stat_counters (name, dimension, shard, count)
+  VALUES (p_name, COALESCE(p_dimension, ''), pg_backend_pid() % 8, p_delta)
+  ON CONFLICT (name, dimension, shard) DO UPDATE SET count = stat_counters.count + EXCLUDED.count;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Row trigger; the optional argument names the column counted by value
+CREATE OR REPLACE FUNCTION stat_track_rows() RETURNS trigger AS $$
+DECLARE
+  old_dimension TEXT;
+  new_dimension TEXT;
+BEGIN
+  IF TG_NARGS > 0 THEN
+    IF TG_OP <> 'INSERT' THEN old_dimension := to_jsonb(OLD) ->> TG_ARGV[0]; END IF;
+    IF TG_OP <> 'DELETE' THEN new_dimension := to_jsonb(NEW) ->> TG_ARGV[0]; END IF;
+  END IF;
+
+  IF TG_OP = 'UPDATE' AND old_dimension IS NOT DISTINCT FROM new_dimension THEN
+    RETURN NULL;
+  END IF;
+  IF TG_OP <> 'INSERT' THEN PERFORM stat_counter_bump(TG_TABLE_NAME, old_dimension, -1); END IF;
+  IF TG_OP <> 'DELETE' THEN PERFORM stat_counter_bump(TG_TABLE_NAME, new_dimension, 1); END IF;
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS stat_users ON users;
+CREATE TRIGGER stat_users AFTER INSERT OR DELETE OR UPDATE OF verification_status ON users
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows('verification_status');
+
+DROP TRIGGER IF EXISTS stat_biometric_data ON biometric_data;
+CREATE TRIGGER stat_biometric_data AFTER INSERT OR DELETE OR UPDATE OF verification_status ON biometric_data
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows('verification_status');
+
+DROP TRIGGER IF EXISTS stat_professional_records ON professional_records;
+CREATE TRIGGER stat_professional_records AFTER INSERT OR DELETE ON professional_records
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows();
+
+DROP TRIGGER IF EXISTS stat_blockchain_transactions ON blockchain_transactions;
+CREATE TRIGGER stat_blockchain_transactions AFTER INSERT OR DELETE OR UPDATE OF transaction_type ON blockchain_transactions
+  FOR EACH ROW EXECUTE PROCEDURE stat_track_rows('transaction_type');
+
+-- Seed counters from existing rows (one-time scan)
+DELETE FROM stat_counters WHERE name IN ('users', 'biometric_data', 'professional_records', 'blockchain_transactions');
+INSERT INTO stat_counters (name, dimension, shard, count)
+SELECT 'users', COALESCE(verification_status, ''), 0, COUNT(*) FROM users GROUP BY 2
+UNION ALL
+SELECT 'biometric_data', COALESCE(verification_status, ''), 0, COUNT(*) FROM biometric_data GROUP BY 2
+UNION ALL
+SELECT 'professional_records', '', 0, COUNT(*) FROM professional_records
+UNION ALL
+SELECT 'blockchain_transactions', COALESCE(transaction_type, ''), 0, COUNT(*) FROM blockchain_transactions GROUP BY 2;
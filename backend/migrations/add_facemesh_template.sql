@@ -0,0 +1,6 @@
+-- Add compact binary facemesh template column
+-- Templates are written by utils/facemesh-template.utils.js (header + quantized landmarks)
+ALTER TABLE biometric_data
+ADD COLUMN IF NOT EXISTS facemesh_template BYTEA;
+
+-- Existing JSONB rows are converted by scripts/run_facemesh_template_migration.js
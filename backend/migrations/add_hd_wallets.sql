@@ -0,0 +1,7 @@
+-- HD-derived user wallets
+-- New users store the BIP-44 address index of their wallet (services/hd-wallet.service.js)
+-- instead of a private key; avax_private_key is only kept for users registered before this
+ALTER TABLE users
+ADD COLUMN IF NOT EXISTS wallet_index INTEGER UNIQUE;
+
+CREATE SEQUENCE IF NOT EXISTS users_wallet_index_seq AS INTEGER MINVALUE 0 START 0 OWNED BY users.wallet_index;
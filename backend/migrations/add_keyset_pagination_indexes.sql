@@ -0,0 +1,11 @@
+-- Composite indexes for keyset pagination on (created_at, id)
+-- Admin user and activity log lists page with WHERE (created_at, id) < (cursor) ORDER BY created_at DESC, id DESC
+
+CREATE INDEX IF NOT EXISTS idx_users_created_at_id ON users(created_at DESC, id DESC);
+
+CREATE INDEX IF NOT EXISTS idx_audit_logs_created_at_id ON audit_logs(created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_user_created_at_id ON audit_logs(user_id, created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_action_created_at_id ON audit_logs(action, created_at DESC, id DESC);
+
+-- has_biometric lookups for each listed user
+CREATE INDEX IF NOT EXISTS idx_biometric_data_active_user_id ON biometric_data(user_id) WHERE is_active = true;
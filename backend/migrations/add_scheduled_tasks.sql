@@ -0,0 +1,14 @@
+-- Scheduled background tasks
+-- One row per task; checkpoint holds the resume position of a sweep that has not finished yet
+
+CREATE TABLE IF NOT EXISTS scheduled_tasks (
+  name VARCHAR(100) PRIMARY KEY,
+  checkpoint JSONB,
+  last_run_started_at TIMESTAMP,
+  last_run_finished_at TIMESTAMP,
+  last_result JSONB,
+  updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Keyset order used by the blockchain expiry sweep
+CREATE INDEX IF NOT EXISTS idx_users_blockchain_expiry_pending ON users(blockchain_expiry, id) WHERE blockchain_status = 'PENDING';
@@ -0,0 +1,130 @@
+-- Monthly range partitions for audit_logs (services/audit-log.service.js)
+-- Rewrites audit_logs as a table partitioned by created_at, one partition per
+-- month (audit_logs_yYYYYmMM) plus audit_logs_default for anything outside
+-- them. Listings ordered by created_at read the newest partitions first and
+-- stop at their LIMIT, and cursor or date bounds skip older months entirely.
+-- Ids keep coming from audit_logs_id_seq, so existing cursors stay valid.
+--
+-- Takes an exclusive lock on audit_logs while rows are copied; run it during
+-- a quiet period on large tables.
+
+BEGIN;
+
+LOCK TABLE audit_logs IN ACCESS EXCLUSIVE MODE;
+
+-- Keep the id sequence; it is owned by the new table at the end
+ALTER SEQUENCE audit_logs_id_seq OWNED BY NONE;
+ALTER TABLE audit_logs ALTER COLUMN id DROP DEFAULT;
+ALTER TABLE audit_logs RENAME TO audit_logs_legacy;
+ALTER TABLE audit_logs_legacy RENAME CONSTRAINT audit_logs_pkey TO audit_logs_legacy_pkey;
+DROP INDEX IF EXISTS idx_audit_logs_user_id;
+DROP INDEX IF EXISTS idx_audit_logs_admin_id;
+DROP INDEX IF EXISTS idx_audit_logs_action;
+DROP INDEX IF EXISTS idx_audit_logs_entity_type;
+DROP INDEX IF EXISTS idx_audit_logs_created_at_id;
+DROP INDEX IF EXISTS idx_audit_logs_user_created_at_id;
+DROP INDEX IF EXISTS idx_audit_logs_action_created_at_id;
+
+-- The partition key must be part of the primary key
+CREATE TABLE audit_logs (
+    id INTEGER NOT NULL DEFAULT nextval('audit_logs_id_seq'),
+    user_id INTEGER REFERENCES users(id) ON DELETE SET NULL,
+    admin_id INTEGER REFERENCES admins(id) ON DELETE SET NULL,
+    action VARCHAR(50) NOT NULL,
+    entity_type VARCHAR(50) NOT NULL,
+    entity_id INTEGER,
+    details JSONB,
+    ip_address VARCHAR(45),
+    created_at TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (id, created_at)
+) PARTITION BY RANGE (created_at);
+
+CREATE TABLE audit_logs_default PARTITION OF audit_logs DEFAULT;
+
+-- Create the partition for the month containing p_month; returns false if it already exists.
+-- Rows that landed in the default partition for that month are moved into it
+CREATE OR REPLACE FUNCTION audit_logs_create_partition(p_month DATE) RETURNS BOOLEAN AS $$
+DECLARE
+  lower_bound TIMESTAMP := date_trunc('month', p_month);
+  upper_bound TIMESTAMP := date_trunc('month', p_month) + INTERVAL '1 month';
+  partition_name TEXT := 'audit_logs_' || to_char(p_month, '"y"YYYY"m"MM');
+BEGIN
+  IF to_regclass(partition_name) IS NOT NULL THEN
+    RETURN false;
+  END IF;
+
+  IF EXISTS (SELECT 1 FROM audit_logs_default WHERE created_at >= lower_bound AND created_at < upper_bound) THEN
+    EXECUTE format('CREATE TABLE %I (LIKE audit_logs INCLUDING DEFAULTS)', partition_name);
+    EXECUTE format(
+      'WITH moved AS (DELETE FROM audit_logs_default WHERE created_at >= $1 AND created_at < $2 RETURNING *)
+       INSERT INTO %I SELECT * FROM moved',
+      partition_name
+    ) USING lower_bound, upper_bound;
+    EXECUTE format('ALTER TABLE audit_logs ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)',
+      partition_name, lower_bound, upper_bound);
+  ELSE
+    EXECUTE format('CREATE TABLE %I PARTITION OF audit_logs FOR VALUES FROM (%L) TO (%L)',
+      partition_name, lower_bound, upper_bound);
+  END IF;
+  RETURN true;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Make sure partitions exist from the current month to p_months_ahead months ahead; returns how many were created
+CREATE OR REPLACE FUNCTION audit_logs_ensure_partitions(p_months_ahead INTEGER DEFAULT 3) RETURNS INTEGER AS $$
+DECLARE
+  created INTEGER := 0;
+  partition_month DATE;
+BEGIN
+  FOR partition_month IN
+    SELECT generate_series(date_trunc('month', LOCALTIMESTAMP),
+                           date_trunc('month', LOCALTIMESTAMP) + make_interval(months => p_months_ahead),
+                           INTERVAL '1 month')::date
+  LOOP
+    IF audit_logs_create_partition(partition_month) THEN
+      created := created + 1;
+    END IF;
+  END LOOP;
+  RETURN created;
+END;
+$$ LANGUAGE plpgsql;
+
+-- One partition per month that has rows, then the current and upcoming months
+SELECT audit_logs_create_partition(partition_month::date)
+FROM generate_series(
+  (SELECT date_trunc('month', MIN(created_at)) FROM audit_logs_legacy),
+  date_trunc('month', LOCALTIMESTAMP),
+  INTERVAL '1 month'
+) AS partition_month;
+SELECT audit_logs_ensure_partitions(3);
+
+-- Rows without a timestamp go to the default partition
+INSERT INTO audit_logs (id, user_id, admin_id, action, entity_type, entity_id, details, ip_address, created_at)
+SELECT id, user_id, admin_id, action, entity_type, entity_id, details, ip_address, COALESCE(created_at, '-infinity')
+FROM audit_logs_legacy;
+
+DROP TABLE audit_logs_legacy;
+ALTER SEQUENCE audit_logs_id_seq OWNED BY audit_logs.id;
+
+CREATE INDEX IF NOT EXISTS idx_audit_logs_user_id ON audit_logs(user_id);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_admin_id ON audit_logs(admin_id);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_action ON audit_logs(action);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_entity_type ON audit_logs(entity_type);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_created_at_id ON audit_logs(created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_user_created_at_id ON audit_logs(user_id, created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_audit_logs_action_created_at_id ON audit_logs(action, created_at DESC, id DESC);
+
+-- Row triggers fire on the partition, so the feed's table name is passed explicitly
+CREATE OR REPLACE FUNCTION notify_change() RETURNS trigger AS $$
+BEGIN
+  PERFORM pg_notify('dbis_changes', json_build_object('table', COALESCE(TG_ARGV[0], TG_TABLE_NAME), 'id', NEW.id)::text);
+  RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER notify_audit_logs AFTER INSERT ON audit_logs
+  FOR EACH ROW EXECUTE PROCEDURE notify_change('audit_logs');
+
+ANALYZE audit_logs;
+
+COMMIT;
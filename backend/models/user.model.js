@@ -4,6 +4,7 @@
  */
 const db = require('../utils/db.utils');
 const { generateFacemeshHash } = require('../utils/biometric.utils');
+const { resolveFacemeshTemplate } = require('../utils/facemesh-template.utils');
 
 /**
  * Get user by ID
@@ -50,8 +51,9 @@ const getUserByGovernmentId = async (governmentId) => {
 const createUser = async (userData, facemeshData) => {
   const { name, governmentId, email, phone, avaxAddress } = userData;
   
-  // Generate facemesh hash
+  // Generate facemesh hash and binary template
   const facemeshHash = generateFacemeshHash(facemeshData);
+  const template = resolveFacemeshTemplate(facemeshData);
   
   return db.executeTransaction(async (client) => {
     // Insert user
@@ -66,9 +68,9 @@ const createUser = async (userData, facemeshData) => {
     
     // Insert biometric data
     await client.query(
-      `INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_data, is_active)
-       VALUES ($1, $2, $3, true)`,
-      [user.id, facemeshHash, JSON.stringify(facemeshData)]
+      `INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_data, facemesh_template, is_active)
+       VALUES ($1, $2, $3, $4, true)`,
+      [user.id, facemeshHash, template ? null : JSON.stringify(facemeshData), template]
     );
     
     return user;
@@ -137,7 +139,7 @@ const updateVerificationStatus = async (id, status, notes, adminId) => {
  */
 const getUserBiometricData = async (userId) => {
   const result = await db.query(
-    `SELECT id, facemesh_hash, facemesh_data, is_active, blockchain_tx_hash, created_at
+    `SELECT id, facemesh_hash, facemesh_data, facemesh_template, is_active, blockchain_tx_hash, created_at
      FROM biometric_data
      WHERE user_id = $1 AND is_active = true`,
     [userId]
@@ -153,8 +155,9 @@ const getUserBiometricData = async (userId) => {
  * @returns {Promise<Object>} Updated biometric data object
  */
 const updateBiometricData = async (userId, facemeshData) => {
-  // Generate facemesh hash
+  // Generate facemesh hash and binary template
   const facemeshHash = generateFacemeshHash(facemeshData);
+  const template = resolveFacemeshTemplate(facemeshData);
   
   return db.executeTransaction(async (client) => {
     // Set all existing biometric data to inactive
@@ -165,10 +168,10 @@ const updateBiometricData = async (userId, facemeshData) => {
     
     // Insert new biometric data
     const result = await client.query(
-      `INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_data, is_active)
-       VALUES ($1, $2, $3, true)
+      `INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_data, facemesh_template, is_active)
+       VALUES ($1, $2, $3, $4, true)
        RETURNING id, facemesh_hash, is_active, created_at`,
-      [userId, facemeshHash, JSON.stringify(facemeshData)]
+      [userId, facemeshHash, template ? null : JSON.stringify(facemeshData), template]
     );
     
     return result.rows[0];
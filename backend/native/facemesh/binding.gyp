@@ -0,0 +1,15 @@
+{
+  "targets": [
+    {
+      "target_name": "facemesh_similarity",
+      "sources": ["src/similarity.cc"],
+      "cflags_cc": ["-O3", "-std=c++17"],
+      "xcode_settings": {
+        "OTHER_CPLUSPLUSFLAGS": ["-O3", "-std=c++17"]
+      },
+      "msvs_settings": {
+        "VCCLCompilerTool": { "Optimization": 2 }
+      }
+    }
+  ]
+}
@@ -0,0 +1,5 @@
+/**
+ * Loader for the native facemesh similarity kernel
+ * Throws if the addon has not been built (see `npm run build:native`)
+ */
+module.exports = require('./build/Release/facemesh_similarity.node');
@@ -0,0 +1,190 @@
+/**
+ * Native landmark-similarity kernel for DBIS
+ * Computes the mean L2 distance between two packed facemesh landmark buffers.
+ *
+ * Buffers are structure-of-arrays Float32Arrays laid out as
+ * [x0..xn-1, y0..yn-1, z0..zn-1], as produced by packLandmarks() in
+ * utils/biometric.utils.js.
+ */
+#include <node_api.h>
+
+#include <cmath>
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DBIS_FACEMESH_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define DBIS_FACEMESH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Pointers to the x, y and z planes of a packed landmark buffer
+struct Planes {
+  const float* x;
+  const float* y;
+  const float* z;
+};
+
+Planes Split(const float* data, size_t count) {
+  return Planes{data, data + count, data + 2 * count};
+}
+
+/**
+ * Portable reference path, also used for the tail of the SIMD loops
+ */
+double SumDistancesScalar(const Planes& a, const Planes& b, size_t begin, size_t end) {
+  double sum = 0.0;
+  for (size_t i = begin; i < end; ++i) {
+    const double dx = static_cast<double>(a.x[i]) - b.x[i];
+    const double dy = static_cast<double>(a.y[i]) - b.y[i];
+    const double dz = static_cast<double>(a.z[i]) - b.z[i];
+    sum += std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+  return sum;
+}
+
+#if defined(DBIS_FACEMESH_AVX2)
+__attribute__((target("avx2,fma")))
+double SumDistancesAvx2(const Planes& a, const Planes& b, size_t count) {
+  __m256 acc = _mm256_setzero_ps();
+  size_t i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(a.x + i), _mm256_loadu_ps(b.x + i));
+    const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(a.y + i), _mm256_loadu_ps(b.y + i));
+    const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(a.z + i), _mm256_loadu_ps(b.z + i));
+    const __m256 sq = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+    acc = _mm256_add_ps(acc, _mm256_sqrt_ps(sq));
+  }
+
+  alignas(32) float lanes[8];
+  _mm256_store_ps(lanes, acc);
+
+  double sum = 0.0;
+  for (float lane : lanes) {
+    sum += lane;
+  }
+  return sum + SumDistancesScalar(a, b, i, count);
+}
+
+bool CpuHasAvx2() {
+  static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return supported;
+}
+#endif
+
+#if defined(DBIS_FACEMESH_NEON)
+double SumDistancesNeon(const Planes& a, const Planes& b, size_t count) {
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  size_t i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t dx = vsubq_f32(vld1q_f32(a.x + i), vld1q_f32(b.x + i));
+    const float32x4_t dy = vsubq_f32(vld1q_f32(a.y + i), vld1q_f32(b.y + i));
+    const float32x4_t dz = vsubq_f32(vld1q_f32(a.z + i), vld1q_f32(b.z + i));
+    const float32x4_t sq = vfmaq_f32(vfmaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz);
+    acc = vaddq_f32(acc, vsqrtq_f32(sq));
+  }
+
+  return static_cast<double>(vaddvq_f32(acc)) + SumDistancesScalar(a, b, i, count);
+}
+#endif
+
+double SumDistances(const Planes& a, const Planes& b, size_t count) {
+#if defined(DBIS_FACEMESH_AVX2)
+  if (CpuHasAvx2()) {
+    return SumDistancesAvx2(a, b, count);
+  }
+#elif defined(DBIS_FACEMESH_NEON)
+  return SumDistancesNeon(a, b, count);
+#endif
+  return SumDistancesScalar(a, b, 0, count);
+}
+
+const char* ActiveBackend() {
+#if defined(DBIS_FACEMESH_AVX2)
+  return CpuHasAvx2() ? "avx2" : "scalar";
+#elif defined(DBIS_FACEMESH_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+/**
+ * Read a Float32Array argument, throwing a TypeError for anything else
+ */
+bool GetFloat32Array(napi_env env, napi_value value, const float** data, size_t* length) {
+  bool isTypedArray = false;
+  if (napi_is_typedarray(env, value, &isTypedArray) != napi_ok || !isTypedArray) {
+    napi_throw_type_error(env, nullptr, "Landmark buffers must be Float32Array instances");
+    return false;
+  }
+
+  napi_typedarray_type type;
+  void* raw = nullptr;
+  if (napi_get_typedarray_info(env, value, &type, length, &raw, nullptr, nullptr) != napi_ok ||
+      type != napi_float32_array) {
+    napi_throw_type_error(env, nullptr, "Landmark buffers must be Float32Array instances");
+    return false;
+  }
+
+  *data = static_cast<const float*>(raw);
+  return true;
+}
+
+/**
+ * meanDistance(a: Float32Array, b: Float32Array): number
+ * Mean Euclidean distance between corresponding landmarks of two packed buffers
+ */
+napi_value MeanDistance(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2];
+  if (napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr) != napi_ok) {
+    return nullptr;
+  }
+
+  if (argc < 2) {
+    napi_throw_type_error(env, nullptr, "meanDistance expects two landmark buffers");
+    return nullptr;
+  }
+
+  const float* a = nullptr;
+  const float* b = nullptr;
+  size_t lengthA = 0;
+  size_t lengthB = 0;
+  if (!GetFloat32Array(env, argv[0], &a, &lengthA) || !GetFloat32Array(env, argv[1], &b, &lengthB)) {
+    return nullptr;
+  }
+
+  if (lengthA != lengthB || lengthA == 0 || lengthA % 3 != 0) {
+    napi_throw_range_error(env, nullptr, "Landmark buffers must have the same non-zero length divisible by 3");
+    return nullptr;
+  }
+
+  const size_t count = lengthA / 3;
+  const double mean = SumDistances(Split(a, count), Split(b, count), count) / static_cast<double>(count);
+
+  napi_value result;
+  napi_create_double(env, mean, &result);
+  return result;
+}
+
+napi_value Init(napi_env env, napi_value exports) {
+  napi_value meanDistance;
+  napi_create_function(env, "meanDistance", NAPI_AUTO_LENGTH, MeanDistance, nullptr, &meanDistance);
+  napi_set_named_property(env, exports, "meanDistance", meanDistance);
+
+  napi_value backend;
+  napi_create_string_utf8(env, ActiveBackend(), NAPI_AUTO_LENGTH, &backend);
+  napi_set_named_property(env, exports, "backend", backend);
+
+  return exports;
+}
+
+}  // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -28,6 +28,13 @@ router.post('/refresh-token', adminController.refreshAdminToken);
  */
 router.get('/users', authenticateAdmin, adminController.getAllUsers);
 
+/**
+ * @route GET /api/admin/users/search
+ * @desc Typeahead user search by name, government ID or email
+ * @access Admin
+ */
+router.get('/users/search', authenticateAdmin, adminController.searchUsers);
+
 /**
  * @route GET /api/admin/users/:id
  * @desc Get user by ID
@@ -42,6 +49,13 @@ router.get('/users/:id', authenticateAdmin, adminController.getUserById);
  */
 router.put('/users/:id/verify', authenticateAdmin, userVerificationRules, validate, adminController.verifyUser);
 
+/**
+ * @route GET /api/admin/blockchain-jobs/:id
+ * @desc Get the status of a queued blockchain job
+ * @access Admin
+ */
+router.get('/blockchain-jobs/:id', authenticateAdmin, adminController.getBlockchainJob);
+
 /**
  * @route PUT /api/admin/users/:id/update
  * @desc Update user information
@@ -72,7 +86,7 @@ router.post('/create', authenticateAdmin, requireSuperAdmin, adminController.cre
 
 /**
  * @route GET /api/admin/dashboard
- * @desc Get dashboard statistics
+ * @desc Get all dashboard statistics (counts, breakdowns, series, recent activity)
  * @access Admin
  */
 router.get('/dashboard', authenticateAdmin, adminController.getDashboardStats);
@@ -84,6 +98,13 @@ router.get('/dashboard', authenticateAdmin, adminController.getDashboardStats);
  */
 router.get('/dashboard/stats', authenticateAdmin, adminController.getDetailedDashboardStats);
 
+/**
+ * @route GET /api/admin/events
+ * @desc Server-Sent Events stream of new logs, verification requests, transactions and dashboard stats
+ * @access Admin
+ */
+router.get('/events', authenticateAdmin, adminController.streamEvents);
+
 /**
  * @route GET /api/admin/profile
  * @desc Get admin profile
@@ -62,6 +62,20 @@ router.get('/verify/:hash', blockchainController.verifyDocumentHash);
  */
 router.post('/verify/:id', authenticateAdmin, blockchainController.verifyProfessionalRecord);
 
+/**
+ * @route POST /api/blockchain/identities/batch-verify
+ * @desc Verify many user identities on blockchain in batched transactions (Admin)
+ * @access Admin
+ */
+router.post('/identities/batch-verify', authenticateAdmin, blockchainController.batchVerifyIdentities);
+
+/**
+ * @route POST /api/blockchain/identities/summary
+ * @desc Read on-chain identity status and professional records for many users in one aggregated call (Admin)
+ * @access Admin
+ */
+router.post('/identities/summary', authenticateAdmin, blockchainController.getIdentitySummaries);
+
 /**
  * @route GET /api/blockchain/transactions
  * @desc Get blockchain transactions for a user
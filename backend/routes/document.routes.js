@@ -1,26 +1,22 @@
 const express = require('express');
 const router = express.Router();
 const multer = require('multer');
-const path = require('path');
 const { body } = require('express-validator');
 const documentController = require('../controllers/document.controller');
 const { authenticateUser, authenticateAdmin } = require('../middleware/auth.middleware');
 
-// Configure multer for file upload
-const storage = multer.diskStorage({
-  destination: (req, file, cb) => {
-    cb(null, 'uploads/');
-  },
-  filename: (req, file, cb) => {
-    const uniqueSuffix = Date.now() + '-' + Math.round(Math.random() * 1E9);
-    cb(null, uniqueSuffix + path.extname(file.originalname));
-  }
-});
+const documentStorage = require('../services/document-storage.service');
+
+const MAX_DOCUMENT_SIZE = 10 * 1024 * 1024; // 10MB limit
+
+// Stream uploads through a hash into content-addressed storage (see document-storage.service)
+const storage = documentStorage.storage();
 
 const upload = multer({
   storage: storage,
   limits: {
-    fileSize: 10 * 1024 * 1024 // 10MB limit
+    fileSize: MAX_DOCUMENT_SIZE,
+    files: 1
   },
   fileFilter: (req, file, cb) => {
     const allowedTypes = [
@@ -38,16 +34,39 @@ const upload = multer({
   }
 });
 
+/**
+ * Accept a single document, rejecting oversized requests before reading the body
+ */
+const uploadDocument = (req, res, next) => {
+  const declaredSize = parseInt(req.headers['content-length'], 10);
+  if (declaredSize > MAX_DOCUMENT_SIZE + 64 * 1024) {
+    return res.status(413).json({ message: 'File too large. Maximum size is 10MB.' });
+  }
+
+  upload.single('document')(req, res, (error) => {
+    if (!error) return next();
+    if (error.code === 'LIMIT_FILE_SIZE') {
+      return res.status(413).json({ message: 'File too large. Maximum size is 10MB.' });
+    }
+    return res.status(400).json({ message: error.message });
+  });
+};
+
 // Upload document (user only)
 router.post('/upload',
   authenticateUser,
-  upload.single('document'),
+  uploadDocument,
   [
     body('professionalRecordId').optional().isInt()
   ],
   documentController.uploadDocument
 );
 
+// Document content from a signed link (authorized by the link signature, supports Range)
+router.get('/content/:documentId',
+  documentController.getDocumentContent
+);
+
 // Get document by ID (for authenticated users)
 router.get('/:documentId',
   authenticateUser,
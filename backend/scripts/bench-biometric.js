@@ -0,0 +1,134 @@
+/**
+ * Biometric microbenchmarks
+ * Times the hot paths of utils/biometric.utils.js, the template codec and the
+ * 1:N facemesh index on synthetic 468-point faces, and writes ns/op per
+ * case to test-results/bench-biometric-<timestamp>.json.
+ *
+ * Each case runs BENCH_ROUNDS rounds (default 5) of about BENCH_ROUND_MS
+ * (default 500ms) after a warmup round, and the median round is reported.
+ * BENCH_INDEX_SIZE (default 2000) sets how many templates the index holds
+ * for the search case. The native kernel is used when built; run with
+ * BIOMETRIC_NATIVE=false to measure the JS path.
+ *
+ * With BENCH_BASELINE set to an earlier result file, the run fails (exit
+ * code 1) if any case got slower by more than BENCH_TOLERANCE (default 0.1).
+ *
+ * Usage: node scripts/bench-biometric.js
+ */
+const { performance } = require('perf_hooks');
+const {
+  generateFacemeshHash,
+  calculateFacemeshSimilarity,
+  packLandmarks,
+  KERNEL
+} = require('../utils/biometric.utils');
+const { encodeFacemeshTemplate, decodeFacemeshTemplate } = require('../utils/facemesh-template.utils');
+const { FacemeshIndexService } = require('../services/facemesh-index.service');
+const { randomFacemesh } = require('./bench/scenarios');
+const { writeResults, compareToBaseline, reportRegressions } = require('./bench/stats');
+
+const ROUNDS = parseInt(process.env.BENCH_ROUNDS || '5', 10);
+const ROUND_MS = parseInt(process.env.BENCH_ROUND_MS || '500', 10);
+const INDEX_SIZE = parseInt(process.env.BENCH_INDEX_SIZE || '2000', 10);
+const TOLERANCE = parseFloat(process.env.BENCH_TOLERANCE || '0.1');
+
+// Results are accumulated here so the optimizer cannot drop the work
+let sink = 0;
+
+/**
+ * Time fn; calls are batched so timer overhead stays out of the result
+ * @returns {Object} { nsPerOp, opsPerSec, rounds }
+ */
+const measure = (fn) => {
+  // Calibrate the batch size to roughly 10ms
+  let batch = 1;
+  for (;;) {
+    const start = performance.now();
+    for (let i = 0; i < batch; i++) sink += fn(i) ? 1 : 0;
+    if (performance.now() - start >= 10 || batch >= 1 << 24) break;
+    batch *= 2;
+  }
+
+  const rounds = [];
+  for (let round = 0; round <= ROUNDS; round++) {
+    let ops = 0;
+    const start = performance.now();
+    let elapsed = 0;
+    while (elapsed < ROUND_MS) {
+      for (let i = 0; i < batch; i++) sink += fn(i) ? 1 : 0;
+      ops += batch;
+      elapsed = performance.now() - start;
+    }
+    // Round 0 is warmup
+    if (round > 0) rounds.push((elapsed * 1e6) / ops);
+  }
+
+  rounds.sort((a, b) => a - b);
+  const nsPerOp = rounds[Math.floor(rounds.length / 2)];
+  return {
+    nsPerOp: Math.round(nsPerOp),
+    opsPerSec: Math.round(1e9 / nsPerOp),
+    rounds: rounds.map(Math.round)
+  };
+};
+
+async function main() {
+  const faces = Array.from({ length: 64 }, randomFacemesh);
+  const packed = faces.map(face => packLandmarks(face.landmarks));
+  const templates = faces.map(face => encodeFacemeshTemplate(face.landmarks));
+  const count = faces.length;
+
+  const cases = {
+    'hash.facemesh': i => generateFacemeshHash(faces[i % count]),
+    'pack.landmarks': i => packLandmarks(faces[i % count].landmarks),
+    'similarity.objects': i => calculateFacemeshSimilarity(faces[i % count], faces[(i + 1) % count]),
+    'similarity.packed': i => calculateFacemeshSimilarity(
+      { landmarks: packed[i % count] },
+      { landmarks: packed[(i + 1) % count] }
+    ),
+    'template.encode': i => encodeFacemeshTemplate(faces[i % count].landmarks),
+    'template.decode': i => decodeFacemeshTemplate(templates[i % count])
+  };
+
+  console.log(`Building a ${INDEX_SIZE}-template index...`);
+  const index = new FacemeshIndexService();
+  const buildStart = performance.now();
+  for (let i = 0; i < INDEX_SIZE; i++) {
+    index.add(i + 1, i + 1, encodeFacemeshTemplate(randomFacemesh().landmarks));
+  }
+  const buildMs = performance.now() - buildStart;
+  index.ready = true;
+  cases[`index.search.${INDEX_SIZE}`] = i => index.findDuplicates(templates[i % count], { limit: 1 }).length;
+
+  console.log(`Kernel: ${KERNEL}, ${ROUNDS} rounds of ${ROUND_MS}ms per case`);
+  const summary = {};
+  for (const [name, fn] of Object.entries(cases)) {
+    summary[name] = measure(fn);
+    console.log(`${name.padEnd(24)} ${String(summary[name].nsPerOp).padStart(10)} ns/op ${String(summary[name].opsPerSec).padStart(10)} ops/s`);
+  }
+  summary[`index.add.${INDEX_SIZE}`] = {
+    nsPerOp: Math.round((buildMs * 1e6) / INDEX_SIZE),
+    opsPerSec: Math.round(INDEX_SIZE / (buildMs / 1000))
+  };
+  console.log(`${`index.add.${INDEX_SIZE}`.padEnd(24)} ${String(summary[`index.add.${INDEX_SIZE}`].nsPerOp).padStart(10)} ns/op`);
+
+  const file = writeResults('bench-biometric', {
+    startedAt: new Date().toISOString(),
+    config: { kernel: KERNEL, rounds: ROUNDS, roundMs: ROUND_MS, indexSize: INDEX_SIZE, node: process.version },
+    summary,
+    sink
+  });
+  console.log(`Results saved to ${file}`);
+
+  if (process.env.BENCH_BASELINE) {
+    reportRegressions(compareToBaseline(summary, process.env.BENCH_BASELINE, {
+      metrics: ['nsPerOp'],
+      tolerance: TOLERANCE
+    }));
+  }
+}
+
+main().catch((error) => {
+  console.error('Biometric benchmark failed:', error);
+  process.exit(1);
+});
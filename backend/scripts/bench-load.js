@@ -0,0 +1,211 @@
+/**
+ * Load test
+ * Runs the user journeys in scripts/bench/scenarios.js (registration,
+ * biometric verify/enroll, document upload, admin listing/search,
+ * verify-and-fund) against a running API. It prints throughput, p50/p95/p99
+ * and error rates per journey and per request, and writes them to
+ * test-results/bench-load-<timestamp>.json.
+ *
+ * Load model:
+ *   BENCH_RATE          journeys started per second (open model: arrivals do not
+ *                       wait for earlier journeys, so queueing shows up as latency)
+ *   BENCH_CONCURRENCY   virtual users running journeys back to back, when
+ *                       BENCH_RATE is unset (closed model, default 10)
+ *   BENCH_MAX_IN_FLIGHT open model cap; arrivals over it are counted as dropped
+ *   BENCH_DURATION_MS   measured phase (default 30000), after BENCH_WARMUP_MS (default 5000)
+ *
+ * BENCH_SCENARIOS weights the mix: "registration=2,biometric=4,documents=1,admin=3,verify-and-fund=1"
+ * (the default). verify-and-fund waits for the funding and identity jobs,
+ * so it needs the blockchain worker and a chain (a local hardhat node with
+ * AVALANCHE_FUJI_RPC_URL pointing at it). BENCH_SEED_USERS users (default 20)
+ * are registered first for the journeys that act on existing accounts. The
+ * admin account comes from BENCH_ADMIN_USERNAME / BENCH_ADMIN_PASSWORD.
+ *
+ * With BENCH_BASELINE set to an earlier result file, the run fails (exit
+ * code 1) if any p95 or error rate grew by more than BENCH_TOLERANCE (default 0.2).
+ *
+ * Usage: BENCH_RATE=20 node scripts/bench-load.js
+ */
+const { performance } = require('perf_hooks');
+require('dotenv').config();
+const { BenchClient } = require('./bench/client');
+const { SCENARIOS, register } = require('./bench/scenarios');
+const { Recorder, printSummary, writeResults, compareToBaseline, reportRegressions } = require('./bench/stats');
+
+const API_URL = process.env.API_URL || 'http://localhost:5000';
+const RATE = parseFloat(process.env.BENCH_RATE || '0');
+const CONCURRENCY = parseInt(process.env.BENCH_CONCURRENCY || '10', 10);
+const MAX_IN_FLIGHT = parseInt(process.env.BENCH_MAX_IN_FLIGHT || '500', 10);
+const DURATION_MS = parseInt(process.env.BENCH_DURATION_MS || '30000', 10);
+const WARMUP_MS = parseInt(process.env.BENCH_WARMUP_MS || '5000', 10);
+const SEED_USERS = parseInt(process.env.BENCH_SEED_USERS || '20', 10);
+const SCENARIO_MIX = process.env.BENCH_SCENARIOS || 'registration=2,biometric=4,documents=1,admin=3,verify-and-fund=1';
+const TOLERANCE = parseFloat(process.env.BENCH_TOLERANCE || '0.2');
+
+/**
+ * Parse "name=weight,..." into a weighted picker
+ */
+const parseMix = (spec) => {
+  const entries = spec.split(',').map(rule => rule.trim()).filter(Boolean).map((rule) => {
+    const [name, weight = '1'] = rule.split('=');
+    if (!SCENARIOS[name]) {
+      throw new Error(`Unknown scenario ${name}; expected one of ${Object.keys(SCENARIOS).join(', ')}`);
+    }
+    return { name, weight: parseFloat(weight) };
+  }).filter(entry => entry.weight > 0);
+
+  const total = entries.reduce((sum, entry) => sum + entry.weight, 0);
+  return {
+    entries,
+    pick: () => {
+      let r = Math.random() * total;
+      for (const entry of entries) {
+        r -= entry.weight;
+        if (r < 0) return entry.name;
+      }
+      return entries[entries.length - 1].name;
+    }
+  };
+};
+
+const runJourney = async (client, context, name) => {
+  const start = performance.now();
+  try {
+    await SCENARIOS[name](client, context);
+    client.recorder.record(`scenario:${name}`, performance.now() - start, true, 'ok');
+  } catch (error) {
+    client.recorder.record(`scenario:${name}`, performance.now() - start, false, error.step || 'error');
+    context.errors[error.message] = (context.errors[error.message] || 0) + 1;
+  }
+};
+
+/**
+ * Closed model: CONCURRENCY loops, each starting its next journey when the last one ends
+ */
+const closedLoad = (client, context, mix, until) => Promise.all(
+  Array.from({ length: CONCURRENCY }, async () => {
+    while (performance.now() < until) {
+      await runJourney(client, context, mix.pick());
+    }
+  })
+);
+
+/**
+ * Open model: start journeys at RATE per second regardless of how many are still running
+ */
+const openLoad = (client, context, mix, from, until) => new Promise((resolve) => {
+  const running = new Set();
+  let started = 0;
+  const timer = setInterval(() => {
+    const now = performance.now();
+    if (now >= until) {
+      clearInterval(timer);
+      Promise.all(running).then(resolve);
+      return;
+    }
+    const due = Math.floor(((now - from) / 1000) * RATE) - started;
+    for (let i = 0; i < due; i++) {
+      started++;
+      if (running.size >= MAX_IN_FLIGHT) {
+        context.dropped++;
+        continue;
+      }
+      const journey = runJourney(client, context, mix.pick()).then(() => running.delete(journey));
+      running.add(journey);
+    }
+  }, 5);
+});
+
+const health = async (client) => {
+  const { status, data } = await client.request('GET', '/api/health');
+  return status === 200 ? data : null;
+};
+
+async function main() {
+  const mix = parseMix(SCENARIO_MIX);
+  const client = new BenchClient(API_URL, new Recorder(), { maxSockets: Math.max(CONCURRENCY, MAX_IN_FLIGHT) + 10 });
+  const context = {
+    users: [],
+    adminToken: null,
+    jobTimeoutMs: parseInt(process.env.BENCH_JOB_TIMEOUT_MS || '120000', 10),
+    jobPollMs: parseInt(process.env.BENCH_JOB_POLL_MS || '1000', 10),
+    errors: {},
+    dropped: 0
+  };
+
+  const before = await health(client);
+  if (!before) {
+    throw new Error(`API at ${API_URL} is not healthy; start the backend first`);
+  }
+
+  const admin = await client.step('admin-login', 'POST', '/api/admin/login', {
+    json: {
+      username: process.env.BENCH_ADMIN_USERNAME || 'admin2',
+      password: process.env.BENCH_ADMIN_PASSWORD || 'SecurePass123'
+    }
+  });
+  context.adminToken = admin.tokens.accessToken;
+
+  console.log(`Seeding ${SEED_USERS} users...`);
+  for (let i = 0; i < SEED_USERS; i += 10) {
+    const batch = Math.min(10, SEED_USERS - i);
+    context.users.push(...await Promise.all(Array.from({ length: batch }, () => register(client))));
+  }
+
+  const model = RATE > 0 ? `${RATE} journeys/s (open, max ${MAX_IN_FLIGHT} in flight)` : `${CONCURRENCY} virtual users (closed)`;
+  console.log(`Target ${API_URL}: ${model}, mix ${mix.entries.map(e => `${e.name}=${e.weight}`).join(',')}, ` +
+    `warmup ${WARMUP_MS}ms, measuring ${DURATION_MS}ms`);
+
+  // Warmup samples go to a recorder that is thrown away
+  const run = (from, until) => (RATE > 0 ? openLoad(client, context, mix, from, until) : closedLoad(client, context, mix, until));
+  if (WARMUP_MS > 0) {
+    const warmupStart = performance.now();
+    await run(warmupStart, warmupStart + WARMUP_MS);
+  }
+
+  client.recorder = new Recorder();
+  context.errors = {};
+  context.dropped = 0;
+  const start = performance.now();
+  await run(start, start + DURATION_MS);
+  const seconds = (performance.now() - start) / 1000;
+
+  const summary = client.recorder.summary(seconds);
+  printSummary(summary);
+  if (context.dropped > 0) {
+    console.log(`${context.dropped} arrivals dropped at the in-flight cap`);
+  }
+
+  const file = writeResults('bench-load', {
+    startedAt: new Date(Date.now() - seconds * 1000).toISOString(),
+    durationSeconds: seconds,
+    config: {
+      apiUrl: API_URL,
+      rate: RATE || null,
+      concurrency: RATE > 0 ? null : CONCURRENCY,
+      maxInFlight: MAX_IN_FLIGHT,
+      warmupMs: WARMUP_MS,
+      scenarios: SCENARIO_MIX,
+      seedUsers: SEED_USERS
+    },
+    summary,
+    dropped: context.dropped,
+    errors: context.errors,
+    // Pool, hashing and logging counters before and after, for context
+    health: { before, after: await health(client) }
+  });
+  console.log(`Results saved to ${file}`);
+
+  if (process.env.BENCH_BASELINE) {
+    reportRegressions(compareToBaseline(summary, process.env.BENCH_BASELINE, {
+      metrics: ['p95', 'errorRate'],
+      tolerance: TOLERANCE
+    }));
+  }
+  client.close();
+}
+
+main().catch((error) => {
+  console.error('Load test failed:', error.message);
+  process.exit(1);
+});
@@ -0,0 +1,104 @@
+/**
+ * Login storm benchmark
+ * Measures the latency of an unrelated endpoint while a burst of logins hits
+ * the API, to check that password hashing does not stall the event loop.
+ *
+ * Samples PROBE_PATH (default /api/health) at PROBE_RATE requests/s, first
+ * alone and then while STORM_CONCURRENCY clients log in back to back for
+ * DURATION_MS, and prints p50/p95/p99 for each phase. Logins need a real
+ * account: BENCH_USERNAME / BENCH_PASSWORD (a user, or an admin with
+ * LOGIN_PATH=/api/admin/login).
+ *
+ * Usage: BENCH_USERNAME=... BENCH_PASSWORD=... node scripts/bench-login-storm.js
+ * Run it against builds with and without the hashing pool to compare.
+ */
+const http = require('http');
+const { performance } = require('perf_hooks');
+const { Recorder, printSummary } = require('./bench/stats');
+require('dotenv').config();
+
+const API_URL = new URL(process.env.API_URL || 'http://localhost:5000');
+const PROBE_PATH = process.env.PROBE_PATH || '/api/health';
+const LOGIN_PATH = process.env.LOGIN_PATH || '/api/user/login';
+const PROBE_RATE = parseInt(process.env.PROBE_RATE || '20', 10);
+const STORM_CONCURRENCY = parseInt(process.env.STORM_CONCURRENCY || '50', 10);
+const DURATION_MS = parseInt(process.env.DURATION_MS || '10000', 10);
+
+const agent = new http.Agent({ keepAlive: true, maxSockets: STORM_CONCURRENCY + 10 });
+
+const request = (method, path, body) => new Promise((resolve) => {
+  const payload = body ? JSON.stringify(body) : null;
+  const start = performance.now();
+  const req = http.request({
+    agent,
+    method,
+    hostname: API_URL.hostname,
+    port: API_URL.port,
+    path,
+    headers: payload ? { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(payload) } : {}
+  }, (res) => {
+    res.resume();
+    res.on('end', () => resolve({ status: res.statusCode, ms: performance.now() - start }));
+  });
+  req.on('error', () => resolve({ status: 0, ms: performance.now() - start }));
+  if (payload) req.write(payload);
+  req.end();
+});
+
+const recorder = new Recorder();
+
+const record = (label, sample) => {
+  recorder.record(label, sample.ms, sample.status > 0 && sample.status < 500, sample.status);
+};
+
+/**
+ * Sample the probe endpoint at a fixed rate for the duration
+ */
+const probe = (duration, label) => new Promise((resolve) => {
+  const pending = [];
+  const timer = setInterval(() => {
+    pending.push(request('GET', PROBE_PATH).then(sample => record(label, sample)));
+  }, 1000 / PROBE_RATE);
+
+  setTimeout(async () => {
+    clearInterval(timer);
+    await Promise.all(pending);
+    resolve();
+  }, duration);
+});
+
+const storm = async (duration, credentials) => {
+  const deadline = Date.now() + duration;
+  const client = async () => {
+    while (Date.now() < deadline) {
+      record('logins', await request('POST', LOGIN_PATH, credentials));
+    }
+  };
+  await Promise.all(Array.from({ length: STORM_CONCURRENCY }, client));
+};
+
+async function main() {
+  const { BENCH_USERNAME: username, BENCH_PASSWORD: password } = process.env;
+  if (!username || !password) {
+    console.error('Set BENCH_USERNAME and BENCH_PASSWORD to an existing account');
+    process.exit(1);
+  }
+
+  console.log(`Target ${API_URL.origin}: probing ${PROBE_PATH} at ${PROBE_RATE}/s, ` +
+    `${STORM_CONCURRENCY} concurrent logins on ${LOGIN_PATH} for ${DURATION_MS}ms`);
+
+  await probe(DURATION_MS, 'baseline');
+  await Promise.all([
+    probe(DURATION_MS, 'storm'),
+    storm(DURATION_MS, { username, password })
+  ]);
+
+  const summary = recorder.summary(DURATION_MS / 1000);
+  printSummary(summary);
+  const logins = summary.logins || { throughput: 0, statuses: {} };
+  console.log(`login throughput ${logins.throughput}/s, ${logins.statuses[503] || 0} shed with 503`);
+}
+
+main()
+  .catch(error => console.error('Benchmark failed:', error))
+  .finally(() => agent.destroy());
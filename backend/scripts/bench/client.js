@@ -0,0 +1,133 @@
+/**
+ * Benchmark HTTP client
+ * Keep-alive JSON and multipart requests against the API that record every
+ * call under a step label. Uses only core modules, so the harness runs
+ * without installing the backend first.
+ */
+const http = require('http');
+const https = require('https');
+const crypto = require('crypto');
+const { performance } = require('perf_hooks');
+
+class StepError extends Error {
+  constructor(step, status, data) {
+    super(`${step} failed with ${status || 'a network error'}${data && data.message ? `: ${data.message}` : ''}`);
+    this.name = 'StepError';
+    this.step = step;
+    this.status = status;
+  }
+}
+
+/**
+ * Encode a multipart/form-data body
+ * @param {Object} fields - Text fields
+ * @param {Object} file - { field, filename, contentType, content (Buffer) }
+ * @returns {Object} { body, contentType }
+ */
+const multipartBody = (fields, file) => {
+  const boundary = `----dbis-bench-${crypto.randomBytes(8).toString('hex')}`;
+  const parts = [];
+  for (const [name, value] of Object.entries(fields)) {
+    if (value === undefined || value === null) continue;
+    parts.push(Buffer.from(`--${boundary}\r\nContent-Disposition: form-data; name="${name}"\r\n\r\n${value}\r\n`));
+  }
+  parts.push(Buffer.from(
+    `--${boundary}\r\nContent-Disposition: form-data; name="${file.field}"; filename="${file.filename}"\r\n` +
+    `Content-Type: ${file.contentType}\r\n\r\n`
+  ));
+  parts.push(file.content, Buffer.from(`\r\n--${boundary}--\r\n`));
+  return { body: Buffer.concat(parts), contentType: `multipart/form-data; boundary=${boundary}` };
+};
+
+class BenchClient {
+  /**
+   * @param {String} baseUrl - API origin, e.g. http://localhost:5000
+   * @param {Recorder} recorder - Where step samples go
+   * @param {Object} options - maxSockets, timeoutMs
+   */
+  constructor(baseUrl, recorder, options = {}) {
+    this.url = new URL(baseUrl);
+    this.transport = this.url.protocol === 'https:' ? https : http;
+    this.agent = new this.transport.Agent({ keepAlive: true, maxSockets: options.maxSockets || 256 });
+    this.recorder = recorder;
+    this.timeoutMs = options.timeoutMs || 60000;
+    this.recording = true;
+  }
+
+  /**
+   * Send one request
+   * @param {String} method - HTTP method
+   * @param {String} path - Path including query string
+   * @param {Object} options - json (body), multipart ({ fields, file }), token
+   * @returns {Promise<Object>} { status (0 on network errors), data, ms }
+   */
+  request(method, path, options = {}) {
+    let payload = null;
+    const headers = { Accept: 'application/json' };
+    if (options.json !== undefined) {
+      payload = Buffer.from(JSON.stringify(options.json));
+      headers['Content-Type'] = 'application/json';
+    } else if (options.multipart) {
+      const encoded = multipartBody(options.multipart.fields || {}, options.multipart.file);
+      payload = encoded.body;
+      headers['Content-Type'] = encoded.contentType;
+    }
+    if (payload) headers['Content-Length'] = payload.length;
+    if (options.token) headers.Authorization = `Bearer ${options.token}`;
+
+    return new Promise((resolve) => {
+      const start = performance.now();
+      const req = this.transport.request({
+        agent: this.agent,
+        method,
+        hostname: this.url.hostname,
+        port: this.url.port,
+        path,
+        headers,
+        timeout: this.timeoutMs
+      }, (res) => {
+        const chunks = [];
+        res.on('data', chunk => chunks.push(chunk));
+        res.on('end', () => {
+          let data = null;
+          try {
+            data = chunks.length > 0 ? JSON.parse(Buffer.concat(chunks).toString('utf8')) : null;
+          } catch (error) {
+            data = null;
+          }
+          resolve({ status: res.statusCode, data, ms: performance.now() - start });
+        });
+      });
+      req.on('timeout', () => req.destroy(new Error('timeout')));
+      req.on('error', () => resolve({ status: 0, data: null, ms: performance.now() - start }));
+      if (payload) req.write(payload);
+      req.end();
+    });
+  }
+
+  /**
+   * Send a request as a named step; records it and throws StepError unless the status is 2xx
+   * @param {String} step - Step label (e.g. "register")
+   * @returns {Promise<Object>} Response data
+   */
+  async step(step, method, path, options = {}) {
+    const { status, data, ms } = await this.request(method, path, options);
+    const ok = status >= 200 && status < 300;
+    if (this.recording) {
+      this.recorder.record(`step:${step}`, ms, ok, status);
+    }
+    if (!ok) {
+      throw new StepError(step, status, data);
+    }
+    return data;
+  }
+
+  close() {
+    this.agent.destroy();
+  }
+}
+
+module.exports = {
+  BenchClient,
+  StepError
+};
@@ -0,0 +1,191 @@
+/**
+ * Benchmark scenarios
+ * The request sequences of test-user-journey.js and scripts/test-document-flow.js,
+ * split into journeys that many virtual users can run at once. Each journey
+ * keeps its state in the virtual user instead of module globals, and makes
+ * every user unique (username, government id, facemesh) so registrations do
+ * not collide or trip duplicate-enrollment detection.
+ *
+ * A scenario is async (client, context) => void and throws on the first failed
+ * step. context holds the admin token and the seeded users set up by
+ * bench-load.js.
+ */
+const crypto = require('crypto');
+
+// MediaPipe face mesh landmark count, as sent by the frontend
+const LANDMARK_COUNT = 468;
+
+// A minimal PDF, like the one test-document-flow.js uploads
+const TEST_DOCUMENT = Buffer.from(
+  '%PDF-1.4\n1 0 obj << /Type /Catalog /Pages 2 0 R >> endobj\n' +
+  '2 0 obj << /Type /Pages /Kids [3 0 R] /Count 1 >> endobj\n' +
+  '3 0 obj << /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >> endobj\n' +
+  'trailer << /Size 4 /Root 1 0 R >>\n%%EOF'
+);
+
+let sequence = 0;
+
+const uniqueId = () => `${Date.now().toString(36)}${process.pid.toString(36)}${(sequence++).toString(36)}`;
+
+/**
+ * Random landmarks; independent draws are far apart, so users never look like duplicates
+ */
+const randomFacemesh = () => ({
+  landmarks: Array.from({ length: LANDMARK_COUNT }, () => ({
+    x: Math.random(),
+    y: Math.random(),
+    z: Math.random() * 0.1
+  }))
+});
+
+/**
+ * Registration payload for a new, unique user
+ */
+const newUser = () => {
+  const id = uniqueId();
+  return {
+    name: 'Bench User',
+    username: `bench_${id}`,
+    password: 'Password123!',
+    email: `bench_${id}@example.com`,
+    phone: '+12025550179',
+    governmentId: `BENCH-${id}`.toUpperCase(),
+    facemeshData: randomFacemesh()
+  };
+};
+
+/**
+ * Register a user and keep what later steps need
+ * @returns {Object} Virtual user: registration payload plus id and token
+ */
+const register = async (client) => {
+  const user = newUser();
+  const result = await client.step('register', 'POST', '/api/user/register', { json: user });
+  return { ...user, id: result.user.id, token: result.tokens.accessToken };
+};
+
+const pick = (items) => items[Math.floor(Math.random() * items.length)];
+
+const delay = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+/**
+ * Registration journey: register, then the profile reads the app makes right after
+ */
+const registration = async (client) => {
+  const user = await register(client);
+  await client.step('profile', 'GET', '/api/users/profile', { token: user.token });
+  await client.step('biometric-status', 'GET', '/api/users/biometric-status', { token: user.token });
+};
+
+/**
+ * Biometric journey: log in as a seeded user, verify (1:1) and re-enroll (1:N duplicate check)
+ */
+const biometric = async (client, context) => {
+  const user = pick(context.users);
+  const login = await client.step('login', 'POST', '/api/user/login', {
+    json: { username: user.username, password: user.password }
+  });
+  const token = login.tokens.accessToken;
+
+  const verified = await client.step('verify-biometric', 'POST', '/api/user/verify-biometric', {
+    token,
+    json: { userId: user.id, facemeshData: user.facemeshData }
+  });
+  if (!verified.verified) {
+    throw new Error('verify-biometric did not match the enrolled facemesh');
+  }
+
+  // Re-enroll with a fresh template; keep it so the next verify matches
+  const facemeshData = randomFacemesh();
+  await client.step('enroll-facemesh', 'PUT', '/api/users/update-facemesh', { token, json: { facemeshData } });
+  user.facemeshData = facemeshData;
+};
+
+/**
+ * Document journey: professional record, upload, read back
+ */
+const documents = async (client, context) => {
+  const user = pick(context.users);
+  const created = await client.step('professional-record', 'POST', '/api/users/professional-record', {
+    token: user.token,
+    json: {
+      recordType: 'EMPLOYMENT',
+      institution: 'Bench Company',
+      title: 'Software Engineer',
+      description: 'Load test record',
+      startDate: '2023-01-01',
+      endDate: '2024-01-01',
+      isCurrent: false
+    }
+  });
+
+  const uploaded = await client.step('document-upload', 'POST', '/api/documents/upload', {
+    token: user.token,
+    multipart: {
+      fields: { professionalRecordId: created.record && created.record.id },
+      file: { field: 'document', filename: 'bench.pdf', contentType: 'application/pdf', content: TEST_DOCUMENT }
+    }
+  });
+  await client.step('document-get', 'GET', `/api/documents/${uploaded.documentId}`, { token: user.token });
+};
+
+/**
+ * Admin journey: list users (two keyset pages), search, open a user
+ */
+const admin = async (client, context) => {
+  const token = context.adminToken;
+  const first = await client.step('admin-list', 'GET', '/api/admin/users?limit=20', { token });
+  const nextCursor = first.pagination && first.pagination.nextCursor;
+  if (nextCursor) {
+    await client.step('admin-list-next', 'GET', `/api/admin/users?limit=20&cursor=${encodeURIComponent(nextCursor)}`, { token });
+  }
+
+  const user = pick(context.users);
+  await client.step('admin-search', 'GET', `/api/admin/users/search?q=${encodeURIComponent(user.username.slice(0, 10))}&limit=10`, { token });
+  await client.step('admin-user', 'GET', `/api/admin/users/${user.id}`, { token });
+};
+
+/**
+ * Verify-and-fund journey: register, admin verifies (queues funding and identity
+ * registration), then poll the jobs until the chain confirms them
+ */
+const verifyAndFund = async (client, context) => {
+  const user = await register(client);
+  const result = await client.step('admin-verify', 'PUT', `/api/admin/users/${user.id}/verify`, {
+    token: context.adminToken,
+    json: { verificationStatus: 'VERIFIED', verificationNotes: 'Verified by load test' }
+  });
+
+  const started = Date.now();
+  for (const job of result.blockchainJobs || []) {
+    for (;;) {
+      const status = await client.step('job-poll', 'GET', `/api/admin/blockchain-jobs/${job.id}`, { token: context.adminToken });
+      if (status.status === 'CONFIRMED') break;
+      if (status.status === 'FAILED') {
+        throw new Error(`Blockchain job ${job.id} failed: ${status.lastError}`);
+      }
+      if (Date.now() - started > context.jobTimeoutMs) {
+        throw new Error(`Blockchain job ${job.id} not confirmed within ${context.jobTimeoutMs}ms`);
+      }
+      await delay(context.jobPollMs);
+    }
+  }
+  if ((result.blockchainJobs || []).length > 0) {
+    client.recorder.record('chain:confirmation', Date.now() - started, true, 'CONFIRMED');
+  }
+};
+
+const SCENARIOS = {
+  registration,
+  biometric,
+  documents,
+  admin,
+  'verify-and-fund': verifyAndFund
+};
+
+module.exports = {
+  SCENARIOS,
+  register,
+  newUser,
+  randomFacemesh
+};
@@ -0,0 +1,163 @@
+/**
+ * Benchmark statistics
+ * Latency samples per label, summarized as throughput, percentiles and error
+ * rate, plus the result file and baseline comparison shared by the bench
+ * scripts (bench-load.js, bench-biometric.js, bench-login-storm.js,
+ * blockchain/scripts/gas-report.js).
+ */
+const fs = require('fs');
+const path = require('path');
+
+// Results go next to the user journey results at the repository root
+const RESULTS_DIR = process.env.BENCH_RESULTS_DIR || path.join(__dirname, '..', '..', '..', 'test-results');
+
+const percentile = (sorted, p) => sorted.length === 0
+  ? 0
+  : sorted[Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1)];
+
+const round = (value, digits = 2) => Math.round(value * 10 ** digits) / 10 ** digits;
+
+/**
+ * Latency and outcome samples grouped by label
+ */
+class Recorder {
+  constructor() {
+    this.series = new Map();
+  }
+
+  /**
+   * Record one sample
+   * @param {String} label - Scenario or step name
+   * @param {Number} ms - Latency
+   * @param {Boolean} ok - Whether the call succeeded
+   * @param {Number|String} status - HTTP status (0 for network errors) or outcome
+   */
+  record(label, ms, ok, status) {
+    let series = this.series.get(label);
+    if (!series) {
+      series = { ms: [], errors: 0, statuses: {} };
+      this.series.set(label, series);
+    }
+    series.ms.push(ms);
+    if (!ok) series.errors++;
+    series.statuses[status] = (series.statuses[status] || 0) + 1;
+  }
+
+  /**
+   * Summaries by label
+   * @param {Number} seconds - Measured duration, for throughput
+   * @returns {Object} { [label]: { count, throughput, errors, errorRate, p50, p95, p99, max, mean, statuses } }
+   */
+  summary(seconds) {
+    const result = {};
+    const labels = [...this.series.keys()].sort();
+    for (const label of labels) {
+      const series = this.series.get(label);
+      const sorted = [...series.ms].sort((a, b) => a - b);
+      const total = sorted.reduce((sum, ms) => sum + ms, 0);
+      result[label] = {
+        count: sorted.length,
+        throughput: round(sorted.length / seconds),
+        errors: series.errors,
+        errorRate: round(series.errors / sorted.length, 4),
+        p50: round(percentile(sorted, 50)),
+        p95: round(percentile(sorted, 95)),
+        p99: round(percentile(sorted, 99)),
+        max: round(sorted[sorted.length - 1] || 0),
+        mean: round(total / sorted.length),
+        statuses: series.statuses
+      };
+    }
+    return result;
+  }
+}
+
+/**
+ * Print summaries as an aligned table
+ * @param {Object} summary - From Recorder.summary
+ */
+const printSummary = (summary) => {
+  const labels = Object.keys(summary);
+  const width = Math.max(10, ...labels.map(label => label.length));
+  for (const label of labels) {
+    const s = summary[label];
+    console.log(
+      `${label.padEnd(width)} n=${String(s.count).padEnd(6)} ${String(s.throughput).padStart(8)}/s ` +
+      `p50=${s.p50}ms p95=${s.p95}ms p99=${s.p99}ms max=${s.max}ms errors=${(s.errorRate * 100).toFixed(2)}%`
+    );
+  }
+};
+
+/**
+ * Write a result file to test-results/
+ * @param {String} prefix - File name prefix (e.g. bench-load)
+ * @param {Object} data - Result document
+ * @returns {String} File path
+ */
+const writeResults = (prefix, data) => {
+  fs.mkdirSync(RESULTS_DIR, { recursive: true });
+  const file = path.join(RESULTS_DIR, `${prefix}-${Date.now()}.json`);
+  fs.writeFileSync(file, JSON.stringify(data, null, 2));
+  return file;
+};
+
+/**
+ * Compare a metric per label against a baseline result file
+ * @param {Object} current - { [label]: { [metric]: Number } }
+ * @param {String} baselineFile - Earlier result file (its `summary`, or the object itself)
+ * @param {Object} options - metrics: names where higher is worse; tolerance: allowed relative increase
+ * @returns {Array} Regressions as { label, metric, baseline, current, change }
+ */
+const compareToBaseline = (current, baselineFile, options = {}) => {
+  const { metrics = ['p95'], tolerance = 0.2 } = options;
+  const document = JSON.parse(fs.readFileSync(baselineFile, 'utf8'));
+  const baseline = document.summary || document;
+  const regressions = [];
+
+  for (const [label, values] of Object.entries(current)) {
+    const before = baseline[label];
+    if (!before) continue;
+    for (const metric of metrics) {
+      if (typeof before[metric] !== 'number' || typeof values[metric] !== 'number') continue;
+      // Rates start at zero, so any increase over a small absolute margin counts
+      const limit = before[metric] === 0 ? 0.001 : before[metric] * (1 + tolerance);
+      if (values[metric] > limit) {
+        regressions.push({
+          label,
+          metric,
+          baseline: before[metric],
+          current: values[metric],
+          change: before[metric] === 0 ? null : round(values[metric] / before[metric] - 1, 4)
+        });
+      }
+    }
+  }
+  return regressions;
+};
+
+/**
+ * Print regressions and set a failing exit code if there are any
+ * @param {Array} regressions - From compareToBaseline
+ */
+const reportRegressions = (regressions) => {
+  if (regressions.length === 0) {
+    console.log('No regressions against the baseline');
+    return;
+  }
+  console.error(`${regressions.length} regression(s) against the baseline:`);
+  for (const r of regressions) {
+    const change = r.change === null ? 'from 0' : `${(r.change * 100).toFixed(1)}%`;
+    console.error(`  ${r.label} ${r.metric}: ${r.baseline} -> ${r.current} (${change})`);
+  }
+  process.exitCode = 1;
+};
+
+module.exports = {
+  RESULTS_DIR,
+  Recorder,
+  percentile,
+  printSummary,
+  writeResults,
+  compareToBaseline,
+  reportRegressions
+};
@@ -0,0 +1,37 @@
+/**
+ * Standalone blockchain worker
+ * Drains the blockchain_jobs queue outside the API process. Run as many as needed;
+ * jobs are leased with FOR UPDATE SKIP LOCKED so workers never process the same job.
+ * Usage: node scripts/blockchain-worker.js
+ * Set BLOCKCHAIN_WORKER_ENABLED=false on the API servers when using dedicated workers.
+ */
+const dotenv = require('dotenv');
+
+// Load environment variables
+dotenv.config();
+
+// Size the pool for a worker rather than the API (DB_WORKER_POOL_MAX)
+process.env.DB_WORKLOAD = process.env.DB_WORKLOAD || 'worker';
+
+const dbService = require('../services/db.service');
+const blockchainQueue = require('../services/blockchain-queue.service');
+
+const start = () => {
+  blockchainQueue.startWorker(dbService);
+};
+
+if (dbService.getConnectionStatus()) {
+  start();
+} else {
+  console.log('Waiting for database connection...');
+  dbService.once('connected', start);
+}
+
+const shutdown = async (signal) => {
+  console.log(`${signal} received, stopping blockchain worker...`);
+  await blockchainQueue.stopWorker();
+  process.exit(0);
+};
+
+process.on('SIGINT', () => shutdown('SIGINT'));
+process.on('SIGTERM', () => shutdown('SIGTERM'));
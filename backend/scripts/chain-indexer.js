@@ -0,0 +1,38 @@
+/**
+ * Standalone chain indexer
+ * Mirrors IdentityManagement events into the chain_* tables outside the API process.
+ * Only one indexer per contract advances the cursor at a time (the cursor row is leased),
+ * so extra instances just stand by.
+ * Usage: node scripts/chain-indexer.js
+ * Set CHAIN_INDEXER_ENABLED=false on the API servers when using a dedicated indexer.
+ */
+const dotenv = require('dotenv');
+
+// Load environment variables
+dotenv.config();
+
+// Size the pool for a worker rather than the API (DB_WORKER_POOL_MAX)
+process.env.DB_WORKLOAD = process.env.DB_WORKLOAD || 'worker';
+
+const dbService = require('../services/db.service');
+const chainIndexer = require('../services/chain-indexer.service');
+
+const start = () => {
+  chainIndexer.startIndexer(dbService);
+};
+
+if (dbService.getConnectionStatus()) {
+  start();
+} else {
+  console.log('Waiting for database connection...');
+  dbService.once('connected', start);
+}
+
+const shutdown = async (signal) => {
+  console.log(`${signal} received, stopping chain indexer...`);
+  await chainIndexer.stopIndexer();
+  process.exit(0);
+};
+
+process.on('SIGINT', () => shutdown('SIGINT'));
+process.on('SIGTERM', () => shutdown('SIGTERM'));
@@ -109,5 +109,5 @@ async function checkAllUserWallets() {
   }
 }
 
-// Run the main function
-main();
+// Run the main function; the shared database service keeps timers, so exit explicitly
+main().finally(() => process.exit(0));
@@ -0,0 +1,295 @@
+/**
+ * Avalanche Fuji Testnet deployment and migration script for IdentityManagementV2
+ * Deploys the gas-optimized contract, copies identities, professional records and
+ * roles from the current IdentityManagement contract, then closes the import window.
+ *
+ * Stop the blockchain worker before running so no new v1 transactions land mid-migration.
+ *
+ * Environment:
+ *   V1_CONTRACT_ADDRESS     - Contract to migrate from (default: AVALANCHE_FUJI_CONTRACT_ADDRESS,
+ *                             then blockchain/deployments/<network>-deployment.json)
+ *   MIGRATION_FROM_BLOCK    - First block scanned for v1 events (default: 0)
+ *   MIGRATION_BLOCK_RANGE   - Blocks per eth_getLogs request (default: 2048, the Fuji RPC limit)
+ *   MIGRATION_KEEP_OPEN     - Set to 'true' to leave the import functions enabled afterwards
+ */
+const fs = require('fs');
+const path = require('path');
+const hre = require('hardhat');
+require('dotenv').config();
+
+const IDENTITY_BATCH_SIZE = 50;
+const RECORD_BATCH_SIZE = 100;
+const CONFIRMATIONS = 2;
+
+// v1 storage: `identities` is the first state variable (slot 0); Identity fields are laid out
+// biometricHash, professionalDataHash, createdAt, updatedAt, (updatedBy, isVerified)
+const V1_IDENTITIES_SLOT = 0;
+
+const chunk = (items, size) => {
+  const chunks = [];
+  for (let i = 0; i < items.length; i += size) {
+    chunks.push(items.slice(i, i + size));
+  }
+  return chunks;
+};
+
+const resolveV1Address = (networkName) => {
+  if (process.env.V1_CONTRACT_ADDRESS) {
+    return process.env.V1_CONTRACT_ADDRESS;
+  }
+  if (process.env.AVALANCHE_FUJI_CONTRACT_ADDRESS) {
+    return process.env.AVALANCHE_FUJI_CONTRACT_ADDRESS;
+  }
+  const deploymentFile = path.resolve(__dirname, '..', 'blockchain', 'deployments', `${networkName}-deployment.json`);
+  if (fs.existsSync(deploymentFile)) {
+    return JSON.parse(fs.readFileSync(deploymentFile, 'utf8')).contractAddress;
+  }
+  return null;
+};
+
+/**
+ * Query an event filter over [fromBlock, latest] in fixed-size block ranges
+ */
+async function queryEvents(contract, filter, fromBlock, blockRange) {
+  const latest = await hre.ethers.provider.getBlockNumber();
+  const events = [];
+
+  for (let start = fromBlock; start <= latest; start += blockRange) {
+    const end = Math.min(start + blockRange - 1, latest);
+    events.push(...await contract.queryFilter(filter, start, end));
+  }
+  return events;
+}
+
+/**
+ * Read a v1 identity straight from storage (v1 has no getter for every field)
+ */
+async function readV1Identity(v1Address, user) {
+  const { ethers } = hre;
+  const base = ethers.BigNumber.from(ethers.utils.keccak256(
+    ethers.utils.defaultAbiCoder.encode(['address', 'uint256'], [user, V1_IDENTITIES_SLOT])
+  ));
+  const slot = (offset) => ethers.provider.getStorageAt(v1Address, base.add(offset));
+
+  const [biometricHash, professionalDataHash, createdAt, updatedAt, packed] = await Promise.all(
+    [0, 1, 2, 3, 4].map(slot)
+  );
+  const packedValue = ethers.BigNumber.from(packed);
+
+  return {
+    user,
+    biometricHash,
+    professionalDataHash,
+    updatedBy: ethers.utils.getAddress(ethers.utils.hexZeroPad(packedValue.mask(160).toHexString(), 20)),
+    createdAt: ethers.BigNumber.from(createdAt).toNumber(),
+    updatedAt: ethers.BigNumber.from(updatedAt).toNumber(),
+    isVerified: !packedValue.shr(160).mask(8).isZero()
+  };
+}
+
+async function readV1Records(v1, user) {
+  const count = (await v1.getProfessionalRecordCount(user)).toNumber();
+  const records = [];
+
+  for (let i = 0; i < count; i++) {
+    const record = await v1.getProfessionalRecord(user, i);
+    records.push({
+      user,
+      dataHash: record.dataHash,
+      verifier: record.verifier,
+      isVerified: record.isVerified,
+      createdAt: record.createdAt.toNumber(),
+      startDate: record.startDate.toNumber(),
+      endDate: record.endDate.toNumber()
+    });
+  }
+  return records;
+}
+
+/**
+ * Accounts that currently hold each non-USER role on v1 (USER is restored by the identity import)
+ */
+async function readV1Roles(v1, fromBlock, blockRange) {
+  const events = [
+    ...await queryEvents(v1, v1.filters.RoleGranted(), fromBlock, blockRange),
+    ...await queryEvents(v1, v1.filters.RoleRevoked(), fromBlock, blockRange)
+  ];
+  const USER_ROLE = await v1.USER_ROLE();
+  const candidates = new Map();
+
+  for (const event of events) {
+    const { account, role } = event.args;
+    if (role === USER_ROLE) continue;
+    candidates.set(`${role}:${account.toLowerCase()}`, { account, role });
+  }
+
+  const holders = new Map();
+  for (const { account, role } of candidates.values()) {
+    if (await v1.hasRole(account, role)) {
+      if (!holders.has(role)) holders.set(role, []);
+      holders.get(role).push(account);
+    }
+  }
+  return holders;
+}
+
+async function main() {
+  console.log('Starting IdentityManagementV2 deployment and migration...');
+
+  const networkName = hre.network.name;
+  if (networkName !== 'avalanche_fuji') {
+    console.error(`ERROR: You're not deploying to Avalanche Fuji testnet. Current network: ${networkName}`);
+    console.error('Please run with: npx hardhat run --network avalanche_fuji scripts/deploy-avalanche-v2.js');
+    process.exit(1);
+  }
+
+  const [deployer] = await hre.ethers.getSigners();
+  console.log(`Deploying contracts with the account: ${deployer.address}`);
+  console.log(`Account balance: ${hre.ethers.utils.formatEther(await deployer.getBalance())} AVAX`);
+
+  const fromBlock = parseInt(process.env.MIGRATION_FROM_BLOCK || '0', 10);
+  const blockRange = parseInt(process.env.MIGRATION_BLOCK_RANGE || '2048', 10);
+
+  const v1Address = resolveV1Address(networkName);
+  let v1 = null;
+  if (v1Address && (await hre.ethers.provider.getCode(v1Address)) !== '0x') {
+    v1 = await hre.ethers.getContractAt('IdentityManagement', v1Address);
+    console.log(`Migrating from IdentityManagement at ${v1Address}`);
+  } else {
+    console.log('No v1 contract found, deploying without migration');
+  }
+
+  try {
+    // Deploy v2
+    console.log('Deploying IdentityManagementV2 contract...');
+    const IdentityManagementV2 = await hre.ethers.getContractFactory('IdentityManagementV2');
+    const v2 = await IdentityManagementV2.deploy();
+    await v2.deployed();
+    await v2.deployTransaction.wait(CONFIRMATIONS);
+    console.log(`IdentityManagementV2 deployed to: ${v2.address}`);
+
+    const summary = { identities: 0, professionalRecords: 0, roles: 0 };
+
+    if (v1) {
+      // Identities, discovered through IdentityCreated events
+      const created = await queryEvents(v1, v1.filters.IdentityCreated(), fromBlock, blockRange);
+      const users = [...new Set(created.map(event => event.args.user))];
+      console.log(`Found ${users.length} identities on v1`);
+
+      const identities = [];
+      const records = [];
+      for (const user of users) {
+        const identity = await readV1Identity(v1Address, user);
+        if (identity.createdAt === 0) continue;
+        identities.push(identity);
+        records.push(...await readV1Records(v1, user));
+      }
+
+      for (const batch of chunk(identities, IDENTITY_BATCH_SIZE)) {
+        const tx = await v2.importIdentities(batch);
+        await tx.wait(CONFIRMATIONS);
+        summary.identities += batch.length;
+        console.log(`Imported ${summary.identities}/${identities.length} identities (${tx.hash})`);
+      }
+
+      // Records keep their v1 index order because each user's history is read and pushed in order
+      for (const batch of chunk(records, RECORD_BATCH_SIZE)) {
+        const tx = await v2.importProfessionalRecords(batch);
+        await tx.wait(CONFIRMATIONS);
+        summary.professionalRecords += batch.length;
+        console.log(`Imported ${summary.professionalRecords}/${records.length} professional records (${tx.hash})`);
+      }
+
+      // Roles still held on v1
+      const holders = await readV1Roles(v1, fromBlock, blockRange);
+      for (const [role, accounts] of holders) {
+        for (const batch of chunk(accounts, IDENTITY_BATCH_SIZE)) {
+          const tx = await v2.grantRoles(batch, role);
+          await tx.wait(CONFIRMATIONS);
+          summary.roles += batch.length;
+        }
+      }
+      console.log(`Re-granted ${summary.roles} role assignments`);
+    }
+
+    // The deployer needs GOVERNMENT for the backend's verification calls
+    const GOVERNMENT_ROLE = hre.ethers.utils.id('GOVERNMENT');
+    if (!(await v2.hasRole(deployer.address, GOVERNMENT_ROLE))) {
+      const tx = await v2.grantRole(deployer.address, GOVERNMENT_ROLE);
+      await tx.wait(CONFIRMATIONS);
+      console.log('GOVERNMENT_ROLE granted to deployer');
+    }
+
+    if (process.env.MIGRATION_KEEP_OPEN !== 'true') {
+      const tx = await v2.closeMigration();
+      await tx.wait(CONFIRMATIONS);
+      console.log('Migration closed, import functions are now disabled');
+    }
+
+    // Point the backend at v2
+    const envPath = path.resolve(__dirname, '..', '.env');
+    try {
+      let envContent = fs.existsSync(envPath) ? fs.readFileSync(envPath, 'utf8') : '';
+      if (envContent.includes('AVALANCHE_FUJI_CONTRACT_ADDRESS=')) {
+        envContent = envContent.replace(
+          /AVALANCHE_FUJI_CONTRACT_ADDRESS=.*/,
+          `AVALANCHE_FUJI_CONTRACT_ADDRESS=${v2.address}`
+        );
+      } else {
+        envContent += `\nAVALANCHE_FUJI_CONTRACT_ADDRESS=${v2.address}\n`;
+      }
+      fs.writeFileSync(envPath, envContent);
+      console.log(`.env file updated with contract address: ${v2.address}`);
+    } catch (error) {
+      console.error('Error updating .env file:', error);
+    }
+
+    // Save deployment info next to the v1 deployment file
+    const deploymentInfo = {
+      network: networkName,
+      contract: 'IdentityManagementV2',
+      contractAddress: v2.address,
+      migratedFrom: v1 ? v1Address : null,
+      migrated: summary,
+      migrationClosed: await v2.migrationClosed(),
+      deploymentTime: new Date().toISOString(),
+      deployer: deployer.address
+    };
+
+    const deploymentDir = path.resolve(__dirname, '..', 'blockchain', 'deployments');
+    if (!fs.existsSync(deploymentDir)) {
+      fs.mkdirSync(deploymentDir, { recursive: true });
+    }
+
+    const deploymentFile = path.resolve(deploymentDir, `${networkName}-v2-deployment.json`);
+    fs.writeFileSync(deploymentFile, JSON.stringify(deploymentInfo, null, 2));
+    console.log(`Deployment information saved to ${deploymentFile}`);
+
+    console.log('----------------------------------------------');
+    console.log('Summary:');
+    console.log(`- Network: ${networkName}`);
+    console.log(`- IdentityManagementV2 contract: ${v2.address}`);
+    console.log(`- Migrated from: ${deploymentInfo.migratedFrom || 'n/a'}`);
+    console.log(`- Identities: ${summary.identities}, records: ${summary.professionalRecords}, roles: ${summary.roles}`);
+    console.log('----------------------------------------------');
+    console.log('Restart the backend and the blockchain worker to pick up the new address');
+    console.log(`View on Snowtrace: https://testnet.snowtrace.io/address/${v2.address}`);
+
+    return deploymentInfo;
+  } catch (error) {
+    console.error('Deployment failed:', error);
+    process.exit(1);
+  }
+}
+
+// Execute the deployment
+if (require.main === module) {
+  main()
+    .then(() => process.exit(0))
+    .catch((error) => {
+      console.error('Deployment failed:', error);
+      process.exit(1);
+    });
+} else {
+  module.exports = main;
+}
@@ -0,0 +1,110 @@
+/**
+ * Migration script: convert biometric_data.facemesh_data JSONB into binary facemesh templates
+ * Usage: node scripts/run_facemesh_template_migration.js [--drop-json]
+ *   --drop-json  Clear facemesh_data once a row has been converted
+ */
+const { Pool } = require('pg');
+const fs = require('fs');
+const path = require('path');
+const dotenv = require('dotenv');
+const { encodeFacemeshTemplate } = require('../utils/facemesh-template.utils');
+
+// Load environment variables
+dotenv.config();
+
+const MIGRATION_NAME = 'add_facemesh_template';
+const BATCH_SIZE = 500;
+const dropJson = process.argv.includes('--drop-json');
+
+// Create database connection pool
+const pool = new Pool({
+  user: process.env.DB_USER || 'postgres',
+  host: process.env.DB_HOST || 'localhost',
+  database: process.env.DB_NAME || 'dbis',
+  password: process.env.DB_PASSWORD || 'postgres',
+  port: process.env.DB_PORT || 5432,
+  ssl: process.env.DB_SSL === 'true' ? { rejectUnauthorized: false } : false
+});
+
+async function convertRows() {
+  let lastId = 0;
+  let converted = 0;
+  let skipped = 0;
+
+  for (;;) {
+    const result = await pool.query(
+      `SELECT id, facemesh_data
+       FROM biometric_data
+       WHERE facemesh_template IS NULL AND facemesh_data IS NOT NULL AND id > $1
+       ORDER BY id
+       LIMIT $2`,
+      [lastId, BATCH_SIZE]
+    );
+
+    if (result.rows.length === 0) break;
+
+    for (const row of result.rows) {
+      let template;
+      try {
+        template = encodeFacemeshTemplate(row.facemesh_data.landmarks);
+      } catch (error) {
+        console.warn(`Skipping biometric_data ${row.id}: ${error.message}`);
+        skipped++;
+        continue;
+      }
+
+      await pool.query(
+        `UPDATE biometric_data
+         SET facemesh_template = $1${dropJson ? ', facemesh_data = NULL' : ''}
+         WHERE id = $2`,
+        [template, row.id]
+      );
+      converted++;
+    }
+
+    lastId = result.rows[result.rows.length - 1].id;
+    console.log(`Converted ${converted} rows so far (last id ${lastId})`);
+  }
+
+  return { converted, skipped };
+}
+
+async function runMigration() {
+  try {
+    // Check if migration was already applied
+    const checkResult = await pool.query(
+      'SELECT COUNT(*) FROM migrations WHERE name = $1',
+      [MIGRATION_NAME]
+    );
+
+    if (parseInt(checkResult.rows[0].count) === 0) {
+      console.log('Reading migration file...');
+      const migrationPath = path.resolve(__dirname, '..', 'migrations', `${MIGRATION_NAME}.sql`);
+      const migration = fs.readFileSync(migrationPath, 'utf8');
+
+      console.log('Running facemesh_template migration...');
+      await pool.query(migration);
+
+      // Log the migration in migrations table
+      await pool.query(
+        'INSERT INTO migrations (name, applied_at) VALUES ($1, NOW())',
+        [MIGRATION_NAME]
+      );
+    } else {
+      console.log('Schema migration was already applied, converting remaining rows');
+    }
+
+    // Conversion is idempotent, so it is safe to re-run after an interruption
+    const { converted, skipped } = await convertRows();
+    console.log(`Migration completed successfully: ${converted} converted, ${skipped} skipped`);
+    process.exitCode = 0;
+  } catch (error) {
+    console.error('Migration failed:', error);
+    process.exitCode = 1;
+  } finally {
+    await pool.end();
+  }
+}
+
+// Run the migration
+runMigration();
@@ -0,0 +1,68 @@
+/**
+ * Migration script: apply a SQL file from migrations/ once
+ * Usage: node scripts/run_sql_migration.js <migration_name>
+ *   e.g. node scripts/run_sql_migration.js add_blockchain_jobs
+ */
+const { Pool } = require('pg');
+const fs = require('fs');
+const path = require('path');
+const dotenv = require('dotenv');
+
+// Load environment variables
+dotenv.config();
+
+const migrationName = process.argv[2];
+if (!migrationName) {
+  console.error('Usage: node scripts/run_sql_migration.js <migration_name>');
+  process.exit(1);
+}
+
+// Create database connection pool
+const pool = new Pool({
+  user: process.env.DB_USER || 'postgres',
+  host: process.env.DB_HOST || 'localhost',
+  database: process.env.DB_NAME || 'dbis',
+  password: process.env.DB_PASSWORD || 'postgres',
+  port: process.env.DB_PORT || 5432,
+  ssl: process.env.DB_SSL === 'true' ? { rejectUnauthorized: false } : false
+});
+
+async function runMigration() {
+  try {
+    // Check if migration was already applied
+    const checkResult = await pool.query(
+      'SELECT COUNT(*) FROM migrations WHERE name = $1',
+      [migrationName]
+    );
+
+    if (parseInt(checkResult.rows[0].count) > 0) {
+      console.log(`Migration ${migrationName} was already applied`);
+      process.exitCode = 0;
+      return;
+    }
+
+    console.log('Reading migration file...');
+    const migrationPath = path.resolve(__dirname, '..', 'migrations', `${migrationName}.sql`);
+    const migration = fs.readFileSync(migrationPath, 'utf8');
+
+    console.log(`Running ${migrationName} migration...`);
+    await pool.query(migration);
+
+    // Log the migration in migrations table
+    await pool.query(
+      'INSERT INTO migrations (name, applied_at) VALUES ($1, NOW())',
+      [migrationName]
+    );
+
+    console.log('Migration completed successfully');
+    process.exitCode = 0;
+  } catch (error) {
+    console.error('Migration failed:', error);
+    process.exitCode = 1;
+  } finally {
+    await pool.end();
+  }
+}
+
+// Run the migration
+runMigration();
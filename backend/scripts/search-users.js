@@ -19,6 +19,9 @@ console.log('Using database configuration:', {
 
 const pool = new Pool(dbConfig);
 
+// Patterns match lower(column) so the trigram indexes from add_user_search.sql can serve them
+const escapeLike = (value) => value.replace(/[\\%_]/g, '\\$&');
+
 /**
  * Search users based on various criteria
  * @param {Object} criteria - Search criteria
@@ -35,20 +38,20 @@ async function searchUsers(criteria) {
     let paramCount = 1;
 
     if (criteria.username) {
-      conditions.push(`u.username ILIKE $${paramCount}`);
-      values.push(`%${criteria.username}%`);
+      conditions.push(`lower(u.username) LIKE $${paramCount}`);
+      values.push(`%${escapeLike(criteria.username.toLowerCase())}%`);
       paramCount++;
     }
 
     if (criteria.email) {
-      conditions.push(`u.email ILIKE $${paramCount}`);
-      values.push(`%${criteria.email}%`);
+      conditions.push(`lower(u.email) LIKE $${paramCount}`);
+      values.push(`%${escapeLike(criteria.email.toLowerCase())}%`);
       paramCount++;
     }
 
     if (criteria.governmentId) {
-      conditions.push(`u.government_id ILIKE $${paramCount}`);
-      values.push(`%${criteria.governmentId}%`);
+      conditions.push(`lower(u.government_id) LIKE $${paramCount}`);
+      values.push(`%${escapeLike(criteria.governmentId.toLowerCase())}%`);
       paramCount++;
     }
 
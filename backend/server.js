@@ -4,20 +4,45 @@
  */
 
 const express = require('express');
-const morgan = require('morgan');
 const helmet = require('helmet');
 const dbService = require('./services/db.service');
+const facemeshIndex = require('./services/facemesh-index.service');
+const blockchainQueue = require('./services/blockchain-queue.service');
+const chainIndexer = require('./services/chain-indexer.service');
+const blockchainExpiry = require('./services/blockchain-expiry.service');
+const statsService = require('./services/stats.service');
+const changeFeed = require('./services/change-feed.service');
+const leader = require('./services/leader.service');
+const passwordHash = require('./services/password-hash.service');
+const auditLog = require('./services/audit-log.service');
+const rpcPool = require('./services/rpc-pool.service');
 const config = require('./config/config');
+const { logger } = require('./utils/logger.utils');
+const { requestLogger } = require('./middleware/request-logger.middleware');
+const { metricsMiddleware } = require('./middleware/metrics.middleware');
+const { registry, renderCluster: renderMetrics, CONTENT_TYPE: METRICS_CONTENT_TYPE } = require('./utils/metrics.utils');
+const tracing = require('./utils/tracing.utils');
 const path = require('path');
 const fs = require('fs');
+const crypto = require('crypto');
 const cors = require('cors');
 
+// Export spans when OTEL_EXPORTER_OTLP_ENDPOINT is set and the OpenTelemetry SDK is installed
+if (tracing.initTracing()) {
+  logger.info(`Exporting traces to ${process.env.OTEL_EXPORTER_OTLP_ENDPOINT}`);
+}
+
 // Create Express app
 const app = express();
-// Explicitly set port to 5000
-const PORT = 5000; // Using port 5000 as specified
+// Port 5000 unless overridden; cluster workers (cluster.js) all share it
+const PORT = parseInt(process.env.PORT || '5000', 10);
+
+// In-flight requests get this long to finish on SIGTERM before the process exits
+const SHUTDOWN_TIMEOUT_MS = parseInt(process.env.SHUTDOWN_TIMEOUT_MS || '25000', 10);
 
 // Middleware
+app.use(requestLogger()); // Request ids and one sampled structured line per request
+app.use(metricsMiddleware()); // Per-route latency histograms and request spans
 app.use(helmet()); // Security headers
 
 // Custom CORS headers
@@ -40,52 +65,72 @@ app.use((req, res, next) => {
   next();
 });
 
-// Custom logging middleware to reduce verbosity
-app.use(morgan('combined', {
-  skip: function (req, res) {
-    // Skip logging for frequent GET requests to users endpoint
-    return req.method === 'GET' && req.path.includes('/api/admin/users');
-  }
-}));
-
-app.use(morgan('dev')); // Request logging
 app.use(express.json()); // Parse JSON request body
 
 // Database service is already initialized and will handle connections automatically
 
 // Listen for database connection events
 dbService.on('connected', () => {
-  console.log('Database service connected successfully');
+  logger.info('Database service connected successfully');
+
+  // Load enrolled templates for duplicate-enrollment detection; enrollments get 503 until it is ready
+  facemeshIndex.buildWithRetry(dbService);
+
+  // Write audit entries spooled while the database was unreachable
+  auditLog.start(dbService).catch(err => logger.error('Audit log spool replay failed:', err));
 });
 
 dbService.on('error', (err) => {
-  console.error('Database service error:', err);
+  logger.error('Database service error:', err);
 });
 
 // Log database connection status
-console.log('Database service initialized with connection pooling and circuit breaker');
-console.log(`Using database host: ${config.DB_HOST}`);
+logger.info('Database service initialized with connection pooling and circuit breaker');
+logger.info(`Using database host: ${config.DB_HOST}`);
 
 // Set up automatic reconnection attempts in case of failure
 setInterval(() => {
   if (!dbService.isConnected) {
-    console.log('Attempting to reconnect to database...');
+    logger.info('Attempting to reconnect to database...');
     dbService.testConnection();
   }
 }, 60000); // Check every minute
 
-// Create a simple logger
-const logger = {
-  info: (message, ...args) => console.log(`[INFO] ${message}`, ...args),
-  error: (message, ...args) => console.error(`[ERROR] ${message}`, ...args),
-  warn: (message, ...args) => console.warn(`[WARN] ${message}`, ...args),
-  debug: (message, ...args) => console.debug(`[DEBUG] ${message}`, ...args)
-};
-
 // Make db service and logger available to routes
 app.locals.db = dbService;
 app.locals.logger = logger;
 
+// Subsystem gauges read from the services' own counters at scrape time
+registry.gauge('dbis_password_hash_tasks', 'Password hash pool tasks by state', ['state'], (gauge) => {
+  const stats = passwordHash.getStats();
+  gauge.set({ state: 'busy' }, stats.busy);
+  gauge.set({ state: 'queued' }, stats.queued);
+});
+registry.gauge('dbis_audit_log_buffered', 'Audit entries waiting to be written', [], (gauge) => {
+  gauge.set({}, auditLog.getStats().buffered);
+});
+registry.gauge('dbis_log_lines_dropped', 'Log lines dropped because the destination fell behind', [], (gauge) => {
+  gauge.set({}, logger.getStats().dropped);
+});
+
+/**
+ * Prometheus scrape endpoint; served while the database is down, since that is when it matters.
+ * In cluster mode it covers every worker on the host, labelled by pid.
+ * Set METRICS_TOKEN to require "Authorization: Bearer <token>"
+ */
+app.get('/metrics', async (req, res) => {
+  const token = process.env.METRICS_TOKEN;
+  if (token) {
+    const expected = Buffer.from(`Bearer ${token}`);
+    const given = Buffer.from(req.headers.authorization || '');
+    if (given.length !== expected.length || !crypto.timingSafeEqual(given, expected)) {
+      return res.status(401).json({ message: 'Metrics token required' });
+    }
+  }
+  res.set('Content-Type', METRICS_CONTENT_TYPE);
+  res.send(await renderMetrics());
+});
+
 // Add database connection check middleware
 app.use(async (req, res, next) => {
   if (!dbService.getConnectionStatus()) {
@@ -121,7 +166,8 @@ app.use('/api/documents', documentRoutes);
 const uploadDir = path.join(__dirname, 'uploads/documents');
 fs.mkdirSync(uploadDir, { recursive: true });
 
-// Serve uploaded files
+// Stored documents are only served through signed /api/documents/content links
+app.use('/uploads/documents', (req, res) => res.status(404).json({ message: 'Not found' }));
 app.use('/uploads', express.static(path.join(__dirname, 'uploads')));
 
 // Health check endpoint
@@ -131,6 +177,12 @@ app.get('/api/health', (req, res) => {
     status: 'ok',
     timestamp: new Date(),
     database: dbStatus,
+    pool: dbService.getPoolStats(),
+    passwordHashing: passwordHash.getStats(),
+    auditLog: auditLog.getStats(),
+    logging: logger.getStats(),
+    rpc: rpcPool.getStats(),
+    facemeshIndex: facemeshIndex.getStats(),
     uptime: process.uptime()
   });
 });
@@ -145,33 +197,143 @@ app.get('/', (req, res) => {
 
 // Error handling middleware
 app.use((err, req, res, next) => {
-  console.error(err.stack);
+  logger.error('Unhandled request error:', err);
   res.status(500).json({
     error: 'Internal Server Error',
     message: config.NODE_ENV === 'development' ? err.message : 'Something went wrong'
   });
 });
 
+/**
+ * Start the periodic background jobs in this process
+ * Each can be disabled on its own with its *_ENABLED=false toggle
+ */
+const startBackgroundJobs = () => {
+  // Drain queued blockchain writes in-process unless dedicated workers are deployed
+  // (see scripts/blockchain-worker.js)
+  if (process.env.BLOCKCHAIN_WORKER_ENABLED !== 'false') {
+    blockchainQueue.startWorker(dbService);
+  }
+
+  // Mirror contract events into Postgres for the read endpoints (see scripts/chain-indexer.js)
+  if (process.env.CHAIN_INDEXER_ENABLED !== 'false') {
+    chainIndexer.startIndexer(dbService);
+  }
+
+  // Expire PENDING blockchain statuses past their 48-hour window
+  if (process.env.BLOCKCHAIN_EXPIRY_SCHEDULER_ENABLED !== 'false') {
+    blockchainExpiry.startScheduler(dbService);
+  }
+
+  // Refresh the dashboard's daily rollups
+  if (process.env.STATS_ROLLUP_ENABLED !== 'false') {
+    statsService.startRollups(dbService);
+  }
+
+  // Create audit_logs partitions for the coming months
+  if (process.env.AUDIT_PARTITION_MAINTENANCE_ENABLED !== 'false') {
+    auditLog.startPartitionMaintenance(dbService);
+  }
+};
+
+const stopBackgroundJobs = () => Promise.all([
+  blockchainQueue.stopWorker(),
+  chainIndexer.stopIndexer(),
+  blockchainExpiry.stopScheduler(),
+  statsService.stopRollups(),
+  auditLog.stopPartitionMaintenance()
+]);
+
+let server = null;
+let shuttingDown = false;
+
+// Election events can arrive while jobs are still stopping, so starts and
+// stops run one after another instead of racing on the same job instances
+let jobTransition = Promise.resolve();
+const transitionJobs = (change) => {
+  jobTransition = jobTransition
+    .then(change)
+    .catch(err => logger.error('Failed to change background jobs:', err));
+  return jobTransition;
+};
+
 // Start server only after database is connected
 const startServer = async () => {
   // Wait for database connection
   if (!dbService.getConnectionStatus()) {
-    console.log('Waiting for database connection...');
+    logger.info('Waiting for database connection...');
     await new Promise((resolve) => {
       dbService.once('connected', resolve);
     });
   }
   
   // Start the server
-  app.listen(PORT, () => {
-    console.log(`Server running on port ${PORT}`);
-    console.log(`Database connected successfully to ${config.DB_HOST}`);
+  server = app.listen(PORT, () => {
+    logger.info(`Server running on port ${PORT}`);
+    logger.info(`Database connected successfully to ${config.DB_HOST}`);
   });
+
+  // Only the elected leader among all API processes runs the background jobs,
+  // so cluster workers and extra hosts do not duplicate them
+  if (process.env.LEADER_ELECTION_ENABLED === 'false') {
+    startBackgroundJobs();
+  } else {
+    const election = leader.startElection(dbService);
+    election.on('elected', () => {
+      transitionJobs(() => {
+        if (!shuttingDown) startBackgroundJobs();
+      });
+    });
+    election.on('demoted', () => transitionJobs(stopBackgroundJobs));
+  }
 };
 
+/**
+ * Drain and exit: stop accepting connections, let in-flight requests finish,
+ * stop the background jobs, hand leadership over, flush the audit log and
+ * close the pool
+ */
+const shutdown = async (signal) => {
+  if (shuttingDown) return;
+  shuttingDown = true;
+  logger.info(`${signal} received, draining`);
+
+  setTimeout(() => {
+    logger.error(`Shutdown did not finish within ${SHUTDOWN_TIMEOUT_MS}ms, exiting`);
+    process.exit(1);
+  }, SHUTDOWN_TIMEOUT_MS).unref();
+
+  const closed = server
+    ? new Promise(resolve => server.close(resolve))
+    : Promise.resolve();
+  // Event streams never finish on their own, and idle keep-alive sockets would hold close() open
+  changeFeed.closeAll();
+  if (server && server.closeIdleConnections) {
+    server.closeIdleConnections();
+  }
+
+  try {
+    await Promise.all([closed, transitionJobs(stopBackgroundJobs)]);
+    await leader.stopElection();
+    // Buffered audit entries are written before the pool closes
+    await auditLog.close();
+    if (dbService.pool) {
+      await dbService.pool.end();
+    }
+    await tracing.shutdownTracing();
+    process.exit(0);
+  } catch (err) {
+    logger.error('Error during shutdown:', err);
+    process.exit(1);
+  }
+};
+
+process.on('SIGTERM', () => shutdown('SIGTERM'));
+process.on('SIGINT', () => shutdown('SIGINT'));
+
 // Start the server
 startServer().catch(err => {
-  console.error('Failed to start server:', err);
+  logger.fatal('Failed to start server:', err);
   process.exit(1);
 });
 
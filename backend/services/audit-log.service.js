@@ -0,0 +1,412 @@
+/**
+ * Audit log writer for DBIS
+ * Request handlers hand entries to record(), which returns immediately.
+ * Entries are buffered and written with one multi-row INSERT per batch, when
+ * AUDIT_BATCH_SIZE entries are waiting or AUDIT_FLUSH_INTERVAL_MS after the
+ * first one, instead of one INSERT round trip per request. Each entry keeps
+ * the time it was recorded as created_at.
+ *
+ * A batch that cannot be written (database unreachable, pool exhausted) is
+ * saved as a spool file under AUDIT_SPOOL_DIR, and entries still buffered when
+ * the process exits are spooled synchronously. Spool files are replayed on
+ * start and after later successful flushes; a file is claimed by renaming it,
+ * so processes sharing the directory do not replay it twice.
+ *
+ * Entries that must commit or roll back with a transaction are still
+ * inserted on the transaction's client rather than through this writer.
+ *
+ * audit_logs is partitioned by month (migrations/partition_audit_logs.sql);
+ * the leader keeps partitions created ahead with startPartitionMaintenance.
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { IntervalJob } = require('../utils/scheduler.utils');
+const { logger } = require('../utils/logger.utils');
+
+const BATCH_SIZE = parseInt(process.env.AUDIT_BATCH_SIZE || '200', 10);
+const FLUSH_INTERVAL_MS = parseInt(process.env.AUDIT_FLUSH_INTERVAL_MS || '250', 10);
+// Entries held in memory while a flush is slow; beyond this they go straight to the spool
+const MAX_BUFFER = parseInt(process.env.AUDIT_MAX_BUFFER || '10000', 10);
+const SPOOL_DIR = process.env.AUDIT_SPOOL_DIR || path.join(process.cwd(), 'logs', 'audit-spool');
+const REPLAY_INTERVAL_MS = parseInt(process.env.AUDIT_REPLAY_INTERVAL_MS || '30000', 10);
+
+// A claimed spool file untouched for this long belonged to a process that died mid-replay
+const STALE_CLAIM_MS = 5 * 60 * 1000;
+
+const SPOOL_SUFFIX = '.jsonl';
+const CLAIM_SUFFIX = '.replaying';
+
+const DEFAULT_MAINTENANCE_OPTIONS = {
+  interval: parseInt(process.env.AUDIT_PARTITION_INTERVAL_MS || String(6 * 60 * 60 * 1000), 10),
+  monthsAhead: parseInt(process.env.AUDIT_PARTITION_MONTHS_AHEAD || '3', 10)
+};
+
+// One row per array element; timestamptz converts recorded UTC times to the column's local time
+const INSERT_SQL = `
+  INSERT INTO audit_logs (user_id, admin_id, action, entity_type, entity_id, details, ip_address, created_at)
+  SELECT * FROM unnest(
+    $1::int[], $2::int[], $3::varchar[], $4::varchar[], $5::int[], $6::jsonb[], $7::varchar[], $8::timestamptz[]
+  )`;
+
+const toRow = (entry) => ({
+  userId: entry.userId || null,
+  adminId: entry.adminId || null,
+  action: entry.action,
+  entityType: entry.entityType,
+  entityId: entry.entityId || null,
+  details: entry.details === undefined || entry.details === null
+    ? null
+    : (typeof entry.details === 'string' ? entry.details : JSON.stringify(entry.details)),
+  ipAddress: entry.ipAddress || null,
+  createdAt: (entry.createdAt || new Date()).toISOString()
+});
+
+/**
+ * Write rows with a single INSERT
+ * @param {Object} db - Database service
+ * @param {Array} rows - Rows from toRow
+ */
+const insertRows = (db, rows) => db.query(INSERT_SQL, [
+  rows.map(row => row.userId),
+  rows.map(row => row.adminId),
+  rows.map(row => row.action),
+  rows.map(row => row.entityType),
+  rows.map(row => row.entityId),
+  rows.map(row => row.details),
+  rows.map(row => row.ipAddress),
+  rows.map(row => row.createdAt)
+]);
+
+class AuditLogWriter {
+  constructor(db, options = {}) {
+    this.db = db;
+    this.batchSize = options.batchSize || BATCH_SIZE;
+    this.flushInterval = options.flushInterval !== undefined ? options.flushInterval : FLUSH_INTERVAL_MS;
+    this.maxBuffer = options.maxBuffer || MAX_BUFFER;
+    this.spoolDir = options.spoolDir || SPOOL_DIR;
+    this.buffer = [];
+    this.timer = null;
+    this.flushing = null;
+    this.inFlight = [];
+    this.replaying = null;
+    this.lastReplayAt = 0;
+    this.spoolSeq = 0;
+    this.stats = { recorded: 0, written: 0, batches: 0, failedBatches: 0, spooled: 0, replayed: 0, lost: 0 };
+
+    this.onExit = () => this.spoolSync();
+    process.on('exit', this.onExit);
+  }
+
+  /**
+   * Buffer an entry for the next batch
+   * @param {Object} entry - userId, adminId, action, entityType, entityId, details, ipAddress
+   */
+  record(entry) {
+    this.buffer.push(toRow(entry));
+    this.stats.recorded++;
+
+    if (this.buffer.length >= this.maxBuffer) {
+      this.spool(this.buffer.splice(0, this.buffer.length - this.batchSize));
+    }
+    if (this.buffer.length >= this.batchSize) {
+      this.flush();
+    } else if (!this.timer) {
+      this.timer = setTimeout(() => {
+        this.timer = null;
+        this.flush();
+      }, this.flushInterval);
+      this.timer.unref();
+    }
+  }
+
+  /**
+   * Write the next batch; one flush runs at a time and the rest follow it
+   * @returns {Promise} Resolves when the batch is written or spooled
+   */
+  flush() {
+    if (this.flushing) return this.flushing;
+    if (this.buffer.length === 0) return Promise.resolve();
+
+    clearTimeout(this.timer);
+    this.timer = null;
+    const batch = this.buffer.splice(0, this.batchSize);
+    this.inFlight = batch;
+
+    this.flushing = insertRows(this.db, batch)
+      .then(() => {
+        this.stats.written += batch.length;
+        this.stats.batches++;
+        if (Date.now() - this.lastReplayAt >= REPLAY_INTERVAL_MS) {
+          this.replay();
+        }
+      })
+      .catch((error) => {
+        this.stats.failedBatches++;
+        logger.error(`Audit log flush failed, spooling ${batch.length} entries:`, error.message);
+        return this.spool(batch);
+      })
+      .finally(() => {
+        this.flushing = null;
+        this.inFlight = [];
+        if (this.buffer.length >= this.batchSize) {
+          this.flush();
+        } else if (this.buffer.length > 0 && !this.timer) {
+          this.timer = setTimeout(() => {
+            this.timer = null;
+            this.flush();
+          }, this.flushInterval);
+          this.timer.unref();
+        }
+      });
+    return this.flushing;
+  }
+
+  spoolPath() {
+    return path.join(this.spoolDir, `audit-${process.pid}-${Date.now()}-${this.spoolSeq++}${SPOOL_SUFFIX}`);
+  }
+
+  /**
+   * Save rows to a new spool file; written under a temporary name, so a
+   * spool file is always complete
+   * @param {Array} rows - Rows from toRow
+   */
+  async spool(rows) {
+    if (rows.length === 0) return;
+    const file = this.spoolPath();
+    try {
+      await fs.promises.mkdir(this.spoolDir, { recursive: true });
+      await fs.promises.writeFile(`${file}.tmp`, rows.map(row => JSON.stringify(row)).join('\n') + '\n');
+      await fs.promises.rename(`${file}.tmp`, file);
+      this.stats.spooled += rows.length;
+    } catch (error) {
+      this.stats.lost += rows.length;
+      logger.error(`Failed to spool ${rows.length} audit log entries:`, error);
+    }
+  }
+
+  /**
+   * Spool whatever is still buffered; runs on process exit, so synchronous.
+   * A batch whose INSERT was cut short is spooled too and may be written twice
+   */
+  spoolSync() {
+    clearTimeout(this.timer);
+    this.timer = null;
+    const rows = this.inFlight.concat(this.buffer.splice(0));
+    this.inFlight = [];
+    if (rows.length === 0) return;
+    const file = this.spoolPath();
+    try {
+      fs.mkdirSync(this.spoolDir, { recursive: true });
+      fs.writeFileSync(`${file}.tmp`, rows.map(row => JSON.stringify(row)).join('\n') + '\n');
+      fs.renameSync(`${file}.tmp`, file);
+      this.stats.spooled += rows.length;
+    } catch (error) {
+      this.stats.lost += rows.length;
+      logger.error(`Failed to spool ${rows.length} audit log entries on exit:`, error);
+    }
+  }
+
+  /**
+   * Claim a spool file by renaming it
+   * @param {String} file - Spool file, or a stale claim
+   * @returns {String|null} Claimed name, or null if another process got it first
+   */
+  async claim(file) {
+    const base = file.endsWith(SPOOL_SUFFIX) ? file : file.slice(0, file.indexOf(CLAIM_SUFFIX));
+    const claimed = `${base}${CLAIM_SUFFIX}.${process.pid}`;
+    try {
+      await fs.promises.rename(path.join(this.spoolDir, file), path.join(this.spoolDir, claimed));
+      const now = new Date();
+      await fs.promises.utimes(path.join(this.spoolDir, claimed), now, now);
+      return claimed;
+    } catch (error) {
+      return null;
+    }
+  }
+
+  /**
+   * Insert spooled entries, one spool file at a time
+   * @returns {Promise<Number>} Entries replayed
+   */
+  replay() {
+    if (!this.replaying) {
+      this.lastReplayAt = Date.now();
+      this.replaying = this.replaySpool().finally(() => {
+        this.replaying = null;
+      });
+    }
+    return this.replaying;
+  }
+
+  async replaySpool() {
+    let files;
+    try {
+      files = await fs.promises.readdir(this.spoolDir);
+    } catch (error) {
+      // Nothing was ever spooled
+      return 0;
+    }
+
+    let replayed = 0;
+    for (const file of files.sort()) {
+      let claimable = file.endsWith(SPOOL_SUFFIX);
+      if (!claimable && file.includes(CLAIM_SUFFIX)) {
+        const stat = await fs.promises.stat(path.join(this.spoolDir, file)).catch(() => null);
+        claimable = stat !== null && Date.now() - stat.mtimeMs > STALE_CLAIM_MS;
+      }
+      if (!claimable) continue;
+
+      const claimed = await this.claim(file);
+      if (!claimed) continue;
+      const claimedPath = path.join(this.spoolDir, claimed);
+
+      try {
+        const rows = (await fs.promises.readFile(claimedPath, 'utf8'))
+          .split('\n')
+          .filter(line => line.length > 0)
+          .map(line => JSON.parse(line));
+        for (let i = 0; i < rows.length; i += this.batchSize) {
+          await insertRows(this.db, rows.slice(i, i + this.batchSize));
+        }
+        await fs.promises.unlink(claimedPath);
+        replayed += rows.length;
+        this.stats.replayed += rows.length;
+      } catch (error) {
+        // Hand the file back for the next attempt
+        logger.error(`Audit log spool replay failed for ${claimed}:`, error.message);
+        const base = claimed.slice(0, claimed.indexOf(CLAIM_SUFFIX));
+        await fs.promises.rename(claimedPath, path.join(this.spoolDir, base)).catch(() => {});
+        break;
+      }
+    }
+    if (replayed > 0) {
+      logger.info(`Replayed ${replayed} spooled audit log entries`);
+    }
+    return replayed;
+  }
+
+  getStats() {
+    return {
+      buffered: this.buffer.length,
+      batchSize: this.batchSize,
+      ...this.stats
+    };
+  }
+
+  /**
+   * Write everything still buffered and wait for a running replay
+   */
+  async close() {
+    clearTimeout(this.timer);
+    this.timer = null;
+    while (this.flushing || this.buffer.length > 0) {
+      await (this.flushing || this.flush());
+    }
+    if (this.replaying) {
+      await this.replaying;
+    }
+    process.removeListener('exit', this.onExit);
+  }
+}
+
+let writer = null;
+
+const writerFor = (db) => {
+  if (!writer) {
+    writer = new AuditLogWriter(db);
+    // Entries spooled by an earlier run
+    writer.replay();
+  }
+  return writer;
+};
+
+/**
+ * Queue an audit log entry; it is written with the next batch
+ * @param {Object} db - Database service
+ * @param {Object} entry - userId, adminId, action, entityType, entityId, details, ipAddress
+ */
+exports.record = (db, entry) => {
+  writerFor(db).record(entry);
+};
+
+/**
+ * Start the shared writer and replay entries spooled by an earlier run
+ * @param {Object} db - Database service
+ * @returns {Promise<Number>} Entries replayed
+ */
+exports.start = (db) => writerFor(db).replay();
+
+exports.flush = () => (writer ? writer.flush() : Promise.resolve());
+
+exports.getStats = () => (writer ? writer.getStats() : null);
+
+/**
+ * Write everything still buffered; call before the pool is closed
+ */
+exports.close = async () => {
+  if (writer) {
+    await writer.close();
+    writer = null;
+  }
+};
+
+/**
+ * Keeps audit_logs partitions created ahead of time
+ */
+class AuditPartitionMaintainer extends IntervalJob {
+  constructor(db, options = {}) {
+    const merged = { ...DEFAULT_MAINTENANCE_OPTIONS, ...options };
+    super({ name: 'Audit log partition maintenance', interval: merged.interval });
+    this.db = db;
+    this.options = merged;
+  }
+
+  start() {
+    if (!this.running) {
+      logger.info(`Audit log partition maintenance started (every ${this.options.interval}ms)`);
+    }
+    return super.start();
+  }
+
+  async run() {
+    const result = await this.db.query(
+      'SELECT audit_logs_ensure_partitions($1) AS created',
+      [this.options.monthsAhead]
+    );
+    const created = result.rows[0].created;
+    if (created > 0) {
+      logger.info(`Created ${created} audit log partition(s)`);
+    }
+  }
+}
+
+let maintainer = null;
+
+/**
+ * Start the shared partition maintenance schedule
+ * @param {Object} db - Database service
+ * @param {Object} options - interval, monthsAhead
+ * @returns {AuditPartitionMaintainer} Running maintainer
+ */
+exports.startPartitionMaintenance = (db, options = {}) => {
+  if (!maintainer) {
+    maintainer = new AuditPartitionMaintainer(db, options);
+  }
+  return maintainer.start();
+};
+
+/**
+ * Stop the partition maintenance schedule, waiting for a running check to finish
+ */
+exports.stopPartitionMaintenance = async () => {
+  if (maintainer) {
+    // Clear it first so a start() during the wait gets a fresh instance
+    const stopping = maintainer;
+    maintainer = null;
+    await stopping.stop();
+  }
+};
+
+exports.AuditLogWriter = AuditLogWriter;
+exports.AuditPartitionMaintainer = AuditPartitionMaintainer;
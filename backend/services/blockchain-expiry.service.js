@@ -0,0 +1,355 @@
+/**
+ * Blockchain expiry sweep for DBIS
+ * Users who were verified but never got their identity on-chain within the
+ * 48-hour window are moved out of PENDING: CONFIRMED if the identity turns out
+ * to exist on-chain after all, EXPIRED otherwise, with the unused verification
+ * funding queued for refund to the admin wallet.
+ *
+ * The sweep walks expired users in (blockchain_expiry, id) keyset order, one
+ * short transaction per chunk. Rows are claimed with SKIP LOCKED so overlapping
+ * sweeps split the work, on-chain existence is read once per chunk, and the
+ * position is checkpointed in scheduled_tasks so an interrupted sweep resumes
+ * where it stopped instead of starting over.
+ */
+const ethers = require('ethers');
+const blockchainQueue = require('./blockchain-queue.service');
+const chainIndexer = require('./chain-indexer.service');
+const { IntervalJob } = require('../utils/scheduler.utils');
+const { logger } = require('../utils/logger.utils');
+
+const TASK_NAME = 'blockchain_expiry';
+
+const DEFAULT_OPTIONS = {
+  interval: parseInt(process.env.BLOCKCHAIN_EXPIRY_INTERVAL_MS || '300000', 10),
+  chunkSize: parseInt(process.env.BLOCKCHAIN_EXPIRY_CHUNK_SIZE || '100', 10),
+  concurrency: parseInt(process.env.BLOCKCHAIN_EXPIRY_CONCURRENCY || '2', 10),
+  // Blocks the chain index may trail the head by and still be trusted; the indexer's confirmation depth
+  maxIndexLag: parseInt(process.env.CHAIN_INDEXER_CONFIRMATIONS || '1', 10),
+  maxDetails: 1000
+};
+
+// Funding rows written by the job queue and by older direct transfers
+const FUNDING_TRANSACTION_TYPES = ['VERIFICATION_FUNDING', 'INITIAL_FUNDING'];
+
+const withTransaction = async (db, callback) => {
+  const client = await db.connect();
+  try {
+    await client.query('BEGIN');
+    const result = await callback(client);
+    await client.query('COMMIT');
+    return result;
+  } catch (error) {
+    await client.query('ROLLBACK');
+    throw error;
+  } finally {
+    client.release();
+  }
+};
+
+/**
+ * Address that receives expiry refunds
+ * @returns {String|null} Admin wallet address, or null if none is configured
+ */
+const getRefundAddress = () => {
+  if (process.env.ADMIN_WALLET_ADDRESS) {
+    return process.env.ADMIN_WALLET_ADDRESS;
+  }
+  if (process.env.ADMIN_PRIVATE_KEY) {
+    return new ethers.Wallet(process.env.ADMIN_PRIVATE_KEY).address;
+  }
+  return null;
+};
+
+/**
+ * Keyset comparison on (blockchain_expiry, id)
+ * Expiries are kept as Postgres timestamp text, which sorts lexically and
+ * round-trips through the JSON checkpoint without a time zone shift
+ */
+const compareKeys = (a, b) => {
+  if (a.expiry !== b.expiry) return a.expiry < b.expiry ? -1 : 1;
+  return a.id - b.id;
+};
+
+/**
+ * Insert one audit row per user in a single statement
+ */
+const insertAuditLogs = (client, action, entries) => {
+  if (entries.length === 0) return null;
+  return client.query(
+    `INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details)
+     SELECT entry.user_id, $1, 'users', entry.user_id, entry.details
+     FROM unnest($2::int[], $3::jsonb[]) AS entry(user_id, details)`,
+    [action, entries.map(entry => entry.userId), entries.map(entry => JSON.stringify(entry.details))]
+  );
+};
+
+/**
+ * Process one chunk of expired users after the given keyset position
+ * Rolls back, leaving every user in the chunk PENDING, if the on-chain read fails
+ * @param {Object} db - Database service
+ * @param {Object|null} after - { expiry, id } keyset position, or null to start from the beginning
+ * @param {Object} options - chunkSize, refundAddress, maxIndexLag
+ * @returns {Object|null} Chunk results, or null if no expired users are left
+ */
+exports.processChunk = async (db, after, options = {}) => {
+  const {
+    chunkSize = DEFAULT_OPTIONS.chunkSize,
+    refundAddress = getRefundAddress(),
+    maxIndexLag = DEFAULT_OPTIONS.maxIndexLag
+  } = options;
+
+  return withTransaction(db, async (client) => {
+    const usersResult = await client.query(
+      `SELECT id, name, government_id, avax_address, blockchain_expiry::text AS expiry_key, blockchain_tx_hash
+       FROM users
+       WHERE blockchain_status = 'PENDING'
+         AND blockchain_expiry < NOW()
+         AND ($1::timestamp IS NULL OR (blockchain_expiry, id) > ($1::timestamp, $2::int))
+       ORDER BY blockchain_expiry, id
+       LIMIT $3
+       FOR UPDATE SKIP LOCKED`,
+      [after ? after.expiry : null, after ? after.id : null, chunkSize]
+    );
+
+    const users = usersResult.rows;
+    if (users.length === 0) {
+      return null;
+    }
+
+    // One read for the whole chunk: the chain index only when it is caught up to the
+    // head, a multicall otherwise, so a lagging index never turns a late registration EXPIRED
+    const withWallet = users.filter(user => user.avax_address);
+    const onChain = new Set();
+    if (withWallet.length > 0) {
+      const { identities } = await chainIndexer.readIdentitySummaries(
+        db,
+        withWallet.map(user => user.avax_address),
+        { recordLimit: 0, maxLagBlocks: maxIndexLag }
+      );
+      identities.filter(identity => identity.exists)
+        .forEach(identity => onChain.add(identity.walletAddress.toLowerCase()));
+    }
+
+    const confirmed = users.filter(user => user.avax_address && onChain.has(user.avax_address.toLowerCase()));
+    const expired = users.filter(user => !confirmed.includes(user));
+
+    if (confirmed.length > 0) {
+      await client.query(
+        `UPDATE users
+         SET blockchain_status = 'CONFIRMED',
+             blockchain_expiry = NULL,
+             updated_at = NOW()
+         WHERE id = ANY($1::int[])`,
+        [confirmed.map(user => user.id)]
+      );
+      await insertAuditLogs(client, 'USER_BLOCKCHAIN_CONFIRMED', confirmed.map(user => ({
+        userId: user.id,
+        details: {
+          message: 'User data confirmed on blockchain after expiry check',
+          previousStatus: 'PENDING'
+        }
+      })));
+    }
+
+    const refunds = new Map();
+    if (expired.length > 0) {
+      await client.query(
+        `UPDATE users
+         SET blockchain_status = 'EXPIRED',
+             blockchain_expiry = NULL,
+             updated_at = NOW()
+         WHERE id = ANY($1::int[])`,
+        [expired.map(user => user.id)]
+      );
+
+      // Only wallets that were actually funded have anything to refund
+      const fundedResult = await client.query(
+        `SELECT DISTINCT user_id
+         FROM blockchain_transactions
+         WHERE user_id = ANY($1::int[])
+           AND transaction_type = ANY($2::text[])
+           AND status = 'CONFIRMED'`,
+        [expired.map(user => user.id), FUNDING_TRANSACTION_TYPES]
+      );
+
+      for (const { user_id: userId } of fundedResult.rows) {
+        if (!refundAddress) {
+          refunds.set(userId, { status: 'SKIPPED', reason: 'No admin wallet address configured' });
+          continue;
+        }
+        const job = await blockchainQueue.enqueue(client, 'EXPIRY_REFUND', {
+          userId,
+          payload: { toAddress: refundAddress }
+        });
+        refunds.set(userId, { status: 'QUEUED', jobId: job.id, toAddress: refundAddress });
+      }
+
+      await insertAuditLogs(client, 'USER_BLOCKCHAIN_EXPIRED', expired.map(user => ({
+        userId: user.id,
+        details: {
+          message: '48-hour blockchain expiry period elapsed without data transfer',
+          previousStatus: 'PENDING',
+          txHash: user.blockchain_tx_hash,
+          refundResult: refunds.get(user.id) || null
+        }
+      })));
+    }
+
+    const last = users[users.length - 1];
+    return {
+      last: { expiry: last.expiry_key, id: last.id },
+      total: users.length,
+      confirmed: confirmed.length,
+      expired: expired.length,
+      details: users.map(user => ({
+        userId: user.id,
+        name: user.name,
+        governmentId: user.government_id,
+        newStatus: confirmed.includes(user) ? 'CONFIRMED' : 'EXPIRED',
+        refundResult: refunds.get(user.id) || null
+      }))
+    };
+  });
+};
+
+/**
+ * Load (creating if needed) the task row and mark a run as started
+ * @returns {Object|null} Saved keyset position of an unfinished sweep
+ */
+const startRun = async (db) => {
+  const result = await db.query(
+    `INSERT INTO scheduled_tasks (name, last_run_started_at, updated_at)
+     VALUES ($1, NOW(), NOW())
+     ON CONFLICT (name) DO UPDATE
+     SET last_run_started_at = NOW(), updated_at = NOW()
+     RETURNING checkpoint`,
+    [TASK_NAME]
+  );
+  return result.rows[0].checkpoint;
+};
+
+const saveCheckpoint = (db, checkpoint) => db.query(
+  `UPDATE scheduled_tasks SET checkpoint = $2, updated_at = NOW() WHERE name = $1`,
+  [TASK_NAME, checkpoint ? JSON.stringify(checkpoint) : null]
+);
+
+const finishRun = (db, summary) => db.query(
+  `UPDATE scheduled_tasks
+   SET checkpoint = NULL, last_run_finished_at = NOW(), last_result = $2, updated_at = NOW()
+   WHERE name = $1`,
+  [TASK_NAME, JSON.stringify(summary)]
+);
+
+/**
+ * Sweep all expired users, resuming from the saved checkpoint
+ * Chunks already committed stay committed if a later chunk fails; the sweep
+ * stops there and the next run picks up from the checkpoint
+ * @param {Object} db - Database service
+ * @param {Object} options - chunkSize, concurrency, maxDetails, maxIndexLag
+ * @returns {Object} { total, confirmed, expired, details, resumed, completed, error }
+ */
+exports.runSweep = async (db, options = {}) => {
+  const { chunkSize, concurrency, maxDetails, maxIndexLag } = { ...DEFAULT_OPTIONS, ...options };
+  const refundAddress = getRefundAddress();
+
+  const checkpoint = await startRun(db);
+  let cursor = checkpoint ? { expiry: checkpoint.expiry, id: checkpoint.id } : null;
+
+  const results = {
+    total: 0,
+    confirmed: 0,
+    expired: 0,
+    details: [],
+    resumed: Boolean(checkpoint),
+    completed: false,
+    error: null
+  };
+
+  logger.info(`Processing expired blockchain statuses${cursor ? ` from checkpoint ${cursor.id}` : ''}...`);
+
+  try {
+    while (true) {
+      // Parallel chunks start from the same position; SKIP LOCKED hands each a disjoint set of rows
+      const chunks = (await Promise.all(
+        Array.from({ length: Math.max(concurrency, 1) }, () =>
+          exports.processChunk(db, cursor, { chunkSize, refundAddress, maxIndexLag }))
+      )).filter(Boolean);
+
+      if (chunks.length === 0) {
+        break;
+      }
+
+      for (const chunk of chunks) {
+        results.total += chunk.total;
+        results.confirmed += chunk.confirmed;
+        results.expired += chunk.expired;
+        results.details.push(...chunk.details.slice(0, maxDetails - results.details.length));
+        if (!cursor || compareKeys(chunk.last, cursor) > 0) {
+          cursor = chunk.last;
+        }
+      }
+      await saveCheckpoint(db, cursor);
+    }
+
+    results.completed = true;
+    await finishRun(db, { total: results.total, confirmed: results.confirmed, expired: results.expired });
+  } catch (error) {
+    logger.error('Error processing expired blockchain statuses:', error);
+    results.error = error.message;
+  }
+
+  logger.info(`Processed ${results.total} expired blockchain statuses (${results.confirmed} confirmed, ${results.expired} expired)`);
+  return results;
+};
+
+/**
+ * Runs the sweep on a fixed interval
+ */
+class BlockchainExpiryScheduler extends IntervalJob {
+  constructor(db, options = {}) {
+    const merged = { ...DEFAULT_OPTIONS, ...options };
+    super({ name: 'Blockchain expiry scheduler', interval: merged.interval });
+    this.db = db;
+    this.options = merged;
+  }
+
+  start() {
+    if (!this.running) {
+      logger.info(`Blockchain expiry scheduler started (every ${this.options.interval}ms)`);
+    }
+    return super.start();
+  }
+
+  async run() {
+    await exports.runSweep(this.db, this.options);
+  }
+}
+
+let scheduler = null;
+
+/**
+ * Start the shared in-process expiry scheduler
+ * @param {Object} db - Database service (query + pool)
+ * @param {Object} options - Scheduler options
+ * @returns {BlockchainExpiryScheduler} Running scheduler
+ */
+exports.startScheduler = (db, options = {}) => {
+  if (!scheduler) {
+    scheduler = new BlockchainExpiryScheduler(db, options);
+  }
+  return scheduler.start();
+};
+
+/**
+ * Stop the shared in-process expiry scheduler, waiting for the current sweep to finish
+ */
+exports.stopScheduler = async () => {
+  if (scheduler) {
+    // Clear it first so a start() during the wait gets a fresh instance
+    const stopping = scheduler;
+    scheduler = null;
+    await stopping.stop();
+  }
+};
+
+exports.BlockchainExpiryScheduler = BlockchainExpiryScheduler;
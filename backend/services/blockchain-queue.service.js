@@ -0,0 +1,627 @@
+/**
+ * Blockchain job queue for DBIS
+ * Durable outbox for on-chain writes. Jobs are inserted inside the caller's
+ * database transaction and drained by a worker that signs, broadcasts and
+ * tracks confirmations without holding a pool connection across RPC calls.
+ *
+ * Job lifecycle: QUEUED -> SUBMITTED -> CONFIRMED | FAILED
+ * A signed transaction is persisted before it is broadcast, so a crashed or
+ * retried job re-broadcasts the same bytes instead of sending a second transfer.
+ */
+const os = require('os');
+const blockchainService = require('./blockchain.service');
+const walletService = require('./wallet.service');
+const hdWallet = require('./hd-wallet.service');
+const { resetNonceManager } = require('./nonce-manager.service');
+const { IntervalJob } = require('../utils/scheduler.utils');
+const { logger } = require('../utils/logger.utils');
+
+const DEFAULT_OPTIONS = {
+  pollInterval: parseInt(process.env.BLOCKCHAIN_WORKER_POLL_INTERVAL || '2000', 10),
+  concurrency: parseInt(process.env.BLOCKCHAIN_WORKER_CONCURRENCY || '2', 10),
+  leaseMs: parseInt(process.env.BLOCKCHAIN_WORKER_LEASE_MS || '60000', 10),
+  confirmations: parseInt(process.env.BLOCKCHAIN_CONFIRMATIONS || '1', 10),
+  confirmationPollMs: 3000,
+  rebroadcastAfterMs: 30000,
+  maxBackoffMs: 300000
+};
+
+// Empty professional data hash used for automatic registrations
+const EMPTY_PROFESSIONAL_DATA_HASH = '0x0000000000000000000000000000000000000000000000000000000000000000';
+
+/**
+ * Error that should fail a job immediately instead of being retried
+ */
+class PermanentJobError extends Error {
+  constructor(message) {
+    super(message);
+    this.name = 'PermanentJobError';
+    this.permanent = true;
+  }
+}
+
+/**
+ * Insert an audit log row for a job
+ */
+const auditJob = (client, job, action, details) => {
+  return client.query(
+    `INSERT INTO audit_logs (admin_id, user_id, action, entity_type, entity_id, details)
+     VALUES ($1, $2, $3, $4, $5, $6)`,
+    [
+      job.created_by,
+      job.user_id,
+      action,
+      'users',
+      job.user_id,
+      JSON.stringify({ jobId: job.id, ...details })
+    ]
+  );
+};
+
+/**
+ * Job handlers keyed by job_type
+ *   prepare(db, job)        -> signed transaction, or { result } when nothing needs to be sent
+ *   transaction(job, signed) -> blockchain_transactions row description
+ *   onConfirmed(client, job, receipt, result)
+ *   onFailed(client, job, error)
+ */
+const JOB_HANDLERS = {
+  VERIFICATION_FUNDING: {
+    prepare: async (db, job) => {
+      const { toAddress, amount } = job.payload;
+      if (!walletService.isValidAddress(toAddress)) {
+        throw new PermanentJobError(`Invalid destination address: ${toAddress}`);
+      }
+      return walletService.prepareTransfer(toAddress, amount);
+    },
+
+    transaction: (job, signed) => ({
+      type: 'VERIFICATION_FUNDING',
+      network: 'avalanche_fuji',
+      data: { amount: job.payload.amount, from: signed.from, to: signed.to, network: 'avalanche_fuji' }
+    }),
+
+    onConfirmed: async (client, job, receipt) => {
+      await auditJob(client, job, 'USER_BLOCKCHAIN_FUNDING', {
+        transactionHash: receipt.transactionHash,
+        amount: job.payload.amount,
+        status: 'CONFIRMED'
+      });
+
+      // Registration is signed by the user's wallet, so it can only run once the funds have landed
+      if (job.payload.registerIdentity) {
+        await exports.enqueue(client, 'IDENTITY_REGISTRATION', {
+          userId: job.user_id,
+          createdBy: job.created_by,
+          payload: { walletAddress: job.payload.toAddress }
+        });
+      }
+    },
+
+    onFailed: (client, job, error) => auditJob(client, job, 'USER_BLOCKCHAIN_FUNDING_FAILED', {
+      error: error.message,
+      amount: job.payload.amount
+    })
+  },
+
+  IDENTITY_REGISTRATION: {
+    prepare: async (db, job) => {
+      const result = await db.query(
+        `SELECT u.avax_address, u.wallet_index, u.avax_private_key, b.facemesh_hash
+         FROM users u
+         LEFT JOIN biometric_data b ON b.user_id = u.id AND b.is_active = true
+         WHERE u.id = $1`,
+        [job.user_id]
+      );
+
+      const row = result.rows[0];
+      if (!hdWallet.hasSigner(row)) {
+        throw new PermanentJobError(`No signing key available for user ${job.user_id}`);
+      }
+      if (!row.facemesh_hash) {
+        throw new PermanentJobError(`No active biometric data found for user ${job.user_id}`);
+      }
+
+      const walletAddress = job.payload.walletAddress || row.avax_address;
+      if (await blockchainService.isIdentityRegistered(walletAddress)) {
+        return { result: { status: 'ALREADY_EXISTS', walletAddress } };
+      }
+
+      const signed = await blockchainService.prepareIdentityRegistration(
+        hdWallet.signerForUser(row),
+        row.facemesh_hash,
+        EMPTY_PROFESSIONAL_DATA_HASH
+      );
+      return { ...signed, biometricHash: row.facemesh_hash };
+    },
+
+    transaction: (job, signed) => ({
+      type: 'IDENTITY_REGISTRATION',
+      network: signed.network,
+      data: { biometricHash: signed.biometricHash, registeredBy: 'SYSTEM_AUTOMATIC', network: signed.network }
+    }),
+
+    onConfirmed: async (client, job, receipt, result) => {
+      if (!receipt) {
+        await auditJob(client, job, 'USER_BLOCKCHAIN_IDENTITY_EXISTS', {
+          message: 'Identity already exists on blockchain',
+          walletAddress: result.walletAddress
+        });
+        return;
+      }
+
+      await client.query(
+        `UPDATE biometric_data
+         SET blockchain_tx_hash = $1,
+             updated_at = NOW()
+         WHERE user_id = $2 AND is_active = true`,
+        [receipt.transactionHash, job.user_id]
+      );
+
+      await auditJob(client, job, 'USER_BLOCKCHAIN_REGISTRATION', {
+        transactionHash: receipt.transactionHash,
+        status: 'CONFIRMED',
+        automatic: true
+      });
+    },
+
+    onFailed: (client, job, error) => auditJob(client, job, 'USER_BLOCKCHAIN_REGISTRATION_FAILED', {
+      error: error.message
+    })
+  },
+
+  // payload.users: [{ userId, walletAddress }], at most MAX_BATCH_SIZE entries
+  IDENTITY_VERIFICATION_BATCH: {
+    prepare: async (db, job) => {
+      const walletAddresses = job.payload.users.map(user => user.walletAddress);
+      const transaction = await blockchainService.populateBatchVerifyIdentities(walletAddresses);
+      return blockchainService.prepareAdminTransaction(transaction);
+    },
+
+    transaction: (job, signed) => ({
+      type: 'IDENTITY_VERIFICATION_BATCH',
+      network: signed.network,
+      data: { userIds: job.payload.users.map(user => user.userId), network: signed.network }
+    }),
+
+    onConfirmed: async (client, job, receipt) => {
+      const verified = new Set(
+        blockchainService.parseReceiptEvents(receipt, 'IdentityVerified').map(args => args.user.toLowerCase())
+      );
+
+      for (const user of job.payload.users) {
+        if (verified.has(user.walletAddress.toLowerCase())) {
+          await auditJob(client, { ...job, user_id: user.userId }, 'USER_BLOCKCHAIN_VERIFIED', {
+            transactionHash: receipt.transactionHash,
+            walletAddress: user.walletAddress,
+            batch: true
+          });
+        }
+      }
+    },
+
+    onFailed: async (client, job, error) => {
+      for (const user of job.payload.users) {
+        await auditJob(client, { ...job, user_id: user.userId }, 'USER_BLOCKCHAIN_VERIFICATION_FAILED', {
+          error: error.message,
+          walletAddress: user.walletAddress,
+          batch: true
+        });
+      }
+    }
+  },
+
+  // Returns whatever is left of the verification funding once a user's registration window expires
+  EXPIRY_REFUND: {
+    prepare: async (db, job) => {
+      const { toAddress } = job.payload;
+      if (!walletService.isValidAddress(toAddress)) {
+        throw new PermanentJobError(`Invalid refund address: ${toAddress}`);
+      }
+
+      const result = await db.query('SELECT wallet_index, avax_private_key FROM users WHERE id = $1', [job.user_id]);
+      const row = result.rows[0];
+      if (!hdWallet.hasSigner(row)) {
+        throw new PermanentJobError(`No signing key available for user ${job.user_id}`);
+      }
+
+      const signed = await blockchainService.prepareBalanceSweep(hdWallet.signerForUser(row), toAddress);
+      return signed || { result: { status: 'NOTHING_TO_REFUND' } };
+    },
+
+    transaction: (job, signed) => ({
+      type: 'EXPIRY_REFUND',
+      network: signed.network,
+      data: { amount: signed.amount, from: signed.from, to: signed.to, network: signed.network }
+    }),
+
+    onConfirmed: async (client, job, receipt, result) => {
+      if (!receipt) {
+        await auditJob(client, job, 'USER_BLOCKCHAIN_EXPIRY_REFUND', {
+          message: 'Balance does not cover the transfer gas, nothing refunded',
+          status: result.status
+        });
+        return;
+      }
+
+      await auditJob(client, job, 'USER_BLOCKCHAIN_EXPIRY_REFUND', {
+        transactionHash: receipt.transactionHash,
+        toAddress: job.payload.toAddress,
+        status: 'CONFIRMED'
+      });
+    },
+
+    onFailed: (client, job, error) => auditJob(client, job, 'USER_BLOCKCHAIN_EXPIRY_REFUND_FAILED', {
+      error: error.message,
+      toAddress: job.payload.toAddress
+    })
+  }
+};
+
+/**
+ * Run a callback inside a transaction on a dedicated client
+ */
+const withTransaction = async (db, callback) => {
+  const client = await db.connect();
+  try {
+    await client.query('BEGIN');
+    const result = await callback(client);
+    await client.query('COMMIT');
+    return result;
+  } catch (error) {
+    await client.query('ROLLBACK');
+    throw error;
+  } finally {
+    client.release();
+  }
+};
+
+/**
+ * Enqueue a blockchain job
+ * Pass the request's transaction client so the job commits (or rolls back) with it
+ * @param {Object} client - pg client or pool
+ * @param {String} jobType - One of the JOB_HANDLERS keys
+ * @param {Object} options - userId, payload, createdBy, maxAttempts
+ * @returns {Object} Inserted job row
+ */
+exports.enqueue = async (client, jobType, options = {}) => {
+  if (!JOB_HANDLERS[jobType]) {
+    throw new Error(`Unknown blockchain job type: ${jobType}`);
+  }
+
+  const { userId = null, payload = {}, createdBy = null, maxAttempts = 5 } = options;
+  const result = await client.query(
+    `INSERT INTO blockchain_jobs (job_type, user_id, payload, created_by, max_attempts)
+     VALUES ($1, $2, $3, $4, $5)
+     RETURNING id, job_type, user_id, status, created_at`,
+    [jobType, userId, JSON.stringify(payload), createdBy, maxAttempts]
+  );
+  return result.rows[0];
+};
+
+/**
+ * Get a job by ID
+ * @param {Object} db - Database service or pool
+ * @param {Number} id - Job ID
+ * @returns {Object|null} Job row without the signed transaction
+ */
+exports.getJob = async (db, id) => {
+  const result = await db.query(
+    `SELECT id, job_type, user_id, payload, status, attempts, max_attempts, run_after,
+            transaction_hash, submitted_at, result, last_error, created_by, created_at, updated_at
+     FROM blockchain_jobs
+     WHERE id = $1`,
+    [id]
+  );
+  return result.rows[0] || null;
+};
+
+/**
+ * Worker that drains blockchain_jobs
+ * Several workers (in-process or scripts/blockchain-worker.js) can run against the
+ * same table: rows are claimed with FOR UPDATE SKIP LOCKED and a time-limited lease.
+ */
+class BlockchainWorker extends IntervalJob {
+  constructor(db, options = {}) {
+    const merged = { ...DEFAULT_OPTIONS, ...options };
+    super({ name: 'Blockchain worker', interval: merged.pollInterval });
+    this.db = db;
+    this.options = merged;
+    this.workerId = `${os.hostname()}:${process.pid}`;
+  }
+
+  start() {
+    if (!this.running) {
+      logger.info(`Blockchain worker ${this.workerId} started (concurrency ${this.options.concurrency})`);
+    }
+    return super.start();
+  }
+
+  async run() {
+    const jobs = await this.claim();
+    await Promise.all(jobs.map(job => this.process(job)));
+
+    // Keep draining while there is a backlog
+    return jobs.length >= this.options.concurrency ? 0 : this.options.pollInterval;
+  }
+
+  /**
+   * Lease up to `concurrency` runnable jobs
+   * The row locks last only for this statement; the lease keeps other workers away
+   */
+  async claim() {
+    const result = await this.db.query(
+      `UPDATE blockchain_jobs
+       SET locked_by = $1,
+           locked_until = NOW() + ($2 * INTERVAL '1 millisecond'),
+           updated_at = NOW()
+       WHERE id IN (
+         SELECT id FROM blockchain_jobs
+         WHERE status IN ('QUEUED', 'SUBMITTED')
+           AND run_after <= NOW()
+           AND (locked_until IS NULL OR locked_until < NOW())
+         ORDER BY run_after, id
+         LIMIT $3
+         FOR UPDATE SKIP LOCKED
+       )
+       RETURNING *`,
+      [this.workerId, this.options.leaseMs, this.options.concurrency]
+    );
+    return result.rows;
+  }
+
+  async process(job) {
+    const handler = JOB_HANDLERS[job.job_type];
+    try {
+      if (!handler) {
+        throw new PermanentJobError(`Unknown blockchain job type: ${job.job_type}`);
+      }
+
+      if (!job.raw_transaction) {
+        const prepared = await handler.prepare(this.db, job);
+        if (!prepared.rawTransaction) {
+          await this.complete(job, handler, 'CONFIRMED', null, prepared.result);
+          return;
+        }
+        try {
+          job = await this.markSubmitted(job, handler, prepared);
+        } catch (error) {
+          // The signed bytes were never persisted; resync so their nonce is not left as a gap
+          resetNonceManager(prepared.from);
+          throw error;
+        }
+      }
+
+      await this.track(job, handler);
+    } catch (error) {
+      await this.fail(job, handler, error);
+    }
+  }
+
+  /**
+   * Persist the signed transaction and its PENDING blockchain_transactions row before broadcasting
+   */
+  async markSubmitted(job, handler, signed) {
+    const description = handler.transaction(job, signed);
+
+    return withTransaction(this.db, async (client) => {
+      await client.query(
+        `INSERT INTO blockchain_transactions
+         (user_id, transaction_type, transaction_hash, status, data, network, from_address, to_address, entity_id, entity_type)
+         VALUES ($1, $2, $3, 'PENDING', $4, $5, $6, $7, $8, 'blockchain_jobs')`,
+        [
+          job.user_id,
+          description.type,
+          signed.transactionHash,
+          JSON.stringify(description.data),
+          description.network,
+          signed.from,
+          signed.to,
+          job.id
+        ]
+      );
+
+      const result = await client.query(
+        `UPDATE blockchain_jobs
+         SET status = 'SUBMITTED',
+             transaction_hash = $2,
+             raw_transaction = $3,
+             submitted_at = NULL,
+             updated_at = NOW()
+         WHERE id = $1
+         RETURNING *`,
+        [job.id, signed.transactionHash, signed.rawTransaction]
+      );
+      return result.rows[0];
+    });
+  }
+
+  /**
+   * Check the receipt, (re)broadcasting while the transaction is unknown to the chain
+   */
+  async track(job, handler) {
+    const { state, receipt } = await blockchainService.getTransactionStatus(
+      job.transaction_hash,
+      this.options.confirmations
+    );
+
+    if (state !== 'PENDING') {
+      blockchainService.recordTransactionGas(job.raw_transaction, receipt);
+      await this.complete(job, handler, state, receipt);
+      return;
+    }
+
+    const submittedAt = job.submitted_at ? new Date(job.submitted_at).getTime() : 0;
+    if (!receipt && Date.now() - submittedAt >= this.options.rebroadcastAfterMs) {
+      try {
+        await blockchainService.broadcastTransaction(job.raw_transaction);
+      } catch (error) {
+        if (blockchainService.classifyBroadcastError(error) !== 'NONCE_EXPIRED') {
+          throw error;
+        }
+        await this.resign(job, error);
+        return;
+      }
+
+      await this.db.query(
+        `UPDATE blockchain_jobs SET submitted_at = NOW() WHERE id = $1`,
+        [job.id]
+      );
+    }
+
+    await this.release(job, this.options.confirmationPollMs);
+  }
+
+  /**
+   * The nonce was consumed by another transaction; sign again with a fresh nonce
+   */
+  async resign(job, error) {
+    const { state, receipt } = await blockchainService.getTransactionStatus(job.transaction_hash, 0);
+    if (receipt) {
+      // Ours was mined after all; track it normally
+      await this.release(job, this.options.confirmationPollMs);
+      return;
+    }
+
+    await withTransaction(this.db, async (client) => {
+      await client.query(
+        `UPDATE blockchain_transactions
+         SET status = 'FAILED', metadata = $2, updated_at = NOW()
+         WHERE transaction_hash = $1 AND status = 'PENDING'`,
+        [job.transaction_hash, JSON.stringify({ reason: 'REPLACED', error: error.message })]
+      );
+      await client.query(
+        `UPDATE blockchain_jobs
+         SET status = 'QUEUED', transaction_hash = NULL, raw_transaction = NULL, submitted_at = NULL,
+             last_error = $2, locked_by = NULL, locked_until = NULL, updated_at = NOW()
+         WHERE id = $1`,
+        [job.id, error.message]
+      );
+    });
+
+    logger.warn(`Blockchain job ${job.id} transaction ${job.transaction_hash} was replaced (${state}), re-signing`);
+  }
+
+  async complete(job, handler, state, receipt, result = null) {
+    const jobResult = result || (receipt && {
+      transactionHash: receipt.transactionHash,
+      blockNumber: receipt.blockNumber,
+      gasUsed: receipt.gasUsed.toString()
+    });
+
+    await withTransaction(this.db, async (client) => {
+      if (receipt) {
+        await client.query(
+          `UPDATE blockchain_transactions
+           SET status = $2, block_number = $3,
+               metadata = COALESCE(metadata, '{}'::jsonb) || $4::jsonb,
+               updated_at = NOW()
+           WHERE transaction_hash = $1`,
+          [receipt.transactionHash, state, receipt.blockNumber, JSON.stringify({ gasUsed: jobResult.gasUsed })]
+        );
+      }
+
+      await client.query(
+        `UPDATE blockchain_jobs
+         SET status = $2, result = $3, raw_transaction = NULL,
+             last_error = $4, locked_by = NULL, locked_until = NULL, updated_at = NOW()
+         WHERE id = $1`,
+        [job.id, state, JSON.stringify(jobResult), state === 'FAILED' ? 'Transaction reverted' : null]
+      );
+
+      if (state === 'CONFIRMED') {
+        await handler.onConfirmed(client, job, receipt, result);
+      } else {
+        await handler.onFailed(client, job, new Error('Transaction reverted'));
+      }
+    });
+  }
+
+  /**
+   * Record a failed attempt; retry with exponential backoff or give up
+   */
+  async fail(job, handler, error) {
+    const attempts = job.attempts + 1;
+    const permanent = error.permanent || attempts >= job.max_attempts;
+    logger.error(`Blockchain job ${job.id} (${job.job_type}) attempt ${attempts} failed:`, error.message);
+
+    try {
+      if (!permanent) {
+        const delay = Math.min(1000 * Math.pow(2, attempts), this.options.maxBackoffMs);
+        await this.db.query(
+          `UPDATE blockchain_jobs
+           SET attempts = $2, last_error = $3, run_after = NOW() + ($4 * INTERVAL '1 millisecond'),
+               locked_by = NULL, locked_until = NULL, updated_at = NOW()
+           WHERE id = $1`,
+          [job.id, attempts, error.message, delay]
+        );
+        return;
+      }
+
+      await withTransaction(this.db, async (client) => {
+        if (job.transaction_hash) {
+          await client.query(
+            `UPDATE blockchain_transactions
+             SET status = 'FAILED', updated_at = NOW()
+             WHERE transaction_hash = $1 AND status = 'PENDING'`,
+            [job.transaction_hash]
+          );
+        }
+        await client.query(
+          `UPDATE blockchain_jobs
+           SET status = 'FAILED', attempts = $2, last_error = $3,
+               locked_by = NULL, locked_until = NULL, updated_at = NOW()
+           WHERE id = $1`,
+          [job.id, attempts, error.message]
+        );
+        if (handler) {
+          await handler.onFailed(client, job, error);
+        }
+      });
+    } catch (updateError) {
+      // The lease expires on its own, so the job will be picked up again
+      logger.error(`Failed to record failure for blockchain job ${job.id}:`, updateError);
+    }
+  }
+
+  release(job, delay) {
+    return this.db.query(
+      `UPDATE blockchain_jobs
+       SET run_after = NOW() + ($2 * INTERVAL '1 millisecond'),
+           locked_by = NULL, locked_until = NULL, updated_at = NOW()
+       WHERE id = $1`,
+      [job.id, delay]
+    );
+  }
+}
+
+let worker = null;
+
+/**
+ * Start the shared in-process worker
+ * @param {Object} db - Database service (query + pool)
+ * @param {Object} options - Worker options
+ * @returns {BlockchainWorker} Running worker
+ */
+exports.startWorker = (db, options = {}) => {
+  if (!worker) {
+    worker = new BlockchainWorker(db, options);
+  }
+  return worker.start();
+};
+
+/**
+ * Stop the shared in-process worker, waiting for the current poll to finish
+ */
+exports.stopWorker = async () => {
+  if (worker) {
+    // Clear it first so a start() during the wait gets a fresh instance
+    const stopping = worker;
+    worker = null;
+    await stopping.stop();
+  }
+};
+
+exports.BlockchainWorker = BlockchainWorker;
+exports.PermanentJobError = PermanentJobError;
+exports.JOB_TYPES = Object.keys(JOB_HANDLERS);
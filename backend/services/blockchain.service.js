@@ -6,6 +6,12 @@ const ethers = require('ethers');
 const fs = require('fs');
 const path = require('path');
 const dotenv = require('dotenv');
+const { getNonceManager, classifyBroadcastError } = require('./nonce-manager.service');
+const { recordGasUsed, contractMethod } = require('./rpc-provider.service');
+const { getSharedProvider, rpcUrlsFromEnv } = require('./rpc-pool.service');
+const { registry, timeAsync } = require('../utils/metrics.utils');
+const tracing = require('../utils/tracing.utils');
+const { logger } = require('../utils/logger.utils');
 
 // Load environment variables
 dotenv.config();
@@ -28,27 +34,98 @@ const IdentityManagementABI = [
   "function verifyIdentity(address user) external",
   "function addProfessionalRecord(bytes32 dataHash, uint256 startDate, uint256 endDate) external",
   "function verifyProfessionalRecord(address user, uint256 recordIndex) external",
+  "function batchVerifyIdentities(address[] users) external returns (uint256 verified)",
+  "function batchVerifyProfessionalRecords(address[] users, uint256[] recordIndexes) external returns (uint256 verified)",
+  "function grantRoles(address[] accounts, bytes32 role) external",
   "function grantRole(address account, bytes32 role) external",
   "function revokeRole(address account, bytes32 role) external",
   "function hasRole(address account, bytes32 role) external view returns (bool)",
   "function getBiometricHash(address user) external view returns (bytes32)",
   "function isIdentityVerified(address user) external view returns (bool)",
   "function getProfessionalRecordCount(address user) external view returns (uint256)",
-  "function getProfessionalRecord(address user, uint256 recordIndex) external view returns (bytes32 dataHash, uint256 startDate, uint256 endDate, address verifier, bool isVerified, uint256 createdAt)"
+  "function getProfessionalRecord(address user, uint256 recordIndex) external view returns (bytes32 dataHash, uint256 startDate, uint256 endDate, address verifier, bool isVerified, uint256 createdAt)",
+  "function getIdentitySummary(address user) external view returns (bool exists, bytes32 biometricHash, bool isVerified, uint256 createdAt, uint256 updatedAt, uint256 professionalRecordCount)",
+  "function getProfessionalRecords(address user, uint256 offset, uint256 limit) external view returns (tuple(bytes32 dataHash, uint256 startDate, uint256 endDate, address verifier, bool isVerified, uint256 createdAt)[] records, uint256 total)"
 ];
 
+// Multicall3 aggregator ABI (deployed at the same address on Avalanche and most EVM chains)
+const Multicall3ABI = [
+  "function aggregate3(tuple(address target, bool allowFailure, bytes callData)[] calls) payable returns (tuple(bool success, bytes returnData)[] returnData)",
+  "function getBlockNumber() view returns (uint256 blockNumber)"
+];
+
+const MULTICALL3_ADDRESS = process.env.MULTICALL3_ADDRESS || '0xcA11bde05977b3631167028862bE2a173976CA11';
+const MULTICALL_BATCH_SIZE = parseInt(process.env.BLOCKCHAIN_MULTICALL_BATCH_SIZE || '200', 10);
+
+const identityInterface = new ethers.utils.Interface(IdentityManagementABI);
+
+// Views whose eth_call results the shared provider caches per block
+const CACHED_VIEWS = [
+  'hasRole',
+  'getBiometricHash',
+  'isIdentityVerified',
+  'getProfessionalRecordCount',
+  'getProfessionalRecord',
+  'getIdentitySummary',
+  'getProfessionalRecords'
+];
+
+// Per exported call; RPC round trips inside it are timed by rpc-provider.service
+const callDuration = registry.histogram(
+  'dbis_chain_call_duration_seconds',
+  'blockchain.service call time by function and outcome',
+  ['call', 'outcome']
+);
+
 // Role constants
 const USER_ROLE = ethers.utils.id("USER");
 const GOVERNMENT_ROLE = ethers.utils.id("GOVERNMENT");
 const ADMIN_ROLE = ethers.utils.id("ADMIN");
 
+// Mirrors IdentityManagement.MAX_BATCH_SIZE
+const MAX_BATCH_SIZE = 200;
+
+/**
+ * Split a list into batches of at most `size` items
+ */
+const chunk = (items, size = MAX_BATCH_SIZE) => {
+  const chunks = [];
+  for (let i = 0; i < items.length; i += size) {
+    chunks.push(items.slice(i, i + size));
+  }
+  return chunks;
+};
+
+/**
+ * Decode this contract's events from a receipt
+ * @param {Object} receipt - Transaction receipt
+ * @param {String} eventName - Event to keep
+ * @returns {Array} Parsed event args
+ */
+const parseReceiptEvents = (receipt, eventName) => {
+  const iface = new ethers.utils.Interface(IdentityManagementABI);
+  const events = [];
+  for (const log of receipt.logs || []) {
+    try {
+      const parsed = iface.parseLog(log);
+      if (parsed.name === eventName) {
+        events.push(parsed.args);
+      }
+    } catch (error) {
+      // Log from another contract
+    }
+  }
+  return events;
+};
+
 /**
  * Get blockchain configuration - always use Avalanche Fuji Testnet
  * @returns {Object} Blockchain configuration
  */
 const getBlockchainConfig = () => {
   // Force use of AVAX Fuji Testnet regardless of environment variable settings
-  const rpcUrl = process.env.AVALANCHE_FUJI_RPC_URL || 'https://api.avax-test.network/ext/bc/C/rpc';
+  const rpcUrls = rpcUrlsFromEnv();
+  const rpcUrl = rpcUrls[0];
   const contractAddress = process.env.AVALANCHE_FUJI_CONTRACT_ADDRESS;
   const chainId = 43113;
   const networkName = 'Avalanche Fuji Testnet';
@@ -56,6 +133,7 @@ const getBlockchainConfig = () => {
   return {
     network: 'avalanche',
     rpcUrl,
+    rpcUrls,
     contractAddress,
     privateKey: process.env.ADMIN_PRIVATE_KEY,
     networkName,
@@ -63,6 +141,9 @@ const getBlockchainConfig = () => {
   };
 };
 
+// Admin wallet and contract on the shared provider, rebuilt only when the configuration changes
+let connection = null;
+
 /**
  * Initialize blockchain provider and contract
  * @returns {Object} Provider and contract instances
@@ -70,7 +151,11 @@ const getBlockchainConfig = () => {
 const initBlockchain = () => {
   try {
     const config = getBlockchainConfig();
-    const { rpcUrl, contractAddress, privateKey, networkName, chainId } = config;
+    const { rpcUrl, rpcUrls, contractAddress, privateKey, networkName, chainId } = config;
+    const key = `${rpcUrls.join(',')}|${contractAddress}|${privateKey}`;
+    if (connection && connection.key === key) {
+      return connection.value;
+    }
     
     if (!rpcUrl) {
       throw new Error(`RPC URL is not defined for ${networkName} network`);
@@ -84,8 +169,7 @@ const initBlockchain = () => {
       throw new Error('ADMIN_PRIVATE_KEY is not defined in environment variables');
     }
     
-    // Create provider
-    const provider = new ethers.providers.JsonRpcProvider(rpcUrl);
+    const provider = getProvider();
     
     // Create wallet
     const wallet = new ethers.Wallet(privateKey, provider);
@@ -97,9 +181,10 @@ const initBlockchain = () => {
       wallet
     );
     
-    return { provider, wallet, contract, networkName };
+    connection = { key, value: { provider, wallet, contract, networkName } };
+    return connection.value;
   } catch (error) {
-    console.error('Blockchain initialization error:', error);
+    logger.error('Blockchain initialization error:', error);
     throw new Error(`Failed to initialize blockchain connection: ${error.message}`);
   }
 };
@@ -120,7 +205,7 @@ exports.getNetworkInfo = () => {
       contractAddress: config.contractAddress
     };
   } catch (error) {
-    console.error('Get network info error:', error);
+    logger.error('Get network info error:', error);
     throw new Error('Failed to get network information');
   }
 };
@@ -139,7 +224,7 @@ exports.isContractAccessible = async () => {
       network: networkName
     };
   } catch (error) {
-    console.error(`Contract accessibility check error:`, error);
+    logger.error(`Contract accessibility check error:`, error);
     return {
       accessible: false,
       error: error.message,
@@ -175,24 +260,39 @@ exports.isIdentityRegistered = async (walletAddress) => {
     }
   } catch (error) {
     // Log the error but don't throw, just return false
-    console.error('Check identity registration error:', error);
+    logger.error('Check identity registration error:', error);
     return false;
   }
 };
 
+/**
+ * Signer for a user's transaction
+ * Signers that are already connected (the cached HD signers from
+ * hd-wallet.service) are used as they are; a private key gets a new wallet
+ * @param {ethers.Signer|String} owner - Signer or private key
+ * @param {ethers.providers.Provider} provider - Provider for keys and unconnected signers
+ * @returns {ethers.Signer}
+ */
+const toSigner = (owner, provider) => {
+  if (typeof owner === 'string') {
+    return new ethers.Wallet(owner, provider);
+  }
+  return owner.provider ? owner : owner.connect(provider);
+};
+
 /**
  * Register identity on blockchain
- * @param {String} privateKey - Private key to use for the transaction
+ * @param {ethers.Signer|String} owner - Identity owner's signer (or private key)
  * @param {String} biometricHash - Hash of user's biometric data
  * @param {String} professionalDataHash - Hash of user's professional data
  * @returns {Object} Transaction result
  */
-exports.registerIdentity = async (privateKey, biometricHash, professionalDataHash) => {
+exports.registerIdentity = async (owner, biometricHash, professionalDataHash) => {
   try {
     const { provider, networkName } = initBlockchain();
     
-    // Create wallet instance using the provided private key
-    const wallet = new ethers.Wallet(privateKey, provider);
+    // Sign as the identity owner
+    const wallet = toSigner(owner, provider);
     
     // Create contract instance connected to the wallet
     const contract = new ethers.Contract(
@@ -206,7 +306,7 @@ exports.registerIdentity = async (privateKey, biometricHash, professionalDataHas
     const professionalDataHashBytes = ethers.utils.id(professionalDataHash);
     
     // Create identity on blockchain using the wallet
-    // The identity will be created for the address associated with the private key
+    // The identity will be created for the owner's address
     const tx = await contract.createIdentity(
       biometricHashBytes,
       professionalDataHashBytes
@@ -214,6 +314,7 @@ exports.registerIdentity = async (privateKey, biometricHash, professionalDataHas
     
     // Wait for transaction to be mined
     const receipt = await tx.wait();
+    recordGasUsed('createIdentity', receipt);
     
     return {
       transactionHash: receipt.transactionHash,
@@ -222,11 +323,213 @@ exports.registerIdentity = async (privateKey, biometricHash, professionalDataHas
       network: networkName
     };
   } catch (error) {
-    console.error('Register identity error:', error);
+    logger.error('Register identity error:', error);
     throw new Error('Failed to register identity on blockchain');
   }
 };
 
+/**
+ * Get the shared provider for the configured network (no signer, no contract address required)
+ * @returns {ethers.providers.JsonRpcProvider} Provider instance
+ */
+const getProvider = () => {
+  const provider = getSharedProvider(getBlockchainConfig().rpcUrls);
+  if (provider.viewSelectors.size === 0) {
+    // Idempotent reads; results are cached per block (see rpc-pool.service)
+    provider.cacheViews(identityInterface, CACHED_VIEWS);
+  }
+  return provider;
+};
+
+/**
+ * Sign a transaction without broadcasting it
+ * The hash is known before submission, so callers can persist it first and
+ * re-broadcast the same bytes after a crash instead of sending a second transaction
+ * @param {ethers.Wallet} wallet - Wallet connected to a provider
+ * @param {Object} transaction - Transaction request
+ * @returns {Object} Signed transaction details
+ */
+const signTransaction = async (wallet, transaction) => {
+  const populated = await wallet.populateTransaction(transaction);
+  const rawTransaction = await wallet.signTransaction(populated);
+
+  return {
+    rawTransaction,
+    transactionHash: ethers.utils.keccak256(rawTransaction),
+    from: wallet.address,
+    to: populated.to,
+    nonce: populated.nonce
+  };
+};
+
+exports.getProvider = getProvider;
+exports.signTransaction = signTransaction;
+exports.getBlockchainConfig = getBlockchainConfig;
+exports.IdentityManagementABI = IdentityManagementABI;
+
+/**
+ * Sign (but do not send) an identity registration transaction
+ * @param {ethers.Signer|String} owner - Identity owner's signer (or private key)
+ * @param {String} biometricHash - Hash of user's biometric data
+ * @param {String} professionalDataHash - Hash of user's professional data
+ * @returns {Object} Signed transaction details
+ */
+exports.prepareIdentityRegistration = async (owner, biometricHash, professionalDataHash) => {
+  const { contractAddress, networkName } = getBlockchainConfig();
+  if (!contractAddress) {
+    throw new Error(`Contract address is not defined for ${networkName} network`);
+  }
+
+  const wallet = toSigner(owner, getProvider());
+  const contract = new ethers.Contract(contractAddress, IdentityManagementABI, wallet);
+
+  // Same bytes32 conversion as registerIdentity
+  const transaction = await contract.populateTransaction.createIdentity(
+    ethers.utils.id(biometricHash),
+    ethers.utils.id(professionalDataHash)
+  );
+
+  return {
+    ...(await signTransaction(wallet, transaction)),
+    network: networkName
+  };
+};
+
+/**
+ * Sign (but do not send) a transfer of a wallet's whole balance, less gas, to another address
+ * @param {ethers.Signer|String} owner - Signer (or private key) of the wallet being emptied
+ * @param {String} toAddress - Destination address
+ * @returns {Object|null} Signed transaction details, or null if the balance does not cover gas
+ */
+exports.prepareBalanceSweep = async (owner, toAddress) => {
+  const { networkName } = getBlockchainConfig();
+  const wallet = toSigner(owner, getProvider());
+  const provider = wallet.provider;
+
+  const [balance, gasPrice] = await Promise.all([
+    provider.getBalance(wallet.address),
+    provider.getGasPrice()
+  ]);
+
+  // 21000 is the fixed gas cost of a plain transfer
+  const amount = balance.sub(gasPrice.mul(21000));
+  if (amount.lte(0)) {
+    return null;
+  }
+
+  return {
+    ...(await signTransaction(wallet, { to: toAddress, value: amount, gasLimit: 21000, gasPrice })),
+    amount: ethers.utils.formatEther(amount),
+    network: networkName
+  };
+};
+
+/**
+ * Broadcast a signed transaction
+ * Re-broadcasting a transaction the node already has is treated as success
+ * @param {String} rawTransaction - Signed transaction bytes
+ * @returns {String} Transaction hash
+ */
+exports.broadcastTransaction = async (rawTransaction) => {
+  const provider = getProvider();
+  try {
+    const response = await provider.sendTransaction(rawTransaction);
+    return response.hash;
+  } catch (error) {
+    if (exports.classifyBroadcastError(error) === 'ALREADY_KNOWN') {
+      return ethers.utils.keccak256(rawTransaction);
+    }
+    throw error;
+  }
+};
+
+exports.classifyBroadcastError = classifyBroadcastError;
+
+/**
+ * Record gas used by a transaction confirmed outside this module (the job queue)
+ * @param {String} rawTransaction - Signed transaction bytes
+ * @param {Object} receipt - Transaction receipt
+ */
+exports.recordTransactionGas = (rawTransaction, receipt) => {
+  let method = 'unknown';
+  try {
+    method = contractMethod(identityInterface, ethers.utils.parseTransaction(rawTransaction));
+  } catch (error) {
+    // Not decodable; counted as unknown
+  }
+  recordGasUsed(method, receipt);
+};
+
+/**
+ * Look up the confirmation state of a submitted transaction
+ * @param {String} transactionHash - Transaction hash
+ * @param {Number} requiredConfirmations - Confirmations needed before the result is final
+ * @returns {Object} { state: PENDING|CONFIRMED|FAILED, receipt }
+ */
+exports.getTransactionStatus = async (transactionHash, requiredConfirmations = 1) => {
+  const receipt = await getProvider().getTransactionReceipt(transactionHash);
+
+  if (!receipt || receipt.blockNumber == null || receipt.confirmations < requiredConfirmations) {
+    return { state: 'PENDING', receipt };
+  }
+
+  return {
+    state: receipt.status === 1 ? 'CONFIRMED' : 'FAILED',
+    receipt
+  };
+};
+
+/**
+ * Send a transaction from the admin wallet and wait for its receipt
+ * Nonces come from the admin wallet's nonce manager, so concurrent callers do not
+ * serialize on each other's confirmations and stuck transactions get fee-bumped
+ * @param {Object} transaction - Transaction request (e.g. from contract.populateTransaction)
+ * @returns {Object} Transaction receipt
+ */
+const sendAdminTransaction = async (transaction) => {
+  const { wallet } = initBlockchain();
+  const pending = await getNonceManager(wallet).send(transaction);
+  const receipt = await pending.wait();
+  recordGasUsed(contractMethod(identityInterface, transaction), receipt);
+  return receipt;
+};
+
+/**
+ * Pipeline mode: broadcast all admin transactions back to back, then await the receipts together
+ * @param {Array} transactions - Transaction requests
+ * @returns {Array} Per transaction: { receipt } or { error }
+ */
+const pipelineAdminTransactions = async (transactions) => {
+  const { wallet } = initBlockchain();
+  const results = await getNonceManager(wallet).pipeline(transactions);
+  results.forEach((result, i) => recordGasUsed(contractMethod(identityInterface, transactions[i]), result.receipt));
+  return results;
+};
+
+/**
+ * Reserve a nonce and sign an admin transaction without broadcasting it (used by the job queue)
+ * @param {Object} transaction - Transaction request
+ * @returns {Object} Signed transaction details
+ */
+exports.prepareAdminTransaction = async (transaction) => {
+  const { wallet, networkName } = initBlockchain();
+  return {
+    ...(await getNonceManager(wallet).sign(transaction)),
+    network: networkName
+  };
+};
+
+/**
+ * Format a receipt the way the write helpers below report it
+ */
+const formatReceipt = (receipt, networkName) => ({
+  transactionHash: receipt.transactionHash,
+  blockNumber: receipt.blockNumber,
+  gasUsed: receipt.gasUsed.toString(),
+  status: receipt.status === 1 ? 'success' : 'failed',
+  network: networkName
+});
+
 /**
  * Update biometric hash on blockchain
  * @param {String} walletAddress - User's wallet address
@@ -240,25 +543,18 @@ exports.updateBiometricHash = async (walletAddress, newBiometricHash) => {
     // Convert string hash to bytes32
     const biometricHashBytes = ethers.utils.id(newBiometricHash);
     
-    // Call contract method
-    const tx = await contract.updateBiometricHash(
-      walletAddress,
-      biometricHashBytes,
-      { gasLimit: 200000 }
+    // Send through the admin nonce manager and wait for the receipt
+    const receipt = await sendAdminTransaction(
+      await contract.populateTransaction.updateBiometricHash(
+        walletAddress,
+        biometricHashBytes,
+        { gasLimit: 200000 }
+      )
     );
     
-    // Wait for transaction to be mined
-    const receipt = await tx.wait();
-    
-    return {
-      transactionHash: receipt.transactionHash,
-      blockNumber: receipt.blockNumber,
-      gasUsed: receipt.gasUsed.toString(),
-      status: receipt.status === 1 ? 'success' : 'failed',
-      network: networkName
-    };
+    return formatReceipt(receipt, networkName);
   } catch (error) {
-    console.error('Update biometric hash on blockchain error:', error);
+    logger.error('Update biometric hash on blockchain error:', error);
     throw new Error('Failed to update biometric hash on blockchain');
   }
 };
@@ -272,24 +568,17 @@ exports.verifyIdentity = async (walletAddress) => {
   try {
     const { contract, networkName } = initBlockchain();
     
-    // Call contract method
-    const tx = await contract.verifyIdentity(
-      walletAddress,
-      { gasLimit: 200000 }
+    // Send through the admin nonce manager and wait for the receipt
+    const receipt = await sendAdminTransaction(
+      await contract.populateTransaction.verifyIdentity(
+        walletAddress,
+        { gasLimit: 200000 }
+      )
     );
     
-    // Wait for transaction to be mined
-    const receipt = await tx.wait();
-    
-    return {
-      transactionHash: receipt.transactionHash,
-      blockNumber: receipt.blockNumber,
-      gasUsed: receipt.gasUsed.toString(),
-      status: receipt.status === 1 ? 'success' : 'failed',
-      network: networkName
-    };
+    return formatReceipt(receipt, networkName);
   } catch (error) {
-    console.error('Verify identity on blockchain error:', error);
+    logger.error('Verify identity on blockchain error:', error);
     throw new Error('Failed to verify identity on blockchain');
   }
 };
@@ -310,15 +599,14 @@ exports.addProfessionalRecord = async (walletAddress, dataHash, startTimestamp,
     const dataHashBytes = ethers.utils.id(dataHash);
     
     // Add professional record on blockchain
-    const tx = await contract.addProfessionalRecord(
-      dataHashBytes,
-      startTimestamp,
-      endTimestamp
+    const receipt = await sendAdminTransaction(
+      await contract.populateTransaction.addProfessionalRecord(
+        dataHashBytes,
+        startTimestamp,
+        endTimestamp
+      )
     );
     
-    // Wait for transaction to be mined
-    const receipt = await tx.wait();
-    
     return {
       transactionHash: receipt.transactionHash,
       blockNumber: receipt.blockNumber,
@@ -326,7 +614,7 @@ exports.addProfessionalRecord = async (walletAddress, dataHash, startTimestamp,
       network: networkName
     };
   } catch (error) {
-    console.error('Add professional record error:', error);
+    logger.error('Add professional record error:', error);
     throw new Error(`Failed to add professional record on blockchain: ${error.message}`);
   }
 };
@@ -341,29 +629,59 @@ exports.verifyProfessionalRecord = async (walletAddress, recordIndex) => {
   try {
     const { contract, networkName } = initBlockchain();
     
-    // Call contract method
-    const tx = await contract.verifyProfessionalRecord(
-      walletAddress,
-      recordIndex,
-      { gasLimit: 200000 }
+    // Send through the admin nonce manager and wait for the receipt
+    const receipt = await sendAdminTransaction(
+      await contract.populateTransaction.verifyProfessionalRecord(
+        walletAddress,
+        recordIndex,
+        { gasLimit: 200000 }
+      )
     );
     
-    // Wait for transaction to be mined
-    const receipt = await tx.wait();
-    
-    return {
-      transactionHash: receipt.transactionHash,
-      blockNumber: receipt.blockNumber,
-      gasUsed: receipt.gasUsed.toString(),
-      status: receipt.status === 1 ? 'success' : 'failed',
-      network: networkName
-    };
+    return formatReceipt(receipt, networkName);
   } catch (error) {
-    console.error('Verify professional record on blockchain error:', error);
+    logger.error('Verify professional record on blockchain error:', error);
     throw new Error('Failed to verify professional record on blockchain');
   }
 };
 
+/**
+ * Verify many identities in one pipeline (government only)
+ * All transactions are broadcast before any receipt is awaited, so they can land in the same block
+ * @param {Array} walletAddresses - Users' wallet addresses
+ * @returns {Array} Per address: transaction details or an error message
+ */
+exports.verifyIdentities = async (walletAddresses) => {
+  const { contract, networkName } = initBlockchain();
+  
+  const transactions = await Promise.all(walletAddresses.map(walletAddress =>
+    contract.populateTransaction.verifyIdentity(walletAddress, { gasLimit: 200000 })
+  ));
+  const results = await pipelineAdminTransactions(transactions);
+  
+  return results.map((result, i) => result.receipt
+    ? { walletAddress: walletAddresses[i], ...formatReceipt(result.receipt, networkName) }
+    : { walletAddress: walletAddresses[i], transactionHash: result.hash || null, status: 'failed', error: result.error.message });
+};
+
+/**
+ * Verify many professional records in one pipeline (government only)
+ * @param {Array} records - { walletAddress, recordIndex } entries
+ * @returns {Array} Per record: transaction details or an error message
+ */
+exports.verifyProfessionalRecords = async (records) => {
+  const { contract, networkName } = initBlockchain();
+  
+  const transactions = await Promise.all(records.map(({ walletAddress, recordIndex }) =>
+    contract.populateTransaction.verifyProfessionalRecord(walletAddress, recordIndex, { gasLimit: 200000 })
+  ));
+  const results = await pipelineAdminTransactions(transactions);
+  
+  return results.map((result, i) => result.receipt
+    ? { ...records[i], ...formatReceipt(result.receipt, networkName) }
+    : { ...records[i], transactionHash: result.hash || null, status: 'failed', error: result.error.message });
+};
+
 /**
  * Get biometric hash from blockchain
  * @param {String} walletAddress - User's wallet address
@@ -375,7 +693,7 @@ exports.getBiometricHash = async (walletAddress) => {
     const biometricHash = await contract.getBiometricHash(walletAddress);
     return biometricHash;
   } catch (error) {
-    console.error('Get biometric hash error:', error);
+    logger.error('Get biometric hash error:', error);
     throw new Error('Failed to get biometric hash from blockchain');
   }
 };
@@ -391,7 +709,7 @@ exports.isIdentityVerified = async (walletAddress) => {
     const verified = await contract.isIdentityVerified(walletAddress);
     return verified;
   } catch (error) {
-    console.error('Check identity verification error:', error);
+    logger.error('Check identity verification error:', error);
     throw new Error('Failed to check if identity is verified on blockchain');
   }
 };
@@ -407,7 +725,7 @@ exports.getProfessionalRecordCount = async (walletAddress) => {
     const count = await contract.getProfessionalRecordCount(walletAddress);
     return count.toNumber();
   } catch (error) {
-    console.error('Get professional record count error:', error);
+    logger.error('Get professional record count error:', error);
     throw new Error('Failed to get professional record count from blockchain');
   }
 };
@@ -431,11 +749,243 @@ exports.getProfessionalRecord = async (walletAddress, recordIndex) => {
       createdAt: record.createdAt.toNumber()
     };
   } catch (error) {
-    console.error('Get professional record error:', error);
+    logger.error('Get professional record error:', error);
     throw new Error('Failed to get professional record from blockchain');
   }
 };
 
+const multicallInterface = new ethers.utils.Interface(Multicall3ABI);
+
+/**
+ * Run many view calls through Multicall3, one eth_call per MULTICALL_BATCH_SIZE calls
+ * Falls back to one eth_call per call on networks without Multicall3
+ * @param {ethers.providers.Provider} provider - Provider to call through
+ * @param {Array} calls - { target, callData }
+ * @returns {Array} { success, returnData } per call, in order
+ */
+const aggregate = async (provider, calls) => {
+  const multicall = new ethers.Contract(MULTICALL3_ADDRESS, Multicall3ABI, provider);
+
+  try {
+    const batches = await Promise.all(chunk(calls, MULTICALL_BATCH_SIZE).map(batch =>
+      multicall.callStatic.aggregate3(batch.map(call => ({
+        target: call.target,
+        allowFailure: true,
+        callData: call.callData
+      })))
+    ));
+    return batches.flat().map(result => ({ success: result.success, returnData: result.returnData }));
+  } catch (error) {
+    if (error.code !== 'CALL_EXCEPTION') {
+      throw error;
+    }
+    return Promise.all(calls.map(async (call) => {
+      try {
+        return { success: true, returnData: await provider.call({ to: call.target, data: call.callData }) };
+      } catch (callError) {
+        return { success: false, returnData: '0x' };
+      }
+    }));
+  }
+};
+
+const decodeResult = (iface, functionName, result) => {
+  if (!result.success || result.returnData === '0x') {
+    return null;
+  }
+  try {
+    return iface.decodeFunctionResult(functionName, result.returnData);
+  } catch (error) {
+    return null;
+  }
+};
+
+const formatRecord = (record, index) => ({
+  index,
+  dataHash: record.dataHash,
+  startDate: record.startDate.toNumber(),
+  endDate: record.endDate.toNumber(),
+  verifier: record.verifier,
+  isVerified: record.isVerified,
+  createdAt: record.createdAt.toNumber()
+});
+
+/**
+ * Read summaries with the per-field getters, for contracts deployed before getIdentitySummary
+ * Two aggregated rounds (fields, then records) instead of 3 + N calls per address
+ */
+const getLegacyIdentitySummaries = async (provider, contractAddress, walletAddresses, recordOffset, recordLimit) => {
+  const fieldCalls = [];
+  for (const walletAddress of walletAddresses) {
+    for (const functionName of ['getBiometricHash', 'isIdentityVerified', 'getProfessionalRecordCount']) {
+      fieldCalls.push({
+        target: contractAddress,
+        callData: identityInterface.encodeFunctionData(functionName, [walletAddress])
+      });
+    }
+  }
+  const fieldResults = await aggregate(provider, fieldCalls);
+
+  const summaries = walletAddresses.map((walletAddress, i) => {
+    const biometricHash = decodeResult(identityInterface, 'getBiometricHash', fieldResults[i * 3]);
+    const isVerified = decodeResult(identityInterface, 'isIdentityVerified', fieldResults[i * 3 + 1]);
+    const count = decodeResult(identityInterface, 'getProfessionalRecordCount', fieldResults[i * 3 + 2]);
+
+    return {
+      walletAddress,
+      exists: biometricHash !== null,
+      biometricHash: biometricHash ? biometricHash[0] : null,
+      isVerified: isVerified ? isVerified[0] : false,
+      createdAt: null,
+      updatedAt: null,
+      professionalRecordCount: count ? count[0].toNumber() : 0,
+      professionalRecords: []
+    };
+  });
+
+  const recordCalls = [];
+  for (const summary of summaries) {
+    if (!summary.exists) continue;
+    const end = Math.min(summary.professionalRecordCount, recordOffset + recordLimit);
+    for (let index = recordOffset; index < end; index++) {
+      recordCalls.push({
+        summary,
+        index,
+        target: contractAddress,
+        callData: identityInterface.encodeFunctionData('getProfessionalRecord', [summary.walletAddress, index])
+      });
+    }
+  }
+
+  if (recordCalls.length > 0) {
+    const recordResults = await aggregate(provider, recordCalls);
+    recordCalls.forEach((call, i) => {
+      const record = decodeResult(identityInterface, 'getProfessionalRecord', recordResults[i]);
+      if (record) {
+        call.summary.professionalRecords.push(formatRecord(record, call.index));
+      }
+    });
+  }
+
+  return summaries;
+};
+
+/**
+ * Get on-chain identity status and a page of professional records for many addresses
+ * Everything is fetched in one aggregated eth_call per MULTICALL_BATCH_SIZE calls
+ * @param {Array} walletAddresses - User wallet addresses
+ * @param {Object} options - recordOffset (default 0), recordLimit (default 20, max MAX_BATCH_SIZE; 0 skips records)
+ * @returns {Object} { blockNumber, identities } with one summary per address, in order
+ */
+exports.getIdentitySummaries = async (walletAddresses, options = {}) => {
+  const recordOffset = Math.max(parseInt(options.recordOffset, 10) || 0, 0);
+  const recordLimit = Math.min(
+    Math.max(options.recordLimit === undefined ? 20 : parseInt(options.recordLimit, 10) || 0, 0),
+    MAX_BATCH_SIZE
+  );
+
+  try {
+    const { contractAddress } = getBlockchainConfig();
+    if (!contractAddress) {
+      throw new Error('Contract address is not defined');
+    }
+    const provider = getProvider();
+
+    const calls = [{ target: MULTICALL3_ADDRESS, callData: multicallInterface.encodeFunctionData('getBlockNumber', []) }];
+    for (const walletAddress of walletAddresses) {
+      calls.push({
+        target: contractAddress,
+        callData: identityInterface.encodeFunctionData('getIdentitySummary', [walletAddress])
+      });
+      if (recordLimit > 0) {
+        calls.push({
+          target: contractAddress,
+          callData: identityInterface.encodeFunctionData('getProfessionalRecords', [walletAddress, recordOffset, recordLimit])
+        });
+      }
+    }
+
+    const results = await aggregate(provider, calls);
+    const blockNumber = decodeResult(multicallInterface, 'getBlockNumber', results[0]);
+    const stride = recordLimit > 0 ? 2 : 1;
+
+    const identities = [];
+    const legacy = [];
+    walletAddresses.forEach((walletAddress, i) => {
+      const summary = decodeResult(identityInterface, 'getIdentitySummary', results[1 + i * stride]);
+      if (!summary) {
+        // Contract predates getIdentitySummary
+        legacy.push(i);
+        identities.push(null);
+        return;
+      }
+
+      const page = recordLimit > 0
+        ? decodeResult(identityInterface, 'getProfessionalRecords', results[2 + i * stride])
+        : null;
+
+      identities.push({
+        walletAddress,
+        exists: summary.exists,
+        biometricHash: summary.exists ? summary.biometricHash : null,
+        isVerified: summary.isVerified,
+        createdAt: summary.exists ? summary.createdAt.toNumber() : null,
+        updatedAt: summary.exists ? summary.updatedAt.toNumber() : null,
+        professionalRecordCount: summary.professionalRecordCount.toNumber(),
+        professionalRecords: page ? page.records.map((record, j) => formatRecord(record, recordOffset + j)) : []
+      });
+    });
+
+    if (legacy.length > 0) {
+      const legacySummaries = await getLegacyIdentitySummaries(
+        provider,
+        contractAddress,
+        legacy.map(i => walletAddresses[i]),
+        recordOffset,
+        recordLimit
+      );
+      legacy.forEach((index, j) => {
+        identities[index] = legacySummaries[j];
+      });
+    }
+
+    return {
+      blockNumber: blockNumber ? blockNumber.blockNumber.toNumber() : null,
+      identities
+    };
+  } catch (error) {
+    logger.error('Get identity summaries error:', error);
+    throw new Error('Failed to get identity summaries from blockchain');
+  }
+};
+
+/**
+ * Get on-chain identity status and a page of professional records for one address
+ * @param {String} walletAddress - User's wallet address
+ * @param {Object} options - See getIdentitySummaries
+ * @returns {Object} Summary, plus the blockNumber it was read at
+ */
+exports.getIdentitySummary = async (walletAddress, options = {}) => {
+  const { blockNumber, identities } = await exports.getIdentitySummaries([walletAddress], options);
+  return { ...identities[0], blockNumber };
+};
+
+/**
+ * Convert a role name to its bytes32 id
+ * @param {String} role - USER_ROLE, GOVERNMENT_ROLE or ADMIN_ROLE
+ * @returns {String} Role id
+ */
+const resolveRole = (role) => {
+  if (role === 'USER_ROLE') {
+    return USER_ROLE;
+  } else if (role === 'GOVERNMENT_ROLE') {
+    return GOVERNMENT_ROLE;
+  } else if (role === 'ADMIN_ROLE') {
+    return ADMIN_ROLE;
+  }
+  throw new Error('Invalid role');
+};
+
 /**
  * Grant role to a user (admin only)
  * @param {String} walletAddress - User's wallet address
@@ -447,40 +997,132 @@ exports.grantRole = async (walletAddress, role) => {
     const { contract, networkName } = initBlockchain();
     
     // Convert role string to bytes32
-    let roleBytes;
-    if (role === 'USER_ROLE') {
-      roleBytes = USER_ROLE;
-    } else if (role === 'GOVERNMENT_ROLE') {
-      roleBytes = GOVERNMENT_ROLE;
-    } else if (role === 'ADMIN_ROLE') {
-      roleBytes = ADMIN_ROLE;
-    } else {
-      throw new Error('Invalid role');
-    }
+    const roleBytes = resolveRole(role);
     
-    // Call contract method
-    const tx = await contract.grantRole(
-      walletAddress,
-      roleBytes,
-      { gasLimit: 200000 }
+    // Send through the admin nonce manager and wait for the receipt
+    const receipt = await sendAdminTransaction(
+      await contract.populateTransaction.grantRole(
+        walletAddress,
+        roleBytes,
+        { gasLimit: 200000 }
+      )
     );
     
-    // Wait for transaction to be mined
-    const receipt = await tx.wait();
-    
-    return {
-      transactionHash: receipt.transactionHash,
-      blockNumber: receipt.blockNumber,
-      gasUsed: receipt.gasUsed.toString(),
-      status: receipt.status === 1 ? 'success' : 'failed',
-      network: networkName
-    };
+    return formatReceipt(receipt, networkName);
   } catch (error) {
-    console.error('Grant role error:', error);
+    logger.error('Grant role error:', error);
     throw new Error('Failed to grant role on blockchain');
   }
 };
 
+/**
+ * Grant a role to many accounts (admin only)
+ * @param {Array} walletAddresses - Accounts to grant the role to
+ * @param {String} role - Role to grant (USER_ROLE, GOVERNMENT_ROLE, ADMIN_ROLE)
+ * @returns {Array} One entry per batch transaction
+ */
+exports.grantRoles = async (walletAddresses, role) => {
+  try {
+    const { contract, networkName } = initBlockchain();
+    const roleBytes = resolveRole(role);
+    
+    const batches = chunk(walletAddresses);
+    const transactions = await Promise.all(batches.map(batch =>
+      contract.populateTransaction.grantRoles(batch, roleBytes)
+    ));
+    const results = await pipelineAdminTransactions(transactions);
+    
+    return results.map((result, i) => result.receipt
+      ? { accounts: batches[i], ...formatReceipt(result.receipt, networkName) }
+      : { accounts: batches[i], transactionHash: result.hash || null, status: 'failed', error: result.error.message });
+  } catch (error) {
+    logger.error('Grant roles error:', error);
+    throw new Error('Failed to grant roles on blockchain');
+  }
+};
+
+/**
+ * Populate a batchVerifyIdentities call
+ * @param {Array} walletAddresses - At most MAX_BATCH_SIZE addresses
+ * @returns {Object} Transaction request
+ */
+exports.populateBatchVerifyIdentities = async (walletAddresses) => {
+  if (walletAddresses.length > MAX_BATCH_SIZE) {
+    throw new Error(`At most ${MAX_BATCH_SIZE} identities can be verified per transaction`);
+  }
+  const { contract } = initBlockchain();
+  return contract.populateTransaction.batchVerifyIdentities(walletAddresses);
+};
+
+/**
+ * Verify many identities with one transaction per MAX_BATCH_SIZE addresses (government only)
+ * Batches are pipelined; addresses without an identity or already verified are skipped on-chain
+ * @param {Array} walletAddresses - Users' wallet addresses
+ * @returns {Object} { verified: addresses newly verified, transactions: per-batch details }
+ */
+exports.batchVerifyIdentities = async (walletAddresses) => {
+  try {
+    const { networkName } = initBlockchain();
+    
+    const batches = chunk(walletAddresses);
+    const transactions = await Promise.all(batches.map(exports.populateBatchVerifyIdentities));
+    const results = await pipelineAdminTransactions(transactions);
+    
+    const verified = [];
+    const details = results.map((result, i) => {
+      if (!result.receipt) {
+        return { count: batches[i].length, transactionHash: result.hash || null, status: 'failed', error: result.error.message };
+      }
+      const events = parseReceiptEvents(result.receipt, 'IdentityVerified');
+      verified.push(...events.map(args => args.user));
+      return { count: batches[i].length, verifiedCount: events.length, ...formatReceipt(result.receipt, networkName) };
+    });
+    
+    return { verified, transactions: details };
+  } catch (error) {
+    logger.error('Batch verify identities error:', error);
+    throw new Error('Failed to batch verify identities on blockchain');
+  }
+};
+
+/**
+ * Verify many professional records with one transaction per MAX_BATCH_SIZE records (government only)
+ * @param {Array} records - { walletAddress, recordIndex } entries
+ * @returns {Object} { verified: { walletAddress, recordIndex } newly verified, transactions: per-batch details }
+ */
+exports.batchVerifyProfessionalRecords = async (records) => {
+  try {
+    const { contract, networkName } = initBlockchain();
+    
+    const batches = chunk(records);
+    const transactions = await Promise.all(batches.map(batch =>
+      contract.populateTransaction.batchVerifyProfessionalRecords(
+        batch.map(record => record.walletAddress),
+        batch.map(record => record.recordIndex)
+      )
+    ));
+    const results = await pipelineAdminTransactions(transactions);
+    
+    const verified = [];
+    const details = results.map((result, i) => {
+      if (!result.receipt) {
+        return { count: batches[i].length, transactionHash: result.hash || null, status: 'failed', error: result.error.message };
+      }
+      const events = parseReceiptEvents(result.receipt, 'ProfessionalRecordVerified');
+      verified.push(...events.map(args => ({ walletAddress: args.user, recordIndex: args.recordIndex.toNumber() })));
+      return { count: batches[i].length, verifiedCount: events.length, ...formatReceipt(result.receipt, networkName) };
+    });
+    
+    return { verified, transactions: details };
+  } catch (error) {
+    logger.error('Batch verify professional records error:', error);
+    throw new Error('Failed to batch verify professional records on blockchain');
+  }
+};
+
+exports.MAX_BATCH_SIZE = MAX_BATCH_SIZE;
+exports.parseReceiptEvents = parseReceiptEvents;
+
 /**
  * Verify a document hash on the blockchain
  * @param {String} hash - Document hash to verify
@@ -503,7 +1145,7 @@ exports.verifyDocumentHash = async (hash) => {
       network: networkName
     };
   } catch (error) {
-    console.error('Verify document hash error:', error);
+    logger.error('Verify document hash error:', error);
     throw new Error('Failed to verify document hash on blockchain');
   }
 };
@@ -537,260 +1179,14 @@ exports.switchNetwork = async (network) => {
       throw new Error('.env file not found');
     }
   } catch (error) {
-    console.error('Switch network error:', error);
+    logger.error('Switch network error:', error);
     return false;
   }
 };
 
-/**
- * Check if user data exists on blockchain
- * @param {String} walletAddress - User's wallet address
- * @returns {Boolean} True if data exists on blockchain, false otherwise
- */
-async function checkUserDataOnBlockchain(walletAddress) {
-  try {
-    return await exports.isIdentityRegistered(walletAddress);
-  } catch (error) {
-    console.error(`Error checking user data on blockchain for address ${walletAddress}:`, error);
-    return false;
+// Time every async call exported above and give it a span; RPC spans nest under it
+for (const [name, fn] of Object.entries(exports)) {
+  if (typeof fn === 'function' && fn.constructor.name === 'AsyncFunction') {
+    exports[name] = (...args) => tracing.withSpan(`blockchain.${name}`, {}, () => timeAsync(callDuration, { call: name }, () => fn(...args)));
   }
 }
-
-/**
- * Process expired blockchain statuses
- * This function checks for users with pending blockchain status who have passed
- * their 48-hour expiry time. If a user hasn't transferred their data to the blockchain
- * within 48 hours after verification, their blockchain status will be reset.
- * 
- * @param {Object} db - Database connection pool
- * @returns {Object} Processing results
- */
-exports.processExpiredBlockchainStatuses = async (db) => {
-  const client = await db.connect();
-  try {
-    console.log('Processing expired blockchain statuses...');
-    
-    // Begin transaction
-    await client.query('BEGIN');
-    
-    // Get users with expired blockchain status
-    const expiredUsersResult = await client.query(
-      `SELECT id, name, government_id, avax_address, blockchain_status, blockchain_expiry, blockchain_tx_hash
-       FROM users
-       WHERE blockchain_status = 'PENDING'
-       AND blockchain_expiry < NOW()`
-    );
-    
-    console.log(`Found ${expiredUsersResult.rows.length} users with expired blockchain status`);
-    
-    const results = {
-      total: expiredUsersResult.rows.length,
-      confirmed: 0,
-      expired: 0,
-      details: []
-    };
-    
-    for (const user of expiredUsersResult.rows) {
-      console.log(`Processing user ${user.id} (${user.name})...`);
-      
-      // Check if user data exists on blockchain despite expiry
-      let dataOnBlockchain = false;
-      if (user.avax_address) {
-        dataOnBlockchain = await checkUserDataOnBlockchain(user.avax_address);
-      }
-      
-      if (dataOnBlockchain) {
-        // If data is on blockchain, update status to CONFIRMED
-        console.log(`User ${user.id} data found on blockchain, updating status to CONFIRMED`);
-        await client.query(
-          `UPDATE users
-           SET blockchain_status = 'CONFIRMED',
-               blockchain_expiry = NULL,
-               updated_at = NOW()
-           WHERE id = $1`,
-          [user.id]
-        );
-        
-        // Log the status update
-        await client.query(
-          `INSERT INTO audit_logs (action, entity_type, entity_id, details)
-           VALUES ($1, $2, $3, $4)`,
-          [
-            'USER_BLOCKCHAIN_CONFIRMED',
-            'users',
-            user.id,
-            JSON.stringify({
-              message: 'User data confirmed on blockchain after manual check',
-              previousStatus: 'PENDING'
-            })
-          ]
-        );
-        
-        results.confirmed++;
-        results.details.push({
-          userId: user.id,
-          name: user.name,
-          governmentId: user.government_id,
-          newStatus: 'CONFIRMED'
-        });
-      } else {
-        // If data is not on blockchain, reset blockchain status and transfer funds back to admin
-        console.log(`User ${user.id} data not found on blockchain, resetting blockchain status and transferring funds back`);
-        
-        // Get the transaction details to determine how much AVAX was sent
-        const txResult = await client.query(
-          `SELECT tx_hash, from_address, to_address, amount, created_at 
-           FROM blockchain_transactions 
-           WHERE user_id = $1 AND tx_type = 'INITIAL_FUNDING' AND status = 'COMPLETED'
-           ORDER BY created_at DESC LIMIT 1`,
-          [user.id]
-        );
-        
-        let refundResult = null;
-        
-        // If we found a transaction, attempt to transfer funds back to admin
-        if (txResult.rows.length > 0) {
-          const tx = txResult.rows[0];
-          const { ethers } = require('ethers');
-          
-          try {
-            // Get admin wallet private key from environment variables
-            const adminPrivateKey = process.env.ADMIN_WALLET_PRIVATE_KEY;
-            if (!adminPrivateKey) {
-              throw new Error('ADMIN_WALLET_PRIVATE_KEY not defined in environment variables');
-            }
-            
-            // Get admin wallet address from environment variables
-            const adminWalletAddress = process.env.ADMIN_WALLET_ADDRESS;
-            if (!adminWalletAddress) {
-              throw new Error('ADMIN_WALLET_ADDRESS not defined in environment variables');
-            }
-            
-            // Initialize provider
-            const rpcUrl = process.env.AVALANCHE_FUJI_RPC_URL;
-            if (!rpcUrl) {
-              throw new Error('AVALANCHE_FUJI_RPC_URL not defined in environment variables');
-            }
-            const provider = new ethers.providers.JsonRpcProvider(rpcUrl);
-            
-            // Create wallet instance from user's private key
-            // We need to retrieve the user's private key from the database
-            const userWalletResult = await client.query(
-              'SELECT avax_address, avax_private_key FROM users WHERE id = $1',
-              [user.id]
-            );
-            
-            if (userWalletResult.rows.length > 0 && userWalletResult.rows[0].avax_private_key) {
-              const userWallet = new ethers.Wallet(userWalletResult.rows[0].avax_private_key, provider);
-              
-              // Check user wallet balance
-              const balance = await provider.getBalance(userWallet.address);
-              
-              if (balance.gt(ethers.utils.parseEther('0'))) {
-                // Calculate gas cost (21000 is standard gas limit for transfers)
-                const gasPrice = await provider.getGasPrice();
-                const gasCost = gasPrice.mul(21000);
-                
-                // Calculate amount to send (balance - gas cost)
-                const amountToSend = balance.sub(gasCost);
-                
-                if (amountToSend.gt(0)) {
-                  // Create transaction
-                  const tx = {
-                    to: adminWalletAddress,
-                    value: amountToSend,
-                    gasLimit: 21000,
-                    gasPrice: gasPrice
-                  };
-                  
-                  // Send transaction
-                  const transaction = await userWallet.sendTransaction(tx);
-                  const receipt = await transaction.wait();
-                  
-                  refundResult = {
-                    success: true,
-                    transactionHash: receipt.transactionHash,
-                    blockNumber: receipt.blockNumber,
-                    fromAddress: userWallet.address,
-                    toAddress: adminWalletAddress,
-                    amount: ethers.utils.formatEther(amountToSend)
-                  };
-                  
-                  // Log the refund transaction
-                  await client.query(
-                    `INSERT INTO blockchain_transactions 
-                     (user_id, tx_hash, from_address, to_address, amount, tx_type, status, created_at)
-                     VALUES ($1, $2, $3, $4, $5, $6, $7, NOW())`,
-                    [
-                      user.id,
-                      receipt.transactionHash,
-                      userWallet.address,
-                      adminWalletAddress,
-                      ethers.utils.formatEther(amountToSend),
-                      'EXPIRY_REFUND',
-                      'COMPLETED'
-                    ]
-                  );
-                }
-              }
-            }
-          } catch (error) {
-            console.error(`Error transferring funds back from user ${user.id}:`, error);
-            refundResult = {
-              success: false,
-              error: error.message
-            };
-          }
-        }
-        
-        // Update user blockchain status
-        await client.query(
-          `UPDATE users
-           SET blockchain_status = 'EXPIRED',
-               blockchain_expiry = NULL,
-               updated_at = NOW()
-           WHERE id = $1`,
-          [user.id]
-        );
-        
-        // Log the status update with refund information
-        await client.query(
-          `INSERT INTO audit_logs (action, entity_type, entity_id, details)
-           VALUES ($1, $2, $3, $4)`,
-          [
-            'USER_BLOCKCHAIN_EXPIRED',
-            'users',
-            user.id,
-            JSON.stringify({
-              message: '48-hour blockchain expiry period elapsed without data transfer',
-              previousStatus: 'PENDING',
-              txHash: user.blockchain_tx_hash,
-              refundResult: refundResult
-            })
-          ]
-        );
-        
-        results.expired++;
-        results.details.push({
-          userId: user.id,
-          name: user.name,
-          governmentId: user.government_id,
-          newStatus: 'EXPIRED',
-          refundResult: refundResult
-        });
-      }
-    }
-    
-    // Commit transaction
-    await client.query('COMMIT');
-    console.log('Finished processing expired blockchain statuses');
-    
-    return results;
-  } catch (error) {
-    await client.query('ROLLBACK');
-    console.error('Error processing expired blockchain statuses:', error);
-    throw error;
-  } finally {
-    client.release();
-  }
-};
@@ -0,0 +1,278 @@
+/**
+ * Cache tier for DBIS
+ * Read-through cache used by DatabaseService for hot per-user reads
+ * (profile, verification status, biometric status).
+ *
+ * Entries live in a bounded in-process LRU with a TTL, or in Redis when
+ * REDIS_URL is set so every API instance shares them. Concurrent misses for
+ * the same key are coalesced into a single load. Controllers invalidate the
+ * affected keys after every write; the TTL bounds staleness from writers
+ * that do not.
+ *
+ * Expired local entries are kept until evicted, so reads can still be
+ * answered while the database circuit breaker is open.
+ *
+ * In cluster mode each worker has its own LRU, so invalidations are also
+ * broadcast to the other workers (utils/cluster.utils.js).
+ */
+
+const clusterUtils = require('../utils/cluster.utils');
+const { logger } = require('../utils/logger.utils');
+
+const DEFAULT_TTL_MS = parseInt(process.env.CACHE_TTL_MS || '60000', 10);
+const MAX_ENTRIES = parseInt(process.env.CACHE_MAX_ENTRIES || '10000', 10);
+const KEY_PREFIX = process.env.CACHE_KEY_PREFIX || 'dbis:';
+
+const INVALIDATE_CHANNEL = 'cache:invalidate';
+
+/**
+ * Cache keys per entity, so readers and invalidators agree on them
+ */
+const keys = {
+  userProfile: (userId) => `user:${userId}:profile`,
+  verificationStatus: (userId) => `user:${userId}:verification`,
+  biometricStatus: (userId) => `user:${userId}:biometric`,
+
+  // Every cached read derived from the user's row
+  user: (userId) => [
+    keys.userProfile(userId),
+    keys.verificationStatus(userId),
+    keys.biometricStatus(userId)
+  ]
+};
+
+/**
+ * Size-bounded LRU map with per-entry expiry
+ * A Map iterates in insertion order, so re-inserting on read keeps the
+ * least recently used entry first
+ */
+class LruStore {
+  constructor(maxEntries = MAX_ENTRIES) {
+    this.maxEntries = maxEntries;
+    this.entries = new Map();
+  }
+
+  async get(key) {
+    const entry = this.entries.get(key);
+    if (!entry) return undefined;
+
+    this.entries.delete(key);
+    this.entries.set(key, entry);
+    return entry.expiresAt > Date.now() ? entry.value : undefined;
+  }
+
+  /**
+   * Value of an entry regardless of expiry, for fallback reads
+   */
+  getStale(key) {
+    const entry = this.entries.get(key);
+    return entry ? entry.value : undefined;
+  }
+
+  async set(key, value, ttl) {
+    this.entries.delete(key);
+    while (this.entries.size >= this.maxEntries) {
+      this.entries.delete(this.entries.keys().next().value);
+    }
+    this.entries.set(key, { value, expiresAt: Date.now() + ttl });
+  }
+
+  async del(keyList) {
+    keyList.forEach(key => this.entries.delete(key));
+  }
+
+  async clear() {
+    this.entries.clear();
+  }
+
+  get size() {
+    return this.entries.size;
+  }
+}
+
+/**
+ * Shared store backed by Redis (node-redis v4)
+ * Values are stored as JSON with a PX expiry; Redis applies its own eviction policy
+ */
+class RedisStore {
+  constructor(client) {
+    this.client = client;
+  }
+
+  async get(key) {
+    const raw = await this.client.get(KEY_PREFIX + key);
+    return raw === null ? undefined : JSON.parse(raw);
+  }
+
+  getStale() {
+    return undefined;
+  }
+
+  async set(key, value, ttl) {
+    await this.client.set(KEY_PREFIX + key, JSON.stringify(value), { PX: ttl });
+  }
+
+  async del(keyList) {
+    if (keyList.length > 0) {
+      await this.client.del(keyList.map(key => KEY_PREFIX + key));
+    }
+  }
+
+  async clear() {
+    for await (const key of this.client.scanIterator({ MATCH: `${KEY_PREFIX}*`, COUNT: 500 })) {
+      await this.client.del(key);
+    }
+  }
+}
+
+/**
+ * Read-through cache with request coalescing
+ */
+class Cache {
+  constructor(store, options = {}) {
+    this.store = store;
+    this.ttl = options.ttl || DEFAULT_TTL_MS;
+    // Forward invalidations to the other cluster workers (local stores only)
+    this.replicate = !!options.replicate;
+    this.inflight = new Map();
+    // Bumped on invalidation so a load that started before a write is not cached after it
+    this.generations = new Map();
+    this.stats = { hits: 0, misses: 0, coalesced: 0, errors: 0 };
+  }
+
+  /**
+   * Return the cached value for key, or load, cache and return it
+   * @param {String} key - Cache key (see keys)
+   * @param {Function} loader - Async function producing the value; undefined results are not cached
+   * @param {Object} options - ttl (ms), fallback (serve an expired entry if the loader fails)
+   * @returns {*} Cached or freshly loaded value
+   */
+  async wrap(key, loader, options = {}) {
+    try {
+      const cached = await this.store.get(key);
+      if (cached !== undefined) {
+        this.stats.hits++;
+        return cached;
+      }
+    } catch (error) {
+      this.stats.errors++;
+      logger.error('Cache read error:', error.message);
+    }
+
+    if (this.inflight.has(key)) {
+      this.stats.coalesced++;
+      return this.inflight.get(key);
+    }
+
+    this.stats.misses++;
+    const generation = this.generations.get(key) || 0;
+    const load = Promise.resolve()
+      .then(loader)
+      .then(async (value) => {
+        if (value !== undefined && (this.generations.get(key) || 0) === generation) {
+          await this.store.set(key, value, options.ttl || this.ttl).catch((error) => {
+            this.stats.errors++;
+            logger.error('Cache write error:', error.message);
+          });
+        }
+        return value;
+      })
+      .catch((error) => {
+        const stale = options.fallback ? this.store.getStale(key) : undefined;
+        if (stale !== undefined) {
+          logger.info(`Serving stale cache entry for ${key}`);
+          return stale;
+        }
+        throw error;
+      })
+      .finally(() => {
+        // An invalidation may already have replaced this load
+        if (this.inflight.get(key) === load) {
+          this.inflight.delete(key);
+        }
+      });
+
+    this.inflight.set(key, load);
+    return load;
+  }
+
+  /**
+   * Drop cached values after a write
+   * @param {String|Array} keyList - Key or keys to drop
+   * @param {Object} options - replicated: received from another worker, do not forward
+   */
+  async invalidate(keyList, options = {}) {
+    const list = [].concat(keyList);
+    if (this.replicate && !options.replicated) {
+      clusterUtils.broadcast(INVALIDATE_CHANNEL, list);
+    }
+    list.forEach((key) => {
+      this.generations.set(key, (this.generations.get(key) || 0) + 1);
+      this.inflight.delete(key);
+    });
+    // Generations only need to outlive in-flight loads
+    if (this.generations.size > MAX_ENTRIES) {
+      this.generations.clear();
+    }
+
+    try {
+      await this.store.del(list);
+    } catch (error) {
+      this.stats.errors++;
+      logger.error('Cache invalidation error:', error.message);
+    }
+  }
+
+  async clear() {
+    this.inflight.clear();
+    this.generations.clear();
+    await this.store.clear();
+  }
+}
+
+/**
+ * Connect the Redis store, or return null if Redis is not configured or unavailable
+ * The redis package is only required when REDIS_URL is set
+ */
+const connectRedis = (url) => {
+  let redis;
+  try {
+    redis = require('redis');
+  } catch (error) {
+    logger.warn('REDIS_URL is set but the redis package is not installed; using the in-process cache');
+    return null;
+  }
+
+  // Fail fast while disconnected so reads fall through to the database
+  const client = redis.createClient({ url, disableOfflineQueue: true });
+  client.on('error', (error) => logger.error('Redis cache error:', error.message));
+  client.connect().catch((error) => logger.error('Redis cache connection failed:', error.message));
+  return new RedisStore(client);
+};
+
+/**
+ * Create the cache tier from the environment
+ * @param {Object} options - ttl, maxEntries, redisUrl (defaults from CACHE_* and REDIS_URL)
+ * @returns {Cache} Cache
+ */
+const createCache = (options = {}) => {
+  const redisUrl = options.redisUrl !== undefined ? options.redisUrl : process.env.REDIS_URL;
+  const store = (redisUrl && connectRedis(redisUrl)) || new LruStore(options.maxEntries);
+  const local = store instanceof LruStore;
+  const cache = new Cache(store, { ...options, replicate: local });
+
+  if (local) {
+    clusterUtils.onBroadcast(INVALIDATE_CHANNEL, (list) => {
+      cache.invalidate(list, { replicated: true }).catch(() => {});
+    });
+  }
+  return cache;
+};
+
+module.exports = {
+  keys,
+  createCache,
+  Cache,
+  LruStore,
+  RedisStore
+};
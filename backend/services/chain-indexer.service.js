@@ -0,0 +1,573 @@
+/**
+ * Chain indexer for DBIS
+ * Mirrors IdentityManagement events into Postgres projection tables so read
+ * endpoints can answer from the database instead of calling the RPC endpoint.
+ *
+ * The indexer backfills from a stored block cursor in fixed block ranges, then
+ * follows the chain head. Block hashes of recently indexed blocks are kept so a
+ * reorg can be detected, rewound to the fork point and replayed. One indexer per
+ * contract holds a lease on its cursor row at a time.
+ */
+const os = require('os');
+const ethers = require('ethers');
+const blockchainService = require('./blockchain.service');
+const { IntervalJob } = require('../utils/scheduler.utils');
+const { logger } = require('../utils/logger.utils');
+
+const DEFAULT_OPTIONS = {
+  pollInterval: parseInt(process.env.CHAIN_INDEXER_POLL_INTERVAL || '3000', 10),
+  startBlock: parseInt(process.env.CHAIN_INDEXER_START_BLOCK || '0', 10),
+  blockRange: parseInt(process.env.CHAIN_INDEXER_BLOCK_RANGE || '2048', 10), // Fuji RPC eth_getLogs limit
+  confirmations: parseInt(process.env.CHAIN_INDEXER_CONFIRMATIONS || '1', 10),
+  leaseMs: 60000,
+  reorgWindow: 128,
+  staleAfterMs: parseInt(process.env.CHAIN_INDEXER_STALE_AFTER_MS || '60000', 10)
+};
+
+const INDEXED_EVENTS = [
+  'IdentityCreated',
+  'IdentityUpdated',
+  'IdentityVerified',
+  'ProfessionalRecordAdded',
+  'ProfessionalRecordVerified'
+];
+
+const contractInterface = new ethers.utils.Interface(blockchainService.IdentityManagementABI);
+const EVENT_TOPICS = INDEXED_EVENTS.map(name => contractInterface.getEventTopic(name));
+
+const toTimestamp = (seconds) => new Date(Number(seconds) * 1000);
+
+const withTransaction = async (db, callback) => {
+  const client = await db.connect();
+  try {
+    await client.query('BEGIN');
+    const result = await callback(client);
+    await client.query('COMMIT');
+    return result;
+  } catch (error) {
+    await client.query('ROLLBACK');
+    throw error;
+  } finally {
+    client.release();
+  }
+};
+
+/**
+ * Event projections
+ * Each handler applies one decoded event to the projection tables, in
+ * (block_number, log_index) order. Values the events lack (record index and
+ * dates, the hash after an update) are stored in the event args at index time
+ */
+const PROJECTIONS = {
+  IdentityCreated: (client, contract, event) => client.query(
+    `INSERT INTO chain_identities
+     (contract_address, account, biometric_hash, created_at, updated_at, created_block, updated_block)
+     VALUES ($1, $2, $3, $4, $4, $5, $5)
+     ON CONFLICT (contract_address, account) DO NOTHING`,
+    [contract, event.account, event.args.biometricHash, toTimestamp(event.args.timestamp), event.block_number]
+  ),
+
+  IdentityUpdated: (client, contract, event) => client.query(
+    `UPDATE chain_identities
+     SET biometric_hash = COALESCE($3, biometric_hash), updated_at = $4, updated_block = $5
+     WHERE contract_address = $1 AND account = $2`,
+    [contract, event.account, event.args.biometricHash || null, toTimestamp(event.args.timestamp), event.block_number]
+  ),
+
+  IdentityVerified: (client, contract, event) => client.query(
+    `UPDATE chain_identities
+     SET is_verified = TRUE, verified_by = $3, verified_at = $4, updated_at = $4, updated_block = $5
+     WHERE contract_address = $1 AND account = $2`,
+    [contract, event.account, event.args.verifier, toTimestamp(event.args.timestamp), event.block_number]
+  ),
+
+  ProfessionalRecordAdded: (client, contract, event) => client.query(
+    `INSERT INTO chain_professional_records
+     (contract_address, account, record_index, data_hash, start_date, end_date, created_at, created_block)
+     VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+     ON CONFLICT (contract_address, account, record_index) DO NOTHING`,
+    [
+      contract,
+      event.account,
+      event.args.recordIndex,
+      event.args.dataHash,
+      event.args.startDate == null ? null : toTimestamp(event.args.startDate),
+      event.args.endDate == null || event.args.endDate === '0' ? null : toTimestamp(event.args.endDate),
+      toTimestamp(event.args.timestamp),
+      event.block_number
+    ]
+  ),
+
+  ProfessionalRecordVerified: (client, contract, event) => client.query(
+    `UPDATE chain_professional_records
+     SET is_verified = TRUE, verifier = $4, verified_at = $5
+     WHERE contract_address = $1 AND account = $2 AND record_index = $3`,
+    [contract, event.account, event.args.recordIndex, event.args.verifier, toTimestamp(event.args.timestamp)]
+  )
+};
+
+/**
+ * Serialize a parsed log's args to plain JSON (BigNumbers become strings)
+ */
+const serializeArgs = (parsed) => {
+  const args = {};
+  parsed.eventFragment.inputs.forEach((input, i) => {
+    const value = parsed.args[i];
+    args[input.name] = ethers.BigNumber.isBigNumber(value) ? value.toString() : value;
+  });
+  return args;
+};
+
+class ChainIndexer extends IntervalJob {
+  constructor(db, options = {}) {
+    const merged = { ...DEFAULT_OPTIONS, ...options };
+    super({ name: 'Chain indexer', interval: merged.pollInterval });
+    this.db = db;
+    this.options = merged;
+    this.indexerId = `${os.hostname()}:${process.pid}`;
+    this.contractAddress = (this.options.contractAddress ||
+      blockchainService.getBlockchainConfig().contractAddress || '').toLowerCase();
+    this.provider = this.options.provider || blockchainService.getProvider();
+    this.contract = new ethers.Contract(this.contractAddress, blockchainService.IdentityManagementABI, this.provider);
+  }
+
+  start() {
+    if (this.running) return this;
+    if (!this.contractAddress) {
+      logger.warn('Chain indexer not started: contract address is not configured');
+      return this;
+    }
+    logger.info(`Chain indexer ${this.indexerId} started for ${this.contractAddress}`);
+    return super.start();
+  }
+
+  async stop() {
+    await super.stop();
+    await this.releaseLease().catch(() => {});
+  }
+
+  async run() {
+    const cursor = await this.lease();
+    const behind = cursor ? await this.indexNext(cursor) : false;
+
+    // Keep going without a pause while backfilling
+    return behind ? 0 : this.options.pollInterval;
+  }
+
+  /**
+   * Take (or renew) the lease on this contract's cursor row
+   * @returns {Object|null} Cursor row, or null if another indexer holds the lease
+   */
+  async lease() {
+    await this.db.query(
+      `INSERT INTO chain_index_cursors (contract_address, block_number)
+       VALUES ($1, $2)
+       ON CONFLICT (contract_address) DO NOTHING`,
+      [this.contractAddress, this.options.startBlock - 1]
+    );
+
+    const result = await this.db.query(
+      `UPDATE chain_index_cursors
+       SET locked_by = $2, locked_until = NOW() + ($3 * INTERVAL '1 millisecond')
+       WHERE contract_address = $1
+         AND (locked_by IS NULL OR locked_by = $2 OR locked_until < NOW())
+       RETURNING block_number, block_hash`,
+      [this.contractAddress, this.indexerId, this.options.leaseMs]
+    );
+
+    if (result.rows.length === 0) {
+      return null;
+    }
+    const cursor = result.rows[0];
+    return { blockNumber: Number(cursor.block_number), blockHash: cursor.block_hash };
+  }
+
+  releaseLease() {
+    return this.db.query(
+      `UPDATE chain_index_cursors SET locked_by = NULL, locked_until = NULL
+       WHERE contract_address = $1 AND locked_by = $2`,
+      [this.contractAddress, this.indexerId]
+    );
+  }
+
+  /**
+   * Index the next block range after the cursor
+   * @returns {Boolean} True if the cursor is still behind the safe head
+   */
+  async indexNext(cursor) {
+    if (cursor.blockHash) {
+      const block = await this.provider.getBlock(cursor.blockNumber);
+      if (!block || block.hash !== cursor.blockHash) {
+        await this.rewind(cursor);
+        return true;
+      }
+    }
+
+    const head = await this.provider.getBlockNumber();
+    const safeHead = head - this.options.confirmations;
+    const fromBlock = cursor.blockNumber + 1;
+    if (fromBlock > safeHead) {
+      // Caught up; mark the index fresh for readers
+      await this.db.query(
+        `UPDATE chain_index_cursors SET caught_up_at = NOW(), updated_at = NOW()
+         WHERE contract_address = $1 AND locked_by = $2`,
+        [this.contractAddress, this.indexerId]
+      );
+      return false;
+    }
+    const toBlock = Math.min(fromBlock + this.options.blockRange - 1, safeHead);
+
+    const [logs, toHeader] = await Promise.all([
+      this.provider.getLogs({ address: this.contractAddress, fromBlock, toBlock, topics: [EVENT_TOPICS] }),
+      this.provider.getBlock(toBlock)
+    ]);
+
+    const parsedLogs = logs
+      .filter(log => !log.removed)
+      .map(log => ({ log, parsed: contractInterface.parseLog(log) }));
+    const recordCounts = await this.recordCounts(parsedLogs
+      .filter(({ parsed }) => parsed.name === 'ProfessionalRecordAdded')
+      .map(({ parsed }) => parsed.args.user.toLowerCase()));
+
+    const events = [];
+    for (const { log, parsed } of parsedLogs) {
+      const args = serializeArgs(parsed);
+      const account = args.user.toLowerCase();
+
+      // Fields the events do not carry are read once here, so replays need no RPC
+      if (parsed.name === 'IdentityUpdated') {
+        args.biometricHash = await this.readBiometricHash(args.user, log.blockNumber);
+      } else if (parsed.name === 'ProfessionalRecordAdded') {
+        const recordIndex = recordCounts.get(account) || 0;
+        recordCounts.set(account, recordIndex + 1);
+        Object.assign(args, { recordIndex }, await this.readRecordDates(args.user, recordIndex));
+      }
+
+      events.push({
+        block_number: log.blockNumber,
+        block_hash: log.blockHash,
+        transaction_hash: log.transactionHash,
+        log_index: log.logIndex,
+        event_name: parsed.name,
+        account,
+        args
+      });
+    }
+
+    await withTransaction(this.db, async (client) => {
+      for (const event of events) {
+        const inserted = await client.query(
+          `INSERT INTO chain_events
+           (contract_address, block_number, block_hash, transaction_hash, log_index, event_name, account, args)
+           VALUES ($1, $2, $3, $4, $5, $6, $7, $8)
+           ON CONFLICT (contract_address, transaction_hash, log_index) DO NOTHING
+           RETURNING id`,
+          [this.contractAddress, event.block_number, event.block_hash, event.transaction_hash,
+           event.log_index, event.event_name, event.account, JSON.stringify(event.args)]
+        );
+        if (inserted.rows.length > 0) {
+          await PROJECTIONS[event.event_name](client, this.contractAddress, event);
+        }
+      }
+
+      const blocks = new Map(events.map(event => [event.block_number, event.block_hash]));
+      blocks.set(toBlock, toHeader.hash);
+      for (const [blockNumber, blockHash] of blocks) {
+        await client.query(
+          `INSERT INTO chain_index_blocks (contract_address, block_number, block_hash)
+           VALUES ($1, $2, $3)
+           ON CONFLICT (contract_address, block_number) DO UPDATE SET block_hash = EXCLUDED.block_hash`,
+          [this.contractAddress, blockNumber, blockHash]
+        );
+      }
+      await client.query(
+        `DELETE FROM chain_index_blocks WHERE contract_address = $1 AND block_number < $2`,
+        [this.contractAddress, toBlock - this.options.reorgWindow]
+      );
+
+      await this.advance(client, toBlock, toHeader.hash, toBlock >= safeHead);
+    });
+
+    if (events.length > 0) {
+      logger.info(`Chain indexer stored ${events.length} events from blocks ${fromBlock}-${toBlock}`);
+    }
+    return toBlock < safeHead;
+  }
+
+  /**
+   * Number of indexed professional records per account
+   */
+  async recordCounts(accounts) {
+    if (accounts.length === 0) return new Map();
+    const result = await this.db.query(
+      `SELECT account, COUNT(*)::int AS count
+       FROM chain_professional_records
+       WHERE contract_address = $1 AND account = ANY($2)
+       GROUP BY account`,
+      [this.contractAddress, [...new Set(accounts)]]
+    );
+    return new Map(result.rows.map(row => [row.account, row.count]));
+  }
+
+  async readRecordDates(user, recordIndex) {
+    // Record dates never change, so the latest state is always correct
+    try {
+      const record = await this.contract.getProfessionalRecord(user, recordIndex);
+      return { startDate: record.startDate.toString(), endDate: record.endDate.toString() };
+    } catch (error) {
+      return { startDate: null, endDate: null };
+    }
+  }
+
+  async readBiometricHash(user, blockNumber) {
+    try {
+      return await this.contract.getBiometricHash(user, { blockTag: blockNumber });
+    } catch (error) {
+      // Non-archive nodes cannot serve old state; the latest value is correct once caught up
+      try {
+        return await this.contract.getBiometricHash(user);
+      } catch (latestError) {
+        return null;
+      }
+    }
+  }
+
+  /**
+   * Move the cursor, failing if the lease was lost to another indexer meanwhile
+   * The index only counts as fresh (caught_up_at) when the cursor reaches the safe head;
+   * a backfill or catch-up chunk that leaves it behind clears the marker
+   */
+  async advance(client, blockNumber, blockHash, caughtUp) {
+    const result = await client.query(
+      `UPDATE chain_index_cursors
+       SET block_number = $3, block_hash = $4, updated_at = NOW(),
+           caught_up_at = CASE WHEN $5 THEN NOW() END
+       WHERE contract_address = $1 AND locked_by = $2`,
+      [this.contractAddress, this.indexerId, blockNumber, blockHash, caughtUp]
+    );
+    if (result.rowCount === 0) {
+      throw new Error(`Chain indexer lease for ${this.contractAddress} was lost`);
+    }
+  }
+
+  /**
+   * Handle a reorg: find the newest stored block still on the canonical chain,
+   * drop everything after it and rebuild the affected accounts' projections
+   */
+  async rewind(cursor) {
+    const stored = await this.db.query(
+      `SELECT block_number, block_hash FROM chain_index_blocks
+       WHERE contract_address = $1 AND block_number <= $2
+       ORDER BY block_number DESC`,
+      [this.contractAddress, cursor.blockNumber]
+    );
+
+    let fork = null;
+    for (const row of stored.rows) {
+      const block = await this.provider.getBlock(Number(row.block_number));
+      if (block && block.hash === row.block_hash) {
+        fork = { blockNumber: Number(row.block_number), blockHash: row.block_hash };
+        break;
+      }
+    }
+    if (!fork) {
+      // Deeper than the stored window: rewind past it and re-read from there
+      fork = { blockNumber: Math.max(cursor.blockNumber - this.options.reorgWindow * 2, this.options.startBlock - 1), blockHash: null };
+    }
+
+    logger.warn(`Chain reorg detected at block ${cursor.blockNumber}, rewinding ${this.contractAddress} to ${fork.blockNumber}`);
+
+    await withTransaction(this.db, async (client) => {
+      const affected = await client.query(
+        `DELETE FROM chain_events WHERE contract_address = $1 AND block_number > $2
+         RETURNING account`,
+        [this.contractAddress, fork.blockNumber]
+      );
+      await client.query(
+        `DELETE FROM chain_index_blocks WHERE contract_address = $1 AND block_number > $2`,
+        [this.contractAddress, fork.blockNumber]
+      );
+
+      const accounts = [...new Set(affected.rows.map(row => row.account))];
+      await rebuildProjections(client, this.contractAddress, accounts);
+      await this.advance(client, fork.blockNumber, fork.blockHash, false);
+    });
+  }
+}
+
+/**
+ * Recompute projections for accounts by replaying their stored events
+ * @param {Object} client - pg client inside a transaction
+ * @param {String} contractAddress - Lowercased contract address
+ * @param {Array} accounts - Lowercased wallet addresses
+ */
+const rebuildProjections = async (client, contractAddress, accounts) => {
+  if (accounts.length === 0) return;
+
+  await client.query(
+    `DELETE FROM chain_professional_records WHERE contract_address = $1 AND account = ANY($2)`,
+    [contractAddress, accounts]
+  );
+  await client.query(
+    `DELETE FROM chain_identities WHERE contract_address = $1 AND account = ANY($2)`,
+    [contractAddress, accounts]
+  );
+
+  const events = await client.query(
+    `SELECT block_number, event_name, account, args FROM chain_events
+     WHERE contract_address = $1 AND account = ANY($2)
+     ORDER BY block_number, log_index`,
+    [contractAddress, accounts]
+  );
+  for (const event of events.rows) {
+    await PROJECTIONS[event.event_name](client, contractAddress, {
+      ...event,
+      block_number: Number(event.block_number)
+    });
+  }
+};
+
+/**
+ * Read identity summaries from the index, in the shape of blockchainService.getIdentitySummaries
+ * @param {Object} db - Database service
+ * @param {Array} walletAddresses - User wallet addresses
+ * @param {Object} options - recordOffset (default 0), recordLimit (default 20; 0 skips records),
+ *                           maxLagBlocks (also require the cursor within this many blocks of the head)
+ * @returns {Object|null} { blockNumber, identities, indexed: true }, or null when the index is
+ *                        missing, not caught up or stale and the caller should read from the chain
+ */
+exports.getIdentitySummaries = async (db, walletAddresses, options = {}) => {
+  const contractAddress = (blockchainService.getBlockchainConfig().contractAddress || '').toLowerCase();
+  if (!contractAddress) return null;
+
+  const recordOffset = Math.max(parseInt(options.recordOffset, 10) || 0, 0);
+  const recordLimit = Math.min(
+    Math.max(options.recordLimit === undefined ? 20 : parseInt(options.recordLimit, 10) || 0, 0),
+    blockchainService.MAX_BATCH_SIZE
+  );
+
+  try {
+    const cursorResult = await db.query(
+      `SELECT block_number FROM chain_index_cursors
+       WHERE contract_address = $1 AND caught_up_at > NOW() - ($2 * INTERVAL '1 millisecond')`,
+      [contractAddress, DEFAULT_OPTIONS.staleAfterMs]
+    );
+    if (cursorResult.rows.length === 0) {
+      return null;
+    }
+    if (options.maxLagBlocks !== undefined) {
+      const head = await blockchainService.getProvider().getBlockNumber();
+      if (head - Number(cursorResult.rows[0].block_number) > options.maxLagBlocks) {
+        return null;
+      }
+    }
+
+    const accounts = walletAddresses.map(address => address.toLowerCase());
+    const [identitiesResult, countsResult, recordsResult] = await Promise.all([
+      db.query(
+        `SELECT account, biometric_hash, is_verified, created_at, updated_at
+         FROM chain_identities
+         WHERE contract_address = $1 AND account = ANY($2)`,
+        [contractAddress, accounts]
+      ),
+      db.query(
+        `SELECT account, COUNT(*)::int AS count
+         FROM chain_professional_records
+         WHERE contract_address = $1 AND account = ANY($2)
+         GROUP BY account`,
+        [contractAddress, accounts]
+      ),
+      recordLimit > 0
+        ? db.query(
+          `SELECT account, record_index, data_hash, start_date, end_date, is_verified, verifier, created_at
+           FROM chain_professional_records
+           WHERE contract_address = $1 AND account = ANY($2)
+             AND record_index >= $3 AND record_index < $3 + $4
+           ORDER BY account, record_index`,
+          [contractAddress, accounts, recordOffset, recordLimit]
+        )
+        : { rows: [] }
+    ]);
+
+    const identities = new Map(identitiesResult.rows.map(row => [row.account, row]));
+    const counts = new Map(countsResult.rows.map(row => [row.account, row.count]));
+    const records = new Map();
+    for (const row of recordsResult.rows) {
+      if (!records.has(row.account)) records.set(row.account, []);
+      records.get(row.account).push({
+        index: row.record_index,
+        dataHash: row.data_hash,
+        startDate: row.start_date ? Math.floor(new Date(row.start_date).getTime() / 1000) : 0,
+        endDate: row.end_date ? Math.floor(new Date(row.end_date).getTime() / 1000) : 0,
+        verifier: row.verifier || ethers.constants.AddressZero,
+        isVerified: row.is_verified,
+        createdAt: Math.floor(new Date(row.created_at).getTime() / 1000)
+      });
+    }
+
+    return {
+      blockNumber: Number(cursorResult.rows[0].block_number),
+      indexed: true,
+      identities: walletAddresses.map((walletAddress, i) => {
+        const identity = identities.get(accounts[i]);
+        return {
+          walletAddress,
+          exists: Boolean(identity),
+          biometricHash: identity ? identity.biometric_hash : null,
+          isVerified: identity ? identity.is_verified : false,
+          createdAt: identity ? Math.floor(new Date(identity.created_at).getTime() / 1000) : null,
+          updatedAt: identity ? Math.floor(new Date(identity.updated_at).getTime() / 1000) : null,
+          professionalRecordCount: counts.get(accounts[i]) || 0,
+          professionalRecords: records.get(accounts[i]) || []
+        };
+      })
+    };
+  } catch (error) {
+    // Index tables missing (migration not run) or unreadable; fall back to the chain
+    logger.warn('Chain index read failed, falling back to RPC:', error.message);
+    return null;
+  }
+};
+
+/**
+ * Read identity summaries from the index, or from the chain when the index is not caught up
+ * @param {Object} db - Database service
+ * @param {Array} walletAddresses - User wallet addresses
+ * @param {Object} options - recordOffset, recordLimit, maxLagBlocks
+ * @returns {Object} { blockNumber, identities }
+ */
+exports.readIdentitySummaries = async (db, walletAddresses, options = {}) => {
+  const indexed = await exports.getIdentitySummaries(db, walletAddresses, options);
+  return indexed || blockchainService.getIdentitySummaries(walletAddresses, options);
+};
+
+let indexer = null;
+
+/**
+ * Start the shared in-process indexer
+ * @param {Object} db - Database service (query + pool)
+ * @param {Object} options - Indexer options
+ * @returns {ChainIndexer} Running indexer
+ */
+exports.startIndexer = (db, options = {}) => {
+  if (!indexer) {
+    indexer = new ChainIndexer(db, options);
+  }
+  return indexer.start();
+};
+
+/**
+ * Stop the shared in-process indexer, waiting for the current poll to finish
+ */
+exports.stopIndexer = async () => {
+  if (indexer) {
+    // Clear it first so a start() during the wait gets a fresh instance
+    const stopping = indexer;
+    indexer = null;
+    await stopping.stop();
+  }
+};
+
+exports.ChainIndexer = ChainIndexer;
+exports.rebuildProjections = rebuildProjections;
+exports.INDEXED_EVENTS = INDEXED_EVENTS;
@@ -0,0 +1,337 @@
+/**
+ * Change feed for DBIS
+ * Pushes new audit logs, verification requests and blockchain transactions to
+ * connected admin portals over Server-Sent Events, instead of each portal
+ * polling the list and dashboard endpoints.
+ *
+ * Inserts into the watched tables NOTIFY on the dbis_changes channel (see
+ * migrations/add_change_notifications.sql). One dedicated connection per
+ * process LISTENs while at least one portal is subscribed; notifications are
+ * collected for NOTIFY_BATCH_MS, the new rows are read once per batch and the
+ * same events are written to every subscriber. Dashboard stats are re-read at
+ * most once per STATS_THROTTLE_MS, however many rows change.
+ *
+ * Events:
+ *   ready                   subscription established
+ *   audit_log               array of new audit log rows (same shape as GET /api/admin/logs)
+ *   verification_request    array of new verification requests
+ *   blockchain_transaction  array of new blockchain transactions
+ *   stats                   full dashboard stats (same shape as GET /api/admin/dashboard)
+ *   resync                  the listener reconnected and may have missed changes; refetch
+ */
+
+const { Client } = require('pg');
+const statsService = require('./stats.service');
+const { logger } = require('../utils/logger.utils');
+
+const CHANNEL = 'dbis_changes';
+
+const NOTIFY_BATCH_MS = parseInt(process.env.CHANGE_FEED_BATCH_MS || '250', 10);
+const STATS_THROTTLE_MS = parseInt(process.env.CHANGE_FEED_STATS_THROTTLE_MS || '1000', 10);
+const HEARTBEAT_MS = parseInt(process.env.CHANGE_FEED_HEARTBEAT_MS || '25000', 10);
+const MAX_SUBSCRIBERS = parseInt(process.env.CHANGE_FEED_MAX_SUBSCRIBERS || '100', 10);
+
+const RECONNECT_MIN_MS = 1000;
+const RECONNECT_MAX_MS = 30000;
+
+/**
+ * Row readers per watched table; each takes an array of ids and returns rows newest first
+ */
+const READERS = {
+  audit_logs: {
+    event: 'audit_log',
+    sql: `SELECT l.id, l.user_id, l.admin_id, l.action, l.entity_type, l.entity_id, l.details, l.ip_address, l.created_at,
+                 u.name as user_name, u.government_id,
+                 a.username as admin_username
+          FROM audit_logs l
+          LEFT JOIN users u ON l.user_id = u.id
+          LEFT JOIN admins a ON l.admin_id = a.id
+          WHERE l.id = ANY($1::int[])
+          ORDER BY l.created_at DESC, l.id DESC`
+  },
+
+  verification_requests: {
+    event: 'verification_request',
+    sql: `SELECT v.id, v.user_id, v.record_id, v.record_type, v.status, v.entity_type, v.requested_at, v.created_at,
+                 u.name as user_name, u.government_id
+          FROM verification_requests v
+          LEFT JOIN users u ON v.user_id = u.id
+          WHERE v.id = ANY($1::int[])
+          ORDER BY v.created_at DESC, v.id DESC`
+  },
+
+  blockchain_transactions: {
+    event: 'blockchain_transaction',
+    sql: `SELECT t.id, t.user_id, t.transaction_type, t.transaction_hash, t.block_number, t.status, t.network, t.created_at,
+                 u.name as user_name, u.government_id
+          FROM blockchain_transactions t
+          LEFT JOIN users u ON t.user_id = u.id
+          WHERE t.id = ANY($1::int[])
+          ORDER BY t.created_at DESC, t.id DESC`
+  }
+};
+
+/**
+ * Format one Server-Sent Event
+ * @param {String} event - Event name
+ * @param {*} data - JSON-serializable payload
+ * @returns {String} Event frame
+ */
+const formatEvent = (event, data) => `event: ${event}\ndata: ${JSON.stringify(data)}\n\n`;
+
+/**
+ * Fans database change notifications out to SSE subscribers
+ */
+class ChangeFeed {
+  constructor(db) {
+    this.db = db;
+    this.subscribers = new Set();
+    this.client = null;
+    this.connecting = null;
+    this.reconnectDelay = RECONNECT_MIN_MS;
+    this.reconnectTimer = null;
+    this.heartbeatTimer = null;
+    this.pending = new Map();
+    this.flushTimer = null;
+    this.statsTimer = null;
+    this.lastStatsAt = 0;
+  }
+
+  /**
+   * Attach an SSE response; it is detached when the client disconnects
+   * @param {Object} req - Express request object
+   * @param {Object} res - Express response object
+   * @returns {Boolean} False if the subscriber limit is reached
+   */
+  subscribe(req, res) {
+    if (this.subscribers.size >= MAX_SUBSCRIBERS) {
+      return false;
+    }
+
+    res.writeHead(200, {
+      'Content-Type': 'text/event-stream',
+      'Cache-Control': 'no-cache, no-transform',
+      Connection: 'keep-alive',
+      'X-Accel-Buffering': 'no'
+    });
+    res.write(`retry: ${RECONNECT_MIN_MS}\n\n`);
+
+    this.subscribers.add(res);
+    req.on('close', () => this.unsubscribe(res));
+
+    this.ensureListening()
+      .then(() => {
+        if (this.subscribers.has(res)) {
+          res.write(formatEvent('ready', { batchMs: NOTIFY_BATCH_MS }));
+        }
+      })
+      .catch(() => {});
+
+    if (!this.heartbeatTimer) {
+      this.heartbeatTimer = setInterval(() => this.broadcastRaw(': heartbeat\n\n'), HEARTBEAT_MS);
+    }
+    return true;
+  }
+
+  unsubscribe(res) {
+    this.subscribers.delete(res);
+    if (this.subscribers.size === 0) {
+      this.close();
+    }
+  }
+
+  /**
+   * Open the LISTEN connection if it is not open yet
+   */
+  ensureListening() {
+    if (this.client) return Promise.resolve();
+    if (this.connecting) return this.connecting;
+
+    // LISTEN needs a session of its own, so this bypasses PgBouncer when one is in front
+    const client = new Client({ ...this.db.connectionConfig({ direct: true }), keepAlive: true });
+
+    this.connecting = client.connect()
+      .then(() => client.query(`LISTEN ${CHANNEL}`))
+      .then(() => {
+        this.connecting = null;
+        // Every subscriber left while the connection was being opened
+        if (this.subscribers.size === 0) {
+          client.end().catch(() => {});
+          return;
+        }
+
+        const reconnected = this.reconnectDelay > RECONNECT_MIN_MS;
+        this.client = client;
+        this.reconnectDelay = RECONNECT_MIN_MS;
+
+        client.on('notification', (message) => this.onNotification(message));
+        client.on('error', (error) => this.onConnectionLost(client, error));
+        client.on('end', () => this.onConnectionLost(client));
+
+        // Anything inserted while the listener was down was never delivered
+        if (reconnected) {
+          this.broadcast('resync', {});
+        }
+      })
+      .catch((error) => {
+        this.connecting = null;
+        client.end().catch(() => {});
+        this.onConnectionLost(null, error);
+        throw error;
+      });
+
+    return this.connecting;
+  }
+
+  onConnectionLost(client, error) {
+    if (client && client !== this.client) return;
+    if (error) {
+      logger.error('Change feed listener error:', error.message);
+    }
+    if (this.client) {
+      this.client.removeAllListeners();
+      this.client.end().catch(() => {});
+      this.client = null;
+    }
+
+    if (this.subscribers.size === 0 || this.reconnectTimer) return;
+    const delay = this.reconnectDelay;
+    this.reconnectDelay = Math.min(this.reconnectDelay * 2, RECONNECT_MAX_MS);
+    this.reconnectTimer = setTimeout(() => {
+      this.reconnectTimer = null;
+      if (this.subscribers.size > 0) {
+        this.ensureListening().catch(() => {});
+      }
+    }, delay);
+  }
+
+  onNotification(message) {
+    let change;
+    try {
+      change = JSON.parse(message.payload);
+    } catch (error) {
+      return;
+    }
+    if (!READERS[change.table] || !Number.isInteger(change.id)) return;
+
+    if (!this.pending.has(change.table)) {
+      this.pending.set(change.table, new Set());
+    }
+    this.pending.get(change.table).add(change.id);
+
+    if (!this.flushTimer) {
+      this.flushTimer = setTimeout(() => this.flush(), NOTIFY_BATCH_MS);
+    }
+  }
+
+  /**
+   * Read the rows behind one batch of notifications and push them
+   */
+  async flush() {
+    this.flushTimer = null;
+    const batch = this.pending;
+    this.pending = new Map();
+
+    for (const [table, ids] of batch) {
+      const reader = READERS[table];
+      try {
+        const result = await this.db.query(reader.sql, [Array.from(ids)]);
+        if (result.rows.length > 0) {
+          this.broadcast(reader.event, result.rows);
+        }
+      } catch (error) {
+        logger.error(`Change feed read error (${table}):`, error.message);
+      }
+    }
+
+    if (batch.size > 0) {
+      this.scheduleStats();
+    }
+  }
+
+  /**
+   * Push fresh dashboard stats, at most once per STATS_THROTTLE_MS
+   */
+  scheduleStats() {
+    if (this.statsTimer) return;
+    const wait = Math.max(this.lastStatsAt + STATS_THROTTLE_MS - Date.now(), 0);
+
+    this.statsTimer = setTimeout(async () => {
+      this.lastStatsAt = Date.now();
+      try {
+        if (this.subscribers.size > 0) {
+          this.broadcast('stats', await statsService.getDashboardStats(this.db));
+        }
+      } catch (error) {
+        logger.error('Change feed stats error:', error.message);
+      } finally {
+        this.statsTimer = null;
+      }
+    }, wait);
+  }
+
+  broadcast(event, data) {
+    this.broadcastRaw(formatEvent(event, data));
+  }
+
+  broadcastRaw(frame) {
+    for (const res of this.subscribers) {
+      res.write(frame);
+    }
+  }
+
+  /**
+   * Stop listening once the last subscriber has gone
+   */
+  close() {
+    clearInterval(this.heartbeatTimer);
+    clearTimeout(this.reconnectTimer);
+    clearTimeout(this.flushTimer);
+    clearTimeout(this.statsTimer);
+    this.heartbeatTimer = null;
+    this.reconnectTimer = null;
+    this.flushTimer = null;
+    this.statsTimer = null;
+    this.pending = new Map();
+    this.reconnectDelay = RECONNECT_MIN_MS;
+
+    if (this.client) {
+      const client = this.client;
+      this.client = null;
+      client.removeAllListeners();
+      client.end().catch(() => {});
+    }
+  }
+}
+
+let feed = null;
+
+/**
+ * Subscribe an SSE response to the shared in-process change feed
+ * @param {Object} db - Database service
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ * @returns {Boolean} False if the subscriber limit is reached
+ */
+exports.subscribe = (db, req, res) => {
+  if (!feed) {
+    feed = new ChangeFeed(db);
+  }
+  return feed.subscribe(req, res);
+};
+
+/**
+ * End every open stream, e.g. while draining for shutdown
+ * Portals reconnect to another worker on their own
+ */
+exports.closeAll = () => {
+  if (!feed) return;
+  for (const res of feed.subscribers) {
+    res.end();
+  }
+  feed.subscribers.clear();
+  feed.close();
+};
+
+exports.ChangeFeed = ChangeFeed;
+exports.formatEvent = formatEvent;
@@ -1,11 +1,67 @@
 /**
  * Database service for TrueID
- * Provides connection pooling, retry logic, and circuit breaking
+ * Provides connection pooling, retry logic, circuit breaking and a read-through cache
+ *
+ * This is the only pool in a process; utils/db.utils.js delegates to it.
+ * Pool size depends on the process workload (DB_WORKLOAD): API servers use
+ * DB_POOL_MAX, dedicated workers DB_WORKER_POOL_MAX. With DB_PGBOUNCER=true
+ * named prepared statements are sent as plain queries, since transaction
+ * pooling does not keep them on one server connection.
  */
 
 const { Pool } = require('pg');
 const config = require('../config/config');
 const EventEmitter = require('events');
+const { createCache } = require('./cache.service');
+const { registry } = require('../utils/metrics.utils');
+const tracing = require('../utils/tracing.utils');
+const { logger } = require('../utils/logger.utils');
+
+const WORKLOAD = process.env.DB_WORKLOAD || 'api';
+
+const POOL_SIZES = {
+  api: parseInt(process.env.DB_POOL_MAX || '20', 10),
+  worker: parseInt(process.env.DB_WORKER_POOL_MAX || '5', 10)
+};
+
+const PGBOUNCER = process.env.DB_PGBOUNCER === 'true';
+
+// Connection checkouts slower than this are logged as pool contention
+const POOL_WAIT_WARN_MS = parseInt(process.env.DB_POOL_WAIT_WARN_MS || '1000', 10);
+
+const poolWait = registry.histogram('dbis_db_pool_wait_seconds', 'Time spent waiting for a pooled connection');
+const queryDuration = registry.histogram(
+  'dbis_db_query_duration_seconds',
+  'Query time by statement (prepared statement name, or verb and table) and outcome',
+  ['statement', 'outcome']
+);
+const circuitTrips = registry.counter('dbis_db_circuit_trips_total', 'Times the circuit breaker opened');
+
+// Statement labels by SQL text; ad hoc SQL is bounded by the code that issues it
+const statementLabels = new Map();
+const STATEMENT_TABLE = /^\s*(?:insert\s+into|update|delete\s+from|select[\s\S]*?\bfrom)\s+"?(\w+)/i;
+
+/**
+ * Low-cardinality label for a query: the prepared statement name, else e.g. "select users"
+ * @param {String|Object} text - SQL text or pg query config
+ * @returns {String} Label
+ */
+const statementLabel = (text) => {
+  if (typeof text !== 'string') {
+    if (text.name) return text.name;
+    text = text.text;
+  }
+  let label = statementLabels.get(text);
+  if (label === undefined) {
+    const verb = (/^\s*(\w+)/.exec(text) || [null, 'unknown'])[1].toLowerCase();
+    const table = STATEMENT_TABLE.exec(text);
+    label = table ? `${verb} ${table[1].toLowerCase()}` : verb;
+    if (statementLabels.size < 1000) {
+      statementLabels.set(text, label);
+    }
+  }
+  return label;
+};
 
 class DatabaseService extends EventEmitter {
   constructor() {
@@ -15,31 +71,73 @@ class DatabaseService extends EventEmitter {
     this.lastError = null;
     this.circuitBroken = false;
     this.circuitResetTimeout = null;
-    this.inMemoryCache = {
-      users: new Map(),
-      verificationStatuses: new Map(),
-      walletAddresses: new Map(),
-      blockchainStatuses: new Map(),
-      lastUpdated: null
+    // Read-through cache for hot lookups (see cached/invalidate)
+    this.cache = createCache();
+    this.workload = WORKLOAD;
+    this.poolMax = POOL_SIZES[WORKLOAD] || POOL_SIZES.api;
+    // Named statement SQL, so one name can never be prepared with two texts
+    this.statements = new Map();
+    this.poolStats = {
+      acquisitions: 0,
+      waitMsTotal: 0,
+      waitMsMax: 0,
+      slowAcquisitions: 0
     };
     
+    this.registerMetrics();
+    
     // Initialize the connection pool
     this.initPool().catch(err => {
-      console.error('Failed to initialize database pool:', err);
+      logger.error('Failed to initialize database pool:', err);
       this.handleConnectionError(err);
     });
   }
   
+  /**
+   * Connection settings shared by the pool and dedicated session clients
+   * @param {Object} options - direct: bypass PgBouncer (DB_DIRECT_HOST/DB_DIRECT_PORT) for
+   *                           session features such as LISTEN
+   * @returns {Object} pg connection config
+   */
+  connectionConfig(options = {}) {
+    const direct = options.direct && PGBOUNCER;
+    return {
+      user: config.DB_USER,
+      host: (direct && process.env.DB_DIRECT_HOST) || config.DB_HOST,
+      database: config.DB_NAME,
+      password: config.DB_PASSWORD,
+      port: (direct && process.env.DB_DIRECT_PORT) || config.DB_PORT,
+      ssl: process.env.DB_SSL === 'true' ? { rejectUnauthorized: false } : false
+    };
+  }
+  
+  /**
+   * Pool and circuit gauges, read at scrape time
+   */
+  registerMetrics() {
+    registry.gauge('dbis_db_pool_connections', 'Pool connections by state', ['state'], (gauge) => {
+      const total = this.pool ? this.pool.totalCount : 0;
+      const idle = this.pool ? this.pool.idleCount : 0;
+      gauge.set({ state: 'total' }, total);
+      gauge.set({ state: 'idle' }, idle);
+      gauge.set({ state: 'active' }, total - idle);
+      gauge.set({ state: 'waiting' }, this.pool ? this.pool.waitingCount : 0);
+      gauge.set({ state: 'max' }, this.poolMax);
+    });
+    registry.gauge('dbis_db_circuit_open', '1 while the circuit breaker rejects queries', [], (gauge) => {
+      gauge.set({}, this.circuitBroken ? 1 : 0);
+    });
+    registry.gauge('dbis_db_connection_failures', 'Consecutive connection failures', [], (gauge) => {
+      gauge.set({}, this.failureCount);
+    });
+  }
+  
   async initPool() {
     try {
       // Create a new pool with better timeout settings
       this.pool = new Pool({
-        user: config.DB_USER,
-        host: config.DB_HOST,
-        database: config.DB_NAME,
-        password: config.DB_PASSWORD,
-        port: config.DB_PORT,
-        max: 20,
+        ...this.connectionConfig(),
+        max: this.poolMax,
         idleTimeoutMillis: 60000, // 1 minute idle timeout
         connectionTimeoutMillis: 10000, // 10 second connection timeout
         keepAlive: true, // Enable TCP keepalive
@@ -48,7 +146,7 @@ class DatabaseService extends EventEmitter {
 
       // Add pool error handler
       this.pool.on('error', (err, client) => {
-        console.error('Unexpected error on idle client', err);
+        logger.error('Unexpected error on idle client', err);
         this.handleConnectionError(err);
       });
 
@@ -65,7 +163,7 @@ class DatabaseService extends EventEmitter {
             await this.testConnection();
             retryInterval = 5000; // Reset on success
           } catch (err) {
-            console.error('Periodic connection test failed:', err);
+            logger.error('Periodic connection test failed:', err);
             this.handleConnectionError(err);
             retryInterval = Math.min(retryInterval * 1.5, maxInterval);
           }
@@ -76,7 +174,7 @@ class DatabaseService extends EventEmitter {
       scheduleNextTest();
       return true;
     } catch (err) {
-      console.error('Failed to initialize pool:', err);
+      logger.error('Failed to initialize pool:', err);
       this.handleConnectionError(err);
       return false;
     }
@@ -84,17 +182,17 @@ class DatabaseService extends EventEmitter {
   
   async testConnection() {
     if (!this.pool) {
-      console.error('Pool is not initialized');
+      logger.error('Pool is not initialized');
       return false;
     }
 
     try {
-      const client = await this.pool.connect();
+      const client = await this.connect();
       try {
         const result = await client.query('SELECT NOW()');
         if (result.rows.length > 0) {
           if (!this.connectionActive) {
-            console.log('Database connected successfully:', result.rows[0]);
+            logger.info('Database connected successfully:', result.rows[0]);
             this.connectionActive = true;
             this.failureCount = 0;
             this.circuitBroken = false;
@@ -121,7 +219,8 @@ class DatabaseService extends EventEmitter {
     // If we've failed too many times, break the circuit
     if (this.failureCount >= 3 && !this.circuitBroken) {
       this.circuitBroken = true;
-      console.error('Circuit breaker tripped after', this.failureCount, 'failures');
+      circuitTrips.inc();
+      logger.error('Circuit breaker tripped after', this.failureCount, 'failures');
       
       // Try to reset after a delay with exponential backoff
       if (this.circuitResetTimeout) {
@@ -131,7 +230,7 @@ class DatabaseService extends EventEmitter {
       const resetDelay = Math.min(Math.pow(2, this.failureCount) * 1000, 30000); // Max 30 seconds
       
       this.circuitResetTimeout = setTimeout(async () => {
-        console.log('Attempting to reset circuit breaker...');
+        logger.info('Attempting to reset circuit breaker...');
         this.circuitBroken = false;
         try {
           // Try to reinitialize the pool
@@ -140,7 +239,7 @@ class DatabaseService extends EventEmitter {
           }
           await this.initPool();
         } catch (initErr) {
-          console.error('Failed to reinitialize pool:', initErr);
+          logger.error('Failed to reinitialize pool:', initErr);
           this.handleConnectionError(initErr);
         }
       }, resetDelay);
@@ -152,40 +251,121 @@ class DatabaseService extends EventEmitter {
     }
   }
   
+  /**
+   * Check out a client, recording how long the pool made the caller wait
+   * Callers must release() the client
+   * @returns {Object} pg client
+   */
+  async connect() {
+    const start = Date.now();
+    const client = await this.pool.connect();
+    const wait = Date.now() - start;
+    poolWait.observe({}, wait / 1000);
+    
+    this.poolStats.acquisitions++;
+    this.poolStats.waitMsTotal += wait;
+    this.poolStats.waitMsMax = Math.max(this.poolStats.waitMsMax, wait);
+    if (wait > POOL_WAIT_WARN_MS) {
+      this.poolStats.slowAcquisitions++;
+      logger.warn('Slow pool checkout:', { wait, waiting: this.pool.waitingCount, max: this.poolMax });
+    }
+    return client;
+  }
+  
   async query(text, params = []) {
     // If circuit is broken, use fallback immediately
     if (this.circuitBroken) {
       throw new Error('Circuit breaker active - database unavailable');
     }
     
+    const statement = statementLabel(text);
+    const span = tracing.startSpan('db.query', { 'db.system': 'postgresql', 'db.operation': statement });
+    let client;
+    let start;
     try {
-      const start = Date.now();
-      const res = await this.pool.query(text, params);
-      const duration = Date.now() - start;
+      client = await this.connect();
+      start = process.hrtime.bigint();
+      const res = await client.query(text, params);
+      const duration = Number(process.hrtime.bigint() - start) / 1e6;
+      client.release();
+      queryDuration.observe({ statement, outcome: 'ok' }, duration / 1000);
+      tracing.endSpan(span);
       
       // Log slow queries
       if (duration > 500) {
-        console.log('Slow query:', { text, duration, rows: res.rowCount });
+        logger.warn('Slow query:', { text: typeof text === 'string' ? text : text.text, duration: Math.round(duration), rows: res.rowCount });
       }
       
       return res;
     } catch (err) {
+      // Discard the connection rather than return a possibly broken one to the pool
+      if (client) {
+        client.release(err);
+      }
+      if (start) {
+        queryDuration.observe({ statement, outcome: 'error' }, Number(process.hrtime.bigint() - start) / 1e9);
+      }
+      tracing.endSpan(span, err);
       this.handleConnectionError(err);
       throw err;
     }
   }
   
+  /**
+   * Run a hot query as a named prepared statement
+   * Each pooled connection parses and plans it once, then reuses the plan.
+   * In PgBouncer mode it runs as a plain parameterized query
+   * @param {String} name - Statement name, unique per SQL text
+   * @param {String} text - SQL query text
+   * @param {Array} params - Query parameters
+   * @returns {Object} Query result
+   */
+  prepared(name, text, params = []) {
+    if (PGBOUNCER) {
+      return this.query(text, params);
+    }
+    
+    const known = this.statements.get(name);
+    if (known === undefined) {
+      this.statements.set(name, text);
+    } else if (known !== text) {
+      return Promise.reject(new Error(`Prepared statement ${name} is already defined with different SQL`));
+    }
+    return this.query({ name, text }, params);
+  }
+  
+  /**
+   * Pool sizing and checkout wait times
+   * @returns {Object} Pool statistics
+   */
+  getPoolStats() {
+    const { acquisitions, waitMsTotal, waitMsMax, slowAcquisitions } = this.poolStats;
+    return {
+      workload: this.workload,
+      max: this.poolMax,
+      total: this.pool ? this.pool.totalCount : 0,
+      idle: this.pool ? this.pool.idleCount : 0,
+      waiting: this.pool ? this.pool.waitingCount : 0,
+      acquisitions,
+      avgWaitMs: acquisitions > 0 ? Math.round((waitMsTotal / acquisitions) * 100) / 100 : 0,
+      maxWaitMs: waitMsMax,
+      slowAcquisitions,
+      preparedStatements: PGBOUNCER ? 0 : this.statements.size,
+      pgbouncer: PGBOUNCER
+    };
+  }
+  
   // Wrapper function with fallback support
   async withFallback(operation, fallback) {
     try {
       // Try to execute the database operation
       return await operation();
     } catch (err) {
-      console.error('Database operation failed:', err);
+      logger.error('Database operation failed:', err);
       
       // If a fallback function is provided, use it
       if (typeof fallback === 'function') {
-        console.log('Using fallback mechanism for database operation');
+        logger.info('Using fallback mechanism for database operation');
         return fallback();
       }
       
@@ -194,32 +374,29 @@ class DatabaseService extends EventEmitter {
     }
   }
   
-  // Cache management functions
-  updateCache(key, id, data) {
-    if (!this.inMemoryCache[key]) {
-      this.inMemoryCache[key] = new Map();
-    }
-    
-    this.inMemoryCache[key].set(id, data);
-    this.inMemoryCache.lastUpdated = new Date();
+  /**
+   * Read through the cache
+   * Concurrent misses share one load; if the database is unavailable an
+   * expired local entry is served instead of failing
+   * @param {String} key - Cache key (see cache.service keys)
+   * @param {Function} loader - Async function reading the value; return undefined to skip caching
+   * @param {Object} options - ttl (ms)
+   * @returns {*} Cached or loaded value
+   */
+  cached(key, loader, options = {}) {
+    return this.cache.wrap(key, loader, { fallback: true, ...options });
   }
   
-  getFromCache(key, id) {
-    if (!this.inMemoryCache[key]) {
-      return null;
-    }
-    
-    return this.inMemoryCache[key].get(id);
+  /**
+   * Drop cached values after a write; call once the write has committed
+   * @param {String|Array} keys - Key or keys to drop
+   */
+  invalidate(keys) {
+    return this.cache.invalidate(keys);
   }
   
   clearCache() {
-    Object.keys(this.inMemoryCache).forEach(key => {
-      if (key !== 'lastUpdated') {
-        this.inMemoryCache[key] = new Map();
-      }
-    });
-    
-    this.inMemoryCache.lastUpdated = new Date();
+    return this.cache.clear();
   }
   
   /**
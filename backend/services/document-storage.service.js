@@ -0,0 +1,461 @@
+/**
+ * Document storage for DBIS
+ * Content-addressed blob store for uploaded documents.
+ *
+ * Uploads are streamed: the multer storage engine below hashes the file
+ * (SHA-256) while writing it to a temporary file, so the document is never
+ * held in memory and never read back. The blob is then stored under a key
+ * derived from its hash; a re-upload of the same content finds the blob
+ * already there and the temporary file is dropped.
+ *
+ * Backends (DOCUMENT_STORAGE):
+ *   local  files under DOCUMENT_STORAGE_DIR (default backend/uploads/documents)
+ *   s3     S3 or MinIO bucket DOCUMENT_S3_BUCKET; needs @aws-sdk/client-s3.
+ *          Only the temporary file touches the app server's disk
+ *
+ * Blobs are only served per document, from signed /api/documents/content/<id>
+ * links: a key is just the content hash, so it must not grant access by
+ * itself. Responses answer Range requests and use the content hash as a
+ * strong ETag; since a blob never changes, they are cacheable as immutable. Delivery is
+ * handed off where possible so Node does not stream the bytes itself:
+ *   local  X-Accel-Redirect to DOCUMENT_ACCEL_REDIRECT_PREFIX (nginx sendfile)
+ *   s3     302 to a pre-signed URL (needs @aws-sdk/s3-request-presigner)
+ */
+
+const fs = require('fs');
+const path = require('path');
+const crypto = require('crypto');
+const { pipeline, Transform } = require('stream');
+
+const BACKEND = process.env.DOCUMENT_STORAGE || 'local';
+const LOCAL_ROOT = path.resolve(process.env.DOCUMENT_STORAGE_DIR || path.join(__dirname, '..', 'uploads', 'documents'));
+const INCOMING_DIR = path.join(LOCAL_ROOT, '.incoming');
+const URL_PREFIX = '/uploads/documents';
+
+// nginx internal location aliased to LOCAL_ROOT, e.g. /protected-documents/
+const ACCEL_REDIRECT_PREFIX = process.env.DOCUMENT_ACCEL_REDIRECT_PREFIX || '';
+const CACHE_MAX_AGE_S = parseInt(process.env.DOCUMENT_CACHE_MAX_AGE_S || '86400', 10);
+const LINK_TTL_S = parseInt(process.env.DOCUMENT_LINK_TTL_S || '300', 10);
+
+const EXTENSION_PATTERN = /^\.[a-z0-9]{1,8}$/;
+const KEY_PATTERN = /^[0-9a-f]{2}\/[0-9a-f]{64}(\.[a-z0-9]{1,8})?$/;
+
+/**
+ * Storage key for a blob: two-character fan-out directory, hash, original extension
+ * The extension is kept so static serving picks the right Content-Type
+ * @param {String} hash - SHA-256 hex digest
+ * @param {String} originalName - Uploaded file name
+ * @returns {String} Storage key
+ */
+const keyFor = (hash, originalName = '') => {
+  const ext = path.extname(originalName).toLowerCase();
+  return `${hash.slice(0, 2)}/${hash}${EXTENSION_PATTERN.test(ext) ? ext : ''}`;
+};
+
+/**
+ * Blobs on the local filesystem
+ */
+class LocalStore {
+  constructor(root = LOCAL_ROOT) {
+    this.root = root;
+  }
+
+  resolve(key) {
+    return path.join(this.root, key);
+  }
+
+  async exists(key) {
+    try {
+      await fs.promises.access(this.resolve(key), fs.constants.F_OK);
+      return true;
+    } catch (error) {
+      return false;
+    }
+  }
+
+  /**
+   * Move a fully written temporary file into place
+   * @returns {Boolean} True if the blob already existed (deduplicated)
+   */
+  async put(key, tempPath) {
+    const target = this.resolve(key);
+    if (await this.exists(key)) {
+      await fs.promises.unlink(tempPath);
+      return true;
+    }
+    await fs.promises.mkdir(path.dirname(target), { recursive: true });
+    // Same filesystem as INCOMING_DIR, so this is an atomic rename rather than a copy
+    await fs.promises.rename(tempPath, target);
+    return false;
+  }
+
+  async stat(key) {
+    const stats = await fs.promises.stat(this.resolve(key));
+    return { size: stats.size, modifiedAt: stats.mtime };
+  }
+
+  createReadStream(key, options = {}) {
+    return fs.createReadStream(this.resolve(key), options);
+  }
+
+  async remove(key) {
+    await fs.promises.unlink(this.resolve(key)).catch(() => {});
+  }
+}
+
+/**
+ * Blobs in an S3-compatible bucket (AWS S3, MinIO)
+ * The AWS SDK is only required when this backend is selected
+ */
+class S3Store {
+  constructor(options = {}) {
+    const { S3Client, HeadObjectCommand, PutObjectCommand, GetObjectCommand, DeleteObjectCommand } = require('@aws-sdk/client-s3');
+    this.commands = { HeadObjectCommand, PutObjectCommand, GetObjectCommand, DeleteObjectCommand };
+    this.bucket = options.bucket || process.env.DOCUMENT_S3_BUCKET;
+    this.prefix = options.prefix !== undefined ? options.prefix : (process.env.DOCUMENT_S3_PREFIX || 'documents/');
+    this.client = new S3Client({
+      region: options.region || process.env.DOCUMENT_S3_REGION || 'us-east-1',
+      endpoint: options.endpoint || process.env.DOCUMENT_S3_ENDPOINT || undefined,
+      // MinIO and most self-hosted stores only support path-style addressing
+      forcePathStyle: Boolean(options.endpoint || process.env.DOCUMENT_S3_ENDPOINT)
+    });
+
+    if (!this.bucket) {
+      throw new Error('DOCUMENT_S3_BUCKET is required for S3 document storage');
+    }
+  }
+
+  objectKey(key) {
+    return this.prefix + key;
+  }
+
+  async stat(key) {
+    const head = await this.client.send(new this.commands.HeadObjectCommand({ Bucket: this.bucket, Key: this.objectKey(key) }));
+    return { size: head.ContentLength, modifiedAt: head.LastModified };
+  }
+
+  async exists(key) {
+    try {
+      await this.stat(key);
+      return true;
+    } catch (error) {
+      if (error.name === 'NotFound' || (error.$metadata && error.$metadata.httpStatusCode === 404)) {
+        return false;
+      }
+      throw error;
+    }
+  }
+
+  async put(key, tempPath, size) {
+    try {
+      if (await this.exists(key)) {
+        return true;
+      }
+      await this.client.send(new this.commands.PutObjectCommand({
+        Bucket: this.bucket,
+        Key: this.objectKey(key),
+        Body: fs.createReadStream(tempPath),
+        ContentLength: size
+      }));
+      return false;
+    } finally {
+      await fs.promises.unlink(tempPath).catch(() => {});
+    }
+  }
+
+  async createReadStream(key, options = {}) {
+    const range = options.start !== undefined ? `bytes=${options.start}-${options.end !== undefined ? options.end : ''}` : undefined;
+    const object = await this.client.send(new this.commands.GetObjectCommand({
+      Bucket: this.bucket,
+      Key: this.objectKey(key),
+      Range: range
+    }));
+    return object.Body;
+  }
+
+  async remove(key) {
+    await this.client.send(new this.commands.DeleteObjectCommand({ Bucket: this.bucket, Key: this.objectKey(key) }));
+  }
+
+  /**
+   * Pre-signed GET URL, or null if the presigner package is not installed
+   */
+  async signedUrl(key, options = {}) {
+    let getSignedUrl;
+    try {
+      ({ getSignedUrl } = require('@aws-sdk/s3-request-presigner'));
+    } catch (error) {
+      return null;
+    }
+    return getSignedUrl(this.client, new this.commands.GetObjectCommand({
+      Bucket: this.bucket,
+      Key: this.objectKey(key),
+      ResponseContentType: options.mimeType,
+      ResponseContentDisposition: options.disposition,
+      ResponseCacheControl: options.cacheControl
+    }), { expiresIn: LINK_TTL_S });
+  }
+}
+
+let store = null;
+
+/**
+ * The configured blob store
+ * @returns {LocalStore|S3Store} Store
+ */
+const getStore = () => {
+  if (!store) {
+    store = BACKEND === 's3' ? new S3Store() : new LocalStore();
+  }
+  return store;
+};
+
+/**
+ * Public URL of a stored blob
+ * @param {String} key - Storage key
+ * @returns {String} URL path
+ */
+const urlFor = (key) => `${URL_PREFIX}/${key}`;
+
+/**
+ * Whether a document_records.file_path is a storage key (as opposed to a
+ * pre-content-addressing multer path such as uploads/123-456.pdf)
+ * @param {String} filePath - Stored file path
+ * @returns {Boolean} True for storage keys
+ */
+const isStorageKey = (filePath) => KEY_PATTERN.test(filePath || '');
+
+/**
+ * Check that the file behind a document record exists
+ * @param {String} filePath - document_records.file_path
+ * @returns {Boolean} True if the blob (or legacy file) exists
+ */
+const documentExists = async (filePath) => {
+  if (isStorageKey(filePath)) {
+    return getStore().exists(filePath);
+  }
+  try {
+    await fs.promises.access(path.resolve(process.cwd(), filePath), fs.constants.F_OK);
+    return true;
+  } catch (error) {
+    return false;
+  }
+};
+
+/**
+ * Multer storage engine that hashes while writing and stores content-addressed
+ * Sets file.hash, file.storageKey, file.url, file.size and file.deduplicated
+ * Size limits are enforced by multer's limits.fileSize as the stream is read
+ */
+class HashingStorage {
+  _handleFile(req, file, cb) {
+    const tempPath = path.join(INCOMING_DIR, `${process.pid}-${crypto.randomBytes(12).toString('hex')}`);
+    const hash = crypto.createHash('sha256');
+    let size = 0;
+    let truncated = false;
+
+    // busboy stops the stream at limits.fileSize; multer reports the error
+    file.stream.on('limit', () => {
+      truncated = true;
+    });
+
+    const hasher = new Transform({
+      transform(chunk, encoding, done) {
+        hash.update(chunk);
+        size += chunk.length;
+        done(null, chunk);
+      }
+    });
+
+    fs.promises.mkdir(INCOMING_DIR, { recursive: true })
+      .then(() => new Promise((resolve, reject) => {
+        pipeline(file.stream, hasher, fs.createWriteStream(tempPath), (error) => (error ? reject(error) : resolve()));
+      }))
+      .then(async () => {
+        if (truncated) {
+          throw Object.assign(new Error('File too large'), { code: 'LIMIT_FILE_SIZE' });
+        }
+        const digest = hash.digest('hex');
+        const storageKey = keyFor(digest, file.originalname);
+        const deduplicated = await getStore().put(storageKey, tempPath, size);
+        cb(null, {
+          hash: digest,
+          storageKey,
+          path: storageKey,
+          url: urlFor(storageKey),
+          size,
+          deduplicated
+        });
+      })
+      .catch((error) => {
+        fs.promises.unlink(tempPath).catch(() => {});
+        cb(error);
+      });
+  }
+
+  // Called by multer when a later part of the request fails (e.g. the size limit).
+  // Content-addressed blobs may be shared by other documents, so only the
+  // temporary file is ever discarded here
+  _removeFile(req, file, cb) {
+    cb(null);
+  }
+}
+
+/**
+ * Parse a single-range Range header
+ * Multiple ranges are answered with the whole file, which RFC 9110 allows.
+ * Invalid ranges (e.g. bytes=5-2) are ignored, as RFC 9110 requires; only a
+ * valid range that selects nothing (starting past the end, or bytes=-0) is unsatisfiable
+ * @param {String} header - Range header
+ * @param {Number} size - File size
+ * @returns {Object|null|String} { start, end }, null for the whole file, or 'unsatisfiable'
+ */
+const parseRange = (header, size) => {
+  const match = /^bytes=(\d*)-(\d*)$/.exec(header || '');
+  if (!match || (match[1] === '' && match[2] === '')) return null;
+
+  if (match[1] === '') {
+    // Suffix range: the last N bytes
+    const length = parseInt(match[2], 10);
+    if (length === 0 || size === 0) return 'unsatisfiable';
+    return { start: Math.max(size - length, 0), end: size - 1 };
+  }
+
+  const start = parseInt(match[1], 10);
+  const last = match[2] === '' ? Infinity : parseInt(match[2], 10);
+  if (last < start) return null;
+  if (start >= size) return 'unsatisfiable';
+  return { start, end: Math.min(last, size - 1) };
+};
+
+const etagMatches = (header, etag) => Boolean(header) &&
+  (header.trim() === '*' || header.split(',').some(tag => tag.trim().replace(/^W\//, '') === etag));
+
+/**
+ * Inline Content-Disposition with an RFC 5987 encoded file name
+ */
+const inlineDisposition = (fileName) => {
+  const fallback = String(fileName).replace(/[^\x20-\x7e]|["\\]/g, '_');
+  return `inline; filename="${fallback}"; filename*=UTF-8''${encodeURIComponent(fileName)}`;
+};
+
+/**
+ * Send a stored document with range, conditional and cache handling
+ * @param {Object} req - Express request object
+ * @param {Object} res - Express response object
+ * @param {Object} document - filePath (storage key or legacy path), hash, mimeType, fileName
+ */
+const send = async (req, res, document) => {
+  const { filePath, hash, mimeType, fileName } = document;
+  const stored = isStorageKey(filePath);
+  const blob = getStore();
+  const etag = `"${hash}"`;
+  const cacheControl = `private, max-age=${CACHE_MAX_AGE_S}, immutable`;
+
+  res.setHeader('ETag', etag);
+  res.setHeader('Cache-Control', cacheControl);
+  res.setHeader('Accept-Ranges', 'bytes');
+  if (etagMatches(req.headers['if-none-match'], etag)) {
+    return res.status(304).end();
+  }
+
+  const disposition = fileName ? inlineDisposition(fileName) : undefined;
+
+  // The object store serves the bytes (and ranges) itself
+  if (stored && blob.signedUrl) {
+    const url = await blob.signedUrl(filePath, { mimeType, disposition, cacheControl });
+    if (url) {
+      return res.redirect(302, url);
+    }
+  }
+
+  res.type(mimeType || path.extname(filePath) || 'application/octet-stream');
+  if (disposition) {
+    res.setHeader('Content-Disposition', disposition);
+  }
+
+  // nginx sends the file with sendfile and handles Range itself
+  if (stored && ACCEL_REDIRECT_PREFIX && blob instanceof LocalStore) {
+    res.setHeader('X-Accel-Redirect', ACCEL_REDIRECT_PREFIX + filePath);
+    return res.end();
+  }
+
+  const legacyPath = stored ? null : path.resolve(process.cwd(), filePath);
+  const { size } = stored ? await blob.stat(filePath) : await fs.promises.stat(legacyPath);
+
+  // If-Range with a different validator means the client's copy is stale: send everything
+  const ifRange = req.headers['if-range'];
+  const range = !ifRange || ifRange === etag ? parseRange(req.headers.range, size) : null;
+  if (range === 'unsatisfiable') {
+    res.setHeader('Content-Range', `bytes */${size}`);
+    return res.status(416).end();
+  }
+
+  if (range) {
+    res.status(206);
+    res.setHeader('Content-Range', `bytes ${range.start}-${range.end}/${size}`);
+    res.setHeader('Content-Length', range.end - range.start + 1);
+  } else {
+    res.setHeader('Content-Length', size);
+  }
+  if (req.method === 'HEAD') {
+    return res.end();
+  }
+
+  const body = stored
+    ? await blob.createReadStream(filePath, range || {})
+    : fs.createReadStream(legacyPath, range || {});
+  pipeline(body, res, () => {});
+};
+
+const isNotFound = (error) => error.code === 'ENOENT' || error.name === 'NotFound' || error.name === 'NoSuchKey';
+
+const signLink = (documentId, expires) => crypto
+  .createHmac('sha256', process.env.DOCUMENT_LINK_SECRET || process.env.JWT_SECRET)
+  .update(`${documentId}:${expires}`)
+  .digest('base64url');
+
+/**
+ * Signed, expiring link to a document's content
+ * Lets browsers (PDF viewers, <img>, downloads) fetch the file, with Range
+ * requests, without an Authorization header. The expiry is rounded up to a
+ * LINK_TTL_S window so repeat views within it reuse the same URL and the
+ * browser cache
+ * @param {Number} documentId - document_records.id
+ * @returns {String} URL path
+ */
+const contentUrl = (documentId) => {
+  const expires = (Math.floor(Date.now() / 1000 / LINK_TTL_S) + 2) * LINK_TTL_S;
+  return `/api/documents/content/${documentId}?expires=${expires}&signature=${signLink(documentId, expires)}`;
+};
+
+/**
+ * Check a link produced by contentUrl
+ * @returns {Boolean} True if the signature matches and the link has not expired
+ */
+const verifyContentLink = (documentId, expires, signature) => {
+  const expiry = parseInt(expires, 10);
+  if (!Number.isInteger(expiry) || expiry * 1000 < Date.now() || typeof signature !== 'string') {
+    return false;
+  }
+  const expected = Buffer.from(signLink(documentId, expiry));
+  const actual = Buffer.from(signature);
+  return expected.length === actual.length && crypto.timingSafeEqual(expected, actual);
+};
+
+module.exports = {
+  keyFor,
+  urlFor,
+  isStorageKey,
+  documentExists,
+  getStore,
+  send,
+  parseRange,
+  isNotFound,
+  contentUrl,
+  verifyContentLink,
+  storage: () => new HashingStorage(),
+  LocalStore,
+  S3Store,
+  LOCAL_ROOT
+};
@@ -0,0 +1,532 @@
+/**
+ * Facemesh index service for DBIS
+ * In-process HNSW (Hierarchical Navigable Small World) index over packed
+ * landmark vectors, used for 1:N duplicate-enrollment detection
+ *
+ * In cluster mode every worker builds its own index; enrollments go through
+ * publish() so the other workers on the host apply the same change.
+ */
+const clusterUtils = require('../utils/cluster.utils');
+const { packLandmarks, calculateFacemeshSimilarity, timeComparison } = require('../utils/biometric.utils');
+const { isFacemeshTemplate, decodeFacemeshTemplate } = require('../utils/facemesh-template.utils');
+const { logger } = require('../utils/logger.utils');
+
+// Number of biometric rows loaded per round trip while building the index
+const BUILD_BATCH_SIZE = 1000;
+
+// Backoff between failed builds
+const BUILD_RETRY_BASE_MS = 1000;
+const BUILD_RETRY_MAX_MS = 60000;
+
+// Seconds enrollment clients are told to wait while the index is not ready
+const NOT_READY_RETRY_AFTER = 5;
+
+const BROADCAST_CHANNEL = 'facemesh-index';
+
+// Index changes that are replicated to the other cluster workers
+const REPLICATED_OPS = ['add', 'removeUser', 'replaceUser'];
+
+/**
+ * Minimal binary heap ordered by a comparator
+ */
+class BinaryHeap {
+  constructor(compare) {
+    this.compare = compare;
+    this.items = [];
+  }
+
+  get size() {
+    return this.items.length;
+  }
+
+  peek() {
+    return this.items[0];
+  }
+
+  push(item) {
+    const items = this.items;
+    items.push(item);
+    let i = items.length - 1;
+    while (i > 0) {
+      const parent = (i - 1) >> 1;
+      if (this.compare(items[i], items[parent]) >= 0) break;
+      [items[i], items[parent]] = [items[parent], items[i]];
+      i = parent;
+    }
+  }
+
+  pop() {
+    const items = this.items;
+    const top = items[0];
+    const last = items.pop();
+    if (items.length > 0) {
+      items[0] = last;
+      let i = 0;
+      for (;;) {
+        const left = 2 * i + 1;
+        const right = left + 1;
+        let best = i;
+        if (left < items.length && this.compare(items[left], items[best]) < 0) best = left;
+        if (right < items.length && this.compare(items[right], items[best]) < 0) best = right;
+        if (best === i) break;
+        [items[i], items[best]] = [items[best], items[i]];
+        i = best;
+      }
+    }
+    return top;
+  }
+}
+
+const nearestFirst = (a, b) => a.distance - b.distance;
+const farthestFirst = (a, b) => b.distance - a.distance;
+
+/**
+ * Squared Euclidean distance between two packed vectors
+ */
+const squaredDistance = (a, b) => {
+  let sum = 0;
+  for (let i = 0; i < a.length; i++) {
+    const d = a[i] - b[i];
+    sum += d * d;
+  }
+  return sum;
+};
+
+class FacemeshIndexService {
+  constructor(options = {}) {
+    this.M = options.M || parseInt(process.env.FACEMESH_INDEX_M) || 16;
+    this.maxM0 = this.M * 2;
+    this.efConstruction = options.efConstruction || parseInt(process.env.FACEMESH_INDEX_EF_CONSTRUCTION) || 100;
+    this.efSearch = options.efSearch || parseInt(process.env.FACEMESH_INDEX_EF_SEARCH) || 64;
+    this.levelMultiplier = 1 / Math.log(this.M);
+    this.reset();
+  }
+
+  reset() {
+    this.dimension = 0;
+    this.vectors = [];
+    this.labels = [];
+    this.links = [];
+    this.deleted = [];
+    this.entryPoint = -1;
+    this.maxLevel = -1;
+    this.nodesByBiometricId = new Map();
+    this.nodesByUserId = new Map();
+    this.activeCount = 0;
+    // Per-node visit stamps, so searches don't allocate a visited set
+    this.visitMarks = new Uint32Array(1024);
+    this.visitEpoch = 0;
+    this.ready = false;
+    this.building = null;
+    this.retryTimer = null;
+  }
+
+  /**
+   * Build the index from all active biometric rows
+   * @param {Object} db - Database service or pool exposing query()
+   * @returns {Promise<Number>} Number of indexed templates
+   */
+  build(db) {
+    if (this.building) {
+      return this.building;
+    }
+
+    this.building = (async () => {
+      const start = Date.now();
+      let lastId = 0;
+
+      for (;;) {
+        const result = await db.query(
+          `SELECT id, user_id, facemesh_template, facemesh_data
+           FROM biometric_data
+           WHERE is_active = true
+             AND (facemesh_template IS NOT NULL OR facemesh_data IS NOT NULL)
+             AND id > $1
+           ORDER BY id
+           LIMIT $2`,
+          [lastId, BUILD_BATCH_SIZE]
+        );
+
+        for (const row of result.rows) {
+          this.add(row.id, row.user_id, row.facemesh_template || row.facemesh_data);
+        }
+
+        if (result.rows.length < BUILD_BATCH_SIZE) break;
+        lastId = result.rows[result.rows.length - 1].id;
+      }
+
+      this.ready = true;
+      logger.info(`Facemesh index built with ${this.activeCount} templates in ${Date.now() - start}ms`);
+      return this.activeCount;
+    })().catch((error) => {
+      this.building = null;
+      logger.error('Failed to build facemesh index:', error);
+      throw error;
+    });
+
+    return this.building;
+  }
+
+  /**
+   * Build the index, retrying with exponential backoff until a build succeeds
+   * @param {Object} db - Database service or pool exposing query()
+   * @param {Number} attempt - Failed attempts so far
+   */
+  buildWithRetry(db, attempt = 0) {
+    clearTimeout(this.retryTimer);
+    this.retryTimer = null;
+    if (this.ready) return;
+
+    this.build(db).catch(() => {
+      const delay = Math.min(BUILD_RETRY_BASE_MS * 2 ** attempt, BUILD_RETRY_MAX_MS);
+      logger.warn(`Retrying facemesh index build in ${delay}ms`);
+      this.retryTimer = setTimeout(() => this.buildWithRetry(db, attempt + 1), delay);
+      this.retryTimer.unref();
+    });
+  }
+
+  /**
+   * Check whether the initial build has completed
+   * @returns {Boolean} True if the index covers all stored templates
+   */
+  isReady() {
+    return this.ready;
+  }
+
+  /**
+   * Send 503 for an enrollment while the duplicate check cannot run
+   * A partly built index would miss duplicates, so enrollments fail closed
+   * @param {Object} res - Express response object
+   * @returns {Boolean} True if a response was sent
+   */
+  respondIfNotReady(res) {
+    if (this.ready) {
+      return false;
+    }
+    res.set('Retry-After', String(NOT_READY_RETRY_AFTER));
+    res.status(503).json({
+      message: 'Biometric enrollment is temporarily unavailable. Please try again shortly.',
+      retryAfter: NOT_READY_RETRY_AFTER
+    });
+    return true;
+  }
+
+  /**
+   * Convert facemesh data into a packed vector of the index dimension
+   * @param {Object|Buffer} facemeshData - Binary template, or facemesh data with a landmarks
+   *   array or packed Float32Array
+   * @returns {Float32Array|null} Packed vector, or null if it cannot be indexed
+   */
+  toVector(facemeshData) {
+    if (isFacemeshTemplate(facemeshData)) {
+      try {
+        return this.toVector({ landmarks: decodeFacemeshTemplate(facemeshData) });
+      } catch (error) {
+        return null;
+      }
+    }
+
+    if (!facemeshData || !facemeshData.landmarks) {
+      return null;
+    }
+
+    const landmarks = facemeshData.landmarks;
+    const vector = landmarks instanceof Float32Array
+      ? landmarks
+      : Array.isArray(landmarks) && landmarks.length > 0 ? packLandmarks(landmarks) : null;
+
+    if (!vector || (this.dimension && vector.length !== this.dimension)) {
+      return null;
+    }
+
+    return vector;
+  }
+
+  /**
+   * Add a biometric template to the index
+   * @param {Number} biometricId - biometric_data.id
+   * @param {Number} userId - Owning user ID
+   * @param {Object|Buffer} facemeshData - Binary template or facemesh data
+   * @returns {Boolean} True if the template was indexed
+   */
+  add(biometricId, userId, facemeshData) {
+    if (this.nodesByBiometricId.has(biometricId)) {
+      return false;
+    }
+
+    const vector = this.toVector(facemeshData);
+    if (!vector) {
+      return false;
+    }
+
+    if (!this.dimension) {
+      this.dimension = vector.length;
+    }
+
+    const node = this.vectors.length;
+    const level = Math.floor(-Math.log(1 - Math.random()) * this.levelMultiplier);
+
+    this.vectors.push(vector);
+    this.labels.push({ biometricId, userId });
+    this.links.push(Array.from({ length: level + 1 }, () => []));
+    this.deleted.push(false);
+    this.nodesByBiometricId.set(biometricId, node);
+    if (!this.nodesByUserId.has(userId)) {
+      this.nodesByUserId.set(userId, new Set());
+    }
+    this.nodesByUserId.get(userId).add(node);
+    this.activeCount++;
+
+    if (this.entryPoint === -1) {
+      this.entryPoint = node;
+      this.maxLevel = level;
+      return true;
+    }
+
+    let entryPoints = [this.entryPoint];
+    for (let l = this.maxLevel; l > level; l--) {
+      entryPoints = [this.searchLayer(vector, entryPoints, 1, l)[0].node];
+    }
+
+    for (let l = Math.min(level, this.maxLevel); l >= 0; l--) {
+      const candidates = this.searchLayer(vector, entryPoints, this.efConstruction, l);
+      const neighbors = this.selectNeighbors(candidates, this.M);
+      this.links[node][l] = neighbors.map(candidate => candidate.node);
+
+      for (const neighbor of this.links[node][l]) {
+        this.connect(neighbor, node, l);
+      }
+
+      entryPoints = candidates.map(candidate => candidate.node);
+    }
+
+    if (level > this.maxLevel) {
+      this.entryPoint = node;
+      this.maxLevel = level;
+    }
+
+    return true;
+  }
+
+  /**
+   * Mark every template of a user as removed
+   * Nodes stay in the graph for navigation but are never returned
+   * @param {Number} userId - User ID
+   */
+  removeUser(userId) {
+    const nodes = this.nodesByUserId.get(userId);
+    if (!nodes) {
+      return;
+    }
+
+    for (const node of nodes) {
+      if (!this.deleted[node]) {
+        this.deleted[node] = true;
+        this.activeCount--;
+      }
+    }
+    this.nodesByUserId.delete(userId);
+  }
+
+  /**
+   * Replace a user's templates with a newly enrolled one
+   * @param {Number} biometricId - biometric_data.id of the new template
+   * @param {Number} userId - User ID
+   * @param {Object|Buffer} facemeshData - Binary template or facemesh data
+   * @returns {Boolean} True if the template was indexed
+   */
+  replaceUser(biometricId, userId, facemeshData) {
+    this.removeUser(userId);
+    return this.add(biometricId, userId, facemeshData);
+  }
+
+  /**
+   * Apply an index change here and in the other cluster workers
+   * Templates are decoded once and sent as packed vectors
+   * @param {String} op - 'add', 'removeUser' or 'replaceUser'
+   * @param {...*} args - Arguments of that method
+   * @returns {*} Result of the local change
+   */
+  publish(op, ...args) {
+    if (!REPLICATED_OPS.includes(op)) {
+      throw new Error(`Unknown facemesh index operation: ${op}`);
+    }
+
+    if (op !== 'removeUser') {
+      const vector = this.toVector(args[2]);
+      args[2] = vector ? { landmarks: vector } : null;
+    }
+
+    const result = this[op](...args);
+    clusterUtils.broadcast(BROADCAST_CHANNEL, { op, args });
+    return result;
+  }
+
+  /**
+   * Find enrolled templates that likely belong to the same person
+   * @param {Object|Buffer} facemeshData - Probe template or facemesh data
+   * @param {Object} options - threshold, limit and excludeUserId
+   * @returns {Array} Matches as { userId, biometricId, similarity }, most similar first
+   */
+  findDuplicates(facemeshData, options = {}) {
+    return timeComparison('search', () => this.rankDuplicates(facemeshData, options));
+  }
+
+  rankDuplicates(facemeshData, options) {
+    const { threshold = 0.85, limit = 5, excludeUserId = null } = options;
+    const vector = this.toVector(facemeshData);
+    if (!vector || this.entryPoint === -1) {
+      return [];
+    }
+
+    const candidates = this.search(vector, Math.max(limit * 4, this.efSearch));
+    const probe = { landmarks: vector };
+    const matches = [];
+
+    for (const candidate of candidates) {
+      const label = this.labels[candidate.node];
+      if (excludeUserId !== null && label.userId === excludeUserId) continue;
+
+      // Re-rank with the same similarity used for 1:1 verification
+      const similarity = calculateFacemeshSimilarity(probe, { landmarks: this.vectors[candidate.node] });
+      if (similarity >= threshold) {
+        matches.push({ userId: label.userId, biometricId: label.biometricId, similarity });
+      }
+    }
+
+    return matches.sort((a, b) => b.similarity - a.similarity).slice(0, limit);
+  }
+
+  /**
+   * Approximate k-nearest-neighbour search over live nodes
+   * @param {Float32Array} vector - Packed query vector
+   * @param {Number} ef - Size of the dynamic candidate list
+   * @returns {Array} Candidates as { node, distance }, nearest first
+   */
+  search(vector, ef) {
+    let entryPoints = [this.entryPoint];
+    for (let l = this.maxLevel; l > 0; l--) {
+      entryPoints = [this.searchLayer(vector, entryPoints, 1, l)[0].node];
+    }
+
+    return this.searchLayer(vector, entryPoints, ef, 0)
+      .filter(candidate => !this.deleted[candidate.node]);
+  }
+
+  nextVisitEpoch() {
+    if (this.visitMarks.length < this.vectors.length) {
+      const grown = new Uint32Array(Math.max(this.visitMarks.length * 2, this.vectors.length));
+      grown.set(this.visitMarks);
+      this.visitMarks = grown;
+    }
+
+    this.visitEpoch++;
+    if (this.visitEpoch === 0xffffffff) {
+      this.visitMarks.fill(0);
+      this.visitEpoch = 1;
+    }
+    return this.visitEpoch;
+  }
+
+  searchLayer(vector, entryPoints, ef, level) {
+    const epoch = this.nextVisitEpoch();
+    const marks = this.visitMarks;
+    const candidates = new BinaryHeap(nearestFirst);
+    const results = new BinaryHeap(farthestFirst);
+
+    for (const node of entryPoints) {
+      marks[node] = epoch;
+      const entry = { node, distance: squaredDistance(vector, this.vectors[node]) };
+      candidates.push(entry);
+      results.push(entry);
+    }
+
+    while (candidates.size > 0) {
+      const current = candidates.pop();
+      if (results.size >= ef && current.distance > results.peek().distance) break;
+
+      const neighbors = this.links[current.node][level] || [];
+      for (const neighbor of neighbors) {
+        if (marks[neighbor] === epoch) continue;
+        marks[neighbor] = epoch;
+
+        const distance = squaredDistance(vector, this.vectors[neighbor]);
+        if (results.size < ef || distance < results.peek().distance) {
+          const entry = { node: neighbor, distance };
+          candidates.push(entry);
+          results.push(entry);
+          if (results.size > ef) results.pop();
+        }
+      }
+    }
+
+    return results.items.sort(nearestFirst);
+  }
+
+  /**
+   * HNSW neighbour-selection heuristic: prefer candidates that are closer to the
+   * new node than to any already selected neighbour, then fill up with the rest
+   */
+  selectNeighbors(candidates, m) {
+    const selected = [];
+    const pruned = [];
+
+    for (const candidate of candidates) {
+      if (selected.length >= m) break;
+      const vector = this.vectors[candidate.node];
+      const diverse = selected.every(
+        chosen => squaredDistance(vector, this.vectors[chosen.node]) > candidate.distance
+      );
+      (diverse ? selected : pruned).push(candidate);
+    }
+
+    for (const candidate of pruned) {
+      if (selected.length >= m) break;
+      selected.push(candidate);
+    }
+
+    return selected;
+  }
+
+  connect(from, to, level) {
+    const links = this.links[from][level];
+    links.push(to);
+
+    const maxConnections = level === 0 ? this.maxM0 : this.M;
+    if (links.length <= maxConnections) {
+      return;
+    }
+
+    // Keep the closest neighbours; cheaper than re-running the heuristic on every overflow
+    const origin = this.vectors[from];
+    this.links[from][level] = links
+      .map(node => ({ node, distance: squaredDistance(origin, this.vectors[node]) }))
+      .sort(nearestFirst)
+      .slice(0, maxConnections)
+      .map(candidate => candidate.node);
+  }
+
+  /**
+   * Get index statistics
+   * @returns {Object} Index size and state
+   */
+  getStats() {
+    return {
+      ready: this.ready,
+      templates: this.activeCount,
+      nodes: this.vectors.length,
+      dimension: this.dimension,
+      maxLevel: this.maxLevel
+    };
+  }
+}
+
+// Create and export a singleton instance
+const facemeshIndex = new FacemeshIndexService();
+clusterUtils.onBroadcast(BROADCAST_CHANNEL, ({ op, args }) => {
+  if (REPLICATED_OPS.includes(op)) {
+    facemeshIndex[op](...args);
+  }
+});
+module.exports = facemeshIndex;
+module.exports.FacemeshIndexService = FacemeshIndexService;
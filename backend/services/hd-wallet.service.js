@@ -0,0 +1,159 @@
+/**
+ * HD wallet service for DBIS
+ * User wallets are derived from one master seed (BIP-32) along the BIP-44
+ * path m/44'/60'/0'/0/<index>, the path Avalanche C-Chain wallets use. The
+ * users table stores only the derivation index (wallet_index), taken from
+ * the users_wallet_index_seq sequence at registration.
+ *
+ * The hardened part of the path is derived once; each user key is then one
+ * non-hardened step from that node. Derived signers, connected to a shared
+ * provider, are kept in a bounded LRU so repeated signing for the same user
+ * does not re-derive or reload the key.
+ *
+ * Without WALLET_MNEMONIC, registration falls back to random wallets whose
+ * private key is stored in avax_private_key. Users registered that way (or
+ * before this service existed) keep signing with their stored key.
+ */
+const ethers = require('ethers');
+const walletService = require('./wallet.service');
+const { getSharedProvider } = require('./rpc-pool.service');
+const { registry } = require('../utils/metrics.utils');
+const { logger } = require('../utils/logger.utils');
+
+const DEFAULT_PATH = "m/44'/60'/0'/0";
+const CACHE_SIZE = parseInt(process.env.WALLET_SIGNER_CACHE_SIZE || '1000', 10);
+
+const signerLookups = registry.counter(
+  'dbis_hd_signer_cache_total',
+  'HD signer cache lookups by result',
+  ['result']
+);
+
+let accountNode = null;
+let warnedLegacy = false;
+
+// Index -> connected ethers.Wallet, least recently used first
+const signers = new Map();
+
+registry.gauge('dbis_hd_signer_cache_size', 'Derived signers held in the HD signer cache', [], (gauge) => {
+  gauge.set({}, signers.size);
+});
+
+/**
+ * Whether a master seed is configured
+ * @returns {Boolean}
+ */
+const isEnabled = () => Boolean(process.env.WALLET_MNEMONIC);
+
+/**
+ * Parent node of all user keys (the external chain of account 0), derived on first use
+ * @returns {ethers.utils.HDNode}
+ */
+const getAccountNode = () => {
+  if (!accountNode) {
+    if (!isEnabled()) {
+      throw new Error('WALLET_MNEMONIC not defined in environment variables');
+    }
+    const root = ethers.utils.HDNode.fromMnemonic(
+      process.env.WALLET_MNEMONIC.trim(),
+      process.env.WALLET_MNEMONIC_PASSPHRASE || undefined
+    );
+    accountNode = root.derivePath(process.env.WALLET_HD_PATH || DEFAULT_PATH);
+  }
+  return accountNode;
+};
+
+const assertIndex = (index) => {
+  // Non-hardened BIP-32 indexes are 31-bit
+  if (!Number.isInteger(index) || index < 0 || index >= 0x80000000) {
+    throw new Error(`Invalid wallet index: ${index}`);
+  }
+};
+
+/**
+ * Address of the wallet at an index, without creating a signer
+ * @param {Number} index - Derivation index
+ * @returns {String} Checksummed address
+ */
+const deriveAddress = (index) => {
+  assertIndex(index);
+  const cached = signers.get(index);
+  return cached ? cached.address : getAccountNode().derivePath(String(index)).address;
+};
+
+/**
+ * Signer for the wallet at an index, connected to the shared provider
+ * @param {Number} index - Derivation index
+ * @returns {ethers.Wallet}
+ */
+const getSigner = (index) => {
+  assertIndex(index);
+  let signer = signers.get(index);
+  if (signer) {
+    signers.delete(index);
+    signers.set(index, signer);
+    signerLookups.inc({ result: 'hit' });
+    return signer;
+  }
+
+  signerLookups.inc({ result: 'miss' });
+  signer = new ethers.Wallet(getAccountNode().derivePath(String(index)).privateKey, getSharedProvider());
+  signers.set(index, signer);
+  if (signers.size > CACHE_SIZE) {
+    signers.delete(signers.keys().next().value);
+  }
+  return signer;
+};
+
+/**
+ * Wallet for a new user: the next derivation index, or a random legacy wallet when no seed is configured
+ * @param {Object} db - Pool or client (use the registration transaction's client)
+ * @returns {Object} { walletIndex, address, privateKey } (privateKey is null for derived wallets)
+ */
+const allocateWallet = async (db) => {
+  if (!isEnabled()) {
+    if (!warnedLegacy) {
+      logger.warn('WALLET_MNEMONIC is not set; storing random per-user private keys');
+      warnedLegacy = true;
+    }
+    const wallet = walletService.generateWallet();
+    return { walletIndex: null, address: wallet.address, privateKey: wallet.privateKey };
+  }
+
+  const result = await db.query("SELECT nextval('users_wallet_index_seq')::int AS index");
+  const walletIndex = result.rows[0].index;
+  return { walletIndex, address: deriveAddress(walletIndex), privateKey: null };
+};
+
+/**
+ * Signer for a user row
+ * @param {Object} user - Row with wallet_index and/or avax_private_key
+ * @returns {ethers.Wallet|null} Connected signer, or null if the user has no key the backend controls
+ */
+const signerForUser = (user) => {
+  if (!user) return null;
+  if (user.wallet_index !== null && user.wallet_index !== undefined) {
+    return getSigner(Number(user.wallet_index));
+  }
+  if (user.avax_private_key) {
+    return new ethers.Wallet(user.avax_private_key, getSharedProvider());
+  }
+  return null;
+};
+
+/**
+ * Whether the backend can sign for a user row
+ * @param {Object} user - Row with wallet_index and/or avax_private_key
+ * @returns {Boolean}
+ */
+const hasSigner = (user) => Boolean(user) &&
+  ((user.wallet_index !== null && user.wallet_index !== undefined) || Boolean(user.avax_private_key));
+
+module.exports = {
+  isEnabled,
+  deriveAddress,
+  getSigner,
+  allocateWallet,
+  signerForUser,
+  hasSigner
+};
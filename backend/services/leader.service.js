@@ -0,0 +1,155 @@
+/**
+ * Leader election for DBIS
+ * Exactly one API process runs the periodic background jobs (blockchain
+ * queue worker, chain indexer, expiry sweeps, stats rollups), however many
+ * cluster workers or hosts are serving HTTP.
+ *
+ * Leadership is a Postgres session-level advisory lock held on a dedicated
+ * connection. Followers retry every LEADER_RETRY_MS; the leader checks its
+ * session on the same interval. If the leader's connection drops, Postgres
+ * releases the lock and another process takes over on its next attempt.
+ *
+ * Events:
+ *   elected   this process holds the lock; start the jobs
+ *   demoted   the lock is no longer held (connection lost or stop()); stop the jobs
+ */
+
+const { Client } = require('pg');
+const EventEmitter = require('events');
+const { logger } = require('../utils/logger.utils');
+
+const LOCK_NAME = process.env.LEADER_LOCK_NAME || 'dbis:background-jobs';
+const RETRY_MS = parseInt(process.env.LEADER_RETRY_MS || '5000', 10);
+
+class LeaderElection extends EventEmitter {
+  constructor(db, options = {}) {
+    super();
+    this.db = db;
+    this.lockName = options.lockName || LOCK_NAME;
+    this.retryInterval = options.retryInterval || RETRY_MS;
+    this.client = null;
+    this.leader = false;
+    this.active = false;
+    this.timer = null;
+  }
+
+  start() {
+    if (this.active) return;
+    this.active = true;
+    this.schedule(0);
+  }
+
+  schedule(delay) {
+    if (!this.active) return;
+    clearTimeout(this.timer);
+    this.timer = setTimeout(() => this.tick(), delay);
+  }
+
+  async tick() {
+    try {
+      if (this.leader) {
+        // Confirms the session holding the lock is still alive
+        await this.client.query('SELECT 1');
+      } else {
+        await this.tryAcquire();
+      }
+    } catch (error) {
+      logger.error('Leader election error:', error.message);
+      this.lose();
+    }
+    this.schedule(this.retryInterval);
+  }
+
+  async tryAcquire() {
+    if (!this.client) {
+      // Advisory locks belong to a session, so this bypasses PgBouncer when one is in front
+      const client = new Client({ ...this.db.connectionConfig({ direct: true }), keepAlive: true });
+      client.on('error', (error) => {
+        logger.error('Leader election connection error:', error.message);
+        this.lose();
+      });
+      this.client = client;
+      await client.connect();
+    }
+
+    const result = await this.client.query(
+      'SELECT pg_try_advisory_lock(hashtext($1)) AS acquired',
+      [this.lockName]
+    );
+    if (!this.active) {
+      this.lose();
+      return;
+    }
+    if (result.rows[0].acquired && !this.leader) {
+      this.leader = true;
+      logger.info(`Elected leader for ${this.lockName} (pid ${process.pid})`);
+      this.emit('elected');
+    }
+  }
+
+  /**
+   * Drop the connection, and with it the lock
+   */
+  lose() {
+    const client = this.client;
+    this.client = null;
+    if (client) {
+      client.removeAllListeners('error');
+      client.on('error', () => {});
+      client.end().catch(() => {});
+    }
+
+    if (this.leader) {
+      this.leader = false;
+      logger.info(`Lost leadership for ${this.lockName} (pid ${process.pid})`);
+      this.emit('demoted');
+    }
+  }
+
+  /**
+   * Stop competing and release the lock if held
+   */
+  async stop() {
+    this.active = false;
+    clearTimeout(this.timer);
+    this.timer = null;
+
+    if (this.leader && this.client) {
+      await this.client
+        .query('SELECT pg_advisory_unlock(hashtext($1))', [this.lockName])
+        .catch(() => {});
+    }
+    this.lose();
+  }
+
+  isLeader() {
+    return this.leader;
+  }
+}
+
+let election = null;
+
+/**
+ * Start competing for leadership of the background jobs
+ * @param {Object} db - Database service
+ * @param {Object} options - lockName, retryInterval
+ * @returns {LeaderElection} Election; listen for elected/demoted
+ */
+exports.startElection = (db, options = {}) => {
+  if (!election) {
+    election = new LeaderElection(db, options);
+    election.start();
+  }
+  return election;
+};
+
+exports.stopElection = async () => {
+  if (election) {
+    // Clear it first so a start() during the wait gets a fresh instance
+    const stopping = election;
+    election = null;
+    await stopping.stop();
+  }
+};
+
+exports.LeaderElection = LeaderElection;
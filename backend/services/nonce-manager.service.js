@@ -0,0 +1,383 @@
+/**
+ * Nonce manager for DBIS
+ * Assigns nonces locally so many transactions from one wallet can be in flight
+ * at once, and replaces stuck transactions with bumped fees.
+ *
+ * Nonce allocation, signing and broadcasting are serialized per wallet (nodes must
+ * see nonces in order); waiting for receipts is not, so callers can send N
+ * transactions and await them together (see pipeline()).
+ */
+const ethers = require('ethers');
+const { logger } = require('../utils/logger.utils');
+
+const DEFAULT_OPTIONS = {
+  pollInterval: 2000,
+  stuckAfterMs: parseInt(process.env.BLOCKCHAIN_STUCK_AFTER_MS || '45000', 10),
+  feeBumpPercent: parseInt(process.env.BLOCKCHAIN_FEE_BUMP_PERCENT || '20', 10), // nodes require >= 10%
+  maxBumps: 5,
+  timeoutMs: 10 * 60 * 1000
+};
+
+const sleep = (ms) => new Promise(resolve => setTimeout(resolve, ms));
+
+// ethers codes and node messages that mean the transaction was refused outright
+const REJECTED_CODES = ['INSUFFICIENT_FUNDS', 'UNPREDICTABLE_GAS_LIMIT', 'INVALID_ARGUMENT'];
+const REJECTED_MESSAGES = [
+  'insufficient funds', 'intrinsic gas too low', 'exceeds block gas limit', 'transaction underpriced',
+  'less than block base fee', 'nonce too high', 'invalid sender'
+];
+
+// A JSON-RPC error response: the node answered, and did not take the transaction
+const hasRpcError = (error) => {
+  if (!error || typeof error.body !== 'string') return false;
+  try {
+    return Boolean(JSON.parse(error.body).error);
+  } catch (parseError) {
+    return false;
+  }
+};
+
+/**
+ * Classify a broadcast error
+ * @param {Error} error - Error thrown by sendTransaction
+ * @returns {String} ALREADY_KNOWN, NONCE_EXPIRED (the nonce was used by another transaction),
+ *   REJECTED (the node answered and refused it, so it was never accepted) or OTHER (no answer:
+ *   timeouts and dropped connections, after which the transaction may still have reached the node)
+ */
+const classifyBroadcastError = (error) => {
+  const message = String((error && (error.body || error.message)) || '').toLowerCase();
+
+  if (message.includes('already known') || message.includes('known transaction') ||
+      message.includes('already imported')) {
+    return 'ALREADY_KNOWN';
+  }
+  if ((error && (error.code === 'NONCE_EXPIRED' || error.code === 'REPLACEMENT_UNDERPRICED')) ||
+      message.includes('nonce too low') || message.includes('replacement transaction underpriced')) {
+    return 'NONCE_EXPIRED';
+  }
+  if ((error && REJECTED_CODES.includes(error.code)) || REJECTED_MESSAGES.some(text => message.includes(text)) ||
+      hasRpcError(error)) {
+    return 'REJECTED';
+  }
+  return 'OTHER';
+};
+
+/**
+ * Increase the fee fields of a populated transaction by `percent`
+ * @param {Object} transaction - Populated transaction (legacy or EIP-1559)
+ * @param {Number} percent - Bump percentage
+ * @returns {Object} Copy with bumped fees
+ */
+const bumpFees = (transaction, percent) => {
+  const bump = (value) => ethers.BigNumber.from(value).mul(100 + percent).div(100).add(1);
+  const bumped = { ...transaction };
+
+  if (transaction.maxFeePerGas != null) {
+    bumped.maxFeePerGas = bump(transaction.maxFeePerGas);
+    bumped.maxPriorityFeePerGas = bump(transaction.maxPriorityFeePerGas);
+  } else {
+    bumped.gasPrice = bump(transaction.gasPrice);
+  }
+  return bumped;
+};
+
+/**
+ * Handle for a transaction sent through a NonceManager
+ */
+class PendingTransaction {
+  constructor(manager, nonce, hash) {
+    this.manager = manager;
+    this.nonce = nonce;
+    this.hash = hash;
+  }
+
+  /**
+   * All hashes broadcast for this nonce (the original plus fee-bumped replacements)
+   */
+  get hashes() {
+    const entry = this.manager.inFlight.get(this.nonce);
+    return entry ? entry.hashes.slice() : [this.hash];
+  }
+
+  wait(confirmations = 1) {
+    return this.manager.waitFor(this.nonce, confirmations);
+  }
+}
+
+class NonceManager {
+  constructor(wallet, options = {}) {
+    if (!wallet.provider) {
+      throw new Error('NonceManager requires a wallet connected to a provider');
+    }
+    this.wallet = wallet;
+    this.address = wallet.address;
+    this.options = { ...DEFAULT_OPTIONS, ...options };
+    this.nextNonce = null;
+    this.lock = Promise.resolve();
+    this.inFlight = new Map();
+  }
+
+  /**
+   * Run fn after every previously queued nonce operation has finished
+   */
+  withLock(fn) {
+    const run = this.lock.then(fn);
+    this.lock = run.catch(() => {});
+    return run;
+  }
+
+  async allocate() {
+    if (this.nextNonce === null) {
+      this.nextNonce = await this.wallet.getTransactionCount('pending');
+    }
+    return this.nextNonce++;
+  }
+
+  /**
+   * Give back the most recently allocated nonce (nothing was broadcast with it)
+   */
+  unallocate(nonce) {
+    if (this.nextNonce === nonce + 1) {
+      this.nextNonce = nonce;
+    } else {
+      this.reset();
+    }
+  }
+
+  /**
+   * Forget the local nonce; the next allocation re-reads the pending count from the chain
+   */
+  reset() {
+    this.nextNonce = null;
+  }
+
+  async signPopulated(populated) {
+    const rawTransaction = await this.wallet.signTransaction(populated);
+    return {
+      rawTransaction,
+      transactionHash: ethers.utils.keccak256(rawTransaction),
+      from: this.address,
+      to: populated.to,
+      nonce: populated.nonce
+    };
+  }
+
+  /**
+   * Allocate a nonce and sign without broadcasting
+   * The caller owns the broadcast; call reset() if the signed bytes are discarded
+   * @param {Object} request - Transaction request
+   * @returns {Object} Signed transaction details
+   */
+  sign(request) {
+    return this.withLock(async () => {
+      const nonce = await this.allocate();
+      try {
+        const populated = await this.wallet.populateTransaction({ ...request, nonce });
+        return await this.signPopulated(populated);
+      } catch (error) {
+        this.unallocate(nonce);
+        throw error;
+      }
+    });
+  }
+
+  /**
+   * Allocate a nonce, sign and broadcast
+   * @param {Object} request - Transaction request
+   * @returns {PendingTransaction} Handle; call wait() for the receipt
+   */
+  send(request) {
+    return this.withLock(async () => {
+      for (let attempt = 0; ; attempt++) {
+        const nonce = await this.allocate();
+        let populated;
+        let signed;
+        try {
+          populated = await this.wallet.populateTransaction({ ...request, nonce });
+          signed = await this.signPopulated(populated);
+        } catch (error) {
+          // Nothing was broadcast
+          this.unallocate(nonce);
+          throw error;
+        }
+
+        try {
+          await this.wallet.provider.sendTransaction(signed.rawTransaction);
+        } catch (error) {
+          const kind = classifyBroadcastError(error);
+          if (kind === 'NONCE_EXPIRED') {
+            // Our local nonce is behind (another signer used this key); resync once
+            this.reset();
+            if (attempt === 0) continue;
+            throw error;
+          }
+          if (kind === 'REJECTED') {
+            this.unallocate(nonce);
+            throw error;
+          }
+          if (kind === 'OTHER') {
+            // It may have reached the node, so keep the nonce and let wait() settle it;
+            // failing here would let the caller retry and send it twice
+            logger.warn(`Broadcast of ${signed.transactionHash} (nonce ${nonce}) for ${this.address} did not get an answer, tracking it:`, error.message);
+          }
+        }
+
+        this.inFlight.set(nonce, {
+          transaction: populated,
+          hashes: [signed.transactionHash],
+          sentAt: Date.now(),
+          bumps: 0
+        });
+        return new PendingTransaction(this, nonce, signed.transactionHash);
+      }
+    });
+  }
+
+  /**
+   * Re-sign an in-flight nonce with higher fees and broadcast the replacement
+   */
+  replace(nonce) {
+    return this.withLock(async () => {
+      const entry = this.inFlight.get(nonce);
+      if (!entry) return;
+
+      const transaction = bumpFees(entry.transaction, this.options.feeBumpPercent);
+      const signed = await this.signPopulated(transaction);
+
+      try {
+        await this.wallet.provider.sendTransaction(signed.rawTransaction);
+      } catch (error) {
+        // NONCE_EXPIRED here means one of our earlier hashes was mined meanwhile. Unanswered
+        // broadcasts are tracked like sent ones, since the replacement may be the one mined
+        if (classifyBroadcastError(error) === 'REJECTED') {
+          throw error;
+        }
+      }
+
+      entry.transaction = transaction;
+      entry.hashes.push(signed.transactionHash);
+      entry.sentAt = Date.now();
+      entry.bumps++;
+      logger.warn(`Nonce ${nonce} for ${this.address} was stuck, replaced with ${signed.transactionHash} (bump ${entry.bumps})`);
+    });
+  }
+
+  /**
+   * Wait until one of the transactions sent with `nonce` has enough confirmations
+   * Stuck transactions are replaced with bumped fees while waiting
+   */
+  async waitFor(nonce, confirmations = 1) {
+    const entry = this.inFlight.get(nonce);
+    if (!entry) {
+      throw new Error(`Nonce ${nonce} is not in flight for ${this.address}`);
+    }
+
+    const provider = this.wallet.provider;
+    const startedAt = Date.now();
+
+    let consumedWithoutReceipt = false;
+
+    try {
+      for (;;) {
+        let mined = false;
+        for (const hash of entry.hashes.slice()) {
+          const receipt = await provider.getTransactionReceipt(hash);
+          if (receipt && receipt.blockNumber != null) {
+            if (receipt.confirmations >= confirmations) {
+              return receipt;
+            }
+            mined = true;
+          }
+        }
+
+        if (!mined) {
+          const minedCount = await provider.getTransactionCount(this.address, 'latest');
+          if (minedCount > nonce) {
+            // Our receipt may not be indexed yet, so only give up on the second sighting
+            if (consumedWithoutReceipt) {
+              throw new Error(`Nonce ${nonce} for ${this.address} was used by another transaction`);
+            }
+            consumedWithoutReceipt = true;
+          } else if (Date.now() - entry.sentAt >= this.options.stuckAfterMs && entry.bumps < this.options.maxBumps &&
+                     nonce === Math.min(...this.inFlight.keys())) {
+            // Only the lowest pending nonce blocks the queue; later ones just wait behind it
+            await this.replace(nonce);
+          }
+        }
+
+        if (Date.now() - startedAt >= this.options.timeoutMs) {
+          throw new Error(`Timed out waiting for nonce ${nonce} from ${this.address}`);
+        }
+        await sleep(this.options.pollInterval);
+      }
+    } finally {
+      this.inFlight.delete(nonce);
+    }
+  }
+
+  /**
+   * Pipeline mode: broadcast every request back to back, then await all receipts together
+   * @param {Array} requests - Transaction requests
+   * @param {Object} options - confirmations
+   * @returns {Array} Per request: { receipt } or { error }
+   */
+  async pipeline(requests, options = {}) {
+    const { confirmations = 1 } = options;
+    const pending = [];
+
+    for (const request of requests) {
+      try {
+        pending.push(await this.send(request));
+      } catch (error) {
+        pending.push(error);
+      }
+    }
+
+    return Promise.all(pending.map(async (item) => {
+      if (item instanceof Error) {
+        return { error: item };
+      }
+      try {
+        return { hash: item.hash, receipt: await item.wait(confirmations) };
+      } catch (error) {
+        return { hash: item.hash, error };
+      }
+    }));
+  }
+}
+
+const managers = new Map();
+
+/**
+ * Get the shared NonceManager for a wallet's address
+ * The first wallet registered for an address (and its provider) is reused
+ * @param {ethers.Wallet} wallet - Wallet connected to a provider
+ * @returns {NonceManager} Manager for the address
+ */
+const getNonceManager = (wallet) => {
+  const key = wallet.address.toLowerCase();
+  if (!managers.has(key)) {
+    managers.set(key, new NonceManager(wallet));
+  }
+  return managers.get(key);
+};
+
+/**
+ * Resync an address's local nonce from the chain on its next allocation
+ * @param {String} address - Wallet address
+ */
+const resetNonceManager = (address) => {
+  const manager = address && managers.get(address.toLowerCase());
+  if (manager) {
+    manager.reset();
+  }
+};
+
+module.exports = {
+  NonceManager,
+  PendingTransaction,
+  getNonceManager,
+  resetNonceManager,
+  classifyBroadcastError,
+  bumpFees
+};
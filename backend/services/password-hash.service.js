@@ -0,0 +1,208 @@
+/**
+ * Password hashing service for DBIS
+ * Credential hashing and verification run on a bounded pool of worker
+ * threads (password-hash.worker.js), so a burst of logins cannot block the
+ * event loop that every other request shares.
+ *
+ * Users are hashed with bcrypt, admins with argon2; verify() picks the
+ * algorithm from the stored hash. At most PASSWORD_HASH_THREADS tasks run at
+ * once. Up to PASSWORD_HASH_MAX_QUEUE more wait in FIFO order, each for at
+ * most PASSWORD_HASH_QUEUE_TIMEOUT_MS. Beyond that, calls fail fast with
+ * PasswordHashBusyError and controllers answer 503 with Retry-After
+ * (respondIfBusy), instead of letting the backlog grow without bound.
+ */
+
+const path = require('path');
+const os = require('os');
+const { Worker } = require('worker_threads');
+
+const cpuCount = () => (os.availableParallelism ? os.availableParallelism() : os.cpus().length);
+
+// Leave a core for the event loop
+const THREADS = parseInt(process.env.PASSWORD_HASH_THREADS || '0', 10) || Math.max(1, Math.min(4, cpuCount() - 1));
+const MAX_QUEUE = parseInt(process.env.PASSWORD_HASH_MAX_QUEUE || '64', 10);
+const QUEUE_TIMEOUT_MS = parseInt(process.env.PASSWORD_HASH_QUEUE_TIMEOUT_MS || '5000', 10);
+const BCRYPT_ROUNDS = parseInt(process.env.BCRYPT_ROUNDS || '10', 10);
+
+// Seconds clients are told to wait when the pool is saturated
+const RETRY_AFTER_S = 2;
+
+const WORKER_PATH = path.join(__dirname, 'password-hash.worker.js');
+
+/**
+ * Thrown when the hashing queue is full or a task waited too long
+ */
+class PasswordHashBusyError extends Error {
+  constructor(message) {
+    super(message);
+    this.name = 'PasswordHashBusyError';
+    this.retryAfter = RETRY_AFTER_S;
+  }
+}
+
+class PasswordHashPool {
+  constructor(options = {}) {
+    this.size = options.threads || THREADS;
+    this.maxQueue = options.maxQueue !== undefined ? options.maxQueue : MAX_QUEUE;
+    this.queueTimeout = options.queueTimeout || QUEUE_TIMEOUT_MS;
+    this.workerPath = options.workerPath || WORKER_PATH;
+    this.idle = [];
+    this.workers = new Set();
+    this.queue = [];
+    this.nextId = 1;
+    this.stats = { completed: 0, failed: 0, rejected: 0, timedOut: 0, waitMsMax: 0 };
+  }
+
+  /**
+   * Run a task on the pool
+   * @param {String} type - Task type (see password-hash.worker.js)
+   * @param {Object} payload - Task arguments
+   * @returns {Promise<*>} Task result
+   */
+  run(type, payload) {
+    if (this.idle.length === 0 && this.workers.size >= this.size && this.queue.length >= this.maxQueue) {
+      this.stats.rejected++;
+      return Promise.reject(new PasswordHashBusyError('Password hashing queue is full'));
+    }
+
+    return new Promise((resolve, reject) => {
+      const task = { id: this.nextId++, type, payload, resolve, reject, queuedAt: Date.now() };
+      task.timer = setTimeout(() => {
+        const index = this.queue.indexOf(task);
+        if (index !== -1) {
+          this.queue.splice(index, 1);
+          this.stats.timedOut++;
+          reject(new PasswordHashBusyError('Timed out waiting for password hashing'));
+        }
+      }, this.queueTimeout);
+      task.timer.unref();
+
+      this.queue.push(task);
+      this.dispatch();
+    });
+  }
+
+  dispatch() {
+    while (this.queue.length > 0) {
+      const worker = this.idle.pop() || this.spawn();
+      if (!worker) return;
+
+      const task = this.queue.shift();
+      clearTimeout(task.timer);
+      this.stats.waitMsMax = Math.max(this.stats.waitMsMax, Date.now() - task.queuedAt);
+      worker.task = task;
+      worker.postMessage({ id: task.id, type: task.type, payload: task.payload });
+    }
+  }
+
+  spawn() {
+    if (this.workers.size >= this.size) return null;
+
+    const worker = new Worker(this.workerPath);
+    worker.task = null;
+    // Idle workers must not keep the process alive on shutdown
+    worker.unref();
+
+    worker.on('message', ({ id, result, error }) => {
+      const task = worker.task;
+      if (!task || task.id !== id) return;
+      worker.task = null;
+
+      if (error) {
+        this.stats.failed++;
+        task.reject(new Error(error));
+      } else {
+        this.stats.completed++;
+        task.resolve(result);
+      }
+      this.idle.push(worker);
+      this.dispatch();
+    });
+
+    // A crashed worker fails its task and is replaced on the next dispatch
+    const onGone = (error) => {
+      if (!this.workers.delete(worker)) return;
+      this.idle = this.idle.filter(w => w !== worker);
+      if (worker.task) {
+        this.stats.failed++;
+        worker.task.reject(error || new Error('Password hashing worker exited'));
+        worker.task = null;
+      }
+      this.dispatch();
+    };
+    worker.on('error', onGone);
+    worker.on('exit', () => onGone());
+
+    this.workers.add(worker);
+    return worker;
+  }
+
+  getStats() {
+    return {
+      threads: this.size,
+      busy: this.workers.size - this.idle.length,
+      queued: this.queue.length,
+      maxQueue: this.maxQueue,
+      ...this.stats
+    };
+  }
+
+  async close() {
+    const workers = Array.from(this.workers);
+    this.workers.clear();
+    this.idle = [];
+    await Promise.all(workers.map(worker => worker.terminate()));
+  }
+}
+
+const pool = new PasswordHashPool();
+
+/**
+ * Hash a password
+ * @param {String} password - Plain-text password
+ * @param {Object} options - algorithm: 'bcrypt' (users, default) or 'argon2' (admins)
+ * @returns {Promise<String>} Encoded hash
+ */
+exports.hash = (password, options = {}) => {
+  if (options.algorithm === 'argon2') {
+    return pool.run('argon2.hash', { password });
+  }
+  return pool.run('bcrypt.hash', { password, rounds: options.rounds || BCRYPT_ROUNDS });
+};
+
+/**
+ * Check a password against a stored bcrypt or argon2 hash
+ * @param {String} password - Plain-text password
+ * @param {String} hash - Stored hash
+ * @returns {Promise<Boolean>} True if the password matches
+ */
+exports.verify = (password, hash) => {
+  if (typeof hash !== 'string' || hash.length === 0) {
+    return Promise.resolve(false);
+  }
+  if (hash.startsWith('$argon2')) {
+    return pool.run('argon2.verify', { password, hash });
+  }
+  return pool.run('bcrypt.compare', { password, hash });
+};
+
+/**
+ * Answer 503 with Retry-After if error means the hashing pool is saturated
+ * @param {Object} res - Express response object
+ * @param {Error} error - Error from hash or verify
+ * @returns {Boolean} True if a response was sent
+ */
+exports.respondIfBusy = (res, error) => {
+  if (!(error instanceof PasswordHashBusyError)) {
+    return false;
+  }
+  res.set('Retry-After', String(error.retryAfter));
+  res.status(503).json({ message: 'Server is busy. Please try again shortly.', retryAfter: error.retryAfter });
+  return true;
+};
+
+exports.getStats = () => pool.getStats();
+exports.close = () => pool.close();
+
+exports.PasswordHashPool = PasswordHashPool;
+exports.PasswordHashBusyError = PasswordHashBusyError;
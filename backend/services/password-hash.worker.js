@@ -0,0 +1,34 @@
+/**
+ * Password hashing worker thread
+ * Runs bcrypt (bcryptjs, pure JS) and argon2 off the API event loop.
+ * Handles one task at a time; see password-hash.service.js for the pool.
+ */
+
+const { parentPort } = require('worker_threads');
+const bcrypt = require('bcryptjs');
+
+let argon2 = null;
+
+// argon2 is only loaded by workers that see an argon2 task
+const getArgon2 = () => {
+  if (!argon2) {
+    argon2 = require('argon2');
+  }
+  return argon2;
+};
+
+const TASKS = {
+  'bcrypt.hash': ({ password, rounds }) => bcrypt.hashSync(password, rounds),
+  'bcrypt.compare': ({ password, hash }) => bcrypt.compareSync(password, hash),
+  'argon2.hash': ({ password }) => getArgon2().hash(password),
+  'argon2.verify': ({ password, hash }) => getArgon2().verify(hash, password)
+};
+
+parentPort.on('message', async ({ id, type, payload }) => {
+  try {
+    const result = await TASKS[type](payload);
+    parentPort.postMessage({ id, result });
+  } catch (error) {
+    parentPort.postMessage({ id, error: error.message });
+  }
+});
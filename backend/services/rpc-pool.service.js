@@ -0,0 +1,415 @@
+/**
+ * RPC provider pool for DBIS
+ * One provider per process for every chain call (blockchain.service,
+ * wallet.service, hd-wallet.service, the chain indexer). The network is
+ * detected once, ethers' receipt polling is shared, and requests are spread
+ * over every configured endpoint:
+ *
+ * - Endpoints come from AVALANCHE_FUJI_RPC_URLS (comma-separated), else
+ *   AVALANCHE_FUJI_RPC_URL, else the public Fuji endpoint.
+ * - Each request goes to a healthy endpoint picked at random, weighted by
+ *   the inverse of its recent latency. An endpoint that times out
+ *   (RPC_TIMEOUT_MS), refuses connections or answers with a bad status is
+ *   cooled down for RPC_ENDPOINT_COOLDOWN_MS, doubling up to
+ *   RPC_ENDPOINT_MAX_COOLDOWN_MS on repeated failures. The request fails
+ *   over to the next endpoint. Errors the node itself returns (reverts,
+ *   nonce errors) are not retried.
+ * - Requests made to one endpoint within RPC_BATCH_WAIT_MS are sent as one
+ *   JSON-RPC batch of up to RPC_BATCH_MAX calls (RPC_BATCH_ENABLED=false
+ *   sends them one by one).
+ * - eth_call on a registered view (cacheViews) is pinned to the latest block
+ *   number and cached per block for RPC_VIEW_CACHE_TTL_MS. The block number
+ *   itself is refreshed at most every RPC_BLOCK_NUMBER_TTL_MS.
+ */
+const { performance } = require('perf_hooks');
+const ethers = require('ethers');
+const { instrumentedSend } = require('./rpc-provider.service');
+const { registry } = require('../utils/metrics.utils');
+
+const DEFAULT_RPC_URL = 'https://api.avax-test.network/ext/bc/C/rpc';
+const TIMEOUT_MS = parseInt(process.env.RPC_TIMEOUT_MS || '10000', 10);
+const COOLDOWN_MS = parseInt(process.env.RPC_ENDPOINT_COOLDOWN_MS || '5000', 10);
+const MAX_COOLDOWN_MS = parseInt(process.env.RPC_ENDPOINT_MAX_COOLDOWN_MS || '120000', 10);
+const BATCH_ENABLED = process.env.RPC_BATCH_ENABLED !== 'false';
+const BATCH_MAX = parseInt(process.env.RPC_BATCH_MAX || '50', 10);
+const BATCH_WAIT_MS = parseInt(process.env.RPC_BATCH_WAIT_MS || '5', 10);
+const VIEW_CACHE_TTL_MS = parseInt(process.env.RPC_VIEW_CACHE_TTL_MS || '2000', 10);
+const VIEW_CACHE_MAX_ENTRIES = parseInt(process.env.RPC_VIEW_CACHE_MAX_ENTRIES || '5000', 10);
+const BLOCK_NUMBER_TTL_MS = parseInt(process.env.RPC_BLOCK_NUMBER_TTL_MS || '1000', 10);
+
+// Starting latency estimate, so a new endpoint gets an even share until measured
+const INITIAL_LATENCY_MS = 250;
+
+// JSON-RPC errors that mean "this endpoint cannot answer right now" rather than a real result
+const RETRYABLE_RPC_CODES = new Set([-32005]);
+const RETRYABLE_RPC_MESSAGE = /header not found|unknown block|block not found|rate limit/i;
+
+const endpointRequests = registry.counter(
+  'dbis_chain_rpc_endpoint_requests_total',
+  'JSON-RPC requests by endpoint and outcome (ok, node_error, transport_error)',
+  ['endpoint', 'outcome']
+);
+
+const failovers = registry.counter(
+  'dbis_chain_rpc_failovers_total',
+  'Requests retried on another endpoint after a transport error',
+  ['method']
+);
+
+const batchSize = registry.histogram(
+  'dbis_chain_rpc_batch_size',
+  'Calls per JSON-RPC HTTP request',
+  [],
+  [1, 2, 5, 10, 20, 50, 100]
+);
+
+const viewCacheLookups = registry.counter(
+  'dbis_chain_view_cache_total',
+  'Cached view call lookups by result',
+  ['result']
+);
+
+// Shared pools by endpoint list
+const pools = new Map();
+
+registry.gauge('dbis_chain_rpc_endpoint_healthy', '1 while an endpoint is taking requests', ['endpoint'], (gauge) => {
+  const now = Date.now();
+  for (const pool of pools.values()) {
+    for (const endpoint of pool.endpoints) {
+      gauge.set({ endpoint: endpoint.label }, endpoint.isHealthy(now) ? 1 : 0);
+    }
+  }
+});
+
+registry.gauge('dbis_chain_rpc_endpoint_latency_seconds', 'Smoothed round trip time per endpoint', ['endpoint'], (gauge) => {
+  for (const pool of pools.values()) {
+    for (const endpoint of pool.endpoints) {
+      gauge.set({ endpoint: endpoint.label }, endpoint.latencyMs / 1000);
+    }
+  }
+});
+
+const retryable = (error) => {
+  error.retryable = true;
+  return error;
+};
+
+/**
+ * Metric label for an endpoint: its host, so API keys in paths or queries stay out of metrics
+ */
+const endpointLabel = (url, taken) => {
+  let label;
+  try {
+    label = new URL(url).host;
+  } catch (error) {
+    label = 'invalid';
+  }
+  return taken.has(label) ? `${label}#${taken.size}` : label;
+};
+
+/**
+ * One node URL with its health and batch queue
+ */
+class Endpoint {
+  constructor(url, label) {
+    this.url = url;
+    this.label = label;
+    // throttleLimit 1: a rate-limited endpoint fails over instead of backing off in place
+    this.connection = { url, timeout: TIMEOUT_MS, throttleLimit: 1 };
+    this.latencyMs = INITIAL_LATENCY_MS;
+    this.failures = 0;
+    this.downUntil = 0;
+    this.queue = [];
+    this.timer = null;
+    this.nextId = 1;
+  }
+
+  isHealthy(now = Date.now()) {
+    return this.downUntil <= now;
+  }
+
+  weight() {
+    return 1 / Math.max(this.latencyMs, 1);
+  }
+
+  succeeded(ms) {
+    this.latencyMs = this.latencyMs * 0.8 + ms * 0.2;
+    this.failures = 0;
+    this.downUntil = 0;
+  }
+
+  failed() {
+    this.failures++;
+    this.latencyMs = Math.min(this.latencyMs * 2, TIMEOUT_MS);
+    this.downUntil = Date.now() + Math.min(COOLDOWN_MS * 2 ** (this.failures - 1), MAX_COOLDOWN_MS);
+  }
+
+  /**
+   * Queue a call for the next batch to this endpoint
+   * @returns {Promise} The call's result; rejections caused by the endpoint carry retryable = true
+   */
+  send(method, params) {
+    return new Promise((resolve, reject) => {
+      this.queue.push({ request: { method, params, id: this.nextId++, jsonrpc: '2.0' }, resolve, reject });
+      if (!BATCH_ENABLED || this.queue.length >= BATCH_MAX) {
+        this.flush();
+      } else if (!this.timer) {
+        this.timer = setTimeout(() => this.flush(), BATCH_WAIT_MS);
+      }
+    });
+  }
+
+  async flush() {
+    clearTimeout(this.timer);
+    this.timer = null;
+    const batch = this.queue.splice(0, BATCH_MAX);
+    if (this.queue.length > 0) {
+      this.timer = setTimeout(() => this.flush(), 0);
+    }
+    if (batch.length === 0) return;
+
+    batchSize.observe({}, batch.length);
+    const started = performance.now();
+    let response;
+    try {
+      // A single call goes unbatched; some endpoints handle batches poorly
+      const body = batch.length === 1 ? batch[0].request : batch.map(entry => entry.request);
+      response = await ethers.utils.fetchJson(this.connection, JSON.stringify(body));
+    } catch (error) {
+      // Timeout, refused connection, bad HTTP status or unparseable body
+      this.failed();
+      endpointRequests.inc({ endpoint: this.label, outcome: 'transport_error' }, batch.length);
+      for (const entry of batch) entry.reject(retryable(error));
+      return;
+    }
+    this.succeeded(performance.now() - started);
+
+    const payloads = Array.isArray(response) ? response : [response];
+    const byId = new Map(payloads.filter(payload => payload && payload.id !== undefined).map(payload => [payload.id, payload]));
+    for (const entry of batch) {
+      const payload = byId.get(entry.request.id) || (batch.length === 1 ? payloads[0] : undefined);
+      if (!payload) {
+        endpointRequests.inc({ endpoint: this.label, outcome: 'transport_error' });
+        entry.reject(retryable(new Error(`No response for ${entry.request.method} in batch from ${this.label}`)));
+      } else if (payload.error) {
+        // Same shape as ethers' JsonRpcBatchProvider, so JsonRpcProvider.perform decodes reverts as usual
+        const error = new Error(payload.error.message);
+        error.code = payload.error.code;
+        error.data = payload.error.data;
+        endpointRequests.inc({ endpoint: this.label, outcome: 'node_error' });
+        if (RETRYABLE_RPC_CODES.has(error.code) || RETRYABLE_RPC_MESSAGE.test(error.message || '')) {
+          retryable(error);
+        }
+        entry.reject(error);
+      } else {
+        endpointRequests.inc({ endpoint: this.label, outcome: 'ok' });
+        entry.resolve(payload.result);
+      }
+    }
+  }
+}
+
+/**
+ * ethers provider whose JSON-RPC calls go through the endpoint pool
+ * StaticJsonRpcProvider: the chain id is detected once, not before every call
+ */
+class PooledJsonRpcProvider extends ethers.providers.StaticJsonRpcProvider {
+  /**
+   * @param {Array} urls - Node URLs
+   */
+  constructor(urls) {
+    // The base connection is unused; send is overridden
+    super(urls[0]);
+    const taken = new Set();
+    this.endpoints = urls.map((url) => {
+      const label = endpointLabel(url, taken);
+      taken.add(label);
+      return new Endpoint(url, label);
+    });
+    this.viewSelectors = new Set();
+    this.views = new Map();
+    this.latestBlock = { number: null, fetchedAt: 0, pending: null };
+  }
+
+  /**
+   * Cache eth_call results of these view functions per block
+   * @param {ethers.utils.Interface} iface - Contract interface
+   * @param {Array} names - View function names
+   */
+  cacheViews(iface, names) {
+    for (const name of names) {
+      this.viewSelectors.add(iface.getSighash(name));
+    }
+  }
+
+  send(method, params) {
+    if (method === 'eth_call' && params[1] === 'latest' && this.isCachedView(params[0])) {
+      return this.cachedCall(params[0]);
+    }
+    return instrumentedSend(method, () => this.dispatch(method, params)).then((result) => {
+      if (method === 'eth_blockNumber') this.noteBlock(result);
+      return result;
+    });
+  }
+
+  isCachedView(transaction) {
+    return Boolean(transaction && transaction.data) && this.viewSelectors.has(transaction.data.slice(0, 10).toLowerCase());
+  }
+
+  /**
+   * Send to the best healthy endpoint, failing over on transport errors
+   */
+  async dispatch(method, params) {
+    const tried = new Set();
+    let lastError;
+    while (tried.size < this.endpoints.length) {
+      const endpoint = this.pick(tried);
+      tried.add(endpoint);
+      try {
+        return await endpoint.send(method, params);
+      } catch (error) {
+        lastError = error;
+        if (!error.retryable) throw error;
+        if (tried.size < this.endpoints.length) failovers.inc({ method });
+      }
+    }
+    throw lastError;
+  }
+
+  /**
+   * Weighted random choice among healthy endpoints; when all are cooling
+   * down, the one that recovers first
+   */
+  pick(exclude) {
+    const now = Date.now();
+    const candidates = this.endpoints.filter(endpoint => !exclude.has(endpoint));
+    const healthy = candidates.filter(endpoint => endpoint.isHealthy(now));
+    if (healthy.length === 0) {
+      return candidates.reduce((best, endpoint) => (endpoint.downUntil < best.downUntil ? endpoint : best));
+    }
+
+    let r = Math.random() * healthy.reduce((sum, endpoint) => sum + endpoint.weight(), 0);
+    for (const endpoint of healthy) {
+      r -= endpoint.weight();
+      if (r <= 0) return endpoint;
+    }
+    return healthy[healthy.length - 1];
+  }
+
+  noteBlock(result) {
+    const number = ethers.BigNumber.from(result).toNumber();
+    // Endpoints lag each other by a block or two; never move the cache key backwards
+    if (this.latestBlock.number === null || number >= this.latestBlock.number) {
+      this.latestBlock.number = number;
+      this.latestBlock.fetchedAt = Date.now();
+    }
+  }
+
+  /**
+   * Latest block number, refreshed at most every BLOCK_NUMBER_TTL_MS; concurrent refreshes share one call
+   */
+  cacheBlockNumber() {
+    const { number, fetchedAt, pending } = this.latestBlock;
+    if (number !== null && Date.now() - fetchedAt < BLOCK_NUMBER_TTL_MS) {
+      return Promise.resolve(number);
+    }
+    if (!pending) {
+      this.latestBlock.pending = instrumentedSend('eth_blockNumber', () => this.dispatch('eth_blockNumber', []))
+        .then((result) => {
+          this.noteBlock(result);
+          return this.latestBlock.number;
+        })
+        .finally(() => {
+          this.latestBlock.pending = null;
+        });
+    }
+    return this.latestBlock.pending;
+  }
+
+  /**
+   * eth_call pinned to the latest block and cached per block
+   * Reverts are cached too: they are the view's answer at that block
+   */
+  async cachedCall(transaction) {
+    const block = await this.cacheBlockNumber();
+    const key = `${block}:${transaction.from || ''}:${transaction.to}:${transaction.data}`.toLowerCase();
+    const now = Date.now();
+
+    const cached = this.views.get(key);
+    if (cached && cached.expiresAt > now) {
+      viewCacheLookups.inc({ result: 'hit' });
+      return cached.promise;
+    }
+    viewCacheLookups.inc({ result: 'miss' });
+
+    const params = [transaction, ethers.utils.hexValue(block)];
+    const promise = instrumentedSend('eth_call', () => this.dispatch('eth_call', params));
+    this.views.delete(key);
+    this.views.set(key, { promise, expiresAt: now + VIEW_CACHE_TTL_MS });
+    if (this.views.size > VIEW_CACHE_MAX_ENTRIES) {
+      this.views.delete(this.views.keys().next().value);
+    }
+    // Endpoint failures are not an answer; let the next call retry
+    promise.catch((error) => {
+      if (error.retryable && this.views.get(key) && this.views.get(key).promise === promise) {
+        this.views.delete(key);
+      }
+    });
+    return promise;
+  }
+
+  /**
+   * Endpoint health for the health endpoint
+   */
+  getStats() {
+    const now = Date.now();
+    return {
+      endpoints: this.endpoints.map(endpoint => ({
+        endpoint: endpoint.label,
+        healthy: endpoint.isHealthy(now),
+        latencyMs: Math.round(endpoint.latencyMs),
+        failures: endpoint.failures,
+        downForMs: Math.max(endpoint.downUntil - now, 0)
+      })),
+      latestBlock: this.latestBlock.number,
+      cachedViews: this.views.size
+    };
+  }
+}
+
+/**
+ * Configured node URLs
+ * @returns {Array} URLs from AVALANCHE_FUJI_RPC_URLS, else AVALANCHE_FUJI_RPC_URL, else the public Fuji endpoint
+ */
+const rpcUrlsFromEnv = () => (process.env.AVALANCHE_FUJI_RPC_URLS || process.env.AVALANCHE_FUJI_RPC_URL || DEFAULT_RPC_URL)
+  .split(',')
+  .map(url => url.trim())
+  .filter(Boolean);
+
+/**
+ * The process-wide provider for a set of endpoints
+ * @param {Array} urls - Node URLs (default: rpcUrlsFromEnv())
+ * @returns {PooledJsonRpcProvider}
+ */
+const getSharedProvider = (urls = rpcUrlsFromEnv()) => {
+  const key = urls.join(',');
+  let pool = pools.get(key);
+  if (!pool) {
+    pool = new PooledJsonRpcProvider(urls);
+    pools.set(key, pool);
+  }
+  return pool;
+};
+
+/**
+ * Stats of every shared pool, for the health endpoint
+ * @returns {Array}
+ */
+const getStats = () => [...pools.values()].map(pool => pool.getStats());
+
+module.exports = {
+  PooledJsonRpcProvider,
+  getSharedProvider,
+  rpcUrlsFromEnv,
+  getStats
+};
@@ -0,0 +1,101 @@
+/**
+ * RPC provider service for DBIS
+ * JSON-RPC providers that record latency and errors per RPC method, and gas
+ * used per contract method.
+ *
+ * The shared provider (rpc-pool.service) and createProvider both go through
+ * instrumentedSend, so each node round trip, including those made inside
+ * ethers (chain id detection, gas estimation, receipt polling), is timed
+ * under its JSON-RPC method name and wrapped in an rpc span.
+ */
+const ethers = require('ethers');
+const { registry } = require('../utils/metrics.utils');
+const tracing = require('../utils/tracing.utils');
+
+const rpcDuration = registry.histogram(
+  'dbis_chain_rpc_duration_seconds',
+  'JSON-RPC round trip time by method and outcome',
+  ['method', 'outcome']
+);
+
+const rpcErrors = registry.counter(
+  'dbis_chain_rpc_errors_total',
+  'Failed JSON-RPC calls by method and ethers error code',
+  ['method', 'code']
+);
+
+// Gas units; a plain transfer is 21000, batch calls reach several million
+const gasUsed = registry.histogram(
+  'dbis_chain_gas_used',
+  'Gas used per confirmed transaction by contract method',
+  ['method', 'status'],
+  [21000, 50000, 100000, 200000, 500000, 1000000, 2000000, 5000000, 10000000]
+);
+
+/**
+ * Time a JSON-RPC call and wrap it in an rpc span
+ * @param {String} method - JSON-RPC method
+ * @param {Function} run - () => Promise of the result
+ * @returns {Promise} The result of run
+ */
+const instrumentedSend = (method, run) => {
+  const end = rpcDuration.startTimer({ method });
+  const span = tracing.startSpan(`rpc ${method}`, { 'rpc.system': 'jsonrpc', 'rpc.method': method },
+    tracing.SpanKind.CLIENT);
+  return run().then((result) => {
+    end({ outcome: 'ok' });
+    tracing.endSpan(span);
+    return result;
+  }, (error) => {
+    end({ outcome: 'error' });
+    rpcErrors.inc({ method, code: error.code || 'UNKNOWN' });
+    tracing.endSpan(span, error);
+    throw error;
+  });
+};
+
+class InstrumentedJsonRpcProvider extends ethers.providers.JsonRpcProvider {
+  send(method, params) {
+    return instrumentedSend(method, () => super.send(method, params));
+  }
+}
+
+/**
+ * Create an instrumented provider
+ * @param {String} rpcUrl - Node URL
+ * @returns {InstrumentedJsonRpcProvider} Provider instance
+ */
+const createProvider = (rpcUrl) => new InstrumentedJsonRpcProvider(rpcUrl);
+
+/**
+ * Record the gas a confirmed transaction used
+ * @param {String} method - Contract method name (or "transfer")
+ * @param {Object} receipt - Transaction receipt
+ */
+const recordGasUsed = (method, receipt) => {
+  if (!receipt || !receipt.gasUsed) return;
+  gasUsed.observe({ method, status: receipt.status === 1 ? 'success' : 'failed' }, receipt.gasUsed.toNumber());
+};
+
+/**
+ * Contract method a transaction calls, for metric labels
+ * @param {ethers.utils.Interface} iface - Contract interface
+ * @param {Object} transaction - Transaction request
+ * @returns {String} Method name, "transfer" without calldata, "unknown" if it does not decode
+ */
+const contractMethod = (iface, transaction) => {
+  if (!transaction.data || transaction.data === '0x') return 'transfer';
+  try {
+    return iface.getFunction(transaction.data.slice(0, 10)).name;
+  } catch (error) {
+    return 'unknown';
+  }
+};
+
+module.exports = {
+  InstrumentedJsonRpcProvider,
+  instrumentedSend,
+  createProvider,
+  recordGasUsed,
+  contractMethod
+};
@@ -0,0 +1,252 @@
+/**
+ * Dashboard statistics for DBIS
+ * Serves the admin dashboard from precomputed tables instead of counting
+ * source tables on every request:
+ *   stat_counters  row counts per table and dimension, kept current by triggers
+ *   stat_daily     per-day rollups (registrations, audit actions), refreshed here
+ *
+ * A dashboard read touches a handful of counter rows, at most ROLLUP_DAYS days
+ * of rollups per series and the five newest audit logs, so its cost does not
+ * grow with the number of users or logs.
+ *
+ * The rollup is incremental: each run re-aggregates only from the start of the
+ * day of its previous run, tracked in scheduled_tasks.
+ */
+const { IntervalJob } = require('../utils/scheduler.utils');
+const { logger } = require('../utils/logger.utils');
+
+const TASK_NAME = 'stats_rollup';
+
+const DEFAULT_OPTIONS = {
+  interval: parseInt(process.env.STATS_ROLLUP_INTERVAL_MS || '60000', 10)
+};
+
+// Longest series the dashboard shows, and how far back the first rollup reaches
+const ROLLUP_DAYS = 30;
+
+/**
+ * Daily series rolled up from source tables
+ * Each query takes the window start ($1, timestamp text) and returns (day, dimension, count)
+ */
+const ROLLUPS = {
+  users_registered: `
+    SELECT DATE(created_at) AS day, '' AS dimension, COUNT(*) AS count
+    FROM users
+    WHERE created_at >= $1::timestamp
+    GROUP BY 1`,
+
+  audit_actions: `
+    SELECT DATE(created_at) AS day, action AS dimension, COUNT(*) AS count
+    FROM audit_logs
+    WHERE created_at >= $1::timestamp
+    GROUP BY 1, 2`
+};
+
+/**
+ * Refresh the daily rollups from the start of the previous run's day
+ * @param {Object} db - Database service
+ * @returns {Object} { since, series }
+ */
+exports.refreshRollups = async (db) => {
+  const task = await db.query(
+    `INSERT INTO scheduled_tasks (name, last_run_started_at, updated_at)
+     VALUES ($1, NOW(), NOW())
+     ON CONFLICT (name) DO UPDATE
+     SET last_run_started_at = NOW(), updated_at = NOW()
+     RETURNING checkpoint, LOCALTIMESTAMP::text AS started_at`,
+    [TASK_NAME]
+  );
+  const { checkpoint, started_at: startedAt } = task.rows[0];
+
+  // Re-aggregate whole days so a partially rolled-up day is replaced, not added to.
+  // Timestamps stay in Postgres text form, like the columns they are compared with
+  const since = await db.query(
+    `SELECT date_trunc('day', COALESCE($1::timestamp, LOCALTIMESTAMP - make_interval(days => $2::int)))::text AS since`,
+    [checkpoint ? checkpoint.watermark : null, ROLLUP_DAYS]
+  );
+  const windowStart = since.rows[0].since;
+
+  // The window's rows are deleted first, so a dimension that has dropped to zero
+  // loses its old count instead of keeping it; one transaction keeps readers from
+  // seeing the window empty
+  const client = await db.connect();
+  try {
+    await client.query('BEGIN');
+    for (const [name, sql] of Object.entries(ROLLUPS)) {
+      await client.query(
+        `DELETE FROM stat_daily WHERE name = $1 AND day >= $2::date`,
+        [name, windowStart]
+      );
+      await client.query(
+        `INSERT INTO stat_daily (name, day, dimension, count)
+         SELECT $2, rollup.day, rollup.dimension, rollup.count
+         FROM (${sql}) AS rollup`,
+        [windowStart, name]
+      );
+    }
+    await client.query('COMMIT');
+  } catch (error) {
+    await client.query('ROLLBACK');
+    throw error;
+  } finally {
+    client.release();
+  }
+
+  await db.query(
+    `UPDATE scheduled_tasks
+     SET checkpoint = $2, last_run_finished_at = NOW(), last_result = $3, updated_at = NOW()
+     WHERE name = $1`,
+    [
+      TASK_NAME,
+      JSON.stringify({ watermark: startedAt }),
+      JSON.stringify({ since: windowStart, series: Object.keys(ROLLUPS) })
+    ]
+  );
+
+  return { since: windowStart, series: Object.keys(ROLLUPS) };
+};
+
+/**
+ * Counter totals as { [name]: { [dimension]: count } }
+ */
+const readCounters = async (db) => {
+  const result = await db.query(
+    `SELECT name, dimension, SUM(count)::bigint AS count
+     FROM stat_counters
+     GROUP BY name, dimension`
+  );
+
+  const counters = {};
+  for (const row of result.rows) {
+    counters[row.name] = counters[row.name] || {};
+    counters[row.name][row.dimension] = parseInt(row.count, 10);
+  }
+  return counters;
+};
+
+const sum = (values = {}) => Object.values(values).reduce((total, count) => total + count, 0);
+
+const toRows = (values = {}, key) => Object.entries(values)
+  .filter(([, count]) => count > 0)
+  .map(([dimension, count]) => ({ [key]: dimension || null, count }));
+
+/**
+ * All dashboard statistics in one read
+ * @param {Object} db - Database service
+ * @returns {Object} Summary counts, breakdowns, series and recent activity
+ */
+exports.getDashboardStats = async (db) => {
+  const [counters, daily, recentActivity, rollup] = await Promise.all([
+    readCounters(db),
+    db.query(
+      `SELECT name, day, dimension, count
+       FROM stat_daily
+       WHERE day >= CURRENT_DATE - $1::int
+       ORDER BY day ASC`,
+      [ROLLUP_DAYS]
+    ),
+    db.query(
+      `SELECT p.*, u.name as user_name, u.government_id, a.username as admin_username
+       FROM (
+         SELECT l.id, l.user_id, l.admin_id, l.action, l.entity_type, l.details, l.created_at
+         FROM audit_logs l
+         ORDER BY l.created_at DESC, l.id DESC
+         LIMIT 5
+       ) p
+       LEFT JOIN users u ON p.user_id = u.id
+       LEFT JOIN admins a ON p.admin_id = a.id
+       ORDER BY p.created_at DESC, p.id DESC`
+    ),
+    db.query('SELECT last_run_finished_at FROM scheduled_tasks WHERE name = $1', [TASK_NAME])
+  ]);
+
+  const users = counters.users || {};
+  const weekAgo = new Date();
+  weekAgo.setDate(weekAgo.getDate() - 7);
+  weekAgo.setHours(0, 0, 0, 0);
+
+  const registrations = daily.rows
+    .filter(row => row.name === 'users_registered')
+    .map(row => ({ date: row.day, count: parseInt(row.count, 10) }));
+
+  const actions = {};
+  daily.rows
+    .filter(row => row.name === 'audit_actions')
+    .forEach(row => {
+      actions[row.dimension] = (actions[row.dimension] || 0) + parseInt(row.count, 10);
+    });
+
+  return {
+    userStats: {
+      total: sum(users),
+      verified: users.VERIFIED || 0,
+      pending: users.PENDING || 0,
+      rejected: users.REJECTED || 0
+    },
+    recordStats: {
+      biometricRecords: sum(counters.biometric_data),
+      professionalRecords: sum(counters.professional_records),
+      blockchainTransactions: sum(counters.blockchain_transactions)
+    },
+    recentActivity: recentActivity.rows,
+    registrationTrend: registrations.filter(row => new Date(row.date) >= weekAgo),
+    userStatsByStatus: toRows(users, 'verification_status'),
+    userStatsByDate: registrations,
+    biometricStats: toRows(counters.biometric_data, 'verification_status'),
+    blockchainStats: toRows(counters.blockchain_transactions, 'transaction_type'),
+    activityStats: toRows(actions, 'action'),
+    rollupRefreshedAt: rollup.rows.length > 0 ? rollup.rows[0].last_run_finished_at : null
+  };
+};
+
+/**
+ * Refreshes the daily rollups on a fixed interval
+ */
+class StatsRollupScheduler extends IntervalJob {
+  constructor(db, options = {}) {
+    const merged = { ...DEFAULT_OPTIONS, ...options };
+    super({ name: 'Stats rollup', interval: merged.interval });
+    this.db = db;
+    this.options = merged;
+  }
+
+  start() {
+    if (!this.running) {
+      logger.info(`Stats rollup started (every ${this.options.interval}ms)`);
+    }
+    return super.start();
+  }
+
+  async run() {
+    await exports.refreshRollups(this.db);
+  }
+}
+
+let scheduler = null;
+
+/**
+ * Start the shared in-process rollup scheduler
+ * @param {Object} db - Database service
+ * @param {Object} options - Scheduler options
+ * @returns {StatsRollupScheduler} Running scheduler
+ */
+exports.startRollups = (db, options = {}) => {
+  if (!scheduler) {
+    scheduler = new StatsRollupScheduler(db, options);
+  }
+  return scheduler.start();
+};
+
+/**
+ * Stop the shared in-process rollup scheduler, waiting for the current refresh to finish
+ */
+exports.stopRollups = async () => {
+  if (scheduler) {
+    // Clear it first so a start() during the wait gets a fresh instance
+    const stopping = scheduler;
+    scheduler = null;
+    await stopping.stop();
+  }
+};
+
+exports.StatsRollupScheduler = StatsRollupScheduler;
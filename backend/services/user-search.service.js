@@ -0,0 +1,117 @@
+/**
+ * User search for DBIS
+ * Typeahead lookup over users by name, government ID and email.
+ *
+ * Each match type is its own index-backed branch with its own LIMIT, so the
+ * cost of a lookup is bounded by the page size rather than the table size:
+ *   exact government ID   btree on lower(government_id)
+ *   prefix                text_pattern_ops btrees
+ *   substring and fuzzy   pg_trgm GIN indexes (3+ character terms only)
+ * Candidates are then ranked exact > prefix > substring/fuzzy, and by
+ * trigram similarity within a tier.
+ */
+
+const DEFAULT_LIMIT = 10;
+const MAX_LIMIT = 50;
+
+// Per-branch candidate cap; ranking only ever looks at this many rows per match type
+const CANDIDATE_LIMIT = parseInt(process.env.USER_SEARCH_CANDIDATE_LIMIT || '200', 10);
+
+// Trigram indexes cannot narrow terms shorter than one trigram
+const MIN_TRIGRAM_LENGTH = 3;
+
+/**
+ * Escape LIKE wildcards in user input
+ * @param {String} value - Raw search term
+ * @returns {String} Term safe to embed in a LIKE pattern
+ */
+const escapeLike = (value) => value.replace(/[\\%_]/g, '\\$&');
+
+/**
+ * Normalize a search term the way the indexes store it
+ * @param {String} value - Raw search term
+ * @returns {String} Trimmed, lower-cased term
+ */
+const normalizeTerm = (value) => String(value || '').trim().toLowerCase();
+
+/**
+ * SQL condition for a substring match that the trigram indexes can serve
+ * Used by list endpoints that filter rather than rank
+ * @param {String} alias - users table alias
+ * @param {Number} paramIndex - Index of the pattern parameter
+ * @returns {String} SQL condition
+ */
+exports.substringCondition = (alias, paramIndex) =>
+  `(lower(${alias}.name) LIKE $${paramIndex} OR lower(${alias}.government_id) LIKE $${paramIndex} OR lower(${alias}.email) LIKE $${paramIndex})`;
+
+/**
+ * LIKE pattern for substringCondition
+ * @param {String} value - Raw search term
+ * @returns {String} %term% pattern
+ */
+exports.substringPattern = (value) => `%${escapeLike(normalizeTerm(value))}%`;
+
+/**
+ * Ranked typeahead search
+ * @param {Object} db - Database service
+ * @param {String} query - Search term
+ * @param {Object} options - limit, status (verification_status filter)
+ * @returns {Array} Matching users, best match first
+ */
+exports.searchUsers = async (db, query, options = {}) => {
+  const term = normalizeTerm(query);
+  if (!term) {
+    return [];
+  }
+
+  const limit = Math.min(Math.max(parseInt(options.limit, 10) || DEFAULT_LIMIT, 1), MAX_LIMIT);
+  const status = options.status || null;
+  const escaped = escapeLike(term);
+
+  const result = await db.query(
+    `WITH candidates AS (
+       (SELECT id, 3 AS tier FROM users
+        WHERE lower(government_id) = $1 AND ($5::text IS NULL OR verification_status = $5))
+       UNION ALL
+       (SELECT id, 2 FROM users
+        WHERE lower(name) LIKE $2 AND ($5::text IS NULL OR verification_status = $5)
+        LIMIT $4)
+       UNION ALL
+       (SELECT id, 2 FROM users
+        WHERE lower(government_id) LIKE $2 AND ($5::text IS NULL OR verification_status = $5)
+        LIMIT $4)
+       UNION ALL
+       (SELECT id, 2 FROM users
+        WHERE lower(email) LIKE $2 AND ($5::text IS NULL OR verification_status = $5)
+        LIMIT $4)
+       UNION ALL
+       (SELECT id, 1 FROM users
+        WHERE $6::boolean
+          AND (lower(name) LIKE $3 OR lower(government_id) LIKE $3 OR lower(email) LIKE $3 OR lower(name) % $1)
+          AND ($5::text IS NULL OR verification_status = $5)
+        LIMIT $4)
+     ),
+     ranked AS (
+       SELECT id, MAX(tier) AS tier FROM candidates GROUP BY id
+     )
+     SELECT u.id, u.name, u.government_id, u.email, u.avax_address,
+            u.is_verified, u.verification_status, u.created_at,
+            r.tier AS match_tier,
+            GREATEST(
+              similarity(lower(u.name), $1),
+              similarity(lower(u.government_id), $1),
+              similarity(COALESCE(lower(u.email), ''), $1)
+            ) AS score
+     FROM ranked r
+     JOIN users u ON u.id = r.id
+     ORDER BY r.tier DESC, score DESC, u.created_at DESC, u.id DESC
+     LIMIT $7`,
+    [term, `${escaped}%`, `%${escaped}%`, CANDIDATE_LIMIT, status, term.length >= MIN_TRIGRAM_LENGTH, limit]
+  );
+
+  return result.rows.map(({ match_tier, score, ...user }) => ({
+    ...user,
+    match: match_tier === 3 ? 'EXACT' : match_tier === 2 ? 'PREFIX' : 'FUZZY',
+    score: Number(score)
+  }));
+};
@@ -3,17 +3,19 @@
  * Handles Avalanche C-Chain wallet operations
  */
 const ethers = require('ethers');
+const { getNonceManager } = require('./nonce-manager.service');
+const { getSharedProvider } = require('./rpc-pool.service');
+const { logger } = require('../utils/logger.utils');
 
 /**
- * Initialize connection to Avalanche Fuji Testnet
+ * Connection to Avalanche Fuji Testnet (the process-wide provider pool)
  * @returns {ethers.providers.JsonRpcProvider} Provider instance
  */
 const initProvider = () => {
-  const rpcUrl = process.env.AVALANCHE_FUJI_RPC_URL;
-  if (!rpcUrl) {
+  if (!process.env.AVALANCHE_FUJI_RPC_URL && !process.env.AVALANCHE_FUJI_RPC_URLS) {
     throw new Error('AVALANCHE_FUJI_RPC_URL not defined in environment variables');
   }
-  return new ethers.providers.JsonRpcProvider(rpcUrl);
+  return getSharedProvider();
 };
 
 /**
@@ -22,19 +24,15 @@ const initProvider = () => {
  */
 exports.generateWallet = () => {
   try {
-    // Create a random wallet
+    // Create a random wallet (only used when no HD master seed is configured, see hd-wallet.service)
     const wallet = ethers.Wallet.createRandom();
     
-    // Connect wallet to provider (optional, not needed just for address generation)
-    const provider = initProvider();
-    const connectedWallet = wallet.connect(provider);
-    
     return {
       address: wallet.address,
       privateKey: wallet.privateKey
     };
   } catch (error) {
-    console.error('Error generating wallet:', error);
+    logger.error('Error generating wallet:', error);
     throw new Error('Failed to generate Avalanche wallet');
   }
 };
@@ -52,7 +50,7 @@ exports.getBalance = async (address) => {
     // Convert from wei to AVAX (18 decimals)
     return ethers.utils.formatEther(balance);
   } catch (error) {
-    console.error('Error getting wallet balance:', error);
+    logger.error('Error getting wallet balance:', error);
     throw new Error('Failed to get wallet balance');
   }
 };
@@ -114,27 +112,61 @@ exports.transferTokens = async (toAddress, amount = 0.03) => {
       gasLimit: 21000, // Standard gas limit for simple transfers
     };
     
-    // Send transaction
-    const transaction = await adminWallet.sendTransaction(tx);
+    // Send through the admin nonce manager so concurrent transfers get distinct nonces
+    const transaction = await getNonceManager(adminWallet).send(tx);
     
-    // Wait for transaction to be mined
+    // Wait for transaction to be mined (stuck transfers are fee-bumped while waiting)
     const receipt = await transaction.wait();
     
     return {
       success: true,
-      transactionHash: transaction.hash,
+      transactionHash: receipt.transactionHash,
       blockNumber: receipt.blockNumber,
       from: adminWallet.address,
       to: toAddress,
       amount: amount,
       gasUsed: receipt.gasUsed.toString(),
-      explorerUrl: `https://testnet.snowtrace.io/tx/${transaction.hash}`
+      explorerUrl: `https://testnet.snowtrace.io/tx/${receipt.transactionHash}`
     };
   } catch (error) {
-    console.error('Error transferring AVAX tokens:', error);
+    logger.error('Error transferring AVAX tokens:', error);
     return {
       success: false,
       error: error.message
     };
   }
 };
+
+/**
+ * Sign (but do not send) an AVAX transfer from the admin wallet
+ * Used by the blockchain job queue, which persists the signed transaction before broadcasting it
+ * @param {String} toAddress - User's wallet address to receive tokens
+ * @param {Number} amount - Amount of AVAX to transfer (default: 0.03)
+ * @returns {Object} Signed transaction details
+ */
+exports.prepareTransfer = async (toAddress, amount = 0.03) => {
+  if (!exports.isValidAddress(toAddress)) {
+    throw new Error(`Invalid destination address: ${toAddress}`);
+  }
+
+  const adminPrivateKey = process.env.ADMIN_PRIVATE_KEY;
+  if (!adminPrivateKey) {
+    throw new Error('ADMIN_PRIVATE_KEY not found in environment variables');
+  }
+
+  const provider = initProvider();
+  const adminWallet = new ethers.Wallet(adminPrivateKey, provider);
+  const amountInWei = ethers.utils.parseEther(amount.toString());
+
+  const adminBalance = await provider.getBalance(adminWallet.address);
+  if (adminBalance.lt(amountInWei)) {
+    throw new Error(`Insufficient balance. Admin has ${ethers.utils.formatEther(adminBalance)} AVAX, trying to send ${amount} AVAX`);
+  }
+
+  // The nonce is reserved locally; the job queue broadcasts (and re-broadcasts) the signed bytes
+  return getNonceManager(adminWallet).sign({
+    to: toAddress,
+    value: amountInWei,
+    gasLimit: 21000 // Standard gas limit for simple transfers
+  });
+};
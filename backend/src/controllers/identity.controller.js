@@ -5,6 +5,49 @@ const crypto = require('crypto');
 const { validationResult } = require('express-validator');
 const { v4: uuidv4 } = require('uuid');
 const blockchainService = require('../services/blockchain.service');
+const facemeshIndex = require('../../services/facemesh-index.service');
+const {
+  isFacemeshTemplate,
+  resolveFacemeshTemplate,
+  hashFacemeshTemplate
+} = require('../../utils/facemesh-template.utils');
+const { generateFacemeshHash } = require('../../utils/biometric.utils');
+const { generateCanonicalHash } = require('../../utils/hash.utils');
+
+/**
+ * Turn an uploaded facemesh file into a binary template
+ * Binary templates are used as-is; JSON uploads with landmarks are encoded
+ * @param {Buffer} buffer - Uploaded file contents
+ * @returns {Buffer|null} Facemesh template, or null if the upload has no usable landmarks
+ */
+const parseFacemeshUpload = (buffer) => {
+  try {
+    if (isFacemeshTemplate(buffer)) {
+      return resolveFacemeshTemplate(null, buffer);
+    }
+    return resolveFacemeshTemplate(JSON.parse(buffer.toString('utf8')));
+  } catch (error) {
+    return null;
+  }
+};
+
+/**
+ * Hash an uploaded facemesh file the same way as the JSON API
+ * Binary templates hash their bytes; JSON uploads use the canonical facemesh hash
+ * @param {Buffer} buffer - Uploaded file contents
+ * @returns {String} SHA-256 hash
+ */
+const hashFacemeshUpload = (buffer) => {
+  if (isFacemeshTemplate(buffer)) {
+    return hashFacemeshTemplate(buffer);
+  }
+
+  try {
+    return generateFacemeshHash(JSON.parse(buffer.toString('utf8')));
+  } catch (error) {
+    return crypto.createHash('sha256').update(buffer).digest('hex');
+  }
+};
 
 /**
  * Register biometric data for a user
@@ -32,18 +75,25 @@ exports.registerBiometric = async (req, res) => {
       });
     }
 
+    // Reject faces already enrolled under another identity
+    const facemeshTemplate = parseFacemeshUpload(req.file.buffer);
+    if (facemeshTemplate && facemeshIndex.findDuplicates(facemeshTemplate, { limit: 1, excludeUserId: userId }).length > 0) {
+      return res.status(409).json({ message: 'Biometric data is already registered to another identity' });
+    }
+
     // Hash the facemesh data using SHA-256
-    const facemeshHash = crypto
-      .createHash('sha256')
-      .update(req.file.buffer)
-      .digest('hex');
+    const facemeshHash = hashFacemeshUpload(req.file.buffer);
 
     // Store the hash in the database
     const result = await db.query(
-      'INSERT INTO biometric_data (user_id, facemesh_hash) VALUES ($1, $2) RETURNING id, created_at',
-      [userId, facemeshHash]
+      'INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_template) VALUES ($1, $2, $3) RETURNING id, created_at',
+      [userId, facemeshHash, facemeshTemplate]
     );
 
+    if (facemeshTemplate) {
+      facemeshIndex.add(result.rows[0].id, userId, facemeshTemplate);
+    }
+
     // Log the biometric registration
     await db.query(
       'INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address) VALUES ($1, $2, $3, $4, $5, $6)',
@@ -83,10 +133,7 @@ exports.authenticateBiometric = async (req, res) => {
     const db = req.app.locals.db;
 
     // Hash the provided facemesh data
-    const providedFacemeshHash = crypto
-      .createHash('sha256')
-      .update(req.file.buffer)
-      .digest('hex');
+    const providedFacemeshHash = hashFacemeshUpload(req.file.buffer);
 
     // Get the stored hash from the database
     const result = await db.query(
@@ -141,11 +188,13 @@ exports.updateBiometric = async (req, res) => {
     const userId = req.user.id;
     const db = req.app.locals.db;
 
+    const facemeshTemplate = parseFacemeshUpload(req.file.buffer);
+    if (facemeshTemplate && facemeshIndex.findDuplicates(facemeshTemplate, { limit: 1, excludeUserId: userId }).length > 0) {
+      return res.status(409).json({ message: 'Biometric data is already registered to another identity' });
+    }
+
     // Hash the new facemesh data
-    const newFacemeshHash = crypto
-      .createHash('sha256')
-      .update(req.file.buffer)
-      .digest('hex');
+    const newFacemeshHash = hashFacemeshUpload(req.file.buffer);
 
     // Deactivate old biometric data
     await db.query(
@@ -155,10 +204,16 @@ exports.updateBiometric = async (req, res) => {
 
     // Store the new hash
     const result = await db.query(
-      'INSERT INTO biometric_data (user_id, facemesh_hash) VALUES ($1, $2) RETURNING id, created_at',
-      [userId, newFacemeshHash]
+      'INSERT INTO biometric_data (user_id, facemesh_hash, facemesh_template) VALUES ($1, $2, $3) RETURNING id, created_at',
+      [userId, newFacemeshHash, facemeshTemplate]
     );
 
+    if (facemeshTemplate) {
+      facemeshIndex.replaceUser(result.rows[0].id, userId, facemeshTemplate);
+    } else {
+      facemeshIndex.removeUser(userId);
+    }
+
     // Log the biometric update
     await db.query(
       'INSERT INTO audit_logs (user_id, action, entity_type, entity_id, details, ip_address) VALUES ($1, $2, $3, $4, $5, $6)',
@@ -210,7 +265,7 @@ exports.addProfessionalRecord = async (req, res) => {
     const db = req.app.locals.db;
 
     // Create a data object to hash
-    const recordData = JSON.stringify({
+    const recordData = {
       recordType,
       organizationName,
       title,
@@ -220,13 +275,10 @@ exports.addProfessionalRecord = async (req, res) => {
       location,
       userId,
       timestamp: new Date().toISOString()
-    });
+    };
 
     // Generate a hash of the record data
-    const dataHash = crypto
-      .createHash('sha256')
-      .update(recordData)
-      .digest('hex');
+    const dataHash = generateCanonicalHash(recordData);
 
     // Store the record in the database
     const result = await db.query(
@@ -375,7 +427,7 @@ exports.updateProfessionalRecord = async (req, res) => {
     } = req.body;
 
     // Create a data object to hash
-    const recordData = JSON.stringify({
+    const recordData = {
       recordType,
       organizationName,
       title,
@@ -385,13 +437,10 @@ exports.updateProfessionalRecord = async (req, res) => {
       location,
       userId,
       timestamp: new Date().toISOString()
-    });
+    };
 
     // Generate a new hash of the updated record data
-    const dataHash = crypto
-      .createHash('sha256')
-      .update(recordData)
-      .digest('hex');
+    const dataHash = generateCanonicalHash(recordData);
 
     // Update the record
     await db.query(
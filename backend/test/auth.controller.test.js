@@ -0,0 +1,110 @@
+/**
+ * Tests for biometric verification in the auth controller
+ */
+jest.mock('../services/password-hash.service', () => ({}));
+jest.mock('../services/hd-wallet.service', () => ({}));
+jest.mock('../services/audit-log.service', () => ({ record: jest.fn() }));
+jest.mock('../services/facemesh-index.service', () => ({ publish: jest.fn() }));
+
+const facemeshIndex = require('../services/facemesh-index.service');
+const authController = require('../controllers/auth.controller');
+const { generateFacemeshHash } = require('../utils/biometric.utils');
+const { generateLegacyHash } = require('../utils/hash.utils');
+const { encodeFacemeshTemplate } = require('../utils/facemesh-template.utils');
+
+const landmarks = Array.from({ length: 468 }, (_, i) => ({
+  x: (i % 26) / 26,
+  y: Math.floor(i / 26) / 18,
+  z: Math.sin(i) / 10
+}));
+
+const createResponse = () => {
+  const res = {};
+  res.status = jest.fn(() => res);
+  res.json = jest.fn(() => res);
+  return res;
+};
+
+const createRequest = (body, rows) => {
+  const db = {
+    query: jest.fn(async (sql) => (sql.trim().startsWith('SELECT') ? { rows } : { rows: [] }))
+  };
+  return {
+    body,
+    ip: '127.0.0.1',
+    app: { locals: { db, logger: { error: jest.fn() } } }
+  };
+};
+
+describe('verifyUserBiometric', () => {
+  beforeEach(() => {
+    facemeshIndex.publish.mockClear();
+  });
+
+  it('matches a template enrollment by similarity', async () => {
+    const template = encodeFacemeshTemplate(landmarks);
+    const req = createRequest(
+      { userId: 1, facemeshTemplate: template.toString('base64') },
+      [{ id: 10, facemesh_hash: 'unused', facemesh_template: template }]
+    );
+    const res = createResponse();
+
+    await authController.verifyUserBiometric(req, res);
+
+    expect(res.status).toHaveBeenCalledWith(200);
+    expect(res.json.mock.calls[0][0].verified).toBe(true);
+  });
+
+  it('matches a legacy enrollment by its landmark hash and stores the template', async () => {
+    const facemeshData = { landmarks };
+    const template = encodeFacemeshTemplate(landmarks);
+    const req = createRequest(
+      { userId: 1, facemeshData, facemeshTemplate: template.toString('base64') },
+      [{ id: 10, facemesh_hash: generateFacemeshHash(facemeshData), facemesh_template: null }]
+    );
+    const res = createResponse();
+
+    await authController.verifyUserBiometric(req, res);
+
+    expect(res.json.mock.calls[0][0].verified).toBe(true);
+    const update = req.app.locals.db.query.mock.calls.find(([sql]) => sql.includes('UPDATE biometric_data'));
+    expect(update).toBeDefined();
+    expect(update[1]).toEqual([template, 10]);
+    expect(facemeshIndex.publish).toHaveBeenCalledWith('add', 10, 1, template);
+  });
+
+  it('matches an unsorted-JSON legacy hash and moves it to the canonical hash', async () => {
+    // Keys out of sorted order, so the legacy and canonical hashes differ
+    const facemeshData = { landmarks, capturedAt: 1700000000000 };
+    const legacyHash = generateLegacyHash(facemeshData);
+    expect(legacyHash).not.toBe(generateFacemeshHash(facemeshData));
+
+    const req = createRequest(
+      { userId: 1, facemeshData },
+      [{ id: 10, facemesh_hash: legacyHash, facemesh_template: null }]
+    );
+    const res = createResponse();
+
+    await authController.verifyUserBiometric(req, res);
+
+    expect(res.json.mock.calls[0][0].verified).toBe(true);
+    const rehash = req.app.locals.db.query.mock.calls.find(([sql]) => sql.includes('SET facemesh_hash'));
+    expect(rehash[1]).toEqual([generateFacemeshHash(facemeshData), 10, legacyHash]);
+    expect(rehash[0]).toContain('blockchain_tx_hash IS NULL');
+  });
+
+  it('rejects a legacy enrollment when only a template is sent', async () => {
+    const facemeshData = { landmarks };
+    const template = encodeFacemeshTemplate(landmarks);
+    const req = createRequest(
+      { userId: 1, facemeshTemplate: template.toString('base64') },
+      [{ id: 10, facemesh_hash: generateFacemeshHash(facemeshData), facemesh_template: null }]
+    );
+    const res = createResponse();
+
+    await authController.verifyUserBiometric(req, res);
+
+    expect(res.json.mock.calls[0][0].verified).toBe(false);
+    expect(facemeshIndex.publish).not.toHaveBeenCalled();
+  });
+});
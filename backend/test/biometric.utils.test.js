@@ -0,0 +1,79 @@
+/**
+ * Tests for facemesh similarity on the native and JavaScript distance kernels
+ */
+const native = require('../utils/biometric.utils');
+
+let js;
+jest.isolateModules(() => {
+  const previous = process.env.BIOMETRIC_NATIVE;
+  process.env.BIOMETRIC_NATIVE = 'false';
+  js = require('../utils/biometric.utils');
+  process.env.BIOMETRIC_NATIVE = previous;
+});
+
+// Deterministic landmarks so failures reproduce
+const landmarksFor = (count, seed) => Array.from({ length: count }, (_, i) => ({
+  x: Math.sin(i * 0.37 + seed),
+  y: Math.cos(i * 0.11 + seed * 2),
+  z: Math.sin(i * 0.05 - seed) / 10
+}));
+
+// Counts that are not multiples of the 8-wide SIMD loop exercise its scalar tail
+const COUNTS = [1, 7, 8, 9, 15, 100, 468];
+
+// The native kernel accumulates in float32; the JS path in float64
+const TOLERANCE = 1e-5;
+
+describe('calculateFacemeshSimilarity on the JS kernel', () => {
+  it('scores identical landmarks as 1', () => {
+    const landmarks = landmarksFor(468, 1);
+    expect(js.KERNEL).toBe('js');
+    expect(js.calculateFacemeshSimilarity({ landmarks }, { landmarks })).toBe(1);
+  });
+
+  it('gives the same score for packed and object landmarks', () => {
+    for (const count of COUNTS) {
+      const a = landmarksFor(count, 1);
+      const b = landmarksFor(count, 1.02);
+      const fromObjects = js.calculateFacemeshSimilarity({ landmarks: a }, { landmarks: b });
+      const fromPacked = js.calculateFacemeshSimilarity(
+        { landmarks: js.packLandmarks(a) },
+        { landmarks: js.packLandmarks(b) }
+      );
+      expect(Math.abs(fromObjects - fromPacked)).toBeLessThan(TOLERANCE);
+    }
+  });
+});
+
+(native.KERNEL === 'native' ? describe : describe.skip)('calculateFacemeshSimilarity on the native kernel', () => {
+  it('matches the JS kernel within tolerance', () => {
+    for (const count of COUNTS) {
+      for (const offset of [0.001, 0.05, 0.5]) {
+        const a = { landmarks: landmarksFor(count, 1) };
+        const b = { landmarks: landmarksFor(count, 1 + offset) };
+        const expected = js.calculateFacemeshSimilarity(a, b);
+        expect(Math.abs(native.calculateFacemeshSimilarity(a, b) - expected)).toBeLessThan(TOLERANCE);
+        const packed = native.calculateFacemeshSimilarity(
+          { landmarks: native.packLandmarks(a.landmarks) },
+          { landmarks: native.packLandmarks(b.landmarks) }
+        );
+        expect(Math.abs(packed - expected)).toBeLessThan(TOLERANCE);
+      }
+    }
+  });
+
+  it('reuses scratch buffers without leaking one comparison into the next', () => {
+    const a = { landmarks: landmarksFor(100, 1) };
+    const b = { landmarks: landmarksFor(100, 2) };
+    const first = native.calculateFacemeshSimilarity(a, b);
+    native.calculateFacemeshSimilarity({ landmarks: landmarksFor(100, 3) }, { landmarks: landmarksFor(100, 4) });
+    expect(native.calculateFacemeshSimilarity(a, b)).toBe(first);
+  });
+
+  it('returns 0 for landmark sets of different sizes', () => {
+    expect(native.calculateFacemeshSimilarity(
+      { landmarks: landmarksFor(9, 1) },
+      { landmarks: landmarksFor(8, 1) }
+    )).toBe(0);
+  });
+});
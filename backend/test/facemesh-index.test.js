@@ -0,0 +1,117 @@
+/**
+ * Tests for the HNSW facemesh index
+ */
+jest.mock('../utils/cluster.utils', () => ({ broadcast: jest.fn(), onBroadcast: jest.fn(), onGather: jest.fn() }));
+
+const { FacemeshIndexService } = require('../services/facemesh-index.service');
+
+const DIMENSION = 468 * 3;
+const LATENT = 12;
+
+// Deterministic PRNG so failures reproduce
+const random = (() => {
+  let seed = 0x2f6b1d;
+  return () => {
+    seed = (seed * 1664525 + 1013904223) >>> 0;
+    return seed / 0x100000000;
+  };
+})();
+
+// Faces vary along a few directions, so vectors are drawn from a low-dimensional subspace
+const basis = Array.from({ length: LATENT }, () => Float32Array.from({ length: DIMENSION }, () => random() - 0.5));
+const mean = Float32Array.from({ length: DIMENSION }, () => random());
+
+const face = () => {
+  const vector = Float32Array.from(mean);
+  for (const direction of basis) {
+    const weight = (random() - 0.5) * 0.2;
+    for (let i = 0; i < DIMENSION; i++) vector[i] += weight * direction[i];
+  }
+  return vector;
+};
+
+// Another capture of the same face
+const recapture = (vector, noise = 0.0005) => vector.map(value => value + (random() - 0.5) * noise);
+
+const squaredDistance = (a, b) => {
+  let sum = 0;
+  for (let i = 0; i < a.length; i++) sum += (a[i] - b[i]) ** 2;
+  return sum;
+};
+
+describe('FacemeshIndexService', () => {
+  it('finds the exact nearest neighbours for most queries', () => {
+    const index = new FacemeshIndexService({ M: 16, efConstruction: 100, efSearch: 64 });
+    const vectors = Array.from({ length: 600 }, face);
+    vectors.forEach((vector, i) => index.add(i + 1, i + 1, { landmarks: vector }));
+
+    const k = 10;
+    let found = 0;
+    let total = 0;
+    for (let q = 0; q < 50; q++) {
+      const query = face();
+      const exact = vectors
+        .map((vector, node) => ({ node, distance: squaredDistance(query, vector) }))
+        .sort((a, b) => a.distance - b.distance)
+        .slice(0, k)
+        .map(entry => entry.node);
+      const approximate = new Set(index.search(query, 64).slice(0, k).map(entry => entry.node));
+      found += exact.filter(node => approximate.has(node)).length;
+      total += k;
+    }
+
+    expect(found / total).toBeGreaterThan(0.95);
+  });
+
+  it('reports a recapture of an enrolled face as a duplicate', () => {
+    const index = new FacemeshIndexService();
+    const vectors = Array.from({ length: 200 }, face);
+    vectors.forEach((vector, i) => index.add(i + 1, i + 1, { landmarks: vector }));
+
+    const matches = index.findDuplicates({ landmarks: recapture(vectors[42]) }, { limit: 1 });
+    expect(matches.length).toBe(1);
+    expect(matches[0].userId).toBe(43);
+    expect(index.findDuplicates({ landmarks: recapture(vectors[42]) }, { limit: 1, excludeUserId: 43 })
+      .some(match => match.userId === 43)).toBe(false);
+  });
+
+  it('ignores a biometric id that is already indexed', () => {
+    const index = new FacemeshIndexService();
+    expect(index.add(1, 1, { landmarks: face() })).toBe(true);
+    expect(index.add(1, 1, { landmarks: face() })).toBe(false);
+    expect(index.getStats().templates).toBe(1);
+  });
+
+  it('stops returning a user after removeUser', () => {
+    const index = new FacemeshIndexService();
+    const vectors = Array.from({ length: 50 }, face);
+    vectors.forEach((vector, i) => index.add(i + 1, i + 1, { landmarks: vector }));
+
+    index.removeUser(7);
+    expect(index.getStats().templates).toBe(49);
+    expect(index.findDuplicates({ landmarks: vectors[6] }, { limit: 5 })
+      .some(match => match.userId === 7)).toBe(false);
+    // Removed nodes still route searches to their neighbours
+    expect(index.findDuplicates({ landmarks: vectors[8] }, { limit: 1 })[0].userId).toBe(9);
+  });
+
+  it('matches only the new template after replaceUser', () => {
+    const index = new FacemeshIndexService();
+    const vectors = Array.from({ length: 50 }, face);
+    vectors.forEach((vector, i) => index.add(i + 1, i + 1, { landmarks: vector }));
+
+    const replacement = face();
+    expect(index.replaceUser(100, 3, { landmarks: replacement })).toBe(true);
+    expect(index.getStats().templates).toBe(50);
+    expect(index.findDuplicates({ landmarks: vectors[2] }, { limit: 5 })
+      .some(match => match.biometricId === 3)).toBe(false);
+    const matches = index.findDuplicates({ landmarks: recapture(replacement) }, { limit: 1 });
+    expect(matches[0]).toEqual(expect.objectContaining({ userId: 3, biometricId: 100 }));
+  });
+
+  it('rejects templates of a different dimension', () => {
+    const index = new FacemeshIndexService();
+    index.add(1, 1, { landmarks: face() });
+    expect(index.add(2, 2, { landmarks: new Float32Array(30) })).toBe(false);
+  });
+});
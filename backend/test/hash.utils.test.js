@@ -0,0 +1,28 @@
+/**
+ * Tests for canonical and legacy hashing
+ */
+const crypto = require('crypto');
+const { generateCanonicalHash, generateLegacyHash, matchStoredHash } = require('../utils/hash.utils');
+
+const sha256 = value => crypto.createHash('sha256').update(value).digest('hex');
+
+describe('hash utils', () => {
+  const record = { title: 'Engineer', institution: 'DBIS', userId: 7 };
+
+  it('hashes canonical JSON with sorted keys', () => {
+    expect(generateCanonicalHash(record)).toBe(sha256('{"institution":"DBIS","title":"Engineer","userId":7}'));
+    expect(generateCanonicalHash({ userId: 7, title: 'Engineer', institution: 'DBIS' }))
+      .toBe(generateCanonicalHash(record));
+  });
+
+  it('hashes legacy JSON in insertion order', () => {
+    expect(generateLegacyHash(record)).toBe(sha256(JSON.stringify(record)));
+  });
+
+  it('matches stored hashes in either form', () => {
+    expect(matchStoredHash(record, generateCanonicalHash(record))).toBe('canonical');
+    expect(matchStoredHash(record, generateLegacyHash(record))).toBe('legacy');
+    expect(matchStoredHash(record, sha256('other'))).toBeNull();
+    expect(matchStoredHash(record, null)).toBeNull();
+  });
+});
@@ -0,0 +1,178 @@
+/**
+ * Tests for nonce allocation and broadcast error handling in the nonce manager
+ */
+const ethers = require('ethers');
+const { NonceManager, classifyBroadcastError, bumpFees } = require('../services/nonce-manager.service');
+
+const withCode = (code, message = code) => Object.assign(new Error(message), { code });
+
+// Stand-in for signed bytes; hex so it hashes like a real raw transaction
+const raw = (nonce, gasPrice = 100) => `0x${Buffer.from(`${nonce}:${gasPrice}`).toString('hex')}`;
+
+// Wallet and provider stub: records every broadcast
+const createWallet = ({ pendingCount = 7, sendTransaction } = {}) => {
+  const provider = {
+    sent: [],
+    sendTransaction: jest.fn(async (raw) => {
+      provider.sent.push(raw);
+      if (sendTransaction) await sendTransaction(raw, provider.sent.length);
+      return { hash: ethers.utils.keccak256(raw) };
+    }),
+    getTransactionReceipt: jest.fn(async () => null),
+    getTransactionCount: jest.fn(async () => 0)
+  };
+  return {
+    address: '0x00000000000000000000000000000000000000aa',
+    provider,
+    getTransactionCount: jest.fn(async () => pendingCount),
+    populateTransaction: jest.fn(async (request) => ({ ...request, gasPrice: 100, gasLimit: 21000 })),
+    signTransaction: jest.fn(async (transaction) => raw(transaction.nonce, String(transaction.gasPrice)))
+  };
+};
+
+describe('classifyBroadcastError', () => {
+  it('recognizes a transaction the node already has', () => {
+    expect(classifyBroadcastError(new Error('already known'))).toBe('ALREADY_KNOWN');
+    expect(classifyBroadcastError({ body: '{"error":{"message":"known transaction: 0xab"}}' })).toBe('ALREADY_KNOWN');
+  });
+
+  it('recognizes a nonce used by another transaction', () => {
+    expect(classifyBroadcastError(withCode('NONCE_EXPIRED'))).toBe('NONCE_EXPIRED');
+    expect(classifyBroadcastError(new Error('nonce too low'))).toBe('NONCE_EXPIRED');
+    expect(classifyBroadcastError(withCode('REPLACEMENT_UNDERPRICED'))).toBe('NONCE_EXPIRED');
+  });
+
+  it('recognizes transactions the node refused', () => {
+    expect(classifyBroadcastError(withCode('INSUFFICIENT_FUNDS'))).toBe('REJECTED');
+    expect(classifyBroadcastError(new Error('intrinsic gas too low'))).toBe('REJECTED');
+    expect(classifyBroadcastError({ code: 'SERVER_ERROR', body: '{"jsonrpc":"2.0","id":1,"error":{"code":-32000,"message":"rejected"}}' }))
+      .toBe('REJECTED');
+  });
+
+  it('treats unanswered broadcasts as ambiguous', () => {
+    expect(classifyBroadcastError(withCode('TIMEOUT', 'timeout'))).toBe('OTHER');
+    expect(classifyBroadcastError(withCode('SERVER_ERROR', 'missing response'))).toBe('OTHER');
+    expect(classifyBroadcastError(withCode('NETWORK_ERROR', 'socket hang up'))).toBe('OTHER');
+  });
+});
+
+describe('bumpFees', () => {
+  it('raises a legacy gas price by the given percentage', () => {
+    const transaction = { nonce: 3, gasPrice: 100 };
+    const bumped = bumpFees(transaction, 20);
+    expect(bumped.gasPrice.toString()).toBe('121');
+    expect(bumped.nonce).toBe(3);
+    expect(transaction.gasPrice).toBe(100);
+  });
+
+  it('raises both EIP-1559 fee fields', () => {
+    const bumped = bumpFees({ maxFeePerGas: 1000, maxPriorityFeePerGas: 10 }, 10);
+    expect(bumped.maxFeePerGas.toString()).toBe('1101');
+    expect(bumped.maxPriorityFeePerGas.toString()).toBe('12');
+    expect(bumped.gasPrice).toBe(undefined);
+  });
+});
+
+describe('NonceManager.send', () => {
+  it('assigns consecutive nonces from the pending count', async () => {
+    const wallet = createWallet();
+    const manager = new NonceManager(wallet);
+
+    const first = await manager.send({ to: '0x01' });
+    const second = await manager.send({ to: '0x02' });
+
+    expect(first.nonce).toBe(7);
+    expect(second.nonce).toBe(8);
+    expect(wallet.getTransactionCount).toHaveBeenCalledTimes(1);
+  });
+
+  it('gives the nonce back when signing fails', async () => {
+    const wallet = createWallet();
+    wallet.signTransaction.mockImplementation(async () => {
+      throw new Error('bad key');
+    });
+    const manager = new NonceManager(wallet);
+
+    await expect(manager.send({ to: '0x01' })).rejects.toThrow('bad key');
+    expect(wallet.provider.sendTransaction).not.toHaveBeenCalled();
+
+    wallet.signTransaction.mockImplementation(async (transaction) => raw(transaction.nonce));
+    expect((await manager.send({ to: '0x01' })).nonce).toBe(7);
+  });
+
+  it('gives the nonce back when the node refuses the transaction', async () => {
+    const wallet = createWallet({
+      sendTransaction: async (raw, count) => {
+        if (count === 1) throw withCode('INSUFFICIENT_FUNDS', 'insufficient funds for gas * price + value');
+      }
+    });
+    const manager = new NonceManager(wallet);
+
+    await expect(manager.send({ to: '0x01' })).rejects.toThrow('insufficient funds');
+    expect(manager.inFlight.size).toBe(0);
+    expect((await manager.send({ to: '0x01' })).nonce).toBe(7);
+  });
+
+  it('keeps the nonce and tracks the hash when a broadcast gets no answer', async () => {
+    const wallet = createWallet({
+      sendTransaction: async (raw, count) => {
+        if (count === 1) throw withCode('TIMEOUT', 'timeout');
+      }
+    });
+    const manager = new NonceManager(wallet);
+
+    const pending = await manager.send({ to: '0x01' });
+    expect(pending.nonce).toBe(7);
+    expect(pending.hashes).toEqual([ethers.utils.keccak256(raw(7))]);
+
+    // The next transfer must not reuse a nonce that may already be on its way
+    expect((await manager.send({ to: '0x02' })).nonce).toBe(8);
+  });
+
+  it('settles an unanswered broadcast through wait()', async () => {
+    const wallet = createWallet({
+      sendTransaction: async () => {
+        throw withCode('SERVER_ERROR', 'missing response');
+      }
+    });
+    const manager = new NonceManager(wallet, { pollInterval: 1 });
+    const pending = await manager.send({ to: '0x01' });
+
+    wallet.provider.getTransactionReceipt.mockImplementation(async (hash) => (
+      hash === pending.hash ? { transactionHash: hash, blockNumber: 12, confirmations: 1 } : null
+    ));
+
+    const receipt = await pending.wait();
+    expect(receipt.transactionHash).toBe(pending.hash);
+    expect(manager.inFlight.size).toBe(0);
+  });
+
+  it('resyncs from the chain once when the local nonce is behind', async () => {
+    const wallet = createWallet({
+      sendTransaction: async (raw, count) => {
+        if (count === 1) throw new Error('nonce too low');
+      }
+    });
+    const manager = new NonceManager(wallet);
+    wallet.getTransactionCount.mockImplementation(async () => (wallet.getTransactionCount.mock.calls.length === 1 ? 7 : 9));
+
+    const pending = await manager.send({ to: '0x01' });
+
+    expect(pending.nonce).toBe(9);
+    expect(wallet.getTransactionCount).toHaveBeenCalledTimes(2);
+    expect(wallet.provider.sent).toEqual([raw(7), raw(9)]);
+  });
+
+  it('fails after a second stale nonce and resyncs on the next send', async () => {
+    const wallet = createWallet({
+      sendTransaction: async (raw, count) => {
+        if (count <= 2) throw withCode('NONCE_EXPIRED', 'nonce has already been used');
+      }
+    });
+    const manager = new NonceManager(wallet);
+
+    await expect(manager.send({ to: '0x01' })).rejects.toThrow('nonce has already been used');
+    await manager.send({ to: '0x01' });
+    expect(wallet.getTransactionCount).toHaveBeenCalledTimes(3);
+  });
+});
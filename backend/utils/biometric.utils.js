@@ -2,10 +2,48 @@
  * Biometric utilities for DBIS
  * Handles facemesh data processing and verification
  */
-const crypto = require('crypto');
+const { generateCanonicalHash, matchStoredHash } = require('./hash.utils');
+const { registry } = require('./metrics.utils');
+const { logger } = require('./logger.utils');
+
+// Optional native SIMD kernel (native/facemesh); the JS path below is used when it is not built
+let nativeKernel = null;
+if (process.env.BIOMETRIC_NATIVE !== 'false') {
+  try {
+    nativeKernel = require('../native/facemesh');
+  } catch (error) {
+    nativeKernel = null;
+  }
+}
+
+const KERNEL = nativeKernel ? 'native' : 'js';
+
+// 1:1 comparisons take microseconds; 1:N searches grow with the enrolled population
+const compareDuration = registry.histogram(
+  'dbis_biometric_compare_duration_seconds',
+  'Biometric comparison time by operation (verify, search) and distance kernel',
+  ['operation', 'kernel'],
+  [0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5]
+);
+
+/**
+ * Run a comparison and record how long it took
+ * @param {String} operation - verify (1:1) or search (1:N)
+ * @param {Function} fn - Synchronous comparison
+ * @returns {*} fn's result
+ */
+const timeComparison = (operation, fn) => {
+  const end = compareDuration.startTimer({ operation, kernel: KERNEL });
+  try {
+    return fn();
+  } finally {
+    end();
+  }
+};
 
 /**
  * Generate SHA-256 hash for facemesh data
+ * Keys are hashed in sorted order, so property order does not change the hash
  * @param {Object} facemeshData - Facemesh data object
  * @returns {String} SHA-256 hash
  */
@@ -15,54 +53,108 @@ const generateFacemeshHash = (facemeshData) => {
     throw new Error('Facemesh data must be a valid object');
   }
 
-  // Sort keys to ensure consistent hashing regardless of property order
-  const normalizedData = normalizeObject(facemeshData);
-  
-  // Convert facemesh data to a consistent string format
-  const facemeshString = JSON.stringify(normalizedData);
-  
-  // Generate SHA-256 hash
-  return crypto.createHash('sha256').update(facemeshString).digest('hex');
-};
-
-/**
- * Normalize an object by sorting keys recursively
- * @param {Object} obj - Object to normalize
- * @returns {Object} Normalized object with sorted keys
- */
-const normalizeObject = (obj) => {
-  if (typeof obj !== 'object' || obj === null) {
-    return obj;
-  }
-
-  if (Array.isArray(obj)) {
-    return obj.map(normalizeObject);
-  }
-
-  return Object.keys(obj)
-    .sort()
-    .reduce((result, key) => {
-      result[key] = normalizeObject(obj[key]);
-      return result;
-    }, {});
+  return generateCanonicalHash(facemeshData);
 };
 
 /**
  * Verify facemesh data against a stored hash
+ * Accepts the canonical hash and the legacy unsorted-JSON hash of older enrollments
  * @param {Object} facemeshData - Facemesh data to verify
  * @param {String} storedHash - Stored hash to compare against
  * @returns {Boolean} True if the hash matches
  */
 const verifyFacemeshHash = (facemeshData, storedHash) => {
   try {
-    const generatedHash = generateFacemeshHash(facemeshData);
-    return generatedHash === storedHash;
+    if (typeof facemeshData !== 'object' || facemeshData === null) {
+      throw new Error('Facemesh data must be a valid object');
+    }
+    return matchStoredHash(facemeshData, storedHash) !== null;
   } catch (error) {
-    console.error('Facemesh verification error:', error);
+    logger.error('Facemesh verification error:', error);
     return false;
   }
 };
 
+/**
+ * Pack an array of {x, y, z} landmarks into a structure-of-arrays Float32Array
+ * laid out as [x0..xn-1, y0..yn-1, z0..zn-1]
+ * @param {Array} landmarks - Landmark objects
+ * @param {Float32Array} out - Optional buffer of length 3n to pack into
+ * @returns {Float32Array|null} Packed buffer, or null if any point is incomplete
+ */
+const packLandmarks = (landmarks, out) => {
+  const count = landmarks.length;
+  const packed = out || new Float32Array(count * 3);
+
+  for (let i = 0; i < count; i++) {
+    const point = landmarks[i];
+    if (!point || point.x === undefined || point.y === undefined || point.z === undefined) {
+      return null;
+    }
+
+    packed[i] = point.x;
+    packed[count + i] = point.y;
+    packed[2 * count + i] = point.z;
+  }
+
+  return packed;
+};
+
+/**
+ * Mean Euclidean distance between two packed landmark buffers (JS fallback)
+ * @param {Float32Array} packed1 - First packed buffer
+ * @param {Float32Array} packed2 - Second packed buffer
+ * @returns {Number} Mean distance
+ */
+const meanPackedDistance = (packed1, packed2) => {
+  const count = packed1.length / 3;
+  let totalDistance = 0;
+
+  for (let i = 0; i < count; i++) {
+    const dx = packed1[i] - packed2[i];
+    const dy = packed1[count + i] - packed2[count + i];
+    const dz = packed1[2 * count + i] - packed2[2 * count + i];
+    totalDistance += Math.sqrt(dx * dx + dy * dy + dz * dz);
+  }
+
+  return totalDistance / count;
+};
+
+// Per-size buffer pairs for packing object landmarks before a native comparison.
+// Comparisons are synchronous, so one pair per size is never used twice at once;
+// the size cap keeps odd-sized requests from growing the cache
+const MAX_SCRATCH_SIZES = 4;
+const scratchBuffers = new Map();
+
+const scratchFor = (length) => {
+  let pair = scratchBuffers.get(length);
+  if (!pair) {
+    pair = [new Float32Array(length), new Float32Array(length)];
+    if (scratchBuffers.size < MAX_SCRATCH_SIZES) {
+      scratchBuffers.set(length, pair);
+    }
+  }
+  return pair;
+};
+
+/**
+ * Calculate similarity between two packed landmark buffers
+ * @param {Float32Array} packed1 - First packed buffer
+ * @param {Float32Array} packed2 - Second packed buffer
+ * @returns {Number} Similarity score between 0 and 1
+ */
+const calculatePackedSimilarity = (packed1, packed2) => {
+  if (packed1.length !== packed2.length || packed1.length === 0 || packed1.length % 3 !== 0) {
+    return 0;
+  }
+
+  const avgDistance = nativeKernel
+    ? nativeKernel.meanDistance(packed1, packed2)
+    : meanPackedDistance(packed1, packed2);
+
+  return Math.exp(-avgDistance);
+};
+
 /**
  * Calculate similarity between two facemesh data objects
  * This is a simplified implementation for demonstration purposes
@@ -76,18 +168,33 @@ const calculateFacemeshSimilarity = (facemeshData1, facemeshData2) => {
   // In a real system, you would use a proper biometric comparison algorithm
   
   // For demonstration, we'll just compare a few key points
-  // Assuming facemeshData has a 'landmarks' array with facial landmark coordinates
+  // Assuming facemeshData has a 'landmarks' array with facial landmark coordinates,
+  // or a packed Float32Array as produced by packLandmarks()
   if (!facemeshData1.landmarks || !facemeshData2.landmarks) {
     return 0;
   }
   
   const landmarks1 = facemeshData1.landmarks;
   const landmarks2 = facemeshData2.landmarks;
+
+  if (landmarks1 instanceof Float32Array && landmarks2 instanceof Float32Array) {
+    return calculatePackedSimilarity(landmarks1, landmarks2);
+  }
   
   // Ensure both have the same number of landmarks
   if (landmarks1.length !== landmarks2.length) {
     return 0;
   }
+
+  // Hand complete landmark sets to the native kernel
+  if (nativeKernel && landmarks1.length > 0) {
+    const [scratch1, scratch2] = scratchFor(landmarks1.length * 3);
+    const packed1 = packLandmarks(landmarks1, scratch1);
+    const packed2 = packed1 && packLandmarks(landmarks2, scratch2);
+    if (packed1 && packed2) {
+      return calculatePackedSimilarity(packed1, packed2);
+    }
+  }
   
   // Calculate Euclidean distance between corresponding landmarks
   let totalDistance = 0;
@@ -98,13 +205,11 @@ const calculateFacemeshSimilarity = (facemeshData1, facemeshData2) => {
     const point2 = landmarks2[i];
     
     if (point1 && point2 && point1.x !== undefined && point1.y !== undefined && point1.z !== undefined) {
-      const distance = Math.sqrt(
-        Math.pow(point1.x - point2.x, 2) +
-        Math.pow(point1.y - point2.y, 2) +
-        Math.pow(point1.z - point2.z, 2)
-      );
+      const dx = point1.x - point2.x;
+      const dy = point1.y - point2.y;
+      const dz = point1.z - point2.z;
       
-      totalDistance += distance;
+      totalDistance += Math.sqrt(dx * dx + dy * dy + dz * dz);
       pointCount++;
     }
   }
@@ -140,5 +245,8 @@ module.exports = {
   generateFacemeshHash,
   verifyFacemeshHash,
   calculateFacemeshSimilarity,
-  isFacemeshSimilar
+  isFacemeshSimilar,
+  packLandmarks,
+  timeComparison,
+  KERNEL
 };
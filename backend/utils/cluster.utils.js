@@ -0,0 +1,215 @@
+/**
+ * Cluster utilities for DBIS
+ * In cluster mode (cluster.js) every HTTP worker keeps its own in-process
+ * state: the local cache tier and the facemesh index. Workers publish changes
+ * to that state with broadcast(); the primary relays each message to every
+ * other worker, where onBroadcast handlers apply it.
+ *
+ * gather() is the request/response counterpart: a worker asks the primary to
+ * collect a value from every worker (onGather handlers) and gets them all back.
+ * The /metrics endpoint uses it so any worker can answer for the whole host.
+ *
+ * Outside cluster mode broadcast() is a no-op, so callers need no checks.
+ * This only reaches workers on the same host; state shared across hosts
+ * lives in Postgres or Redis.
+ */
+
+const cluster = require('cluster');
+const { logger } = require('./logger.utils');
+
+const MESSAGE_TYPE = 'dbis:broadcast';
+// gather(): worker -> primary, primary -> each worker, each worker -> primary, primary -> worker
+const GATHER_TYPE = 'dbis:gather';
+const COLLECT_TYPE = 'dbis:collect';
+const COLLECTED_TYPE = 'dbis:collected';
+const GATHERED_TYPE = 'dbis:gathered';
+
+const DEFAULT_GATHER_TIMEOUT_MS = 2000;
+
+const handlers = new Map();
+const collectors = new Map();
+const pendingGathers = new Map();
+let nextGatherId = 1;
+let listening = false;
+
+const isPrimary = () => (cluster.isPrimary !== undefined ? cluster.isPrimary : cluster.isMaster);
+
+const collect = async (message) => {
+  const collector = collectors.get(message.channel);
+  let payload = null;
+  let error = null;
+  try {
+    payload = collector ? await collector() : null;
+  } catch (err) {
+    error = err.message;
+  }
+  if (process.connected) {
+    process.send({ type: COLLECTED_TYPE, id: message.id, payload, error });
+  }
+};
+
+const dispatch = (message) => {
+  if (!message) return;
+  if (message.type === COLLECT_TYPE) {
+    collect(message);
+    return;
+  }
+  if (message.type === GATHERED_TYPE) {
+    const pending = pendingGathers.get(message.id);
+    if (pending) {
+      pendingGathers.delete(message.id);
+      pending(message.results);
+    }
+    return;
+  }
+  if (message.type !== MESSAGE_TYPE) return;
+  for (const handler of handlers.get(message.channel) || []) {
+    try {
+      handler(message.payload);
+    } catch (error) {
+      logger.error(`Cluster broadcast handler error (${message.channel}):`, error.message);
+    }
+  }
+};
+
+/**
+ * Send a message to every other worker of this cluster
+ * @param {String} channel - Channel name
+ * @param {*} payload - Payload; structured-clone serializable (see cluster.js)
+ */
+const broadcast = (channel, payload) => {
+  if (!cluster.isWorker || !process.connected) return;
+  process.send({ type: MESSAGE_TYPE, channel, payload }, (error) => {
+    if (error) {
+      logger.error(`Cluster broadcast failed (${channel}):`, error.message);
+    }
+  });
+};
+
+/**
+ * Handle messages broadcast by other workers
+ * @param {String} channel - Channel name
+ * @param {Function} handler - Called with the payload
+ */
+const onBroadcast = (channel, handler) => {
+  if (!handlers.has(channel)) {
+    handlers.set(channel, []);
+  }
+  handlers.get(channel).push(handler);
+  listen();
+};
+
+const listen = () => {
+  if (!listening && cluster.isWorker) {
+    listening = true;
+    process.on('message', dispatch);
+  }
+};
+
+/**
+ * Answer gather() requests on a channel with this worker's value
+ * @param {String} channel - Channel name
+ * @param {Function} collector - Returns the value (or a promise of it)
+ */
+const onGather = (channel, collector) => {
+  collectors.set(channel, collector);
+  listen();
+};
+
+/**
+ * Collect a channel's value from every worker of this cluster, this one included
+ * Workers that do not answer within the timeout are left out.
+ * @param {String} channel - Channel name
+ * @param {Number} timeoutMs - How long the primary waits for each worker
+ * @returns {Promise<Array|null>} [{ worker, pid, payload }], or null outside cluster mode
+ */
+const gather = (channel, timeoutMs = DEFAULT_GATHER_TIMEOUT_MS) => {
+  if (!cluster.isWorker || !process.connected) return Promise.resolve(null);
+  listen();
+  const id = `${process.pid}:${nextGatherId++}`;
+  return new Promise((resolve) => {
+    // The primary answers within its own timeout; this one only covers a lost primary
+    const timer = setTimeout(() => {
+      pendingGathers.delete(id);
+      resolve(null);
+    }, timeoutMs * 2);
+    pendingGathers.set(id, (results) => {
+      clearTimeout(timer);
+      resolve(results);
+    });
+    process.send({ type: GATHER_TYPE, id, channel, timeoutMs }, (error) => {
+      if (error) {
+        logger.error(`Cluster gather failed (${channel}):`, error.message);
+      }
+    });
+  });
+};
+
+// Primary side of gather(): ask every worker, reply to the requester once all have answered
+const relayGather = (requester, message) => {
+  const workers = Object.values(cluster.workers).filter(worker => worker && worker.isConnected());
+  const results = [];
+  let remaining = workers.length;
+  let timer = null;
+  let finished = false;
+
+  const finish = () => {
+    if (finished) return;
+    finished = true;
+    clearTimeout(timer);
+    if (requester.isConnected()) {
+      requester.send({ type: GATHERED_TYPE, id: message.id, results });
+    }
+  };
+
+  for (const worker of workers) {
+    const collectId = `${message.id}:${worker.id}`;
+    const onMessage = (reply) => {
+      if (!reply || reply.type !== COLLECTED_TYPE || reply.id !== collectId) return;
+      worker.off('message', onMessage);
+      if (reply.error) {
+        logger.error(`Worker ${worker.process.pid} failed to collect ${message.channel}:`, reply.error);
+      } else {
+        results.push({ worker: worker.id, pid: worker.process.pid, payload: reply.payload });
+      }
+      if (--remaining === 0) finish();
+    };
+    worker.on('message', onMessage);
+    worker.send({ type: COLLECT_TYPE, id: collectId, channel: message.channel });
+    // Drop the listener if this worker never answers
+    setTimeout(() => worker.off('message', onMessage), message.timeoutMs).unref();
+  }
+
+  if (remaining === 0) {
+    finish();
+  } else {
+    timer = setTimeout(finish, message.timeoutMs);
+  }
+};
+
+/**
+ * Relay worker broadcasts and gather requests; call once in the primary
+ */
+const relayBroadcasts = () => {
+  cluster.on('message', (sender, message) => {
+    if (message && message.type === GATHER_TYPE) {
+      relayGather(sender, message);
+      return;
+    }
+    if (!message || message.type !== MESSAGE_TYPE) return;
+    for (const worker of Object.values(cluster.workers)) {
+      if (worker && worker !== sender && worker.isConnected()) {
+        worker.send(message);
+      }
+    }
+  });
+};
+
+module.exports = {
+  isPrimary,
+  broadcast,
+  onBroadcast,
+  gather,
+  onGather,
+  relayBroadcasts
+};
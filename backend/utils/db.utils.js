@@ -1,38 +1,12 @@
 /**
  * Database utilities for DBIS
- * Handles database operations and connection pooling
+ * Query helpers over the shared DatabaseService pool (services/db.service.js),
+ * so models and scripts using these helpers do not open a second pool
  */
-const { Pool } = require('pg');
 const fs = require('fs');
 const path = require('path');
-
-// Create a singleton database connection pool
-let pool;
-
-/**
- * Initialize the database connection pool
- * @returns {Object} Database pool instance
- */
-const initPool = () => {
-  if (!pool) {
-    pool = new Pool({
-      user: process.env.DB_USER || 'postgres',
-      host: process.env.DB_HOST || 'localhost',
-      database: process.env.DB_NAME || 'dbis',
-      password: process.env.DB_PASSWORD || 'postgres',
-      port: process.env.DB_PORT || 5432,
-      ssl: process.env.DB_SSL === 'true' ? { rejectUnauthorized: false } : false
-    });
-    
-    // Handle pool errors
-    pool.on('error', (err) => {
-      console.error('Unexpected error on idle client', err);
-      process.exit(-1);
-    });
-  }
-  
-  return pool;
-};
+const dbService = require('../services/db.service');
+const { logger } = require('./logger.utils');
 
 /**
  * Execute a database query with parameters
@@ -41,8 +15,7 @@ const initPool = () => {
  * @returns {Promise} Query result
  */
 const query = async (text, params) => {
-  const pool = initPool();
-  return pool.query(text, params);
+  return dbService.query(text, params);
 };
 
 /**
@@ -50,8 +23,7 @@ const query = async (text, params) => {
  * @returns {Object} Database client
  */
 const getClient = async () => {
-  const pool = initPool();
-  return pool.connect();
+  return dbService.connect();
 };
 
 /**
@@ -63,15 +35,15 @@ const initSchema = async () => {
     const schemaPath = path.resolve(__dirname, '..', 'config', 'database.sql');
     const schema = fs.readFileSync(schemaPath, 'utf8');
     
-    console.log('Initializing database schema...');
+    logger.info('Initializing database schema...');
     
     // Execute the schema SQL
     await query(schema);
     
-    console.log('Database schema initialized successfully');
+    logger.info('Database schema initialized successfully');
     return true;
   } catch (error) {
-    console.error('Error initializing database schema:', error);
+    logger.error('Error initializing database schema:', error);
     return false;
   }
 };
@@ -85,7 +57,7 @@ const checkDatabase = async () => {
     const result = await query('SELECT NOW()');
     return result.rows.length > 0;
   } catch (error) {
-    console.error('Database check error:', error);
+    logger.error('Database check error:', error);
     return false;
   }
 };
@@ -0,0 +1,250 @@
+/**
+ * Facemesh template utilities for DBIS
+ * Versioned binary encoding of facemesh landmarks, stored in biometric_data.facemesh_template
+ *
+ * Layout (little-endian):
+ *   0  2 bytes  magic "FM"
+ *   2  uint8    format version (1)
+ *   3  uint8    coordinate encoding (1 = int16 quantized, 2 = float16)
+ *   4  uint16   landmark count n
+ *   6  uint16   reserved (0)
+ *   8  int16 only: float32 min x/y/z, float32 step x/y/z (24 bytes)
+ *   .. payload: n x-values, n y-values, n z-values (2 bytes each)
+ */
+const crypto = require('crypto');
+const { packLandmarks } = require('./biometric.utils');
+
+const TEMPLATE_MAGIC = 0x4d46; // "FM" read as uint16 LE
+const TEMPLATE_VERSION = 1;
+const ENCODING_INT16 = 1;
+const ENCODING_FLOAT16 = 2;
+const HEADER_SIZE = 8;
+const QUANTIZATION_SIZE = 24;
+const MAX_LANDMARKS = 0xffff;
+
+const float32Scratch = new Float32Array(1);
+const uint32Scratch = new Uint32Array(float32Scratch.buffer);
+
+/**
+ * Convert a number to IEEE 754 half-precision bits (round to nearest even)
+ * @param {Number} value - Value to convert
+ * @returns {Number} 16-bit half-float bit pattern
+ */
+const toFloat16Bits = (value) => {
+  float32Scratch[0] = value;
+  const bits = uint32Scratch[0];
+  const sign = (bits >>> 16) & 0x8000;
+  const exponent = (bits >>> 23) & 0xff;
+  let mantissa = bits & 0x7fffff;
+
+  if (exponent === 0xff) {
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+  }
+
+  const halfExponent = exponent - 127 + 15;
+  if (halfExponent >= 0x1f) {
+    return sign | 0x7c00;
+  }
+
+  if (halfExponent <= 0) {
+    if (halfExponent < -10) {
+      return sign;
+    }
+    mantissa |= 0x800000;
+    const shift = 14 - halfExponent;
+    const half = mantissa >>> shift;
+    const remainder = mantissa & ((1 << shift) - 1);
+    const halfway = 1 << (shift - 1);
+    return sign | (half + (remainder > halfway || (remainder === halfway && (half & 1)) ? 1 : 0));
+  }
+
+  const half = (halfExponent << 10) | (mantissa >>> 13);
+  const remainder = mantissa & 0x1fff;
+  return sign | (half + (remainder > 0x1000 || (remainder === 0x1000 && (half & 1)) ? 1 : 0));
+};
+
+/**
+ * Convert IEEE 754 half-precision bits to a number
+ * @param {Number} bits - 16-bit half-float bit pattern
+ * @returns {Number} Decoded value
+ */
+const fromFloat16Bits = (bits) => {
+  const sign = bits & 0x8000 ? -1 : 1;
+  const exponent = (bits >>> 10) & 0x1f;
+  const mantissa = bits & 0x3ff;
+
+  if (exponent === 0) {
+    return sign * mantissa * Math.pow(2, -24);
+  }
+  if (exponent === 0x1f) {
+    return mantissa ? NaN : sign * Infinity;
+  }
+  return sign * (1 + mantissa / 1024) * Math.pow(2, exponent - 15);
+};
+
+/**
+ * Encode landmarks into a binary facemesh template
+ * @param {Array|Float32Array} landmarks - {x, y, z} landmarks or a packed buffer
+ * @param {Object} options - encoding (ENCODING_INT16 or ENCODING_FLOAT16)
+ * @returns {Buffer} Encoded template
+ */
+const encodeFacemeshTemplate = (landmarks, options = {}) => {
+  const { encoding = ENCODING_INT16 } = options;
+  const packed = landmarks instanceof Float32Array ? landmarks : packLandmarks(landmarks || []);
+
+  if (!packed || packed.length === 0 || packed.length % 3 !== 0) {
+    throw new Error('Facemesh landmarks must be a non-empty list of {x, y, z} points');
+  }
+
+  const count = packed.length / 3;
+  if (count > MAX_LANDMARKS) {
+    throw new Error(`Facemesh templates support at most ${MAX_LANDMARKS} landmarks`);
+  }
+  if (encoding !== ENCODING_INT16 && encoding !== ENCODING_FLOAT16) {
+    throw new Error(`Unsupported facemesh template encoding: ${encoding}`);
+  }
+
+  const quantizationSize = encoding === ENCODING_INT16 ? QUANTIZATION_SIZE : 0;
+  const buffer = Buffer.alloc(HEADER_SIZE + quantizationSize + packed.length * 2);
+
+  buffer.writeUInt16LE(TEMPLATE_MAGIC, 0);
+  buffer.writeUInt8(TEMPLATE_VERSION, 2);
+  buffer.writeUInt8(encoding, 3);
+  buffer.writeUInt16LE(count, 4);
+  buffer.writeUInt16LE(0, 6);
+
+  let offset = HEADER_SIZE + quantizationSize;
+
+  if (encoding === ENCODING_FLOAT16) {
+    for (let i = 0; i < packed.length; i++, offset += 2) {
+      buffer.writeUInt16LE(toFloat16Bits(packed[i]), offset);
+    }
+    return buffer;
+  }
+
+  // Quantize each axis independently over its own [min, max] range
+  for (let axis = 0; axis < 3; axis++) {
+    const start = axis * count;
+    let min = Infinity;
+    let max = -Infinity;
+    for (let i = start; i < start + count; i++) {
+      if (packed[i] < min) min = packed[i];
+      if (packed[i] > max) max = packed[i];
+    }
+
+    if (!Number.isFinite(min) || !Number.isFinite(max)) {
+      throw new Error('Facemesh landmarks must be finite numbers');
+    }
+
+    const step = max > min ? (max - min) / 0xffff : 1;
+    buffer.writeFloatLE(min, HEADER_SIZE + axis * 4);
+    buffer.writeFloatLE(step, HEADER_SIZE + 12 + axis * 4);
+
+    for (let i = start; i < start + count; i++, offset += 2) {
+      buffer.writeInt16LE(Math.round((packed[i] - min) / step) - 0x8000, offset);
+    }
+  }
+
+  return buffer;
+};
+
+/**
+ * Check whether a buffer starts with a facemesh template header
+ * @param {Buffer} buffer - Candidate buffer
+ * @returns {Boolean} True if the buffer looks like a template
+ */
+const isFacemeshTemplate = (buffer) => {
+  return Buffer.isBuffer(buffer) &&
+    buffer.length >= HEADER_SIZE &&
+    buffer.readUInt16LE(0) === TEMPLATE_MAGIC;
+};
+
+/**
+ * Decode a binary facemesh template into packed landmarks
+ * @param {Buffer} buffer - Encoded template
+ * @returns {Float32Array} Packed [x0..xn-1, y0..yn-1, z0..zn-1] landmarks
+ */
+const decodeFacemeshTemplate = (buffer) => {
+  if (!isFacemeshTemplate(buffer)) {
+    throw new Error('Invalid facemesh template');
+  }
+
+  const version = buffer.readUInt8(2);
+  const encoding = buffer.readUInt8(3);
+  const count = buffer.readUInt16LE(4);
+
+  if (version !== TEMPLATE_VERSION) {
+    throw new Error(`Unsupported facemesh template version: ${version}`);
+  }
+
+  const quantizationSize = encoding === ENCODING_INT16 ? QUANTIZATION_SIZE : 0;
+  if ((encoding !== ENCODING_INT16 && encoding !== ENCODING_FLOAT16) ||
+      buffer.length !== HEADER_SIZE + quantizationSize + count * 6) {
+    throw new Error('Invalid facemesh template');
+  }
+
+  const packed = new Float32Array(count * 3);
+  let offset = HEADER_SIZE + quantizationSize;
+
+  if (encoding === ENCODING_FLOAT16) {
+    for (let i = 0; i < packed.length; i++, offset += 2) {
+      packed[i] = fromFloat16Bits(buffer.readUInt16LE(offset));
+    }
+    return packed;
+  }
+
+  for (let axis = 0; axis < 3; axis++) {
+    const min = buffer.readFloatLE(HEADER_SIZE + axis * 4);
+    const step = buffer.readFloatLE(HEADER_SIZE + 12 + axis * 4);
+    const start = axis * count;
+    for (let i = start; i < start + count; i++, offset += 2) {
+      packed[i] = (buffer.readInt16LE(offset) + 0x8000) * step + min;
+    }
+  }
+
+  return packed;
+};
+
+/**
+ * Resolve the template for an enroll/verify request
+ * Accepts a base64 `facemeshTemplate` from the client, or encodes legacy JSON landmarks
+ * @param {Object} facemeshData - Legacy facemesh data with a landmarks array
+ * @param {String|Buffer} facemeshTemplate - Base64 or raw encoded template
+ * @returns {Buffer|null} Validated template, or null if no landmarks were supplied
+ */
+const resolveFacemeshTemplate = (facemeshData, facemeshTemplate) => {
+  if (facemeshTemplate) {
+    const buffer = Buffer.isBuffer(facemeshTemplate)
+      ? facemeshTemplate
+      : Buffer.from(String(facemeshTemplate), 'base64');
+    decodeFacemeshTemplate(buffer);
+    return buffer;
+  }
+
+  if (facemeshData && Array.isArray(facemeshData.landmarks) && facemeshData.landmarks.length > 0 &&
+      packLandmarks(facemeshData.landmarks)) {
+    return encodeFacemeshTemplate(facemeshData.landmarks);
+  }
+
+  return null;
+};
+
+/**
+ * Generate SHA-256 hash of an encoded template
+ * @param {Buffer} template - Encoded template
+ * @returns {String} SHA-256 hash
+ */
+const hashFacemeshTemplate = (template) => {
+  return crypto.createHash('sha256').update(template).digest('hex');
+};
+
+module.exports = {
+  TEMPLATE_VERSION,
+  ENCODING_INT16,
+  ENCODING_FLOAT16,
+  encodeFacemeshTemplate,
+  decodeFacemeshTemplate,
+  isFacemeshTemplate,
+  resolveFacemeshTemplate,
+  hashFacemeshTemplate
+};
@@ -0,0 +1,157 @@
+/**
+ * Hashing utilities for DBIS
+ * Canonical, streaming SHA-256 over JSON-compatible values
+ */
+const crypto = require('crypto');
+
+// Tokens are batched into chunks of this many characters before hashing
+const CHUNK_SIZE = 4096;
+
+/**
+ * Incrementally feeds canonical JSON tokens into a hash
+ * The byte stream is identical to JSON.stringify() of the value with every
+ * object's keys sorted, but no sorted copy or full string is ever built
+ */
+class CanonicalHasher {
+  constructor(algorithm = 'sha256') {
+    this.hash = crypto.createHash(algorithm);
+    this.chunk = '';
+    this.ancestors = new Set();
+  }
+
+  write(token) {
+    // Large tokens (long strings) go straight to the hash instead of being copied into the chunk
+    if (token.length >= CHUNK_SIZE) {
+      if (this.chunk.length > 0) {
+        this.hash.update(this.chunk);
+        this.chunk = '';
+      }
+      this.hash.update(token);
+      return;
+    }
+
+    this.chunk += token;
+    if (this.chunk.length >= CHUNK_SIZE) {
+      this.hash.update(this.chunk);
+      this.chunk = '';
+    }
+  }
+
+  /**
+   * Write a value; returns false for values JSON omits (undefined, functions, symbols)
+   */
+  writeValue(value) {
+    switch (typeof value) {
+      case 'string':
+        this.write(JSON.stringify(value));
+        return true;
+      case 'number':
+        this.write(Number.isFinite(value) ? String(value) : 'null');
+        return true;
+      case 'boolean':
+        this.write(value ? 'true' : 'false');
+        return true;
+      case 'bigint':
+        throw new TypeError('Cannot hash a BigInt value');
+      case 'object':
+        if (value === null) {
+          this.write('null');
+          return true;
+        }
+        this.writeContainer(value);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  writeContainer(value) {
+    if (this.ancestors.has(value)) {
+      throw new TypeError('Cannot hash a value with circular references');
+    }
+    this.ancestors.add(value);
+
+    if (Array.isArray(value)) {
+      this.write('[');
+      for (let i = 0; i < value.length; i++) {
+        if (i > 0) this.write(',');
+        if (!this.writeValue(value[i])) this.write('null');
+      }
+      this.write(']');
+    } else {
+      const keys = Object.keys(value).sort();
+      let first = true;
+      this.write('{');
+      for (const key of keys) {
+        const item = value[key];
+        if (item === undefined || typeof item === 'function' || typeof item === 'symbol') continue;
+        this.write(first ? JSON.stringify(key) + ':' : ',' + JSON.stringify(key) + ':');
+        this.writeValue(item);
+        first = false;
+      }
+      this.write('}');
+    }
+
+    this.ancestors.delete(value);
+  }
+
+  digest(encoding = 'hex') {
+    if (this.chunk.length > 0) {
+      this.hash.update(this.chunk);
+      this.chunk = '';
+    }
+    return this.hash.digest(encoding);
+  }
+}
+
+/**
+ * Generate a canonical SHA-256 hash of a JSON-compatible value
+ * Key order does not affect the result
+ * @param {*} value - Value to hash
+ * @returns {String} SHA-256 hash (hex)
+ */
+const generateCanonicalHash = (value) => {
+  const hasher = new CanonicalHasher();
+  if (!hasher.writeValue(value)) {
+    throw new TypeError('Value cannot be represented as JSON');
+  }
+  return hasher.digest('hex');
+};
+
+/**
+ * Generate a SHA-256 hash of JSON.stringify(value) in its own key order
+ * Hashes stored before canonical hashing (biometric_data.facemesh_hash and
+ * professional_records.data_hash from the controllers) used this form
+ * @param {*} value - Value to hash
+ * @returns {String} SHA-256 hash (hex)
+ */
+const generateLegacyHash = (value) => {
+  const json = JSON.stringify(value);
+  if (json === undefined) {
+    throw new TypeError('Value cannot be represented as JSON');
+  }
+  return crypto.createHash('sha256').update(json).digest('hex');
+};
+
+/**
+ * Check a value against a stored hash in canonical or legacy form
+ * @param {*} value - Value to check
+ * @param {String} storedHash - Stored hash (hex)
+ * @returns {String|null} 'canonical' or 'legacy' for the form that matched, null if neither did
+ */
+const matchStoredHash = (value, storedHash) => {
+  if (!storedHash) {
+    return null;
+  }
+  if (generateCanonicalHash(value) === storedHash) {
+    return 'canonical';
+  }
+  return generateLegacyHash(value) === storedHash ? 'legacy' : null;
+};
+
+module.exports = {
+  CanonicalHasher,
+  generateCanonicalHash,
+  generateLegacyHash,
+  matchStoredHash
+};
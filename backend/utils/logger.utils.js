@@ -1,53 +1,306 @@
 /**
  * Logging utilities for DBIS
- * Handles application logging using Winston
+ * Structured logging with one JSON object per line, written asynchronously.
+ *
+ * Log calls below LOG_LEVEL return before any formatting. Enabled calls are
+ * serialized to a line and appended to an in-memory buffer. The buffer is
+ * written to LOG_FILE (stdout by default) in LOG_BUFFER_BYTES chunks or every
+ * LOG_FLUSH_INTERVAL_MS, with one write in flight at a time, so the event
+ * loop never waits for the terminal or disk. If the destination falls behind
+ * by more than LOG_MAX_BUFFER_BYTES, new lines are dropped and counted instead
+ * of growing memory. The buffer is written synchronously on exit.
+ *
+ * Lines logged while a request is handled carry its reqId
+ * (middleware/request-logger.middleware.js), wherever the logger was called.
+ * LOG_FORMAT=pretty prints readable lines (the default on a terminal outside
+ * production).
+ *
+ * getStats() reports lines, drops and the time spent formatting, as a share
+ * of request time.
  */
-const winston = require('winston');
-const path = require('path');
 const fs = require('fs');
+const os = require('os');
+const { AsyncLocalStorage } = require('async_hooks');
 
-// Create logs directory if it doesn't exist
-const logsDir = path.join(process.cwd(), 'logs');
-if (!fs.existsSync(logsDir)) {
-  fs.mkdirSync(logsDir, { recursive: true });
+const LEVELS = { trace: 10, debug: 20, info: 30, warn: 40, error: 50, fatal: 60 };
+
+const LOG_LEVEL = LEVELS[process.env.LOG_LEVEL] ? process.env.LOG_LEVEL : 'info';
+const LOG_FORMAT = process.env.LOG_FORMAT ||
+  (process.stdout.isTTY && process.env.NODE_ENV !== 'production' ? 'pretty' : 'json');
+const BUFFER_BYTES = parseInt(process.env.LOG_BUFFER_BYTES || '4096', 10);
+const MAX_BUFFER_BYTES = parseInt(process.env.LOG_MAX_BUFFER_BYTES || String(4 * 1024 * 1024), 10);
+const FLUSH_INTERVAL_MS = parseInt(process.env.LOG_FLUSH_INTERVAL_MS || '100', 10);
+
+// Per-request fields (reqId) added to every line logged while the request is handled
+const requestContext = new AsyncLocalStorage();
+
+/**
+ * Buffered, non-blocking writer to a file descriptor
+ */
+class BufferedDestination {
+  constructor(options = {}) {
+    this.fd = options.fd !== undefined ? options.fd : 1;
+    this.minLength = options.minLength || BUFFER_BYTES;
+    this.maxLength = options.maxLength || MAX_BUFFER_BYTES;
+    this.flushInterval = options.flushInterval || FLUSH_INTERVAL_MS;
+    this.chunks = [];
+    this.length = 0;
+    this.writing = false;
+    this.timer = null;
+    this.stats = { written: 0, dropped: 0, writeErrors: 0 };
+
+    process.on('exit', () => this.flushSync());
+  }
+
+  /**
+   * Queue a line
+   * @param {String} line - Serialized line, newline included
+   * @returns {Boolean} False if it was dropped because the buffer is full
+   */
+  write(line) {
+    if (this.length + line.length > this.maxLength) {
+      this.stats.dropped++;
+      return false;
+    }
+    this.chunks.push(line);
+    this.length += line.length;
+
+    if (this.length >= this.minLength) {
+      this.flush();
+    } else if (!this.timer) {
+      this.timer = setTimeout(() => {
+        this.timer = null;
+        this.flush();
+      }, this.flushInterval);
+      this.timer.unref();
+    }
+    return true;
+  }
+
+  flush() {
+    if (this.writing || this.length === 0) return;
+    clearTimeout(this.timer);
+    this.timer = null;
+    const data = Buffer.from(this.chunks.join(''));
+    this.chunks = [];
+    this.length = 0;
+    this.writing = true;
+    this.writeBuffer(data);
+  }
+
+  writeBuffer(data) {
+    fs.write(this.fd, data, 0, data.length, null, (error, written) => {
+      if (error) {
+        // Non-blocking pipes report EAGAIN while full
+        if (error.code === 'EAGAIN') {
+          setTimeout(() => this.writeBuffer(data), 10).unref();
+          return;
+        }
+        this.stats.writeErrors++;
+      } else {
+        this.stats.written += written;
+        if (written < data.length) {
+          this.writeBuffer(data.subarray(written));
+          return;
+        }
+      }
+      this.writing = false;
+      if (this.length >= this.minLength) {
+        this.flush();
+      } else if (this.length > 0 && !this.timer) {
+        this.timer = setTimeout(() => {
+          this.timer = null;
+          this.flush();
+        }, this.flushInterval);
+        this.timer.unref();
+      }
+    });
+  }
+
+  /**
+   * Write the buffer before the process exits; a chunk already being written is left to finish
+   */
+  flushSync() {
+    if (this.length === 0) return;
+    clearTimeout(this.timer);
+    this.timer = null;
+    const data = this.chunks.join('');
+    this.chunks = [];
+    this.length = 0;
+    try {
+      fs.writeSync(this.fd, data);
+      this.stats.written += Buffer.byteLength(data);
+    } catch (error) {
+      this.stats.writeErrors++;
+    }
+  }
+}
+
+const serializeError = (error) => {
+  const serialized = { type: error.name, message: error.message, stack: error.stack };
+  if (error.code !== undefined) {
+    serialized.code = error.code;
+  }
+  return serialized;
+};
+
+const stringify = (value) => {
+  try {
+    return JSON.stringify(value, (key, nested) => (nested instanceof Error ? serializeError(nested) : nested));
+  } catch (error) {
+    return '"[Unserializable]"';
+  }
+};
+
+// Fields written as ',"key":value' fragments, so bindings are serialized once per child
+const fieldsFragment = (fields) => Object.keys(fields)
+  .filter(key => fields[key] !== undefined)
+  .map(key => `,${JSON.stringify(key)}:${stringify(fields[key])}`)
+  .join('');
+
+const PRETTY_LABELS = { 10: 'TRACE', 20: 'DEBUG', 30: 'INFO', 40: 'WARN', 50: 'ERROR', 60: 'FATAL' };
+
+const prettyLine = (line) => {
+  const { level, time, msg, pid, hostname, reqId, err, ...fields } = JSON.parse(line);
+  const extra = Object.keys(fields).length > 0 ? ` ${JSON.stringify(fields)}` : '';
+  const stack = err ? `\n${err.stack || err.message}` : '';
+  return `${new Date(time).toISOString()} ${PRETTY_LABELS[level] || level}${reqId ? ` [${reqId}]` : ''} ${msg}${extra}${stack}\n`;
+};
+
+class Logger {
+  constructor(destination, options = {}) {
+    this.destination = destination;
+    this.levelValue = LEVELS[options.level] || LEVELS.info;
+    this.format = options.format || 'json';
+    this.bindings = options.bindings || {};
+    this.prefix = options.prefix !== undefined ? options.prefix : fieldsFragment(this.bindings);
+    // Shared by a logger and its children
+    this.stats = options.stats || { lines: 0, formatNs: 0n, requests: 0, requestNs: 0n };
+  }
+
+  isLevelEnabled(level) {
+    return LEVELS[level] >= this.levelValue;
+  }
+
+  /**
+   * Logger whose lines carry extra fields
+   * @param {Object} bindings - Fields added to every line
+   * @returns {Logger} Child logger
+   */
+  child(bindings) {
+    return new Logger(this.destination, {
+      level: Object.keys(LEVELS).find(name => LEVELS[name] === this.levelValue),
+      format: this.format,
+      bindings: { ...this.bindings, ...bindings },
+      prefix: this.prefix + fieldsFragment(bindings),
+      stats: this.stats
+    });
+  }
+
+  /**
+   * Serialize and queue one line. Accepts console-style arguments: Errors are
+   * logged under err, a plain object's keys become fields, anything else is
+   * appended to the message. A leading object (pino style) is fields too
+   */
+  write(level, message, args) {
+    const started = process.hrtime.bigint();
+
+    let fields = null;
+    let error = null;
+    let msg = message;
+    if (msg instanceof Error) {
+      error = msg;
+      msg = msg.message;
+    } else if (msg !== null && typeof msg === 'object') {
+      fields = msg;
+      msg = args.length > 0 && typeof args[0] === 'string' ? args.shift() : '';
+    }
+    msg = msg === undefined ? '' : String(msg);
+
+    for (const arg of args) {
+      if (arg instanceof Error) {
+        error = arg;
+      } else if (arg !== null && typeof arg === 'object' && !fields) {
+        fields = arg;
+      } else {
+        msg += ` ${typeof arg === 'object' ? stringify(arg) : arg}`;
+      }
+    }
+
+    let line = `{"level":${LEVELS[level]},"time":${Date.now()}${this.prefix}`;
+    const context = requestContext.getStore();
+    if (context && this.bindings.reqId === undefined && !(fields && fields.reqId !== undefined)) {
+      line += `,"reqId":${JSON.stringify(context.reqId)}`;
+    }
+    if (fields) {
+      line += fieldsFragment(fields);
+    }
+    if (error) {
+      line += `,"err":${stringify(serializeError(error))}`;
+    }
+    line += `,"msg":${JSON.stringify(msg)}}\n`;
+
+    this.destination.write(this.format === 'pretty' ? prettyLine(line) : line);
+    this.stats.lines++;
+    this.stats.formatNs += process.hrtime.bigint() - started;
+  }
+
+  /**
+   * Count a finished request towards the logging overhead share
+   * @param {BigInt} durationNs - Request duration
+   */
+  recordRequest(durationNs) {
+    this.stats.requests++;
+    this.stats.requestNs += durationNs;
+  }
+
+  flush() {
+    this.destination.flushSync();
+  }
+
+  getStats() {
+    const { lines, formatNs, requests, requestNs } = this.stats;
+    return {
+      level: Object.keys(LEVELS).find(name => LEVELS[name] === this.levelValue),
+      lines,
+      buffered: this.destination.length,
+      ...this.destination.stats,
+      formatMsTotal: Number(formatNs) / 1e6,
+      avgFormatUs: lines > 0 ? Number(formatNs) / lines / 1e3 : 0,
+      requests,
+      // Share of total request time spent formatting log lines
+      overheadShare: requestNs > 0n ? Number(formatNs) / Number(requestNs) : 0
+    };
+  }
 }
 
-// Define log format
-const logFormat = winston.format.combine(
-  winston.format.timestamp({ format: 'YYYY-MM-DD HH:mm:ss' }),
-  winston.format.errors({ stack: true }),
-  winston.format.splat(),
-  winston.format.json()
-);
-
-// Create logger instance
-const logger = winston.createLogger({
-  level: process.env.LOG_LEVEL || 'info',
-  format: logFormat,
-  defaultMeta: { service: 'dbis-backend' },
-  transports: [
-    // Write all logs with level 'error' and below to error.log
-    new winston.transports.File({ 
-      filename: path.join(logsDir, 'error.log'), 
-      level: 'error' 
-    }),
-    // Write all logs with level 'info' and below to combined.log
-    new winston.transports.File({ 
-      filename: path.join(logsDir, 'combined.log') 
-    })
-  ]
-});
-
-// If we're not in production, also log to the console
-if (process.env.NODE_ENV !== 'production') {
-  logger.add(new winston.transports.Console({
-    format: winston.format.combine(
-      winston.format.colorize(),
-      winston.format.simple()
-    )
-  }));
+for (const level of Object.keys(LEVELS)) {
+  Logger.prototype[level] = function log(message, ...args) {
+    if (LEVELS[level] < this.levelValue) return;
+    this.write(level, message, args);
+  };
 }
 
+/**
+ * Create a logger
+ * @param {Object} options - level, format ('json' | 'pretty'), bindings,
+ *                           destination (BufferedDestination) or file (path)
+ * @returns {Logger} Logger
+ */
+const createLogger = (options = {}) => {
+  const destination = options.destination || new BufferedDestination({
+    fd: options.file ? fs.openSync(options.file, 'a') : 1
+  });
+  return new Logger(destination, {
+    level: options.level || LOG_LEVEL,
+    format: options.format || LOG_FORMAT,
+    bindings: options.bindings || { pid: process.pid, hostname: os.hostname() }
+  });
+};
+
+// Shared application logger
+const logger = createLogger({ file: process.env.LOG_FILE });
+
 /**
  * Log an API request
  * @param {Object} req - Express request object
@@ -87,17 +340,12 @@ const logResponse = (req, res, message) => {
  * @param {String} message - Log message
  */
 const logError = (req, error, message) => {
-  logger.error(message, {
+  logger.error(message, error, {
     method: req.method,
     url: req.originalUrl,
     ip: req.ip,
     userId: req.user?.id,
-    adminId: req.admin?.id,
-    error: {
-      name: error.name,
-      message: error.message,
-      stack: error.stack
-    }
+    adminId: req.admin?.id
   });
 };
 
@@ -125,6 +373,11 @@ const logAudit = (action, entityType, entityId, details, user) => {
 
 module.exports = {
   logger,
+  createLogger,
+  requestContext,
+  BufferedDestination,
+  Logger,
+  LEVELS,
   logRequest,
   logResponse,
   logError,
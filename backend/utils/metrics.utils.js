@@ -0,0 +1,347 @@
+/**
+ * Metrics utilities for DBIS
+ * A small in-process Prometheus registry (counters, gauges, histograms with
+ * labels) rendered in the text exposition format by GET /metrics.
+ *
+ * Each module declares the metrics it updates next to the code it measures.
+ * An observation is a map lookup and a few number updates. Gauges that mirror
+ * state kept elsewhere (pool counts, queue depths) take a collect callback,
+ * which is read at scrape time instead of on every change.
+ *
+ * In cluster mode each worker keeps its own registry. renderCluster() has the
+ * worker handling the scrape gather every worker's text over cluster IPC and
+ * merges them, adding a pid label, so one scrape target covers the host.
+ *
+ * Names follow dbis_<subsystem>_<name>_<unit>. Label values must come from
+ * small fixed sets (route templates, statement kinds, RPC methods); never ids
+ * or raw URLs.
+ */
+const { monitorEventLoopDelay } = require('perf_hooks');
+const { logger } = require('./logger.utils');
+const clusterUtils = require('./cluster.utils');
+
+// Seconds; covers sub-millisecond queries up to slow chain confirmations
+const DEFAULT_BUCKETS = [0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30];
+
+const escapeLabel = (value) => String(value).replace(/\\/g, '\\\\').replace(/\n/g, '\\n').replace(/"/g, '\\"');
+
+const renderLabels = (names, values, extra = '') => {
+  const pairs = names.map((name, i) => `${name}="${escapeLabel(values[i])}"`);
+  if (extra) pairs.push(extra);
+  return pairs.length > 0 ? `{${pairs.join(',')}}` : '';
+};
+
+const formatValue = (value) => {
+  if (value === Infinity) return '+Inf';
+  if (value === -Infinity) return '-Inf';
+  return String(value);
+};
+
+class Metric {
+  constructor(type, name, help, labelNames = []) {
+    this.type = type;
+    this.name = name;
+    this.help = help;
+    this.labelNames = labelNames;
+    this.series = new Map();
+  }
+
+  /**
+   * Series for a label set, created on first use
+   * @param {Object} labels - Label values by name
+   */
+  seriesFor(labels = {}) {
+    const values = this.labelNames.map(name => (labels[name] === undefined ? '' : String(labels[name])));
+    const key = values.join('\u0001');
+    let series = this.series.get(key);
+    if (!series) {
+      series = this.createSeries(values);
+      this.series.set(key, series);
+    }
+    return series;
+  }
+
+  header() {
+    return `# HELP ${this.name} ${this.help}\n# TYPE ${this.name} ${this.type}\n`;
+  }
+}
+
+class Counter extends Metric {
+  constructor(name, help, labelNames) {
+    super('counter', name, help, labelNames);
+  }
+
+  createSeries(values) {
+    return { values, value: 0 };
+  }
+
+  inc(labels, value = 1) {
+    this.seriesFor(labels).value += value;
+  }
+
+  render() {
+    let out = this.header();
+    for (const series of this.series.values()) {
+      out += `${this.name}${renderLabels(this.labelNames, series.values)} ${formatValue(series.value)}\n`;
+    }
+    return out;
+  }
+}
+
+class Gauge extends Metric {
+  /**
+   * @param {Function} collect - Optional; called with the gauge before each scrape to set current values
+   */
+  constructor(name, help, labelNames, collect) {
+    super('gauge', name, help, labelNames);
+    this.collect = collect;
+  }
+
+  createSeries(values) {
+    return { values, value: 0 };
+  }
+
+  set(labels, value) {
+    this.seriesFor(labels).value = value;
+  }
+
+  inc(labels, value = 1) {
+    this.seriesFor(labels).value += value;
+  }
+
+  dec(labels, value = 1) {
+    this.seriesFor(labels).value -= value;
+  }
+
+  render() {
+    if (this.collect) {
+      this.collect(this);
+    }
+    let out = this.header();
+    for (const series of this.series.values()) {
+      out += `${this.name}${renderLabels(this.labelNames, series.values)} ${formatValue(series.value)}\n`;
+    }
+    return out;
+  }
+}
+
+class Histogram extends Metric {
+  constructor(name, help, labelNames, buckets = DEFAULT_BUCKETS) {
+    super('histogram', name, help, labelNames);
+    this.buckets = [...buckets].sort((a, b) => a - b);
+  }
+
+  createSeries(values) {
+    return { values, counts: new Array(this.buckets.length).fill(0), sum: 0, count: 0 };
+  }
+
+  /**
+   * Record one observation
+   * @param {Object} labels - Label values
+   * @param {Number} value - Observed value (seconds for durations)
+   */
+  observe(labels, value) {
+    const series = this.seriesFor(labels);
+    series.sum += value;
+    series.count++;
+    // Only the first matching bucket is counted; render() accumulates
+    for (let i = 0; i < this.buckets.length; i++) {
+      if (value <= this.buckets[i]) {
+        series.counts[i]++;
+        break;
+      }
+    }
+  }
+
+  /**
+   * Start timing; call the returned function to observe the elapsed seconds
+   * @param {Object} labels - Label values, merged with those passed at the end
+   * @returns {Function} end(extraLabels) => seconds
+   */
+  startTimer(labels = {}) {
+    const started = process.hrtime.bigint();
+    return (extra) => {
+      const seconds = Number(process.hrtime.bigint() - started) / 1e9;
+      this.observe(extra ? { ...labels, ...extra } : labels, seconds);
+      return seconds;
+    };
+  }
+
+  render() {
+    let out = this.header();
+    for (const series of this.series.values()) {
+      let cumulative = 0;
+      this.buckets.forEach((bound, i) => {
+        cumulative += series.counts[i];
+        out += `${this.name}_bucket${renderLabels(this.labelNames, series.values, `le="${bound}"`)} ${cumulative}\n`;
+      });
+      const labels = renderLabels(this.labelNames, series.values);
+      out += `${this.name}_bucket${renderLabels(this.labelNames, series.values, 'le="+Inf"')} ${series.count}\n`;
+      out += `${this.name}_sum${labels} ${series.sum}\n`;
+      out += `${this.name}_count${labels} ${series.count}\n`;
+    }
+    return out;
+  }
+}
+
+class Registry {
+  constructor() {
+    this.metrics = new Map();
+  }
+
+  register(metric) {
+    const existing = this.metrics.get(metric.name);
+    if (existing) {
+      if (existing.type !== metric.type) {
+        throw new Error(`Metric ${metric.name} is already registered as a ${existing.type}`);
+      }
+      return existing;
+    }
+    this.metrics.set(metric.name, metric);
+    return metric;
+  }
+
+  counter(name, help, labelNames = []) {
+    return this.register(new Counter(name, help, labelNames));
+  }
+
+  gauge(name, help, labelNames = [], collect = null) {
+    return this.register(new Gauge(name, help, labelNames, collect));
+  }
+
+  histogram(name, help, labelNames = [], buckets = DEFAULT_BUCKETS) {
+    return this.register(new Histogram(name, help, labelNames, buckets));
+  }
+
+  /**
+   * Every metric in the Prometheus text format
+   * @returns {String} Exposition text
+   */
+  render() {
+    let out = '';
+    for (const metric of this.metrics.values()) {
+      try {
+        out += metric.render();
+      } catch (error) {
+        // One failing collector must not break the scrape
+        logger.error(`Failed to collect metric ${metric.name}:`, error.message);
+      }
+    }
+    return out;
+  }
+}
+
+const registry = new Registry();
+
+const CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8';
+
+// Event loop delay tells CPU-bound stalls apart from waiting on Postgres or the chain
+const loopDelay = monitorEventLoopDelay({ resolution: 10 });
+loopDelay.enable();
+
+registry.gauge('dbis_event_loop_delay_seconds', 'Event loop delay since the last scrape', ['quantile'], (gauge) => {
+  gauge.set({ quantile: '0.5' }, loopDelay.percentile(50) / 1e9);
+  gauge.set({ quantile: '0.99' }, loopDelay.percentile(99) / 1e9);
+  gauge.set({ quantile: '1' }, loopDelay.max / 1e9);
+  loopDelay.reset();
+});
+
+registry.gauge('process_cpu_seconds', 'User and system CPU time used by the process', ['mode'], (gauge) => {
+  const { user, system } = process.cpuUsage();
+  gauge.set({ mode: 'user' }, user / 1e6);
+  gauge.set({ mode: 'system' }, system / 1e6);
+});
+
+registry.gauge('process_resident_memory_bytes', 'Resident set size', [], (gauge) => {
+  gauge.set({}, process.memoryUsage().rss);
+});
+
+/**
+ * Time an async call: observes its duration labelled with outcome (ok / error)
+ * @param {Histogram} histogram - Duration histogram with an outcome label
+ * @param {Object} labels - Other label values
+ * @param {Function} fn - Call to time
+ * @returns {Promise<*>} The call's result
+ */
+const timeAsync = async (histogram, labels, fn) => {
+  const end = histogram.startTimer(labels);
+  try {
+    const result = await fn();
+    end({ outcome: 'ok' });
+    return result;
+  } catch (error) {
+    end({ outcome: 'error' });
+    throw error;
+  }
+};
+
+const METRICS_CHANNEL = 'metrics';
+
+clusterUtils.onGather(METRICS_CHANNEL, () => registry.render());
+
+// Add a pid label to one sample line
+const labelSample = (line, label) => {
+  const brace = line.indexOf('{');
+  const space = line.indexOf(' ');
+  if (brace !== -1 && brace < space) {
+    return `${line.slice(0, brace + 1)}${label},${line.slice(brace + 1)}`;
+  }
+  return `${line.slice(0, space)}{${label}}${line.slice(space)}`;
+};
+
+/**
+ * Merge the exposition text of several workers
+ * Samples are grouped under one HELP/TYPE header per metric, as the format requires.
+ * @param {Array} results - [{ pid, payload }] with payload the worker's render()
+ * @returns {String} Exposition text
+ */
+const mergeRenders = (results) => {
+  const families = new Map();
+  for (const { pid, payload } of results) {
+    const label = `pid="${escapeLabel(pid)}"`;
+    let family = null;
+    for (const line of String(payload || '').split('\n')) {
+      if (!line) continue;
+      if (line.startsWith('# HELP ')) {
+        const name = line.split(' ')[2];
+        family = families.get(name);
+        if (!family) {
+          family = { header: [line], samples: [] };
+          families.set(name, family);
+        }
+      } else if (line.startsWith('# TYPE ')) {
+        if (family && family.header.length === 1) family.header.push(line);
+      } else if (family && !line.startsWith('#')) {
+        family.samples.push(labelSample(line, label));
+      }
+    }
+  }
+  let out = '';
+  for (const family of families.values()) {
+    out += `${family.header.join('\n')}\n`;
+    if (family.samples.length > 0) out += `${family.samples.join('\n')}\n`;
+  }
+  return out;
+};
+
+/**
+ * Every worker's metrics in cluster mode, this process's otherwise
+ * @returns {Promise<String>} Exposition text
+ */
+const renderCluster = async () => {
+  const results = await clusterUtils.gather(METRICS_CHANNEL);
+  return results ? mergeRenders(results) : registry.render();
+};
+
+module.exports = {
+  registry,
+  renderCluster,
+  mergeRenders,
+  CONTENT_TYPE,
+  DEFAULT_BUCKETS,
+  timeAsync,
+  Counter,
+  Gauge,
+  Histogram,
+  Registry
+};
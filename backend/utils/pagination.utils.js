@@ -0,0 +1,124 @@
+/**
+ * Pagination utilities for DBIS
+ * Keyset (cursor) pagination on (created_at, id) and cached row counts
+ */
+
+const COUNT_CACHE_TTL_MS = parseInt(process.env.ADMIN_COUNT_CACHE_TTL_MS || '30000', 10);
+const COUNT_CACHE_MAX_ENTRIES = 500;
+
+// Above this many rows an unfiltered count uses the planner estimate instead of COUNT(*)
+const ESTIMATE_THRESHOLD = parseInt(process.env.ADMIN_COUNT_ESTIMATE_THRESHOLD || '100000', 10);
+
+const countCache = new Map();
+
+/**
+ * Encode a keyset position as an opaque cursor
+ * created_at is carried as Postgres timestamp text so microseconds survive the round trip
+ * @param {Object} row - Row with cursor_created_at and id
+ * @returns {String} base64url cursor
+ */
+const encodeCursor = (row) => {
+  return Buffer.from(JSON.stringify([row.cursor_created_at, row.id])).toString('base64url');
+};
+
+/**
+ * Decode a cursor produced by encodeCursor
+ * @param {String} cursor - base64url cursor
+ * @returns {Object|null} { createdAt, id }, or null if the cursor is missing or malformed
+ */
+const decodeCursor = (cursor) => {
+  if (!cursor) return null;
+  try {
+    const [createdAt, id] = JSON.parse(Buffer.from(String(cursor), 'base64url').toString('utf8'));
+    if (typeof createdAt !== 'string' || !Number.isInteger(id)) return null;
+    return { createdAt, id };
+  } catch (error) {
+    return null;
+  }
+};
+
+/**
+ * Parse and clamp a page size
+ * @param {String|Number} value - Requested limit
+ * @param {Number} fallback - Default limit
+ * @param {Number} max - Largest allowed limit
+ * @returns {Number} Page size
+ */
+const parseLimit = (value, fallback, max = 100) => {
+  const limit = parseInt(value, 10);
+  if (!Number.isInteger(limit) || limit < 1) return fallback;
+  return Math.min(limit, max);
+};
+
+/**
+ * Split a LIMIT n + 1 result into a page and the cursor for the next one
+ * @param {Array} rows - Rows selected with cursor_created_at, ordered (created_at, id) DESC
+ * @param {Number} limit - Page size
+ * @returns {Object} { rows, nextCursor, hasMore }
+ */
+const keysetPage = (rows, limit) => {
+  const hasMore = rows.length > limit;
+  const page = rows.slice(0, limit);
+  const nextCursor = hasMore ? encodeCursor(page[page.length - 1]) : null;
+
+  return {
+    rows: page.map(({ cursor_created_at, ...row }) => row),
+    nextCursor,
+    hasMore
+  };
+};
+
+/**
+ * Count rows, reusing a recent result for the same query and parameters
+ * @param {Object} db - Database service
+ * @param {String} sql - Query returning a single `count` column
+ * @param {Array} params - Query parameters
+ * @returns {Number} Row count
+ */
+const cachedCount = async (db, sql, params = []) => {
+  const key = `${sql}\u0000${JSON.stringify(params)}`;
+  const cached = countCache.get(key);
+  if (cached && cached.expiresAt > Date.now()) {
+    return cached.count;
+  }
+
+  const result = await db.query(sql, params);
+  const count = parseInt(result.rows[0].count, 10);
+
+  if (countCache.size >= COUNT_CACHE_MAX_ENTRIES) {
+    countCache.delete(countCache.keys().next().value);
+  }
+  countCache.set(key, { count, expiresAt: Date.now() + COUNT_CACHE_TTL_MS });
+  return count;
+};
+
+/**
+ * Row count of a whole table: the planner estimate for large tables, an exact (cached) count otherwise.
+ * A partitioned table has no statistics of its own, so its partitions' estimates are summed
+ * @param {Object} db - Database service
+ * @param {String} table - Table name (trusted identifier)
+ * @returns {Object} { count, estimated }
+ */
+const tableCount = async (db, table) => {
+  const estimate = await db.query(
+    `SELECT COALESCE(SUM(GREATEST(c.reltuples, 0)), -1)::bigint AS count
+     FROM pg_class c
+     WHERE c.oid = to_regclass($1)
+        OR c.oid IN (SELECT inhrelid FROM pg_inherits WHERE inhparent = to_regclass($1))`,
+    [table]
+  );
+  const estimated = parseInt(estimate.rows[0].count, 10);
+  if (estimated >= ESTIMATE_THRESHOLD) {
+    return { count: estimated, estimated: true };
+  }
+  return { count: await cachedCount(db, `SELECT COUNT(*) FROM ${table}`), estimated: false };
+};
+
+module.exports = {
+  encodeCursor,
+  decodeCursor,
+  parseLimit,
+  keysetPage,
+  cachedCount,
+  tableCount
+};
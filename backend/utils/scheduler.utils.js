@@ -0,0 +1,70 @@
+/**
+ * Scheduling utilities for DBIS
+ * Base class for background loops that run one task at a time on a timer.
+ *
+ * Subclasses implement run(). The next run is scheduled when the current one
+ * settles, never on a fixed clock, so a slow run delays the next one instead
+ * of overlapping it. run() may return a delay in ms for the next run (0 to
+ * keep draining a backlog); otherwise the job waits `interval`. Errors are
+ * logged and the loop carries on. stop() waits for a run in progress.
+ */
+const { logger } = require('./logger.utils');
+
+class IntervalJob {
+  /**
+   * @param {Object} options - name (used in log lines), interval (ms between runs)
+   */
+  constructor(options = {}) {
+    this.name = options.name || this.constructor.name;
+    this.interval = options.interval;
+    this.running = false;
+    this.timer = null;
+    this.active = null;
+  }
+
+  /**
+   * One unit of work
+   * @returns {Number|undefined} Delay before the next run, or undefined for `interval`
+   */
+  async run() {
+    throw new Error(`${this.name} does not implement run()`);
+  }
+
+  start() {
+    if (this.running) return this;
+    this.running = true;
+    this.schedule(0);
+    return this;
+  }
+
+  async stop() {
+    this.running = false;
+    clearTimeout(this.timer);
+    if (this.active) {
+      await this.active;
+    }
+  }
+
+  schedule(delay) {
+    if (!this.running) return;
+    this.timer = setTimeout(() => {
+      this.active = this.tick().finally(() => {
+        this.active = null;
+      });
+    }, delay);
+  }
+
+  async tick() {
+    let delay;
+    try {
+      delay = await this.run();
+    } catch (error) {
+      logger.error(`${this.name} error:`, error);
+    }
+    this.schedule(typeof delay === 'number' ? delay : this.interval);
+  }
+}
+
+module.exports = {
+  IntervalJob
+};
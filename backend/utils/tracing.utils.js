@@ -0,0 +1,126 @@
+/**
+ * Tracing utilities for DBIS
+ * OpenTelemetry spans around API requests, database queries, chain calls and
+ * biometric comparisons.
+ *
+ * @opentelemetry/api is loaded lazily. When it is not installed every helper
+ * here runs the wrapped function directly, so instrumented code has no
+ * dependency on it. initTracing() starts an exporter (OTLP over HTTP to
+ * OTEL_EXPORTER_OTLP_ENDPOINT) when that variable is set and
+ * @opentelemetry/sdk-node and @opentelemetry/exporter-trace-otlp-http are
+ * installed; OTEL_SERVICE_NAME defaults to dbis-backend.
+ */
+const { logger } = require('./logger.utils');
+
+const tryRequire = (name) => {
+  try {
+    return require(name);
+  } catch (error) {
+    return null;
+  }
+};
+
+const otel = tryRequire('@opentelemetry/api');
+const tracer = otel ? otel.trace.getTracer('dbis-backend') : null;
+
+let sdk = null;
+
+/**
+ * Start exporting spans; call once at startup before the routes are loaded
+ * @returns {Boolean} True if an exporter was started
+ */
+const initTracing = () => {
+  if (sdk || !process.env.OTEL_EXPORTER_OTLP_ENDPOINT) return false;
+  const sdkNode = tryRequire('@opentelemetry/sdk-node');
+  const exporter = tryRequire('@opentelemetry/exporter-trace-otlp-http');
+  if (!otel || !sdkNode || !exporter) {
+    logger.warn('OTEL_EXPORTER_OTLP_ENDPOINT is set but the OpenTelemetry packages are not installed; tracing disabled');
+    return false;
+  }
+
+  process.env.OTEL_SERVICE_NAME = process.env.OTEL_SERVICE_NAME || 'dbis-backend';
+  sdk = new sdkNode.NodeSDK({ traceExporter: new exporter.OTLPTraceExporter() });
+  sdk.start();
+  return true;
+};
+
+/**
+ * Flush and stop the exporter
+ */
+const shutdownTracing = async () => {
+  if (!sdk) return;
+  try {
+    await sdk.shutdown();
+  } catch (error) {
+    logger.error('Failed to flush traces:', error.message);
+  }
+  sdk = null;
+};
+
+/**
+ * Start a span as a child of the active one; end it with endSpan
+ * @param {String} name - Span name
+ * @param {Object} attributes - Span attributes
+ * @param {Number} kind - Optional SpanKind
+ * @returns {Object|null} Span, or null when tracing is unavailable
+ */
+const startSpan = (name, attributes = {}, kind) => {
+  if (!tracer) return null;
+  return tracer.startSpan(name, { attributes, kind });
+};
+
+/**
+ * End a span, recording an error if one is given
+ * @param {Object|null} span - Span from startSpan
+ * @param {Error} error - Optional error
+ */
+const endSpan = (span, error) => {
+  if (!span) return;
+  if (error) {
+    span.recordException(error);
+    span.setStatus({ code: otel.SpanStatusCode.ERROR, message: error.message });
+  }
+  span.end();
+};
+
+/**
+ * Run fn with span as the active span, so spans started inside become its children
+ * @param {Object|null} span - Span from startSpan
+ * @param {Function} fn - Function to run
+ * @returns {*} fn's result
+ */
+const runInSpan = (span, fn) => {
+  if (!span) return fn();
+  return otel.context.with(otel.trace.setSpan(otel.context.active(), span), fn);
+};
+
+/**
+ * Run an async function inside a new span, ending it when the promise settles
+ * @param {String} name - Span name
+ * @param {Object} attributes - Span attributes
+ * @param {Function} fn - Function to run; receives the span (or null)
+ * @returns {Promise<*>} fn's result
+ */
+const withSpan = async (name, attributes, fn) => {
+  const span = startSpan(name, attributes);
+  if (!span) return fn(null);
+  try {
+    const result = await runInSpan(span, () => fn(span));
+    endSpan(span);
+    return result;
+  } catch (error) {
+    endSpan(span, error);
+    throw error;
+  }
+};
+
+module.exports = {
+  enabled: Boolean(tracer),
+  SpanKind: otel ? otel.SpanKind : {},
+  initTracing,
+  shutdownTracing,
+  startSpan,
+  endSpan,
+  runInSpan,
+  withSpan
+};
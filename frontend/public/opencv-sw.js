@@ -0,0 +1,56 @@
+/* eslint-disable no-restricted-globals */
+/**
+ * Runtime cache for OpenCV.js
+ * Serves the self-hosted builds under /opencv/ and the CDN fallback
+ * cache-first, so face detection does not download ~10 MB of WASM on every
+ * visit. All other requests go to the network untouched.
+ *
+ * Bump CACHE_VERSION when the builds in public/opencv are replaced.
+ */
+const CACHE_VERSION = 'opencv-4.5.5-v1';
+const CACHE_PREFIX = 'opencv-';
+
+const SCOPE_PATH = new URL(self.registration.scope).pathname;
+const CDN_URLS = ['https://docs.opencv.org/4.5.5/opencv.js'];
+
+const isCached = (request) => {
+  if (request.method !== 'GET') return false;
+  const url = new URL(request.url);
+  if (CDN_URLS.includes(url.href)) return true;
+  return url.origin === self.location.origin && url.pathname.startsWith(`${SCOPE_PATH}opencv/`);
+};
+
+self.addEventListener('install', () => {
+  self.skipWaiting();
+});
+
+self.addEventListener('activate', (event) => {
+  event.waitUntil(
+    caches.keys()
+      .then(keys => Promise.all(
+        keys
+          .filter(key => key.startsWith(CACHE_PREFIX) && key !== CACHE_VERSION)
+          .map(key => caches.delete(key))
+      ))
+      // Control the open page right away, so its face detection worker is served from the cache
+      .then(() => self.clients.claim())
+  );
+});
+
+self.addEventListener('fetch', (event) => {
+  if (!isCached(event.request)) return;
+
+  event.respondWith(
+    caches.open(CACHE_VERSION).then(async (cache) => {
+      const cached = await cache.match(event.request);
+      if (cached) return cached;
+
+      const response = await fetch(event.request);
+      // Opaque CDN responses report status 0; missing self-hosted builds are not cached
+      if (response.ok || response.type === 'opaque') {
+        cache.put(event.request, response.clone());
+      }
+      return response;
+    })
+  );
+});
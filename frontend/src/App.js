@@ -1,22 +1,22 @@
-import React from 'react';
+import React, { Suspense } from 'react';
 import { BrowserRouter as Router, Routes, Route, Navigate } from 'react-router-dom';
 import { ThemeProvider, createTheme } from '@mui/material/styles';
 import CssBaseline from '@mui/material/CssBaseline';
 import { AuthProvider, useAuth } from './context/AuthContext';
 
-// Pages
+// Pages: login and registration are in the entry chunk, the rest load on demand (see routes.js)
 import Login from './pages/Login';
 import Register from './pages/Register';
-import Dashboard from './pages/Dashboard';
-import Profile from './pages/Profile';
-import WalletPage from './pages/WalletPage';
-import VerificationStatus from './pages/VerificationStatus';
-import ProfessionalRecords from './pages/ProfessionalRecords';
-import BlockchainStatus from './pages/BlockchainStatus';
-import BiometricVerificationPage from './pages/BiometricVerificationPage';
-import NotFound from './pages/NotFound';
-
-
+import {
+  Dashboard,
+  Profile,
+  WalletPage,
+  VerificationStatus,
+  ProfessionalRecords,
+  BlockchainStatus,
+  BiometricVerificationPage,
+  NotFound
+} from './routes';
 
 // Components
 import Layout from './components/Layout';
@@ -65,29 +65,31 @@ function App() {
       <CssBaseline />
       <AuthProvider>
         <Router>
-          <Routes>
-            {/* Public routes */}
-            <Route path="/login" element={<Login />} />
-            <Route path="/register" element={<Register />} />
+          <Suspense fallback={<LoadingScreen />}>
+            <Routes>
+              {/* Public routes */}
+              <Route path="/login" element={<Login />} />
+              <Route path="/register" element={<Register />} />
             
-            {/* Protected routes */}
-            <Route path="/" element={
-              <ProtectedRoute>
-                <Layout />
-              </ProtectedRoute>
-            }>
-              <Route index element={<Dashboard />} />
-              <Route path="profile" element={<Profile />} />
-              <Route path="wallet" element={<WalletPage />} />
-              <Route path="verification-status" element={<VerificationStatus />} />
-              <Route path="professional-records" element={<ProfessionalRecords />} />
-              <Route path="blockchain-status" element={<BlockchainStatus />} />
-              <Route path="biometric-verification" element={<BiometricVerificationPage />} />
-            </Route>
+              {/* Protected routes */}
+              <Route path="/" element={
+                <ProtectedRoute>
+                  <Layout />
+                </ProtectedRoute>
+              }>
+                <Route index element={<Dashboard />} />
+                <Route path="profile" element={<Profile />} />
+                <Route path="wallet" element={<WalletPage />} />
+                <Route path="verification-status" element={<VerificationStatus />} />
+                <Route path="professional-records" element={<ProfessionalRecords />} />
+                <Route path="blockchain-status" element={<BlockchainStatus />} />
+                <Route path="biometric-verification" element={<BiometricVerificationPage />} />
+              </Route>
             
-            {/* 404 route */}
-            <Route path="*" element={<NotFound />} />
-          </Routes>
+              {/* 404 route */}
+              <Route path="*" element={<NotFound />} />
+            </Routes>
+          </Suspense>
         </Router>
       </AuthProvider>
     </ThemeProvider>
@@ -9,6 +9,7 @@ import {
   Grid
 } from '@mui/material';
 import { useAuth } from '../context/AuthContext';
+import { loadFaceDetection, createFaceDetector, captureFrame } from '../utils/faceDetection';
 
 /**
  * BiometricVerification component for verifying user identity using biometrics
@@ -26,17 +27,17 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
   const videoRef = useRef(null);
   const canvasRef = useRef(null);
   const streamRef = useRef(null);
-  const processingIntervalRef = useRef(null);
+  const detectorRef = useRef(null);
   
-  // Listen for OpenCV.js to be loaded
+  // Load OpenCV.js (in the face detection worker where supported)
   useEffect(() => {
-    if (window.cv) {
-      setOpencvLoaded(true);
-    } else {
-      const listener = () => setOpencvLoaded(true);
-      document.addEventListener('opencv-ready', listener);
-      return () => document.removeEventListener('opencv-ready', listener);
-    }
+    let mounted = true;
+    loadFaceDetection()
+      .then(() => mounted && setOpencvLoaded(true))
+      .catch(() => mounted && setError('Failed to load the facial recognition system. Please refresh the page and try again.'));
+    return () => {
+      mounted = false;
+    };
   }, []);
   
   // Clean up resources when component unmounts
@@ -45,8 +46,8 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
       if (streamRef.current) {
         streamRef.current.getTracks().forEach(track => track.stop());
       }
-      if (processingIntervalRef.current) {
-        clearInterval(processingIntervalRef.current);
+      if (detectorRef.current) {
+        detectorRef.current.stop();
       }
     };
   }, []);
@@ -78,10 +79,14 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
         videoRef.current.srcObject = stream;
       }
       
-      // Start processing frames for face detection
-      processingIntervalRef.current = setInterval(() => {
-        processVideoFrame();
-      }, 100); // Process 10 frames per second
+      // Analyze frames off the UI thread; the overlay canvas is drawn by the detector
+      detectorRef.current = createFaceDetector({
+        video: videoRef.current,
+        canvas: canvasRef.current,
+        profile: 'user',
+        onResult: (result) => setFaceDetected(result.faceDetected)
+      });
+      await detectorRef.current.start();
       
     } catch (err) {
       console.error('Error accessing camera:', err);
@@ -97,160 +102,15 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
       streamRef.current = null;
     }
     
-    if (processingIntervalRef.current) {
-      clearInterval(processingIntervalRef.current);
-      processingIntervalRef.current = null;
+    if (detectorRef.current) {
+      detectorRef.current.stop();
+      detectorRef.current = null;
     }
     
     setCameraActive(false);
     setFaceDetected(false);
   };
 
-  // Process video frames with OpenCV for face detection
-  const processVideoFrame = () => {
-    if (!videoRef.current || !canvasRef.current || !opencvLoaded || !window.cv) return;
-    
-    const video = videoRef.current;
-    const canvas = canvasRef.current;
-    
-    if (video.readyState !== video.HAVE_ENOUGH_DATA) return;
-    
-    // Set canvas dimensions to match video
-    canvas.width = video.videoWidth;
-    canvas.height = video.videoHeight;
-    
-    // Get canvas context and draw the current video frame
-    const ctx = canvas.getContext('2d');
-    if (!ctx) {
-      return; // Canvas context not available yet
-    }
-    ctx.drawImage(video, 0, 0, canvas.width, canvas.height);
-    
-    // Create OpenCV matrices directly without using imread or matFromImageData
-    // Get image data from canvas
-    const imageData = ctx.getImageData(0, 0, canvas.width, canvas.height);
-    
-    // Create an empty Mat of the right size and type
-    const src = new window.cv.Mat(canvas.height, canvas.width, window.cv.CV_8UC4);
-    // Fill the Mat with the image data
-    src.data.set(new Uint8Array(imageData.data));
-    
-    // Create grayscale version
-    const gray = new window.cv.Mat();
-    window.cv.cvtColor(src, gray, window.cv.COLOR_RGBA2GRAY);
-    
-    // Perform face detection
-    try {
-      // Since we can't easily load XML cascade classifiers in browser,
-      // we'll use our enhanced simulated face detection instead
-      
-      // This is a hack - in a real application you would load the XML file properly
-      // Since we can't easily load XML classifiers in the browser environment through OpenCV.js,
-      // we're simulating face detection by checking for movement/differences in frames
-      
-      // Detect faces
-      const faces = detectSimulatedFaces(gray, src);
-      
-      // If faces detected, update UI
-      if (faces > 0) {
-        setFaceDetected(true);
-      } else {
-        setFaceDetected(false);
-      }
-      
-      // Draw faces on canvas for visualization
-      // In a real implementation, this would draw rectangles around detected faces
-      
-      // Display the processed frame
-      window.cv.imshow(canvas, src);
-    } catch (e) {
-      console.error('Error in face detection:', e);
-    }
-    
-    // Clean up resources
-    src.delete();
-    gray.delete();
-  };
-  
-  // Enhanced face detection simulation
-  const detectSimulatedFaces = (gray, src) => {
-    // We'll use multiple metrics to improve face detection reliability
-    let faceDetected = false;
-    
-    if (gray.rows > 0 && gray.cols > 0) {
-      // Define face region of interest (center of frame where face likely is)
-      const faceROI = new window.cv.Rect(
-        Math.floor(gray.cols * 0.25), 
-        Math.floor(gray.rows * 0.15), 
-        Math.floor(gray.cols * 0.5), 
-        Math.floor(gray.rows * 0.7)
-      );
-      
-      const centerRegion = gray.roi(faceROI);
-      
-      // 1. Calculate brightness in the center region
-      const meanVal = window.cv.mean(centerRegion);
-      const brightness = meanVal[0];
-      
-      // 2. Calculate contrast (standard deviation of pixel values)
-      const stdDev = new window.cv.Mat();
-      const mean = new window.cv.Mat();
-      window.cv.meanStdDev(centerRegion, mean, stdDev);
-      const contrast = stdDev.data[0];
-      
-      // 3. Edge detection to find facial features
-      const edges = new window.cv.Mat();
-      window.cv.Canny(centerRegion, edges, 50, 150);
-      const edgesMean = window.cv.mean(edges);
-      const edgeIntensity = edgesMean[0];
-      
-      // 4. Combine metrics with appropriate thresholds
-      // Brightness must be sufficient (face is usually brighter than background)
-      // Contrast must be high enough (faces have varying tones)
-      // Edge intensity must be significant (faces have features that create edges)
-      faceDetected = 
-        brightness > 40 && // Brightness threshold
-        contrast > 15 && // Contrast threshold
-        edgeIntensity > 5; // Edge intensity threshold
-      
-      // Draw rectangle showing region of interest with color based on detection
-      const color = faceDetected 
-        ? new window.cv.Scalar(0, 255, 0, 255) // Green if face detected
-        : new window.cv.Scalar(255, 0, 0, 255); // Red if no face detected
-      
-      window.cv.rectangle(
-        src,
-        new window.cv.Point(faceROI.x, faceROI.y),
-        new window.cv.Point(faceROI.x + faceROI.width, faceROI.y + faceROI.height),
-        color,
-        2
-      );
-      
-      // If face detected, draw additional visual cues
-      if (faceDetected) {
-        // Draw a circle in the center to indicate the sweet spot for face positioning
-        const centerX = faceROI.x + Math.floor(faceROI.width / 2);
-        const centerY = faceROI.y + Math.floor(faceROI.height / 2);
-        window.cv.circle(
-          src,
-          new window.cv.Point(centerX, centerY),
-          20,
-          new window.cv.Scalar(0, 255, 255, 255),
-          2
-        );
-      }
-      
-      // Clean up resources
-      centerRegion.delete();
-      stdDev.delete();
-      mean.delete();
-      edges.delete();
-    }
-    
-    // Return 1 face if detected, 0 otherwise
-    return faceDetected ? 1 : 0;
-  };
-
   // Capture facial biometrics
   const captureFacemesh = async () => {
     setFacemeshCapturing(true);
@@ -262,18 +122,18 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
       }
       
       // In a real app, this would capture actual facial landmarks
-      // For demo purposes, we're capturing a frame from the canvas
-      const canvas = canvasRef.current;
+      // For demo purposes, we're capturing a frame from the camera
+      const video = videoRef.current;
       
       // Get the image data
-      const imageData = canvas.toDataURL('image/jpeg', 0.9);
+      const imageData = captureFrame(video, 0.9);
       
       // Extract facial features (simulated)
       const facialFeatures = {
         // In a real implementation, these would be actual facial landmarks
         landmarks: Array.from({ length: 68 }, (_, i) => ({
-          x: Math.random() * canvas.width,
-          y: Math.random() * canvas.height,
+          x: Math.random() * video.videoWidth,
+          y: Math.random() * video.videoHeight,
           z: Math.random() * 50
         })),
         imageData: imageData,
@@ -368,8 +228,7 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
                   display: 'block', 
                   width: '100%', 
                   height: 'auto',
-                  objectFit: 'cover',
-                  opacity: 0 // Hide the video element as we're displaying the canvas
+                  objectFit: 'cover'
                 }} 
               />
               <canvas 
@@ -380,7 +239,8 @@ const BiometricVerification = ({ onComplete, onVerificationComplete, userId, ver
                   height: 'auto',
                   position: 'absolute',
                   top: 0,
-                  left: 0
+                  left: 0,
+                  pointerEvents: 'none' // Transparent detection overlay over the live video
                 }} 
               />
               {faceDetected && (
@@ -1,9 +1,9 @@
-import React, { useState } from 'react';
+import React, { Suspense, useState } from 'react';
 import { Outlet, useNavigate, Link } from 'react-router-dom';
 import { 
   AppBar, Box, Drawer, Toolbar, Typography, IconButton, 
   List, ListItem, ListItemIcon, ListItemText, Divider, 
-  Avatar, Menu, MenuItem, Container
+  Avatar, Menu, MenuItem, Container, LinearProgress
 } from '@mui/material';
 import {
   Menu as MenuIcon,
@@ -18,6 +18,8 @@ import {
   BugReport as TestIcon
 } from '@mui/icons-material';
 import { useAuth } from '../context/AuthContext';
+import { preloadFaceDetection } from '../utils/faceDetection';
+import { routePages } from '../routes';
 
 const drawerWidth = 240;
 
@@ -44,14 +46,20 @@ const Layout = () => {
     navigate('/login');
   };
   
+  // Hovering or focusing a link fetches its page chunk (and the camera engine for biometrics)
+  const preloadBiometric = () => {
+    routePages['/biometric-verification'].preload();
+    preloadFaceDetection();
+  };
+  
   const menuItems = [
-    { text: 'Dashboard', icon: <DashboardIcon />, path: '/' },
-    { text: 'Profile', icon: <PersonIcon />, path: '/profile' },
-    { text: 'Wallet', icon: <WalletIcon />, path: '/wallet' },
-    { text: 'Verification Status', icon: <VerifiedUserIcon />, path: '/verification-status' },
-    { text: 'Biometric Verification', icon: <BiometricIcon />, path: '/biometric-verification' },
-    { text: 'Professional Records', icon: <WorkIcon />, path: '/professional-records' },
-    { text: 'Blockchain Status', icon: <BlockchainIcon />, path: '/blockchain-status' },
+    { text: 'Dashboard', icon: <DashboardIcon />, path: '/', preload: routePages['/'].preload },
+    { text: 'Profile', icon: <PersonIcon />, path: '/profile', preload: routePages['/profile'].preload },
+    { text: 'Wallet', icon: <WalletIcon />, path: '/wallet', preload: routePages['/wallet'].preload },
+    { text: 'Verification Status', icon: <VerifiedUserIcon />, path: '/verification-status', preload: routePages['/verification-status'].preload },
+    { text: 'Biometric Verification', icon: <BiometricIcon />, path: '/biometric-verification', preload: preloadBiometric },
+    { text: 'Professional Records', icon: <WorkIcon />, path: '/professional-records', preload: routePages['/professional-records'].preload },
+    { text: 'Blockchain Status', icon: <BlockchainIcon />, path: '/blockchain-status', preload: routePages['/blockchain-status'].preload },
   ];
   
   // Development menu items - only shown in development environment
@@ -75,6 +83,9 @@ const Layout = () => {
             component={Link} 
             to={item.path}
             onClick={() => setMobileOpen(false)}
+            onMouseEnter={item.preload}
+            onFocus={item.preload}
+            onTouchStart={item.preload}
           >
             <ListItemIcon>
               {item.icon}
@@ -206,7 +217,10 @@ const Layout = () => {
       >
         <Toolbar />
         <Container maxWidth="lg">
-          <Outlet />
+          {/* Page chunks load inside the shell, so navigation keeps the drawer and app bar */}
+          <Suspense fallback={<LinearProgress />}>
+            <Outlet />
+          </Suspense>
         </Container>
       </Box>
     </Box>
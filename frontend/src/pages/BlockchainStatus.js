@@ -73,18 +73,18 @@ const BlockchainStatus = () => {
     setError(null);
     
     try {
-      // Fetch blockchain status from blockchain API
-      const blockchainResponse = await blockchainAPI.getBlockchainStatus();
-      
-      // Fetch verification status
-      const verificationResponse = await userAPI.getVerificationStatus();
+      // Fetch blockchain and verification status together
+      const [blockchainResponse, verificationResponse] = await Promise.all([
+        blockchainAPI.getBlockchainStatus(),
+        userAPI.getVerificationStatus()
+      ]);
       
       // Get status data from response
       const { status: blockchainStatus } = blockchainResponse.data;
       
-      // If there's a transaction hash, get its status
-      let confirmations = 0;
-      if (blockchainStatus?.registrationTxHash) {
+      // Confirmations come with the status; only older backends need a separate transaction lookup
+      let confirmations = blockchainStatus?.confirmations || 0;
+      if (blockchainStatus?.registrationTxHash && blockchainStatus.confirmations === undefined) {
         try {
           const txStatus = await blockchainAPI.getTransactionStatus(blockchainStatus.registrationTxHash);
           confirmations = txStatus.data.confirmations || 0;
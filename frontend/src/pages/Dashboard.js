@@ -31,6 +31,7 @@ import {
 import { useAuth } from '../context/AuthContext';
 import { userAPI, blockchainAPI, walletAPI } from '../services/api.service';
 import walletService from '../services/wallet.service';
+import { preloadFaceDetection } from '../utils/faceDetection';
 
 const Dashboard = () => {
   const { user } = useAuth();
@@ -851,6 +852,9 @@ const Dashboard = () => {
                 size="small" 
                 component={RouterLink} 
                 to="/biometric-verification"
+                onMouseEnter={preloadFaceDetection}
+                onFocus={preloadFaceDetection}
+                onTouchStart={preloadFaceDetection}
                 endIcon={<BiometricIcon />}
               >
                 {dashboardData.biometricStatus?.verified ? "Update Biometrics" : "Verify Now"}
@@ -0,0 +1,29 @@
+/**
+ * Lazily loaded pages
+ * Login and Register stay in the entry chunk so a cold start on either only
+ * downloads what it renders. Every page behind the login is its own chunk,
+ * and the wallet and blockchain pages pull in ethers only when they load.
+ * Layout calls preload() on nav link hover and focus; the dashboard is
+ * prefetched once the app is idle since it is where login lands.
+ */
+import { lazyRoute } from './utils/lazyRoute';
+
+export const Dashboard = lazyRoute(() => import(/* webpackChunkName: "page-dashboard", webpackPrefetch: true */ './pages/Dashboard'));
+export const Profile = lazyRoute(() => import(/* webpackChunkName: "page-profile" */ './pages/Profile'));
+export const WalletPage = lazyRoute(() => import(/* webpackChunkName: "page-wallet" */ './pages/WalletPage'));
+export const VerificationStatus = lazyRoute(() => import(/* webpackChunkName: "page-verification-status" */ './pages/VerificationStatus'));
+export const ProfessionalRecords = lazyRoute(() => import(/* webpackChunkName: "page-professional-records" */ './pages/ProfessionalRecords'));
+export const BlockchainStatus = lazyRoute(() => import(/* webpackChunkName: "page-blockchain-status" */ './pages/BlockchainStatus'));
+export const BiometricVerificationPage = lazyRoute(() => import(/* webpackChunkName: "page-biometric-verification" */ './pages/BiometricVerificationPage'));
+export const NotFound = lazyRoute(() => import(/* webpackChunkName: "page-not-found" */ './pages/NotFound'));
+
+// Nav paths (as in Layout) to the page each one renders
+export const routePages = {
+  '/': Dashboard,
+  '/profile': Profile,
+  '/wallet': WalletPage,
+  '/verification-status': VerificationStatus,
+  '/professional-records': ProfessionalRecords,
+  '/blockchain-status': BlockchainStatus,
+  '/biometric-verification': BiometricVerificationPage
+};
@@ -1,4 +1,5 @@
 import axios from 'axios';
+import { withFacemeshTemplate } from '../utils/facemeshTemplate';
 
 // Create an axios instance with default config
 const API = axios.create({
@@ -75,7 +76,7 @@ API.interceptors.response.use(
 // Auth API calls
 export const authAPI = {
   register: (userData) => {
-    return API.post('/user/register', userData);
+    return API.post('/user/register', withFacemeshTemplate(userData));
   },
   login: (credentials) => {
     return API.post('/user/login', credentials);
@@ -90,7 +91,7 @@ export const authAPI = {
         hasData: !!verificationData.facemeshData
       });
       
-      const response = await API.post('/user/verify-biometric', verificationData);
+      const response = await API.post('/user/verify-biometric', withFacemeshTemplate(verificationData, { keepFacemeshData: true }));
       console.log('Biometric verification response:', response.data);
       
       // Ensure we have a properly structured response
@@ -186,7 +187,7 @@ export const userAPI = {
     return API.get('/profession/status');
   },
   updateFacemesh: (facemeshData) => {
-    return API.put('/users/update-facemesh', { facemeshData });
+    return API.put('/users/update-facemesh', withFacemeshTemplate({ facemeshData }));
   },
   getBiometricStatus: async () => {
     try {
@@ -1,9 +1,31 @@
-import { ethers } from 'ethers';
-
 /**
  * Wallet Service for frontend
  * Handles Avalanche C-Chain wallet operations
+ *
+ * ethers is loaded on first use into its own chunk, so pages that import
+ * this service do not pull the chain libraries into their bundle.
  */
+let ethersModule = null;
+let ethersLoading = null;
+
+const loadEthers = () => {
+  if (!ethersLoading) {
+    ethersLoading = import(/* webpackChunkName: "vendor-ethers" */ 'ethers')
+      .then((module) => {
+        ethersModule = module.ethers;
+        return ethersModule;
+      })
+      .catch((error) => {
+        ethersLoading = null;
+        throw error;
+      });
+  }
+  return ethersLoading;
+};
+
+// Shape check used until ethers has loaded (ethers also validates the checksum)
+const ADDRESS_PATTERN = /^0x[0-9a-fA-F]{40}$/;
+
 class WalletService {
   constructor() {
     this.provider = null;
@@ -13,7 +35,7 @@ class WalletService {
     this.retryAttempts = 3;
     this.retryDelayMs = 1000;
     this.lastError = null;
-    this.initProvider();
+    // The provider is created on first use (getBalance) rather than at import
   }
 
   /**
@@ -25,6 +47,7 @@ class WalletService {
       const rpcUrl = process.env.REACT_APP_AVALANCHE_FUJI_RPC_URL || 'https://api.avax-test.network/ext/bc/C/rpc';
       console.log('Connecting to RPC URL:', rpcUrl);
       
+      const ethers = await loadEthers();
       this.provider = new ethers.providers.JsonRpcProvider(rpcUrl);
       
       // Test the connection by getting the network
@@ -63,6 +86,14 @@ class WalletService {
    * @returns {Promise<String>} Balance in AVAX
    */
   async getBalance(address, forceRefresh = false) {
+    let ethers;
+    try {
+      ethers = await loadEthers();
+    } catch (error) {
+      console.error('Failed to load wallet libraries:', error);
+      return '0';
+    }
+    
     // Validate address
     if (!this.isValidAddress(address)) {
       console.error('Invalid wallet address:', address);
@@ -160,7 +191,7 @@ class WalletService {
    */
   isValidAddress(address) {
     try {
-      return ethers.utils.isAddress(address);
+      return ethersModule ? ethersModule.utils.isAddress(address) : ADDRESS_PATTERN.test(address);
     } catch (error) {
       return false;
     }
@@ -188,6 +219,7 @@ class WalletService {
       const address = accounts[0];
       
       // Create a Web3Provider using the window.ethereum object
+      const ethers = await loadEthers();
       const provider = new ethers.providers.Web3Provider(window.ethereum);
       
       // Get the network information
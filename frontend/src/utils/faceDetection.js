@@ -0,0 +1,354 @@
+/**
+ * Face detection engine for the camera components
+ * Runs FaceDetectionPipeline in a dedicated Web Worker: camera frames are
+ * sent as transferred ImageBitmaps and the worker draws the detection overlay
+ * into an OffscreenCanvas, so the UI thread only schedules frames. The video
+ * element shows the live preview at full frame rate underneath the overlay.
+ *
+ * Frames are scheduled with requestVideoFrameCallback (requestAnimationFrame
+ * where unsupported). A frame is skipped while the previous one is still
+ * being analyzed or if it arrives within FRAME_INTERVAL_MS of the last one,
+ * so slow devices analyze fewer frames instead of queueing them.
+ *
+ * OpenCV.js is self-hosted under public/opencv: the SIMD+threads build when
+ * the page is cross-origin isolated, else the SIMD build, else the baseline
+ * build, else the CDN. The build that loaded is remembered so later visits
+ * try it first, and opencv-sw.js keeps it in Cache Storage. Call
+ * preloadFaceDetection when a camera route is about to be visited.
+ *
+ * Browsers without OffscreenCanvas fall back to the same pipeline on the main
+ * thread. Mirrored in admin-portal/src/utils.
+ */
+import { FaceDetectionPipeline, PROFILES, drawOverlay, whenOpenCvReady } from './faceDetectionPipeline';
+
+const OPENCV_CDN_URL = 'https://docs.opencv.org/4.5.5/opencv.js';
+const OPENCV_BASE_URL = `${process.env.PUBLIC_URL || ''}/opencv`;
+const OPENCV_BUILD_KEY = 'opencvBuild';
+
+// Smallest module using a v128 instruction; validates only where WebAssembly SIMD is supported
+const WASM_SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+]);
+
+// At most 10 analyzed frames per second
+export const FRAME_INTERVAL_MS = 100;
+
+// Wider frames are downscaled before analysis
+const MAX_FRAME_WIDTH = 640;
+
+const HAVE_ENOUGH_DATA = 4;
+
+let engine = null;
+let nextOverlayId = 1;
+const overlayIds = new WeakMap();
+
+/**
+ * OpenCV.js builds to try, best first
+ * @returns {Array} Script URLs
+ */
+const opencvBuilds = () => {
+  let simd = false;
+  try {
+    simd = typeof WebAssembly === 'object' && WebAssembly.validate(WASM_SIMD_PROBE);
+  } catch (error) {
+    simd = false;
+  }
+
+  const builds = [];
+  // Threads need SharedArrayBuffer, which needs COOP/COEP headers
+  if (simd && window.crossOriginIsolated) {
+    builds.push(`${OPENCV_BASE_URL}/simd-threads/opencv.js`);
+  }
+  if (simd) {
+    builds.push(`${OPENCV_BASE_URL}/simd/opencv.js`);
+  }
+  builds.push(`${OPENCV_BASE_URL}/opencv.js`, OPENCV_CDN_URL);
+
+  let last = null;
+  try {
+    last = localStorage.getItem(OPENCV_BUILD_KEY);
+  } catch (error) {
+    // Storage disabled
+  }
+  return builds.includes(last) ? [last, ...builds.filter(url => url !== last)] : builds;
+};
+
+const rememberBuild = (url) => {
+  try {
+    if (url) {
+      localStorage.setItem(OPENCV_BUILD_KEY, url);
+    }
+  } catch (error) {
+    // Storage disabled
+  }
+};
+
+const supportsWorker = () =>
+  typeof Worker !== 'undefined' &&
+  typeof OffscreenCanvas !== 'undefined' &&
+  typeof createImageBitmap === 'function' &&
+  typeof HTMLCanvasElement !== 'undefined' &&
+  'transferControlToOffscreen' in HTMLCanvasElement.prototype;
+
+const startWorker = () => new Promise((resolve, reject) => {
+  const worker = new Worker(new URL('./faceDetection.worker.js', import.meta.url));
+
+  const fail = (message) => {
+    worker.terminate();
+    reject(new Error(message));
+  };
+  const onError = (event) => fail(event.message || 'Face detection worker failed to start');
+  const onMessage = ({ data }) => {
+    if (data.type === 'ready') {
+      worker.removeEventListener('message', onMessage);
+      worker.removeEventListener('error', onError);
+      rememberBuild(data.url);
+      resolve({ mode: 'worker', worker });
+    } else if (data.type === 'error') {
+      fail(data.message);
+    }
+  };
+  worker.addEventListener('message', onMessage);
+  worker.addEventListener('error', onError);
+  worker.postMessage({ type: 'init', opencvUrls: opencvBuilds() });
+});
+
+const loadScript = (url) => new Promise((resolve, reject) => {
+  const script = document.createElement('script');
+  script.src = url;
+  script.async = true;
+  script.onload = resolve;
+  script.onerror = () => {
+    script.remove();
+    reject(new Error(`Failed to load ${url}`));
+  };
+  document.body.appendChild(script);
+});
+
+/**
+ * Load OpenCV.js on the page for the main-thread fallback
+ */
+const loadOpenCvScript = async () => {
+  if (!window.cv) {
+    let loaded = null;
+    for (const url of opencvBuilds()) {
+      try {
+        await loadScript(url);
+        loaded = url;
+        break;
+      } catch (error) {
+        console.warn(error.message);
+      }
+    }
+    if (!loaded) {
+      throw new Error('Failed to load OpenCV.js');
+    }
+    rememberBuild(loaded);
+  }
+  return whenOpenCvReady(window.cv);
+};
+
+/**
+ * Start loading the detection engine; safe to call repeatedly
+ * @returns {Promise<Object>} Engine ({ mode: 'worker', worker } or { mode: 'main', cv })
+ */
+export const loadFaceDetection = () => {
+  if (!engine) {
+    const worker = supportsWorker()
+      ? startWorker()
+      : Promise.reject(new Error('OffscreenCanvas is not supported'));
+
+    engine = worker
+      .catch((error) => {
+        console.warn('Face detection worker unavailable, using the main thread:', error.message);
+        return loadOpenCvScript().then(({ cv }) => ({ mode: 'main', cv }));
+      })
+      .catch((error) => {
+        // Allow a retry on the next call
+        engine = null;
+        throw error;
+      });
+  }
+  return engine;
+};
+
+/**
+ * Warm the detection engine before a camera route renders, e.g. on link
+ * hover or focus; runs when the browser is idle
+ */
+export const preloadFaceDetection = () => {
+  if (engine) return;
+  const load = () => loadFaceDetection().catch(() => {});
+  if (typeof window.requestIdleCallback === 'function') {
+    window.requestIdleCallback(load, { timeout: 2000 });
+  } else {
+    setTimeout(load, 0);
+  }
+};
+
+/**
+ * Create a detector that analyzes frames of a playing video
+ * @param {Object} options - video, canvas (overlay), profile ('user' | 'admin'),
+ *                           onResult(result), interval (ms between analyzed frames)
+ * @returns {Object} { start, stop }
+ */
+export const createFaceDetector = ({ video, canvas, profile = 'user', onResult, interval = FRAME_INTERVAL_MS }) => {
+  let wanted = false;
+  let running = false;
+  let busy = false;
+  let lastFrameAt = -Infinity;
+  let frameHandle = null;
+  let current = null;
+  let pipeline = null;
+  let scratch = null;
+
+  const useVideoFrames = typeof video.requestVideoFrameCallback === 'function';
+
+  const frameSize = () => {
+    const { videoWidth, videoHeight } = video;
+    if (videoWidth <= MAX_FRAME_WIDTH) {
+      return { width: videoWidth, height: videoHeight };
+    }
+    return { width: MAX_FRAME_WIDTH, height: Math.round(videoHeight * MAX_FRAME_WIDTH / videoWidth) };
+  };
+
+  const onWorkerMessage = ({ data }) => {
+    if (data.type !== 'result') return;
+    busy = false;
+    if (data.error) {
+      console.error('Error in face detection:', data.error);
+    } else if (running && onResult) {
+      onResult(data.result);
+    }
+  };
+
+  const submitToWorker = () => {
+    const { width, height } = frameSize();
+    busy = true;
+    createImageBitmap(video, { resizeWidth: width, resizeHeight: height })
+      .then((bitmap) => {
+        if (!running) {
+          bitmap.close();
+          busy = false;
+          return;
+        }
+        current.worker.postMessage({ type: 'frame', bitmap }, [bitmap]);
+      })
+      .catch(() => {
+        busy = false;
+      });
+  };
+
+  const analyzeOnMainThread = () => {
+    const { width, height } = frameSize();
+    if (!scratch) {
+      scratch = document.createElement('canvas');
+    }
+    if (scratch.width !== width || scratch.height !== height) {
+      scratch.width = width;
+      scratch.height = height;
+    }
+    const ctx = scratch.getContext('2d', { willReadFrequently: true });
+    ctx.drawImage(video, 0, 0, width, height);
+
+    try {
+      const result = pipeline.analyze(ctx.getImageData(0, 0, width, height));
+      drawOverlay(canvas.getContext('2d'), result, PROFILES[profile] || PROFILES.user);
+      if (onResult) {
+        onResult(result);
+      }
+    } catch (error) {
+      console.error('Error in face detection:', error);
+    }
+  };
+
+  const scheduleFrame = () => {
+    frameHandle = useVideoFrames
+      ? video.requestVideoFrameCallback(onFrame)
+      : requestAnimationFrame(onFrame);
+  };
+
+  const onFrame = (now) => {
+    if (!running) return;
+
+    if (!busy && video.readyState >= HAVE_ENOUGH_DATA && video.videoWidth > 0 && now - lastFrameAt >= interval) {
+      lastFrameAt = now;
+      if (current.mode === 'worker') {
+        submitToWorker();
+      } else {
+        analyzeOnMainThread();
+      }
+    }
+    scheduleFrame();
+  };
+
+  const start = async () => {
+    wanted = true;
+    const loaded = await loadFaceDetection();
+    // stop() was called while the engine loaded
+    if (!wanted || running) return;
+    current = loaded;
+    running = true;
+
+    if (current.mode === 'worker') {
+      let id = overlayIds.get(canvas);
+      const message = { type: 'attach', id, profile };
+      const transfer = [];
+      if (!id) {
+        id = nextOverlayId++;
+        overlayIds.set(canvas, id);
+        message.id = id;
+        message.canvas = canvas.transferControlToOffscreen();
+        transfer.push(message.canvas);
+      }
+      current.worker.addEventListener('message', onWorkerMessage);
+      current.worker.postMessage(message, transfer);
+    } else {
+      pipeline = new FaceDetectionPipeline(current.cv, PROFILES[profile] || PROFILES.user);
+    }
+
+    scheduleFrame();
+  };
+
+  const stop = () => {
+    wanted = false;
+    if (!running) return;
+    running = false;
+    busy = false;
+
+    if (frameHandle !== null) {
+      if (useVideoFrames) {
+        video.cancelVideoFrameCallback(frameHandle);
+      } else {
+        cancelAnimationFrame(frameHandle);
+      }
+      frameHandle = null;
+    }
+
+    if (current.mode === 'worker') {
+      current.worker.removeEventListener('message', onWorkerMessage);
+      current.worker.postMessage({ type: 'detach' });
+    } else {
+      pipeline.delete();
+      pipeline = null;
+      const ctx = canvas.getContext('2d');
+      ctx.clearRect(0, 0, canvas.width, canvas.height);
+    }
+  };
+
+  return { start, stop };
+};
+
+/**
+ * Capture the current video frame as a JPEG data URL
+ * @param {HTMLVideoElement} video - Playing video
+ * @param {Number} quality - JPEG quality
+ * @returns {String} Data URL
+ */
+export const captureFrame = (video, quality = 0.9) => {
+  const canvas = document.createElement('canvas');
+  canvas.width = video.videoWidth;
+  canvas.height = video.videoHeight;
+  canvas.getContext('2d').drawImage(video, 0, 0, canvas.width, canvas.height);
+  return canvas.toDataURL('image/jpeg', quality);
+};
@@ -0,0 +1,118 @@
+/* eslint-disable no-restricted-globals */
+/**
+ * Face detection worker
+ * Runs OpenCV.js off the UI thread. Receives camera frames as transferred
+ * ImageBitmaps, analyzes them with FaceDetectionPipeline and draws the overlay
+ * straight into the attached OffscreenCanvas.
+ *
+ * Messages in:  init { opencvUrls }, attach { id, canvas?, profile }, frame { bitmap }, detach
+ * Messages out: ready { url }, error { message }, result { result } or { error }
+ */
+import { FaceDetectionPipeline, PROFILES, drawOverlay, whenOpenCvReady } from './faceDetectionPipeline';
+
+let opencv = null;
+let pipeline = null;
+let profile = PROFILES.user;
+let overlay = null;
+let scratch = null;
+
+// A canvas can be transferred only once, so overlays are kept by id for re-attachment;
+// canvases of unmounted components are never attached again, so only the latest few are kept
+const overlays = new Map();
+const MAX_OVERLAYS = 4;
+
+let loadedUrl = null;
+
+/**
+ * Import the first OpenCV.js build that loads
+ * @param {Array} urls - Script URLs, best first
+ */
+const loadOpenCv = (urls) => {
+  if (!opencv) {
+    opencv = Promise.resolve().then(() => {
+      for (const url of urls) {
+        try {
+          self.importScripts(url);
+          loadedUrl = url;
+          break;
+        } catch (error) {
+          // Missing self-hosted build; try the next one
+        }
+      }
+      if (!loadedUrl) {
+        throw new Error('Failed to load OpenCV.js');
+      }
+      return whenOpenCvReady(self.cv);
+    });
+  }
+  return opencv;
+};
+
+const processFrame = async (bitmap) => {
+  const { cv } = await opencv;
+  const { width, height } = bitmap;
+
+  if (!scratch || scratch.width !== width || scratch.height !== height) {
+    scratch = new OffscreenCanvas(width, height);
+  }
+  const ctx = scratch.getContext('2d', { willReadFrequently: true });
+  ctx.drawImage(bitmap, 0, 0);
+  bitmap.close();
+
+  if (!pipeline) {
+    pipeline = new FaceDetectionPipeline(cv, profile);
+  }
+  const result = pipeline.analyze(ctx.getImageData(0, 0, width, height));
+
+  if (overlay) {
+    drawOverlay(overlay.getContext('2d'), result, profile);
+  }
+  self.postMessage({ type: 'result', result });
+};
+
+self.onmessage = ({ data }) => {
+  switch (data.type) {
+    case 'init':
+      loadOpenCv(data.opencvUrls)
+        .then(() => self.postMessage({ type: 'ready', url: loadedUrl }))
+        .catch(error => self.postMessage({ type: 'error', message: error.message || 'Failed to load OpenCV.js' }));
+      break;
+
+    case 'attach': {
+      if (data.canvas) {
+        overlays.set(data.id, data.canvas);
+        if (overlays.size > MAX_OVERLAYS) {
+          overlays.delete(overlays.keys().next().value);
+        }
+      }
+      overlay = overlays.get(data.id) || null;
+
+      const next = PROFILES[data.profile] || PROFILES.user;
+      if (next !== profile) {
+        profile = next;
+        if (pipeline) {
+          pipeline.delete();
+          pipeline = null;
+        }
+      }
+      break;
+    }
+
+    case 'frame':
+      processFrame(data.bitmap).catch(error => {
+        data.bitmap.close();
+        self.postMessage({ type: 'result', error: error.message });
+      });
+      break;
+
+    case 'detach':
+      if (overlay) {
+        overlay.getContext('2d').clearRect(0, 0, overlay.width, overlay.height);
+        overlay = null;
+      }
+      break;
+
+    default:
+      break;
+  }
+};
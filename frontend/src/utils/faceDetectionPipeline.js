@@ -0,0 +1,176 @@
+/**
+ * Face presence heuristic on OpenCV.js
+ * Shared by the face detection worker and its main-thread fallback; the same
+ * file is mirrored in admin-portal/src/utils.
+ *
+ * A frame "contains a face" when the region of interest is bright enough,
+ * has enough contrast and enough Canny edges. All Mats are allocated once per
+ * frame size and reused, so steady-state frames allocate nothing on the
+ * OpenCV heap.
+ */
+
+/**
+ * Wait for an OpenCV.js module's WASM runtime
+ * Builds differ: cv may be a thenable, an initialized module or a module
+ * that calls onRuntimeInitialized. Resolves to { cv } because the module
+ * itself can be a thenable
+ * @param {Object} cv - The global cv after opencv.js has loaded
+ * @returns {Promise<Object>} { cv }
+ */
+export const whenOpenCvReady = (cv) => new Promise((resolve, reject) => {
+  if (!cv) {
+    reject(new Error('OpenCV.js did not initialize'));
+  } else if (cv.Mat) {
+    resolve({ cv });
+  } else if (typeof cv.then === 'function') {
+    cv.then(module => {
+      delete module.then;
+      resolve({ cv: module });
+    });
+  } else {
+    cv.onRuntimeInitialized = () => resolve({ cv });
+  }
+});
+
+/**
+ * Detection profiles
+ * roi is [x, y, width, height] as fractions of the frame; required is how
+ * many of the three checks must pass
+ */
+export const PROFILES = {
+  // Citizen verification (frontend BiometricVerification)
+  user: {
+    roi: [0.25, 0.15, 0.5, 0.7],
+    minBrightness: 40,
+    minContrast: 15,
+    minEdgeRatio: 5 / 255,
+    required: 3,
+    marker: 'center'
+  },
+
+  // Officer-assisted identification (admin BiometricVerificationAdmin)
+  admin: {
+    roi: [0.2, 0.2, 0.6, 0.6],
+    minBrightness: 30,
+    minContrast: 15,
+    minEdgeRatio: 0.03,
+    required: 2,
+    marker: 'target'
+  }
+};
+
+export class FaceDetectionPipeline {
+  constructor(cv, profile = PROFILES.user) {
+    this.cv = cv;
+    this.profile = profile;
+    this.width = 0;
+    this.height = 0;
+    this.mats = null;
+  }
+
+  /**
+   * (Re)allocate the Mats when the frame size changes
+   */
+  resize(width, height) {
+    if (this.mats && width === this.width && height === this.height) return;
+    this.delete();
+
+    const cv = this.cv;
+    const [x, y, w, h] = this.profile.roi;
+    const rect = new cv.Rect(
+      Math.floor(width * x),
+      Math.floor(height * y),
+      Math.floor(width * w),
+      Math.floor(height * h)
+    );
+    const gray = new cv.Mat(height, width, cv.CV_8UC1);
+
+    this.width = width;
+    this.height = height;
+    this.rect = rect;
+    this.mats = {
+      src: new cv.Mat(height, width, cv.CV_8UC4),
+      gray,
+      // View into gray; follows it without copying
+      region: gray.roi(rect),
+      mean: new cv.Mat(),
+      stdDev: new cv.Mat(),
+      edges: new cv.Mat(rect.height, rect.width, cv.CV_8UC1)
+    };
+  }
+
+  /**
+   * Analyze one RGBA frame
+   * @param {ImageData} imageData - Frame pixels
+   * @returns {Object} faceDetected, brightness, contrast, edgeRatio, roi and frame size
+   */
+  analyze(imageData) {
+    const cv = this.cv;
+    const profile = this.profile;
+    this.resize(imageData.width, imageData.height);
+    const { src, gray, region, mean, stdDev, edges } = this.mats;
+
+    src.data.set(imageData.data);
+    cv.cvtColor(src, gray, cv.COLOR_RGBA2GRAY);
+    cv.meanStdDev(region, mean, stdDev);
+    cv.Canny(region, edges, 50, 150);
+
+    const brightness = mean.data64F[0];
+    const contrast = stdDev.data64F[0];
+    const edgeRatio = cv.countNonZero(edges) / (this.rect.width * this.rect.height);
+
+    const passed = [
+      brightness > profile.minBrightness,
+      contrast > profile.minContrast,
+      edgeRatio > profile.minEdgeRatio
+    ].filter(Boolean).length;
+
+    return {
+      faceDetected: passed >= profile.required,
+      brightness,
+      contrast,
+      edgeRatio,
+      roi: { x: this.rect.x, y: this.rect.y, width: this.rect.width, height: this.rect.height },
+      width: this.width,
+      height: this.height
+    };
+  }
+
+  delete() {
+    if (!this.mats) return;
+    Object.values(this.mats).forEach(mat => mat.delete());
+    this.mats = null;
+  }
+}
+
+/**
+ * Draw the detection overlay; the canvas sits transparently over the live video
+ * @param {CanvasRenderingContext2D|OffscreenCanvasRenderingContext2D} ctx - Overlay context
+ * @param {Object} result - FaceDetectionPipeline.analyze result
+ * @param {Object} profile - Detection profile
+ */
+export const drawOverlay = (ctx, result, profile) => {
+  const { roi, width, height, faceDetected } = result;
+  if (ctx.canvas.width !== width || ctx.canvas.height !== height) {
+    ctx.canvas.width = width;
+    ctx.canvas.height = height;
+  }
+  ctx.clearRect(0, 0, width, height);
+
+  ctx.lineWidth = 2;
+  ctx.strokeStyle = faceDetected ? 'rgb(0, 255, 0)' : 'rgb(255, 0, 0)';
+  ctx.strokeRect(roi.x, roi.y, roi.width, roi.height);
+
+  if (profile.marker === 'center' && faceDetected) {
+    // Sweet spot for face positioning
+    ctx.strokeStyle = 'rgb(0, 255, 255)';
+    ctx.beginPath();
+    ctx.arc(roi.x + Math.floor(roi.width / 2), roi.y + Math.floor(roi.height / 2), 20, 0, 2 * Math.PI);
+    ctx.stroke();
+  } else if (profile.marker === 'target') {
+    ctx.strokeStyle = 'rgba(255, 255, 255, 0.5)';
+    ctx.beginPath();
+    ctx.arc(Math.floor(width / 2), Math.floor(height / 2), Math.floor(width / 10), 0, 2 * Math.PI);
+    ctx.stroke();
+  }
+};
@@ -0,0 +1,90 @@
+/**
+ * Binary facemesh template encoder
+ * Mirrors backend/utils/facemesh-template.utils.js (format version 1, int16 quantized)
+ */
+const TEMPLATE_MAGIC = 0x4d46; // "FM"
+const TEMPLATE_VERSION = 1;
+const ENCODING_INT16 = 1;
+const HEADER_SIZE = 8;
+const QUANTIZATION_SIZE = 24;
+
+/**
+ * Encode {x, y, z} landmarks into a base64 facemesh template
+ * @param {Array} landmarks - Facial landmarks
+ * @returns {String|null} Base64 template, or null if the landmarks are incomplete
+ */
+export const encodeFacemeshTemplate = (landmarks) => {
+  if (!Array.isArray(landmarks) || landmarks.length === 0 || landmarks.length > 0xffff) {
+    return null;
+  }
+
+  const count = landmarks.length;
+  const axes = ['x', 'y', 'z'];
+  const view = new DataView(new ArrayBuffer(HEADER_SIZE + QUANTIZATION_SIZE + count * 6));
+
+  view.setUint16(0, TEMPLATE_MAGIC, true);
+  view.setUint8(2, TEMPLATE_VERSION);
+  view.setUint8(3, ENCODING_INT16);
+  view.setUint16(4, count, true);
+  view.setUint16(6, 0, true);
+
+  let offset = HEADER_SIZE + QUANTIZATION_SIZE;
+
+  for (let axis = 0; axis < 3; axis++) {
+    const key = axes[axis];
+    let min = Infinity;
+    let max = -Infinity;
+
+    // Round through float32 so the bytes match the backend encoder
+    for (const point of landmarks) {
+      if (!point || typeof point[key] !== 'number' || !Number.isFinite(point[key])) {
+        return null;
+      }
+      const value = Math.fround(point[key]);
+      if (value < min) min = value;
+      if (value > max) max = value;
+    }
+
+    const step = max > min ? (max - min) / 0xffff : 1;
+    view.setFloat32(HEADER_SIZE + axis * 4, min, true);
+    view.setFloat32(HEADER_SIZE + 12 + axis * 4, step, true);
+
+    for (const point of landmarks) {
+      view.setInt16(offset, Math.round((Math.fround(point[key]) - min) / step) - 0x8000, true);
+      offset += 2;
+    }
+  }
+
+  let binary = '';
+  const bytes = new Uint8Array(view.buffer);
+  for (let i = 0; i < bytes.length; i++) {
+    binary += String.fromCharCode(bytes[i]);
+  }
+  return btoa(binary);
+};
+
+/**
+ * Replace a request's facemeshData landmarks with a compact facemeshTemplate
+ * Requests without usable landmarks are returned unchanged. Verification
+ * requests keep facemeshData as well: users enrolled before templates only
+ * have a hash of the JSON landmarks, which the template cannot reproduce.
+ * @param {Object} payload - Request body containing facemeshData
+ * @param {Object} options - { keepFacemeshData } to send both forms
+ * @returns {Object} Request body to send
+ */
+export const withFacemeshTemplate = (payload, options = {}) => {
+  const facemeshTemplate = payload && payload.facemeshData
+    ? encodeFacemeshTemplate(payload.facemeshData.landmarks)
+    : null;
+
+  if (!facemeshTemplate) {
+    return payload;
+  }
+
+  if (options.keepFacemeshData) {
+    return { ...payload, facemeshTemplate };
+  }
+
+  const { facemeshData, ...rest } = payload;
+  return { ...rest, facemeshTemplate };
+};
@@ -0,0 +1,31 @@
+/**
+ * Route-level code splitting
+ * lazyRoute wraps a dynamic import in React.lazy and adds preload(), so a
+ * route's chunk can be fetched on link hover or focus before it is visited.
+ * A failed chunk load is not cached, so the next preload or render retries it.
+ * Mirrored in admin-portal/src/utils.
+ */
+import { lazy } from 'react';
+
+/**
+ * @param {Function} factory - () => import('./pages/Page')
+ * @returns {React.LazyExoticComponent} Lazy component with a preload() method
+ */
+export const lazyRoute = (factory) => {
+  let pending = null;
+  const load = () => {
+    if (!pending) {
+      pending = factory().catch((error) => {
+        pending = null;
+        throw error;
+      });
+    }
+    return pending;
+  };
+
+  const Component = lazy(load);
+  Component.preload = () => {
+    load().catch(() => {});
+  };
+  return Component;
+};
@@ -0,0 +1,92 @@
+/**
+ * Bundle size budget check for the React apps
+ * Run from frontend/ or admin-portal/ after `npm run build`. Reads
+ * build/asset-manifest.json, gzips every emitted JS and CSS file, and
+ * checks the sizes against the "bundleBudget" block of that app's
+ * package.json:
+ *
+ *   initialKb    gzipped total of the entrypoint files (what first paint downloads)
+ *   chunkKb      largest gzipped lazy chunk
+ *   totalKb      gzipped total of every JS and CSS file
+ *   initialMustNotInclude  strings that must not appear in entrypoint JS,
+ *                e.g. "ethers/5." to keep the chain libraries out of first paint
+ *
+ * Exits with code 1 when a budget is exceeded.
+ *
+ * Usage: npm run build && npm run check:size
+ */
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+
+const appDir = process.cwd();
+const buildDir = path.join(appDir, 'build');
+const manifestFile = path.join(buildDir, 'asset-manifest.json');
+
+const kb = bytes => Math.round((bytes / 1024) * 10) / 10;
+
+function main() {
+  const pkg = JSON.parse(fs.readFileSync(path.join(appDir, 'package.json'), 'utf8'));
+  const budget = pkg.bundleBudget;
+  if (!budget) {
+    throw new Error(`No bundleBudget in ${path.join(appDir, 'package.json')}`);
+  }
+  if (!fs.existsSync(manifestFile)) {
+    throw new Error(`${manifestFile} not found; run npm run build first`);
+  }
+
+  const manifest = JSON.parse(fs.readFileSync(manifestFile, 'utf8'));
+  const initial = new Set(manifest.entrypoints || []);
+  const assets = Object.values(manifest.files)
+    .filter(file => /\.(js|css)$/.test(file))
+    // Manifest paths are relative to the public URL
+    .map(file => file.replace(/^.*?static\//, 'static/'));
+
+  const sizes = [...new Set(assets)].map((file) => {
+    const content = fs.readFileSync(path.join(buildDir, file));
+    return { file, gzip: zlib.gzipSync(content, { level: 9 }).length, initial: initial.has(file), content };
+  }).sort((a, b) => b.gzip - a.gzip);
+
+  const initialKb = kb(sizes.filter(s => s.initial).reduce((sum, s) => sum + s.gzip, 0));
+  const totalKb = kb(sizes.reduce((sum, s) => sum + s.gzip, 0));
+  const lazy = sizes.filter(s => !s.initial && s.file.endsWith('.js'));
+  const largestChunk = lazy[0];
+
+  const width = Math.max(...sizes.map(s => s.file.length));
+  for (const s of sizes) {
+    console.log(`${s.file.padEnd(width)} ${String(kb(s.gzip)).padStart(8)} kB gzip${s.initial ? '  (initial)' : ''}`);
+  }
+  console.log(`initial ${initialKb} kB, total ${totalKb} kB, largest lazy chunk ${largestChunk ? kb(largestChunk.gzip) : 0} kB`);
+
+  const failures = [];
+  if (budget.initialKb && initialKb > budget.initialKb) {
+    failures.push(`initial bundle ${initialKb} kB exceeds ${budget.initialKb} kB`);
+  }
+  if (budget.totalKb && totalKb > budget.totalKb) {
+    failures.push(`total ${totalKb} kB exceeds ${budget.totalKb} kB`);
+  }
+  if (budget.chunkKb && largestChunk && kb(largestChunk.gzip) > budget.chunkKb) {
+    failures.push(`${largestChunk.file} ${kb(largestChunk.gzip)} kB exceeds ${budget.chunkKb} kB`);
+  }
+  for (const marker of budget.initialMustNotInclude || []) {
+    for (const s of sizes.filter(entry => entry.initial && entry.file.endsWith('.js'))) {
+      if (s.content.includes(marker)) {
+        failures.push(`${s.file} contains "${marker}", which should only load on demand`);
+      }
+    }
+  }
+
+  if (failures.length > 0) {
+    console.error(`Bundle budget exceeded:\n  ${failures.join('\n  ')}`);
+    process.exitCode = 1;
+  } else {
+    console.log('Bundle within budget');
+  }
+}
+
+try {
+  main();
+} catch (error) {
+  console.error('Bundle size check failed:', error.message);
+  process.exit(1);
+}